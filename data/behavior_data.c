@@ -5223,17 +5223,6 @@ const BehaviorScript bhvWigglerHead[] = {
     END_LOOP(),
 };
 
-const BehaviorScript bhvWigglerBody[] = {
-    BEGIN(OBJ_LIST_GENACTOR),
-    OR_INT(oFlags, OBJ_FLAG_UPDATE_GFX_POS_AND_ANGLE),
-    LOAD_ANIMATIONS(oAnimations, wiggler_seg5_anims_0500C874),
-    SET_OBJ_PHYSICS(/*Wall hitbox radius*/ 0, /*Gravity*/ -400, /*Bounciness*/ 0, /*Drag strength*/ 1000, /*Friction*/ 1000, /*Buoyancy*/ 200, /*Unused*/ 0, 0),
-    SCALE(/*Unused*/ 0, /*Field*/ 400),
-    BEGIN_LOOP(),
-        CALL_NATIVE(bhv_wiggler_body_part_update),
-    END_LOOP(),
-};
-
 const BehaviorScript bhvEnemyLakitu[] = {
     BEGIN(OBJ_LIST_PUSHABLE),
     OR_INT(oFlags, (OBJ_FLAG_COMPUTE_ANGLE_TO_MARIO | OBJ_FLAG_COMPUTE_DIST_TO_MARIO | OBJ_FLAG_UPDATE_GFX_POS_AND_ANGLE)),
@@ -5518,6 +5507,7 @@ const BehaviorScript bhvTTCSpinner[] = {
     LOAD_COLLISION_DATA(ttc_seg7_collision_rotating_clock_platform2),
     OR_INT(oFlags, OBJ_FLAG_UPDATE_GFX_POS_AND_ANGLE),
     SET_FLOAT(oCollisionDistance, 450),
+    CALL_NATIVE(bhv_ttc_spinner_init),
     BEGIN_LOOP(),
         CALL_NATIVE(bhv_ttc_spinner_update),
         CALL_NATIVE(load_object_collision_model),
@@ -5570,7 +5560,6 @@ const BehaviorScript bhvOctagonalPlatformRotating[] = {
     OR_INT(oFlags, OBJ_FLAG_UPDATE_GFX_POS_AND_ANGLE),
     CALL_NATIVE(bhv_rotating_octagonal_plat_init),
     BEGIN_LOOP(),
-        CALL_NATIVE(bhv_rotating_octagonal_plat_loop),
         CALL_NATIVE(load_object_collision_model),
     END_LOOP(),
 };
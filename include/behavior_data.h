@@ -462,7 +462,6 @@ extern const BehaviorScript bhvChainChompChainPart[];
 extern const BehaviorScript bhvWoodenPost[];
 extern const BehaviorScript bhvChainChompGate[];
 extern const BehaviorScript bhvWigglerHead[];
-extern const BehaviorScript bhvWigglerBody[];
 extern const BehaviorScript bhvEnemyLakitu[];
 extern const BehaviorScript bhvCameraLakitu[];
 extern const BehaviorScript bhvCloud[];
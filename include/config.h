@@ -5,6 +5,11 @@
  * A catch-all file for configuring various bugfixes and other settings in SM64
  */
 
+#ifdef POOL_SIZES
+// Generated by tools/level_pool_sizes.py (POOL_SIZES=1 in the Makefile)
+#include "pool_sizes.h"
+#endif
+
 #include "config/config_audio.h"
 #include "config/config_benchmark.h"
 #include "config/config_camera.h"
@@ -45,6 +45,32 @@
 #define MAX_SIMULTANEOUS_NOTES_EMULATOR 40
 #define MAX_SIMULTANEOUS_NOTES_CONSOLE 24
 
+/**
+ * Notes whose volume stays below this threshold (out of 0x7FFF) are not synthesized, while their playback position still advances as normal (US/JP only).
+ * This saves RSP and CPU time on notes that are fading out or drowned out by distance, at the cost of a small inaccuracy in the first samples once such a note becomes audible again.
+ * Comment out to synthesize every enabled note like vanilla.
+ */
+// #define INAUDIBLE_NOTE_VOLUME_THRESHOLD 0x20
+
+/**
+ * Notes playing the same sample from the same position at the same pitch as the note synthesized right before them reuse its decoded
+ * and resampled samples, and only mix them in with their own volume (US/JP only). This happens when sequences double a voice on several channels.
+ * Each merged note costs a 64 byte state copy on the RSP instead of its sample DMA, ADPCM decoding and resampling.
+ */
+// #define MERGE_UNISON_NOTES
+
+/**
+ * Audio updates in which no note is playing only output silence, without any sequence-independent synthesis work on the CPU or RSP (US/JP only).
+ * The reverb is left to ring out first, then cleared, so nothing stale plays once a note starts again.
+ */
+// #define SKIP_SILENT_AUDIO_UPDATES
+
+/**
+ * Adjusts how far ahead of playback the audio interface is kept to the measured margin, instead of a fixed amount (US/JP only).
+ * Buffering grows right after the AI runs (nearly) dry and slowly backs off again while there's margin to spare, so latency is only added when it's needed.
+ */
+// #define ADAPTIVE_AI_BUFFERING
+
 /** 
  * Uses a much better implementation of reverb over vanilla's fake echo reverb. Great for caves or eerie levels, as well as just a better audio experience in general.
  * Reverb presets can be configured in audio/data.c to meet desired aesthetic/performance needs. More detailed usage info can also be found on the HackerSM64 Wiki page.
@@ -15,3 +15,13 @@
     #define ENABLE_VANILLA_LEVEL_SPECIFIC_CHECKS
     #define TEST_LEVEL LEVEL_CASTLE_GROUNDS
 #endif
+
+/**
+ * Prints the average frame times of the benchmark to the debug output (ISVPRINT or UNF) once, after skipping the first
+ * BENCHMARK_WARMUP_FRAMES frames and measuring the next BENCHMARK_REPORT_FRAMES. Both need to be multiples of 64.
+ * Used by tools/opt_flag_tuner.py, which builds with CREDITS_BENCHMARK=1 to turn on the credits benchmark.
+ */
+#ifdef ENABLE_CREDITS_BENCHMARK
+    #define BENCHMARK_WARMUP_FRAMES 256
+    #define BENCHMARK_REPORT_FRAMES 1920
+#endif
@@ -64,6 +64,12 @@
  */
 #define VISUAL_DEBUG
 
+/**
+ * How many collision cells around Mario's the visual surface view draws. 0 only draws the cell Mario is in.
+ * Static surfaces are only rebuilt when Mario moves to another cell, so a larger radius mostly costs RDP time.
+ */
+#define VISUAL_DEBUG_SURFACE_RADIUS 0
+
 /**
  * Opens all courses and doors. Used for debugging purposes to unlock all content.
  */
@@ -94,3 +100,15 @@
  * Intentionally crash the game whenever a runtime assertion fails (also invoked by the DEBUG define in the Makefile).
  */
 #define DEBUG_ASSERTIONS
+
+/**
+ * In ISVPRINT and UNF builds, queues osSyncPrintf and debug_printf output in a ring buffer that a low priority thread
+ * writes out in small chunks, instead of stalling the printing thread on every IS-Viewer or USB write.
+ * Output that doesn't fit in the buffer is dropped and reported once there's room again.
+ */
+// #define BUFFERED_DEBUG_PRINT
+
+/**
+ * Prefixes every line of buffered debug output with the time it was printed at, in milliseconds since boot.
+ */
+// #define DEBUG_PRINT_TIMESTAMPS
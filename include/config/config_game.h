@@ -60,6 +60,17 @@
  */
 #define AREA_COUNT 8
 
+/**
+ * Spreads out spawning an area's objects over the frames after it loads, instead of creating all of them at once.
+ * Objects within TIME_SLICED_SPAWN_NEAR_DIST of the warp Mario enters from still spawn immediately, as do all warp objects,
+ * the rest spawn nearest first, for at most TIME_SLICED_SPAWN_BUDGET microseconds per frame. Objects that look for other
+ * objects when they initialize may not find them yet, so test your levels with this enabled, and add the behaviors of the
+ * objects they look for to sNeverDeferredBehaviors in object_list_processor.c (red coins and hidden stars already are).
+ */
+// #define TIME_SLICED_SPAWNING
+#define TIME_SLICED_SPAWN_NEAR_DIST 4000.0f
+#define TIME_SLICED_SPAWN_BUDGET    500
+
 /**
  * Makes signs and NPCs easier to talk to.
  */
@@ -98,3 +109,16 @@
  * The levelscript needs to have a MARIO_POS command for this to work.
  */
 #define START_LEVEL LEVEL_CASTLE_GROUNDS
+
+/**
+ * Computes atan2s with a polynomial instead of the arctangent table. The result is at most 0.6 units from the exact angle
+ * (the table's is up to 5.4) and avoids a load from the 4KB table, but angles differ slightly from vanilla.
+ */
+// #define ATAN2S_POLYNOMIAL
+
+/**
+ * Makes the rotate-and-translate matrix builders skip the rotation when it's zero, as it is for every translation node.
+ * The result is the same as doing the full multiplication, except that negative zeros in the parent matrix stay negative
+ * instead of becoming positive zeros.
+ */
+// #define MTXF_SKIP_ZERO_ROTATION
@@ -6,14 +6,26 @@
 
 /**
  * The size of the master display list (gDisplayListHead). 6400 is vanilla.
+ * Building with POOL_SIZES=1 raises this if the level data needs more.
  */
+#ifndef GFX_POOL_SIZE
 #define GFX_POOL_SIZE 10000
+#endif
+
+/**
+ * Keeps the graph nodes built from the actor groups' models across level loads, and reuses them whenever a level loads the same group again.
+ * GEO_LAYOUT_CACHE_SIZE bytes are set aside for them, which should fit the groups that are used most.
+ */
+// #define GEO_LAYOUT_CACHE
+#define GEO_LAYOUT_CACHE_SIZE    0x8000
+#define GEO_LAYOUT_CACHE_ENTRIES 256
 
 /**
  * Causes the global light direction to be in world space,
  * this allows you to have a singular light source that doesn't change with the camera's rotation.
  * By modifying `globalLightDirection`, you can choose the direction that points TOWARDS the light,
  * but keep in mind that this direction should be normalized to roughly ~127 if changed.
+ * Always on when building with BAKE_LEVEL_LIGHTING=1, whose BAKE_LEVEL_LIGHTING_DIR has to match `globalLightDirection`.
  */
 // #define WORLDSPACE_LIGHTING
 
@@ -84,6 +96,14 @@
  */
 #define SILHOUETTE 63
 
+/**
+ * Skips the silhouette pass while nothing is between the camera and Mario, which is tested each frame
+ * with a few raycasts against collision. Saves the silhouette's extra draw of Mario most of the time,
+ * but unlike vanilla, Mario gets no silhouette behind geometry without collision (e.g. trees and decorations).
+ * Requires SILHOUETTE.
+ */
+// #define SILHOUETTE_VISIBILITY_CHECK
+
 /**
  * Use 64x64 quarter shadow textures (Vanilla are 16x16).
  */
@@ -146,6 +166,18 @@
  */
 #define POLISHED_TRANSITIONS
 
+/**
+ * Alternates between the far and near half of the depth range every frame, so the Z-buffer only needs to be cleared every other frame.
+ * Saves RDP fill time, at the cost of half the depth precision (may cause more Z-fighting on distant surfaces).
+ */
+// #define ALTERNATE_ZBUFFER_RANGES
+
+/**
+ * Only clears the part of the Z-buffer the area is drawn to when it's scissored to a clip viewport (e.g. the letterboxed ending cutscene), rather than the whole screen.
+ * Whatever the previous frames drew outside of that is cleared along with it. Only saves RDP fill time while a clip viewport is in use.
+ */
+// #define CLIP_ZBUFFER_CLEAR
+
 /**
  * Uses frustratio of 2 instead of 1.
  * Can improve performance in some circumstances, though it can also cause large tris to warp if cut off from the camera.
@@ -29,3 +29,17 @@
 #define EXIT_COURSE_LEVEL LEVEL_CASTLE
 #define EXIT_COURSE_AREA 0x01
 #define EXIT_COURSE_NODE 0x1F
+
+// -- PAUSE MENU SETTINGS --
+
+/**
+ * Captures the frame once the pause screen's camera has settled and draws the pause menu over that image until unpausing,
+ * instead of rendering the area every paused frame. The image is kept in the Z-buffer, so it costs no extra RAM.
+ * NOTE: Anything that animates while paused (environment effects like snow, scrolling textures) stands still.
+ */
+// #define PAUSE_FROZEN_BACKGROUND
+
+/**
+ * Bakes the pause menu's darkening into the frozen background, so it isn't drawn again every paused frame (has no effect if you disable PAUSE_FROZEN_BACKGROUND).
+ */
+// #define PAUSE_FROZEN_BACKGROUND_SHADED
@@ -49,6 +49,11 @@
     #undef BETTER_REVERB
 #endif
 
+// Precompiled sequences (PRECOMPILE_SEQUENCES=1 in the Makefile) only implement the US/JP command set.
+#if defined(PRECOMPILE_SEQUENCES) && !(defined(VERSION_US) || defined(VERSION_JP))
+    #undef PRECOMPILE_SEQUENCES
+#endif
+
 /*****************
  * config_debug.h
  */
@@ -117,6 +122,15 @@
     #define DEBUG_ASSERTIONS
 #endif // DEBUG
 
+// Only ISVPRINT and UNF builds have a debug print channel to buffer.
+#if !defined(ISVPRINT) && !defined(UNF)
+    #undef BUFFERED_DEBUG_PRINT
+#endif
+
+#ifndef BUFFERED_DEBUG_PRINT
+    #undef DEBUG_PRINT_TIMESTAMPS
+#endif
+
 
 /*****************
  * config_camera.h
@@ -161,6 +175,24 @@
 #endif // !KEEP_MARIO_HEAD
 
 
+/*****************
+ * config_graphics.h
+ */
+
+#if !SILHOUETTE
+    #undef SILHOUETTE_VISIBILITY_CHECK
+#endif // !SILHOUETTE
+
+#ifdef NO_SEGMENTED_MEMORY
+    #undef GEO_LAYOUT_CACHE
+#endif // NO_SEGMENTED_MEMORY
+
+// Lighting baked into level geometry (BAKE_LEVEL_LIGHTING=1 in the Makefile) only matches a light that's fixed in world space.
+#if defined(BAKE_LEVEL_LIGHTING) && !defined(WORLDSPACE_LIGHTING)
+    #define WORLDSPACE_LIGHTING
+#endif
+
+
 /*****************
  * config_menu.h
  */
@@ -172,6 +204,10 @@
     #undef EXIT_COURSE_NODE
 #endif // DISABLE_EXIT_COURSE
 
+#ifndef PAUSE_FROZEN_BACKGROUND
+    #undef PAUSE_FROZEN_BACKGROUND_SHADED
+#endif // !PAUSE_FROZEN_BACKGROUND
+
 
 /*****************
  * config_objects.h
@@ -253,6 +253,57 @@ enum SurfaceClass {
     SURFACE_CLASS_NOT_SLIPPERY
 };
 
+#define SURFACE_TYPE_FLOOR_CLASS(cmd) ( \
+    (((cmd) == SURFACE_NOT_SLIPPERY) || ((cmd) == SURFACE_HARD_NOT_SLIPPERY) || ((cmd) == SURFACE_SWITCH)) ? SURFACE_CLASS_NOT_SLIPPERY : \
+    (((cmd) == SURFACE_SLIPPERY) || ((cmd) == SURFACE_NOISE_SLIPPERY) || ((cmd) == SURFACE_HARD_SLIPPERY) || ((cmd) == SURFACE_NO_CAM_COL_SLIPPERY)) ? SURFACE_CLASS_SLIPPERY : \
+    (((cmd) == SURFACE_SUPER_SLIPPERY) || ((cmd) == SURFACE_VERY_SLIPPERY) || ((cmd) == SURFACE_ICE) || ((cmd) == SURFACE_HARD_VERY_SLIPPERY) \
+        || ((cmd) == SURFACE_NOISE_VERY_SLIPPERY_73) || ((cmd) == SURFACE_NOISE_VERY_SLIPPERY_74) || ((cmd) == SURFACE_NOISE_VERY_SLIPPERY) \
+        || ((cmd) == SURFACE_NO_CAM_COL_VERY_SLIPPERY)) ? SURFACE_CLASS_VERY_SLIPPERY : \
+    SURFACE_CLASS_DEFAULT)
+
+// Column of sTerrainSounds: default, hard, slippery, very slippery, noisy default, noisy slippery
+#define SURFACE_TYPE_TERRAIN_SOUND(cmd) ( \
+    (((cmd) == SURFACE_NOT_SLIPPERY) || ((cmd) == SURFACE_HARD) || ((cmd) == SURFACE_HARD_NOT_SLIPPERY) || ((cmd) == SURFACE_SWITCH)) ? 1 : \
+    (((cmd) == SURFACE_SLIPPERY) || ((cmd) == SURFACE_HARD_SLIPPERY) || ((cmd) == SURFACE_NO_CAM_COL_SLIPPERY)) ? 2 : \
+    (SURFACE_TYPE_FLOOR_CLASS(cmd) == SURFACE_CLASS_VERY_SLIPPERY) ? 3 : \
+    ((cmd) == SURFACE_NOISE_DEFAULT) ? 4 : \
+    ((cmd) == SURFACE_NOISE_SLIPPERY) ? 5 : \
+    0)
+
+// Floors mario_handle_special_floors() acts on
+#define SURFACE_IS_SPECIAL_FLOOR(cmd) (((cmd) == SURFACE_DEATH_PLANE) || ((cmd) == SURFACE_VERTICAL_WIND) || ((cmd) == SURFACE_WARP) \
+                                       || ((cmd) == SURFACE_TIMER_START) || ((cmd) == SURFACE_TIMER_END) || ((cmd) == SURFACE_BURNING))
+
+/**
+ * Properties of each surface type, so Mario's code can look them up once instead of classifying the type
+ * with the macros above every frame. The table is built by the compiler from those same macros (see
+ * surface_collision.c), so the two can't disagree.
+ */
+enum SurfaceTypeProperties {
+    SURFACE_PROP_FLOOR_CLASS   = (0x3 << 0), // enum SurfaceClass
+    SURFACE_PROP_TERRAIN_SOUND = (0x7 << 2), // SURFACE_TYPE_TERRAIN_SOUND
+    SURFACE_PROP_QUICKSAND     = (1 << 5),
+    SURFACE_PROP_NOT_HARD      = (1 << 6),
+    SURFACE_PROP_UNSAFE        = (1 << 7),
+    SURFACE_PROP_SPECIAL_FLOOR = (1 << 8),
+};
+
+#define SURFACE_TYPE_PROPERTIES(cmd) ( \
+    (SURFACE_TYPE_FLOOR_CLASS(cmd) << 0) | \
+    (SURFACE_TYPE_TERRAIN_SOUND(cmd) << 2) | \
+    (SURFACE_IS_QUICKSAND(cmd)     ? SURFACE_PROP_QUICKSAND     : 0) | \
+    (SURFACE_IS_NOT_HARD(cmd)      ? SURFACE_PROP_NOT_HARD      : 0) | \
+    (SURFACE_IS_UNSAFE(cmd)        ? SURFACE_PROP_UNSAFE        : 0) | \
+    (SURFACE_IS_SPECIAL_FLOOR(cmd) ? SURFACE_PROP_SPECIAL_FLOOR : 0))
+
+#define NUM_SURFACE_TYPE_PROPERTIES 0x100
+
+extern const u16 gSurfaceTypeProperties[NUM_SURFACE_TYPE_PROPERTIES];
+
+#define SURFACE_TYPE_HAS_PROPERTY(cmd, prop) (gSurfaceTypeProperties[(cmd) & (NUM_SURFACE_TYPE_PROPERTIES - 1)] & (prop))
+#define SURFACE_TYPE_GET_FLOOR_CLASS(cmd)    (SURFACE_TYPE_HAS_PROPERTY(cmd, SURFACE_PROP_FLOOR_CLASS) >> 0)
+#define SURFACE_TYPE_GET_TERRAIN_SOUND(cmd)  (SURFACE_TYPE_HAS_PROPERTY(cmd, SURFACE_PROP_TERRAIN_SOUND) >> 2)
+
 enum SurfaceFlags {
     SURFACE_FLAGS_NONE            = (0 << 0), // 0x0000
     SURFACE_FLAG_DYNAMIC          = (1 << 0), // 0x0001
@@ -266,7 +317,14 @@ enum TerrainLoadCmd {
     TERRAIN_LOAD_CONTINUE,        // Stop loading vertices but continues to load other collision commands
     TERRAIN_LOAD_END,             // End the collision list
     TERRAIN_LOAD_OBJECTS,         // Loads in certain objects for level start
-    TERRAIN_LOAD_ENVIRONMENT      // Loads water/HMC gas
+    TERRAIN_LOAD_ENVIRONMENT,     // Loads water/HMC gas
+    TERRAIN_LOAD_PRIMITIVE        // Object collision described by a shape instead of triangles
+};
+
+// Shapes for TERRAIN_LOAD_PRIMITIVE
+enum SurfacePrimitiveShapes {
+    SURFACE_PRIMITIVE_BOX,      // Box centered on the object, rotated by its yaw
+    SURFACE_PRIMITIVE_CYLINDER  // Vertical cylinder centered on the object
 };
 
 #define TERRAIN_LOAD_IS_SURFACE_TYPE_LOW(cmd)  (cmd <  0x40)
@@ -323,4 +381,10 @@ enum TerrainType {
 // Water Box
 #define COL_WATER_BOX(id, x1, z1, x2, z2, y) id, x1, z1, x2, z2, y
 
+// Collision Primitive Box, used instead of COL_INIT() and the triangles. Can be used for flat platforms too, but not for water.
+#define COL_PRIMITIVE_BOX(surfType, halfX, minY, maxY, halfZ) TERRAIN_LOAD_PRIMITIVE, SURFACE_PRIMITIVE_BOX, surfType, halfX, minY, maxY, halfZ
+
+// Collision Primitive Cylinder, used instead of COL_INIT() and the triangles
+#define COL_PRIMITIVE_CYLINDER(surfType, radius, minY, maxY) TERRAIN_LOAD_PRIMITIVE, SURFACE_PRIMITIVE_CYLINDER, surfType, radius, minY, maxY, radius
+
 #endif // SURFACE_TERRAINS_H
@@ -0,0 +1,23 @@
+#include "macros.inc"
+
+#ifdef RSP_DECOMPRESS
+
+.section .text
+
+/* Yay0 decompression microcode (rsp/yay0.s) */
+
+.balign 16
+glabel yay0MainTextStart
+    .incbin "rsp/yay0.bin"
+glabel yay0MainTextEnd
+
+/* DATA SECTION START */
+
+.section .data
+
+.balign 16
+glabel yay0MainDataStart
+    .incbin "rsp/yay0_data.bin"
+glabel yay0MainDataEnd
+
+#endif
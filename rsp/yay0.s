@@ -0,0 +1,345 @@
+.rsp
+
+.include "rsp/rsp_defs.inc"
+
+// This file assumes DATA_FILE and CODE_FILE are set on the command line
+
+.if version() < 110
+    .error "armips 0.11 or newer is required"
+.endif
+
+// Yay0 decompression microcode.
+//
+// The task's data_ptr points to a struct Yay0SPState (see src/boot/slidec.h). Each task
+// decompresses at most sliceSize bytes, then writes the state back and exits, so the
+// scheduler can run audio and graphics tasks in between slices.
+//
+// The three input streams (mask words, link halfwords and chunk bytes) are read through
+// small DMEM buffers. Output goes to a DMEM window that keeps the most recent bytes for
+// back-references and is flushed to RDRAM as it fills up; references further back than
+// the window are fetched from RDRAM instead. The output buffer must be 8-byte aligned
+// and padded to a multiple of 8 bytes, since DMA writes whole doublewords.
+
+STREAM_BUFFER_SIZE equ 0x100
+WINDOW_HISTORY     equ 0x600 // bytes kept for back-references when the window slides
+MAX_RUN            equ 0x120 // longest back-reference (0x111 bytes), rounded up
+
+.create DATA_FILE, 0x0000
+
+// struct Yay0SPState, loaded from and written back to data_ptr
+yay0State:
+.dw 0x00000000, 0x00000000, 0x00000000, 0x00000000 // 0x00000000
+.dw 0x00000000, 0x00000000, 0x00000000, 0x00000000 // 0x00000010
+.dw 0x00000000, 0x00000000                         // 0x00000020
+YAY0_STATE_SIZE equ 0x28
+
+state_mask_ptr   equ 0x00
+state_link_ptr   equ 0x04
+state_chunk_ptr  equ 0x08
+state_dest       equ 0x0C
+state_dest_start equ 0x10
+state_dest_end   equ 0x14
+state_mask       equ 0x18
+state_mask_bits  equ 0x1C
+state_slice_size equ 0x20
+
+.definelabel refBuffer,   0x030 // back-references fetched from RDRAM (MAX_RUN + 8 bytes)
+.definelabel maskBuffer,  0x150
+.definelabel linkBuffer,  0x250
+.definelabel chunkBuffer, 0x350
+.definelabel window,      0x450 // decompressed output, up to the OSTask
+.definelabel windowEnd,   OSTask_addr
+
+.close // DATA_FILE
+
+
+.create CODE_FILE, 0x04001080
+
+// Register usage:
+//   $8  remaining mask bits, next bit in the MSB
+//   $9  number of remaining mask bits
+//   $10 mask stream read pointer,  $11 buffer end, $12 RDRAM address of maskBuffer
+//   $13 link stream read pointer,  $14 buffer end, $15 RDRAM address of linkBuffer
+//   $16 chunk stream read pointer, $17 buffer end, $18 RDRAM address of chunkBuffer
+//   $19 window write pointer
+//   $20 start of the window's unflushed output, 8-byte aligned
+//   $21 RDRAM address of window
+//   $22 bytes left to decompress in this slice
+
+    lw    $2, (OSTask_addr + OSTask_data_ptr)($zero)
+    addi  $1, $zero, yay0State
+    jal   dma_read
+     addi  $3, $zero, YAY0_STATE_SIZE - 1
+
+    lw    $8, (yay0State + state_mask)($zero)
+    lw    $9, (yay0State + state_mask_bits)($zero)
+
+    // Start with empty stream buffers, so the first read of each refills it
+    addi  $10, $zero, maskBuffer
+    addi  $11, $zero, maskBuffer
+    lw    $12, (yay0State + state_mask_ptr)($zero)
+    addi  $13, $zero, linkBuffer
+    addi  $14, $zero, linkBuffer
+    lw    $15, (yay0State + state_link_ptr)($zero)
+    addi  $16, $zero, chunkBuffer
+    addi  $17, $zero, chunkBuffer
+    lw    $18, (yay0State + state_chunk_ptr)($zero)
+
+    // Bytes left = min(destEnd - dest, sliceSize)
+    lw    $5, (yay0State + state_dest)($zero)
+    lw    $6, (yay0State + state_dest_end)($zero)
+    lw    $7, (yay0State + state_slice_size)($zero)
+    sub   $22, $6, $5
+    slt   $24, $7, $22
+    beqz  $24, @@slice_set
+     nop
+    addi  $22, $7, 0
+@@slice_set:
+
+    // Reload the previous output as history, starting at max((dest & ~7) - WINDOW_HISTORY, destStart)
+    lw    $6, (yay0State + state_dest_start)($zero)
+    addi  $24, $zero, -8
+    and   $21, $5, $24
+    addi  $21, $21, -WINDOW_HISTORY
+    slt   $24, $21, $6
+    beqz  $24, @@window_base_set
+     nop
+    addi  $21, $6, 0
+@@window_base_set:
+    sub   $3, $5, $21
+    addi  $19, $3, window
+    addi  $24, $zero, -8
+    and   $20, $19, $24
+    blez  $3, decode_loop
+     addi  $1, $zero, window
+    addi  $2, $21, 0
+    jal   dma_read
+     addi  $3, $3, -1
+
+decode_loop:
+    blez  $22, finish
+     addi  $24, $19, -(windowEnd - MAX_RUN)
+    // Make sure the longest back-reference still fits in the window
+    bgez  $24, slide_window
+     nop
+
+    bnez  $9, @@have_mask_bits
+     sub   $24, $11, $10
+    slti  $24, $24, 4
+    beqz  $24, @@have_mask_word
+     addi  $5, $zero, maskBuffer
+    sub   $6, $10, $5
+    jal   refill_stream
+     add   $6, $6, $12
+    addi  $10, $6, 0
+    addi  $11, $5, STREAM_BUFFER_SIZE
+    addi  $12, $7, 0
+@@have_mask_word:
+    lw    $8, 0x00($10)
+    addi  $10, $10, 4
+    addi  $9, $zero, 32
+@@have_mask_bits:
+    addi  $9, $9, -1
+    bltz  $8, literal
+     sll   $8, $8, 1
+
+back_reference:
+    sub   $24, $14, $13
+    slti  $24, $24, 2
+    beqz  $24, @@have_link
+     addi  $5, $zero, linkBuffer
+    sub   $6, $13, $5
+    jal   refill_stream
+     add   $6, $6, $15
+    addi  $13, $6, 0
+    addi  $14, $5, STREAM_BUFFER_SIZE
+    addi  $15, $7, 0
+@@have_link:
+    lbu   $5, 0x00($13)
+    lbu   $6, 0x01($13)
+    addi  $13, $13, 2
+    sll   $5, $5, 8
+    or    $5, $5, $6
+    andi  $25, $5, 0x0FFF
+    addi  $25, $25, 1          // distance
+    srl   $26, $5, 12          // length - 2, or 0 if the length is in the chunk stream
+    bnez  $26, @@have_length
+     addi  $26, $26, 2
+    jal   read_chunk_byte
+     nop
+    addi  $26, $24, 18
+@@have_length:
+    sub   $22, $22, $26
+    sub   $27, $19, $25
+    addi  $24, $27, -window
+    bgez  $24, copy_bytes
+     nop
+
+    // The source is older than the window, so flush and read it back from RDRAM
+    jal   flush_window
+     nop
+    addi  $2, $19, -window
+    add   $2, $2, $21
+    sub   $2, $2, $25
+    andi  $27, $2, 7
+    sub   $2, $2, $27
+    add   $3, $27, $26
+    addi  $1, $zero, refBuffer
+    jal   dma_read
+     addi  $3, $3, -1
+    addi  $27, $27, refBuffer
+
+copy_bytes:
+    // Byte by byte, since the source may overlap the output
+    lbu   $24, 0x00($27)
+    addi  $27, $27, 1
+    addi  $26, $26, -1
+    sb    $24, 0x00($19)
+    bgtz  $26, copy_bytes
+     addi  $19, $19, 1
+    j     decode_loop
+     nop
+
+literal:
+    jal   read_chunk_byte
+     nop
+    sb    $24, 0x00($19)
+    addi  $19, $19, 1
+    j     decode_loop
+     addi  $22, $22, -1
+
+// Returns the next chunk stream byte in $24.
+read_chunk_byte:
+    bne   $16, $17, @@have_byte
+     addi  $28, $ra, 0
+    addi  $5, $zero, chunkBuffer
+    sub   $6, $16, $5
+    jal   refill_stream
+     add   $6, $6, $18
+    addi  $16, $6, 0
+    addi  $17, $5, STREAM_BUFFER_SIZE
+    addi  $18, $7, 0
+@@have_byte:
+    lbu   $24, 0x00($16)
+    jr    $28
+     addi  $16, $16, 1
+
+// Flushes the window, then moves its last WINDOW_HISTORY bytes back to the start.
+slide_window:
+    jal   flush_window
+     nop
+    addi  $5, $19, -(window + WINDOW_HISTORY)
+    addi  $24, $zero, -16
+    and   $5, $5, $24
+    add   $21, $21, $5
+    sub   $19, $19, $5
+    sub   $20, $20, $5
+    addi  $6, $zero, window
+    add   $7, $6, $5
+@@move:
+    lqv   $v0[0], 0x00($7)
+    addi  $7, $7, 0x10
+    sqv   $v0[0], 0x00($6)
+    addi  $6, $6, 0x10
+    slt   $24, $6, $19
+    bnez  $24, @@move
+     nop
+    j     decode_loop
+     nop
+
+finish:
+    jal   flush_window
+     nop
+
+    // Save the stream positions for the next slice
+    addi  $24, $10, -maskBuffer
+    add   $24, $24, $12
+    sw    $24, (yay0State + state_mask_ptr)($zero)
+    addi  $24, $13, -linkBuffer
+    add   $24, $24, $15
+    sw    $24, (yay0State + state_link_ptr)($zero)
+    addi  $24, $16, -chunkBuffer
+    add   $24, $24, $18
+    sw    $24, (yay0State + state_chunk_ptr)($zero)
+    addi  $24, $19, -window
+    add   $24, $24, $21
+    sw    $24, (yay0State + state_dest)($zero)
+    sw    $8, (yay0State + state_mask)($zero)
+    sw    $9, (yay0State + state_mask_bits)($zero)
+
+    lw    $2, (OSTask_addr + OSTask_data_ptr)($zero)
+    addi  $1, $zero, yay0State
+    jal   dma_write
+     addi  $3, $zero, YAY0_STATE_SIZE - 1
+
+    ori   $1, $zero, 0x4000
+    mtc0  $1, SP_STATUS
+    break
+    nop
+@@forever:
+    b     @@forever
+     nop
+
+// Writes the window's unflushed output to RDRAM. The last partial doubleword is
+// written again by the next flush.
+flush_window:
+    sub   $3, $19, $20
+    blez  $3, @@done
+     addi  $1, $20, 0
+    addi  $2, $20, -window
+    add   $2, $2, $21
+    addi  $24, $zero, -8
+    and   $20, $19, $24
+    j     dma_write
+     addi  $3, $3, -1
+@@done:
+    jr    $ra
+     nop
+
+// Refills a stream buffer.
+// $5 = buffer, $6 = RDRAM address of the next unread byte
+// Returns $6 = next unread byte in the buffer, $7 = RDRAM address of the buffer
+refill_stream:
+    addi  $24, $zero, -8
+    and   $7, $6, $24
+    sub   $6, $6, $7
+    add   $6, $6, $5
+    addi  $1, $5, 0
+    addi  $2, $7, 0
+    j     dma_read
+     addi  $3, $zero, STREAM_BUFFER_SIZE - 1
+
+// Synchronous DMA: $1 = DMEM address, $2 = RDRAM address, $3 = length - 1
+dma_read:
+    mfc0  $4, SP_SEMAPHORE
+    bnez  $4, dma_read
+     nop
+@@dma_not_full:
+    mfc0  $4, SP_DMA_FULL
+    bnez  $4, @@dma_not_full
+     nop
+    mtc0  $1, SP_MEM_ADDR
+    mtc0  $2, SP_DRAM_ADDR
+    j     dma_wait
+     mtc0  $3, SP_RD_LEN
+
+dma_write:
+    mfc0  $4, SP_SEMAPHORE
+    bnez  $4, dma_write
+     nop
+@@dma_not_full:
+    mfc0  $4, SP_DMA_FULL
+    bnez  $4, @@dma_not_full
+     nop
+    mtc0  $1, SP_MEM_ADDR
+    mtc0  $2, SP_DRAM_ADDR
+    mtc0  $3, SP_WR_LEN
+
+dma_wait:
+    mfc0  $4, SP_DMA_BUSY
+    bnez  $4, dma_wait
+     nop
+    jr    $ra
+     mtc0  $zero, SP_SEMAPHORE
+
+.close // CODE_FILE
@@ -156,6 +156,21 @@ void seq_channel_layer_process_script(struct SequenceChannelLayer *layer) {
 
     struct SequenceChannel *seqChannel = (*layer).seqChannel;
     struct SequencePlayer  *seqPlayer = (*seqChannel).seqPlayer;
+#ifdef PRECOMPILE_SEQUENCES
+    if (layer->event != NULL) {
+        s32 result = seq_channel_layer_process_events(layer, &sp3A);
+        if (result == SEQ_EVENT_RESULT_END) {
+            return;
+        }
+        if (result == SEQ_EVENT_RESULT_DELAY) {
+            goto events_done;
+        }
+        if (result != SEQ_EVENT_RESULT_FALLBACK) {
+            cmdSemitone = result;
+            goto note_decoded;
+        }
+    }
+#endif
     for (;;) {
         state = &layer->scriptState;
         //M64_READ_U8(state, cmd);
@@ -334,6 +349,9 @@ l1138:
             cmdSemitone = cmd - (cmd & 0xc0);
         }
 
+#ifdef PRECOMPILE_SEQUENCES
+note_decoded:
+#endif
         layer->delay = sp3A;
         layer->duration = layer->noteDuration * sp3A / 256;
         if ((seqPlayer->muted && (seqChannel->muteBehavior & MUTE_BEHAVIOR_STOP_NOTES) != 0)
@@ -443,6 +461,9 @@ l13cc:
         }
     }
 
+#ifdef PRECOMPILE_SEQUENCES
+events_done:
+#endif
     if (layer->stopSomething == TRUE) {
         if (layer->note != NULL || layer->continuousNotes) {
             seq_channel_layer_note_decay(layer);
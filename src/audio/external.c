@@ -26,6 +26,26 @@
 #define SAMPLES_TO_OVERPRODUCE 0x10
 #define EXTRA_BUFFERED_AI_SAMPLES_TARGET 0x40
 
+#ifdef ADAPTIVE_AI_BUFFERING
+// Range and step sizes of how far ahead of playback the AI buffer is kept.
+#define EXTRA_BUFFERED_AI_SAMPLES_MIN 0x20
+#define EXTRA_BUFFERED_AI_SAMPLES_MAX 0x100
+#define EXTRA_BUFFERED_AI_SAMPLES_GROW 0x20
+#define EXTRA_BUFFERED_AI_SAMPLES_SHRINK 0x10
+// Consecutive audio frames with margin to spare before buffering less.
+#define AI_MARGIN_FRAMES_TO_SHRINK 300
+
+static s32 sExtraBufferedAiSamples = EXTRA_BUFFERED_AI_SAMPLES_TARGET;
+static s32 sAiMarginFrames = 0;
+#else
+#define sExtraBufferedAiSamples EXTRA_BUFFERED_AI_SAMPLES_TARGET
+#endif
+
+// Audio frames where the AI had already run out of samples to play.
+u32 gAudioUnderruns = 0;
+// Audio updates that only output silence, see SKIP_SILENT_AUDIO_UPDATES.
+u32 gAudioSkippedUpdates = 0;
+
 struct Sound {
     s32 soundBits;
     f32 *position;
@@ -612,6 +632,20 @@ struct SPTask *create_next_audio_frame_task(void) {
     index = (gCurrAiBufferIndex - 2 + NUMAIBUFFERS) % NUMAIBUFFERS;
     samplesRemainingInAI = osAiGetLength() / 4;
 
+    if (samplesRemainingInAI == 0 && gAiBufferLengths[index] != 0) {
+        gAudioUnderruns++;
+    }
+#ifdef ADAPTIVE_AI_BUFFERING
+    // Buffer further ahead right after running (nearly) dry, and slowly back off while there's margin to spare.
+    if (samplesRemainingInAI < EXTRA_BUFFERED_AI_SAMPLES_GROW) {
+        sExtraBufferedAiSamples = MIN(sExtraBufferedAiSamples + EXTRA_BUFFERED_AI_SAMPLES_GROW, EXTRA_BUFFERED_AI_SAMPLES_MAX);
+        sAiMarginFrames = 0;
+    } else if (samplesRemainingInAI >= (u32) sExtraBufferedAiSamples / 2 && ++sAiMarginFrames >= AI_MARGIN_FRAMES_TO_SHRINK) {
+        sExtraBufferedAiSamples = MAX(sExtraBufferedAiSamples - EXTRA_BUFFERED_AI_SAMPLES_SHRINK, EXTRA_BUFFERED_AI_SAMPLES_MIN);
+        sAiMarginFrames = 0;
+    }
+#endif
+
     // Audio is triple buffered; the audio interface reads from two buffers
     // while the third is being written by the RSP. More precisely, the
     // lifecycle is:
@@ -642,7 +676,7 @@ struct SPTask *create_next_audio_frame_task(void) {
     index = gCurrAiBufferIndex;
     gCurrAiBuffer = gAiBuffers[index];
     gAiBufferLengths[index] =
-        ((gSamplesPerFrameTarget - samplesRemainingInAI + EXTRA_BUFFERED_AI_SAMPLES_TARGET) & ~0xf)
+        ((gSamplesPerFrameTarget - samplesRemainingInAI + sExtraBufferedAiSamples) & ~0xf)
         + SAMPLES_TO_OVERPRODUCE;
     if (gAiBufferLengths[index] < gMinAiBufferLength) {
         gAiBufferLengths[index] = gMinAiBufferLength;
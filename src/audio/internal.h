@@ -249,6 +249,25 @@ struct M64ScriptState {
     u8 depth;
 }; // size = 0x1C
 
+#ifdef PRECOMPILE_SEQUENCES
+// A pre-decoded layer command, generated at build time by tools/seq_compiler.py.
+struct SeqEvent {
+    /*0x00*/ u8 op;
+    /*0x01*/ u8 arg0;
+    /*0x02*/ u8 arg1;
+    /*0x03*/ u8 arg2;
+    /*0x04*/ u16 value;
+    /*0x06*/ u16 offset; // offset of the original command within the sequence
+}; // size = 0x8
+
+struct SeqEventStream {
+    /*0x00*/ u32 magic;
+    /*0x04*/ u16 numEvents;
+    /*0x06*/ u16 reserved;
+    /*0x08*/ struct SeqEvent events[];
+};
+#endif
+
 // Also known as a Group, according to debug strings.
 struct SequencePlayer {
     /*US/JP, EU,    SH   */
@@ -326,7 +345,10 @@ struct SequencePlayer {
 #endif
     /*0x138, 0x140*/ uintptr_t bankDmaCurrDevAddr;
     /*0x13C, 0x144*/ ssize_t bankDmaRemaining;
-}; // size = 0x140, 0x148 on EU, 0x14C on SH
+#ifdef PRECOMPILE_SEQUENCES
+    /*0x140*/ struct SeqEventStream *seqEvents; // NULL if the sequence has no precompiled layers
+#endif
+}; // size = 0x140, 0x148 on EU, 0x14C on SH (0x144 on US/JP with PRECOMPILE_SEQUENCES)
 
 struct AdsrSettings {
     u8 releaseRate;
@@ -554,7 +576,11 @@ struct SequenceChannelLayer {
 #if defined(VERSION_EU)
     u8 pad2[4];
 #endif
-}; // size = 0x80
+#ifdef PRECOMPILE_SEQUENCES
+    /*0x80*/ struct SeqEvent *event; // next precompiled event, or NULL when interpreting scriptState
+    /*0x84*/ struct SeqEvent *eventStack[4]; // return points for calls and loops, paired with scriptState.depth
+#endif
+}; // size = 0x80, 0x94 with PRECOMPILE_SEQUENCES
 
 #if defined(VERSION_EU) || defined(VERSION_SH)
 struct NoteSynthesisState {
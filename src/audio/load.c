@@ -753,6 +753,12 @@ void load_sequence_internal(u32 player, u32 seqId, s32 loadAsync) {
     seqPlayer->enabled = TRUE;
     seqPlayer->seqData = sequenceData;
     seqPlayer->scriptState.pc = sequenceData;
+#ifdef PRECOMPILE_SEQUENCES
+    seqPlayer->seqEvents = NULL;
+    if (!seqPlayer->seqDmaInProgress) {
+        sequence_player_init_events(seqPlayer);
+    }
+#endif
 }
 
 // (void) must be omitted from parameters to fix stack with -framepointer
@@ -123,6 +123,9 @@ s32 seq_channel_set_layer(struct SequenceChannel *seqChannel, s32 layerIndex) {
 #endif
     layer->portamento.mode = 0;
     layer->scriptState.depth = 0;
+#ifdef PRECOMPILE_SEQUENCES
+    layer->event = NULL;
+#endif
     layer->status = SOUND_LOAD_STATUS_NOT_LOADED;
     layer->noteDuration = 0x80;
 #if defined(VERSION_EU) || defined(VERSION_SH)
@@ -409,6 +412,199 @@ u32 m64_read_compressed_u16(struct M64ScriptState *state) {
     return ret;
 }
 
+#ifdef PRECOMPILE_SEQUENCES
+/**
+ * Finds the layer event stream that tools/seq_compiler.py appended to the current sequence, if any.
+ * The footer sits in the last 8 bytes of the sequence, so this must only run once its DMA has completed.
+ */
+void sequence_player_init_events(struct SequencePlayer *seqPlayer) {
+    u32 len = gSeqFileHeader->seqArray[seqPlayer->seqId].len;
+    u32 *footer = (u32 *) (seqPlayer->seqData + len - 8);
+    struct SeqEventStream *stream;
+
+    seqPlayer->seqEvents = NULL;
+    if (len < 16 || footer[0] != SEQ_EVENTS_MAGIC) {
+        return;
+    }
+
+    stream = (struct SeqEventStream *) (seqPlayer->seqData + footer[1]);
+    if (stream->magic == SEQ_EVENTS_MAGIC) {
+        seqPlayer->seqEvents = stream;
+    }
+}
+
+/**
+ * Returns the precompiled event for the layer command at the given sequence offset,
+ * or NULL if that layer script has to be interpreted.
+ */
+static struct SeqEvent *sequence_player_find_event(struct SequencePlayer *seqPlayer, u16 offset) {
+    struct SeqEventStream *stream = seqPlayer->seqEvents;
+    s32 lo, hi, mid;
+
+    if (stream == NULL) {
+        return NULL;
+    }
+
+    lo = 0;
+    hi = stream->numEvents - 1;
+    while (lo <= hi) {
+        mid = (lo + hi) >> 1;
+        if (stream->events[mid].offset < offset) {
+            lo = mid + 1;
+        } else if (stream->events[mid].offset > offset) {
+            hi = mid - 1;
+        } else {
+            return &stream->events[mid];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Fast path for seq_channel_layer_process_script. Runs a layer's precompiled events up to its next note
+ * or delay, with the same effects as interpreting the original commands.
+ * Returns the semitone of the next note (with its play percentage in *playPercentage), or one of
+ * SEQ_EVENT_RESULT_DELAY, SEQ_EVENT_RESULT_END and SEQ_EVENT_RESULT_FALLBACK. In the fallback case
+ * the layer's script state is rebuilt so that the interpreter can continue from the same command.
+ */
+static s32 seq_channel_layer_process_events(struct SequenceChannelLayer *layer, u16 *playPercentage) {
+    struct SequenceChannel *seqChannel = layer->seqChannel;
+    struct SequencePlayer *seqPlayer = seqChannel->seqPlayer;
+    struct M64ScriptState *state = &layer->scriptState;
+    struct SeqEvent *event = layer->event;
+    u8 semitone;
+    u16 velocity;
+    s32 i;
+
+    for (;;) {
+        switch (event->op) {
+            case SEQ_EVENT_END:
+                if (state->depth == 0) {
+                    layer->event = NULL;
+                    seq_channel_layer_disable(layer);
+                    return SEQ_EVENT_RESULT_END;
+                }
+                event = layer->eventStack[--state->depth];
+                continue;
+
+            case SEQ_EVENT_CALL:
+                layer->eventStack[state->depth++] = event + 1;
+                event = &seqPlayer->seqEvents->events[event->value];
+                continue;
+
+            case SEQ_EVENT_LOOP:
+                state->remLoopIters[state->depth] = event->arg0;
+                layer->eventStack[state->depth++] = event + 1;
+                break;
+
+            case SEQ_EVENT_LOOPEND:
+                if (--state->remLoopIters[state->depth - 1] != 0) {
+                    event = layer->eventStack[state->depth - 1];
+                    continue;
+                }
+                state->depth--;
+                break;
+
+            case SEQ_EVENT_JUMP:
+                event = &seqPlayer->seqEvents->events[event->value];
+                continue;
+
+            case SEQ_EVENT_DELAY:
+                layer->delay = event->value;
+                layer->stopSomething = TRUE;
+                layer->event = event + 1;
+                return SEQ_EVENT_RESULT_DELAY;
+
+            case SEQ_EVENT_SET_VELOCITY:
+                layer->velocitySquare = (f32)(event->arg0 * event->arg0);
+                break;
+
+            case SEQ_EVENT_SET_PAN:
+                layer->pan = (f32) event->arg0 / 128.0f;
+                break;
+
+            case SEQ_EVENT_TRANSPOSE:
+                layer->transposition = event->arg0;
+                break;
+
+            case SEQ_EVENT_SET_DURATION:
+                layer->noteDuration = event->arg0;
+                break;
+
+            case SEQ_EVENT_CONTINUOUS_ON:
+            case SEQ_EVENT_CONTINUOUS_OFF:
+                layer->continuousNotes = (event->op == SEQ_EVENT_CONTINUOUS_ON);
+                seq_channel_layer_note_decay(layer);
+                break;
+
+            case SEQ_EVENT_SET_DEFAULT_PLAY_PERCENTAGE:
+                layer->shortNoteDefaultPlayPercentage = event->value;
+                break;
+
+            case SEQ_EVENT_SET_INSTR:
+                if (event->arg0 < 127) {
+                    get_instrument(seqChannel, event->arg0, &layer->instrument, &layer->adsr);
+                }
+                break;
+
+            case SEQ_EVENT_PORTAMENTO:
+                layer->portamento.mode = event->arg0;
+                semitone = event->arg1 + seqChannel->transposition + layer->transposition + seqPlayer->transposition;
+                if (semitone >= 0x80) {
+                    semitone = 0;
+                }
+                layer->portamentoTargetNote = semitone;
+                layer->portamentoTime = event->value;
+                break;
+
+            case SEQ_EVENT_DISABLE_PORTAMENTO:
+                layer->portamento.mode = 0;
+                break;
+
+            case SEQ_EVENT_VELOCITY_FROM_TABLE:
+                velocity = seqPlayer->shortNoteVelocityTable[event->arg0];
+                layer->velocitySquare = (f32)(velocity * velocity);
+                break;
+
+            case SEQ_EVENT_DURATION_FROM_TABLE:
+                layer->noteDuration = seqPlayer->shortNoteDurationTable[event->arg0];
+                break;
+
+            case SEQ_EVENT_NOTE0:
+            case SEQ_EVENT_NOTE1:
+            case SEQ_EVENT_NOTE2:
+                // Notes are compiled in their large form only.
+                if (seqChannel->largeNotes != TRUE) {
+                    goto fallback;
+                }
+                layer->stopSomething = FALSE;
+                if (event->op == SEQ_EVENT_NOTE2) {
+                    *playPercentage = layer->playPercentage;
+                } else {
+                    *playPercentage = event->value;
+                    layer->playPercentage = event->value;
+                }
+                layer->noteDuration = (event->op == SEQ_EVENT_NOTE1) ? 0 : event->arg2;
+                layer->velocitySquare = event->arg1 * event->arg1;
+                layer->event = event + 1;
+                return event->arg0;
+
+            case SEQ_EVENT_FALLBACK:
+                goto fallback;
+        }
+        event++;
+    }
+
+fallback:
+    state->pc = seqPlayer->seqData + event->offset;
+    for (i = 0; i < state->depth; i++) {
+        state->stack[i] = seqPlayer->seqData + layer->eventStack[i]->offset;
+    }
+    layer->event = NULL;
+    return SEQ_EVENT_RESULT_FALLBACK;
+}
+#endif
+
 #if defined(VERSION_SH)
 void seq_channel_layer_process_script(struct SequenceChannelLayer *layer) {
     if (!layer->enabled) {
@@ -2116,6 +2312,9 @@ void sequence_channel_process_script(struct SequenceChannel *seqChannel) {
                         sp5A = m64_read_s16(state);
                         if (seq_channel_set_layer(seqChannel, loBits) == 0) {
                             seqChannel->layers[loBits]->scriptState.pc = seqPlayer->seqData + sp5A;
+#ifdef PRECOMPILE_SEQUENCES
+                            seqChannel->layers[loBits]->event = sequence_player_find_event(seqPlayer, sp5A);
+#endif
                         }
                         break;
 
@@ -2130,6 +2329,9 @@ void sequence_channel_process_script(struct SequenceChannel *seqChannel) {
                             seqData = (*seqChannel->dynTable)[(u8) value];
                             sp5A = ((seqData[0] << 8) + seqData[1]);
                             seqChannel->layers[loBits]->scriptState.pc = seqPlayer->seqData + sp5A;
+#ifdef PRECOMPILE_SEQUENCES
+                            seqChannel->layers[loBits]->event = sequence_player_find_event(seqPlayer, sp5A);
+#endif
                         }
                         break;
 
@@ -2256,6 +2458,9 @@ void sequence_player_process_sequence(struct SequencePlayer *seqPlayer) {
 #endif
         seqPlayer->seqDmaInProgress = FALSE;
         gSeqLoadStatus[seqPlayer->seqId] = SOUND_LOAD_STATUS_COMPLETE;
+#ifdef PRECOMPILE_SEQUENCES
+        sequence_player_init_events(seqPlayer);
+#endif
     }
 #endif
 
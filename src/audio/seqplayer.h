@@ -17,6 +17,44 @@ enum PortamentoModes {
     PORTAMENTO_MODE_5
 };
 
+#ifdef PRECOMPILE_SEQUENCES
+#define SEQ_EVENTS_MAGIC 0x53514556 // 'SQEV'
+
+// Must match the event list in tools/seq_compiler.py.
+enum SeqEventOps {
+    SEQ_EVENT_NOP,
+    SEQ_EVENT_END,
+    SEQ_EVENT_CALL,
+    SEQ_EVENT_LOOP,
+    SEQ_EVENT_LOOPEND,
+    SEQ_EVENT_JUMP,
+    SEQ_EVENT_DELAY,
+    SEQ_EVENT_SET_VELOCITY,
+    SEQ_EVENT_SET_PAN,
+    SEQ_EVENT_TRANSPOSE,
+    SEQ_EVENT_SET_DURATION,
+    SEQ_EVENT_CONTINUOUS_ON,
+    SEQ_EVENT_CONTINUOUS_OFF,
+    SEQ_EVENT_SET_DEFAULT_PLAY_PERCENTAGE,
+    SEQ_EVENT_SET_INSTR,
+    SEQ_EVENT_PORTAMENTO,
+    SEQ_EVENT_DISABLE_PORTAMENTO,
+    SEQ_EVENT_VELOCITY_FROM_TABLE,
+    SEQ_EVENT_DURATION_FROM_TABLE,
+    SEQ_EVENT_NOTE0,
+    SEQ_EVENT_NOTE1,
+    SEQ_EVENT_NOTE2,
+    SEQ_EVENT_FALLBACK,
+};
+
+// Results of seq_channel_layer_process_events besides a note semitone.
+enum SeqEventResults {
+    SEQ_EVENT_RESULT_DELAY = -1,
+    SEQ_EVENT_RESULT_END = -2,
+    SEQ_EVENT_RESULT_FALLBACK = -3,
+};
+#endif
+
 void seq_channel_layer_disable(struct SequenceChannelLayer *seqPlayer);
 void sequence_channel_disable(struct SequenceChannel *seqPlayer);
 void sequence_player_disable(struct SequencePlayer* seqPlayer);
@@ -25,5 +63,8 @@ void *audio_list_pop_back(struct AudioListItem *list);
 void process_sequences(s32 iterationsRemaining);
 void init_sequence_player(u32 player);
 void init_sequence_players(void);
+#ifdef PRECOMPILE_SEQUENCES
+void sequence_player_init_events(struct SequencePlayer *seqPlayer);
+#endif
 
 #endif // AUDIO_SEQPLAYER_H
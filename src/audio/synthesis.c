@@ -68,6 +68,86 @@ struct VolumeChange {
 };
 
 u64 *synthesis_do_one_audio_update(s16 *aiBuf, u32 bufLen, u64 *cmd, s32 updateIndex);
+
+#ifdef SKIP_SILENT_AUDIO_UPDATES
+// How many reverb windows to let ring out before the reverb is cut off.
+#define SILENT_UPDATE_REVERB_TAIL_WINDOWS 8
+
+// Consecutive audio updates without a single enabled note.
+static u32 sSilentAudioUpdates = 0;
+
+/**
+ * Clears the reverb's history, so nothing left in it from before the silence plays once synthesis resumes.
+ */
+static void clear_reverb_buffers(void) {
+    if (!gSynthesisReverb.useReverb) {
+        return;
+    }
+
+    bzero(gSynthesisReverb.ringBuffer.left, gSynthesisReverb.bufSizePerChannel * sizeof(s16));
+    bzero(gSynthesisReverb.ringBuffer.right, gSynthesisReverb.bufSizePerChannel * sizeof(s16));
+    // The RSP reads and writes the ring buffer directly when it isn't downsampled
+    osWritebackDCache(gSynthesisReverb.ringBuffer.left, gSynthesisReverb.bufSizePerChannel * sizeof(s16));
+    osWritebackDCache(gSynthesisReverb.ringBuffer.right, gSynthesisReverb.bufSizePerChannel * sizeof(s16));
+#ifdef BETTER_REVERB
+    if (toggleBetterReverb) {
+        bzero(gBetterReverbPool.start + BETTER_REVERB_PTR_SIZE, gBetterReverbPool.cur - (gBetterReverbPool.start + BETTER_REVERB_PTR_SIZE));
+        bzero(historySamplesLight, sizeof(historySamplesLight));
+    }
+#endif
+}
+
+/**
+ * Whether this audio update can skip synthesis and output silence. That's the case once no note has been
+ * enabled for long enough for the reverb to ring out. Called after the update's sequence processing, so
+ * notes started by it are seen in time.
+ */
+static s32 audio_update_is_silent(s32 chunkLen) {
+    s32 i;
+    u32 tailUpdates = 0;
+
+    for (i = 0; i < gMaxSimultaneousNotes; i++) {
+        if (((struct vNote *) &gNotes[i])->enabled) {
+            break;
+        }
+    }
+
+    if (gSynthesisReverb.useReverb) {
+        tailUpdates = (SILENT_UPDATE_REVERB_TAIL_WINDOWS * gSynthesisReverb.bufSizePerChannel * gReverbDownsampleRate) / chunkLen + 1;
+    }
+
+    if (i < gMaxSimultaneousNotes) {
+        if (sSilentAudioUpdates > tailUpdates) {
+            // The reverb's downsampling buffers of the last few frames were never written, so don't read them.
+            gSynthesisReverb.framesLeftToIgnore = 3;
+        }
+        sSilentAudioUpdates = 0;
+        return FALSE;
+    }
+
+    sSilentAudioUpdates++;
+    if (sSilentAudioUpdates <= tailUpdates) {
+        return FALSE;
+    }
+    if (sSilentAudioUpdates == tailUpdates + 1) {
+        clear_reverb_buffers();
+    }
+
+    gAudioSkippedUpdates++;
+    return TRUE;
+}
+
+/**
+ * Outputs an update's worth of silence.
+ */
+static u64 *synthesis_silent_audio_update(s16 *aiBuf, u32 bufLen, u64 *cmd) {
+    aClearBuffer(cmd++, DMEM_ADDR_TEMP, bufLen * 2);
+    aSetBuffer(cmd++, 0, 0, DMEM_ADDR_TEMP, bufLen * 2);
+    aSaveBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(aiBuf));
+    return cmd;
+}
+#endif
+
 u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd);
 u64 *load_wave_samples(u64 *cmd, struct Note *note, s32 nSamplesToLoad);
 #ifdef ENABLE_STEREO_HEADSET_EFFECTS
@@ -382,10 +462,17 @@ u64 *synthesis_execute(u64 *cmdBuf, s32 *writtenCmds, s16 *aiBuf, s32 bufLen) {
         AUDIO_PROFILER_COMPLETE_AND_SWITCH(PROFILER_TIME_SUB_AUDIO_SEQUENCES_PROCESSING, PROFILER_TIME_SUB_AUDIO_SEQUENCES, PROFILER_TIME_SUB_AUDIO_SYNTHESIS);
         AUDIO_PROFILER_START_SHARED(PROFILER_TIME_SUB_AUDIO_SYNTHESIS, PROFILER_TIME_SUB_AUDIO_SYNTHESIS_ENVELOPE_REVERB);
 
-        if (gSynthesisReverb.useReverb) {
-            prepare_reverb_ring_buffer(chunkLen, gAudioUpdatesPerFrame - i);
+#ifdef SKIP_SILENT_AUDIO_UPDATES
+        if (audio_update_is_silent(chunkLen)) {
+            cmd = synthesis_silent_audio_update((s16 *) aiBufPtr, chunkLen * 2, cmd);
+        } else
+#endif
+        {
+            if (gSynthesisReverb.useReverb) {
+                prepare_reverb_ring_buffer(chunkLen, gAudioUpdatesPerFrame - i);
+            }
+            cmd = synthesis_do_one_audio_update((s16 *) aiBufPtr, chunkLen * 2, cmd, gAudioUpdatesPerFrame - i);
         }
-        cmd = synthesis_do_one_audio_update((s16 *) aiBufPtr, chunkLen * 2, cmd, gAudioUpdatesPerFrame - i);
 
         AUDIO_PROFILER_COMPLETE_AND_SWITCH(PROFILER_TIME_SUB_AUDIO_SYNTHESIS_ENVELOPE_REVERB, PROFILER_TIME_SUB_AUDIO_SYNTHESIS, PROFILER_TIME_SUB_AUDIO_UPDATE);
 
@@ -479,6 +566,162 @@ u64 *synthesis_do_one_audio_update(s16 *aiBuf, u32 bufLen, u64 *cmd, s32 updateI
     return cmd;
 }
 
+// Aux buffers currently set on the RSP, so consecutive notes mixing into the same buffers
+// don't need to set them again. Reset at the start of every note processing pass (0 is never an aux buffer).
+static struct {
+    u16 dryRight;
+    u16 wetLeft;
+    u16 wetRight;
+} sAuxBuffers;
+
+static u64 *set_aux_buffers(u64 *cmd, u16 dryRight, u16 wetLeft, u16 wetRight) {
+    if (sAuxBuffers.dryRight != dryRight || sAuxBuffers.wetLeft != wetLeft || sAuxBuffers.wetRight != wetRight) {
+        aSetBuffer(cmd++, A_AUX, dryRight, wetLeft, wetRight);
+        sAuxBuffers.dryRight = dryRight;
+        sAuxBuffers.wetLeft = wetLeft;
+        sAuxBuffers.wetRight = wetRight;
+    }
+    return cmd;
+}
+
+#ifdef INAUDIBLE_NOTE_VOLUME_THRESHOLD
+/**
+ * Whether a note is quiet enough for the whole update to be skipped. Freshly enabled notes and notes
+ * using headset pan effects are always synthesized, since they carry state that has to be set up on the RSP.
+ */
+static s32 note_is_inaudible(struct Note *note) {
+    if (note->needsInit) {
+        return FALSE;
+    }
+#ifdef ENABLE_STEREO_HEADSET_EFFECTS
+    if (note->usesHeadsetPanEffects) {
+        return FALSE;
+    }
+#endif
+    return note->curVolLeft < INAUDIBLE_NOTE_VOLUME_THRESHOLD && note->curVolRight < INAUDIBLE_NOTE_VOLUME_THRESHOLD
+        && note->targetVolLeft < INAUDIBLE_NOTE_VOLUME_THRESHOLD && note->targetVolRight < INAUDIBLE_NOTE_VOLUME_THRESHOLD;
+}
+
+/**
+ * Advances an inaudible note's sample position and volume exactly like synthesis_process_notes would, without
+ * generating any commands. Looping around still sets note->restart, so the ADPCM decoder state is reloaded from
+ * the loop once the note is synthesized again. The envelope mixer always reinitializes on resume, since the
+ * target volume has to have risen above the current one for the note to become audible.
+ */
+static void note_skip_synthesis(struct Note *note, s32 nSamples, s32 nParts) {
+    struct AdpcmLoop *loopInfo;
+    s32 samplesRemaining;
+
+    note->initFullVelocity = FALSE;
+    note->curVolLeft = note->targetVolLeft;
+    note->curVolRight = note->targetVolRight;
+
+    if (note->sound == NULL) {
+        note->samplePosInt += nSamples;
+        return;
+    }
+
+    // Both parts of a split note decode the same amount of samples in total
+    nSamples *= nParts;
+    loopInfo = note->sound->sample->loop;
+    while (nSamples > 0) {
+        samplesRemaining = loopInfo->end - note->samplePosInt;
+        if (nSamples < samplesRemaining) {
+            note->samplePosInt += nSamples;
+            break;
+        }
+
+        nSamples -= samplesRemaining;
+        if (loopInfo->count != 0) {
+            note->restart = TRUE;
+            note->samplePosInt = loopInfo->start;
+        } else {
+            note->samplePosInt = 0;
+            note->finished = TRUE;
+            ((struct vNote *)note)->enabled = 0;
+            break;
+        }
+    }
+}
+#endif
+
+#ifdef MERGE_UNISON_NOTES
+// The last ADPCM note synthesized this pass, as it was before its samples were decoded. Its resampled samples
+// stay in DMEM_ADDR_TEMP until the next note is synthesized. Reset at the start of every note processing pass.
+static struct {
+    struct Note *note;
+    struct AudioBankSample *sample;
+    s32 samplePosInt;
+    u16 samplePosFrac;
+    u16 resamplingRate;
+    u8 nParts;
+    u8 restart;
+} sUnisonSource;
+
+/**
+ * Whether a note is about to decode and resample exactly what the last synthesized note did: the same sample,
+ * from the same position, at the same pitch. Call after its samplePosFrac has been advanced for this update.
+ */
+static s32 note_is_in_unison(struct Note *note, u16 resamplingRate, s32 nParts) {
+    if (sUnisonSource.note == NULL || note->sound == NULL || note->needsInit) {
+        return FALSE;
+    }
+#ifdef ENABLE_STEREO_HEADSET_EFFECTS
+    if (note->usesHeadsetPanEffects) {
+        return FALSE;
+    }
+#endif
+    return note->sound->sample == sUnisonSource.sample && note->samplePosInt == sUnisonSource.samplePosInt
+        && note->samplePosFrac == sUnisonSource.samplePosFrac && resamplingRate == sUnisonSource.resamplingRate
+        && nParts == sUnisonSource.nParts && note->restart == sUnisonSource.restart;
+}
+
+/**
+ * Remember a note that's about to be synthesized, so the notes after it can check whether they play in unison with it.
+ * Freshly enabled notes start their decoder from scratch, and headset pan effects overwrite DMEM_ADDR_TEMP,
+ * so neither can be followed.
+ */
+static void set_unison_source(struct Note *note, u16 resamplingRate, s32 nParts) {
+    sUnisonSource.note = NULL;
+    if (note->sound == NULL || note->needsInit) {
+        return;
+    }
+#ifdef ENABLE_STEREO_HEADSET_EFFECTS
+    if (note->usesHeadsetPanEffects) {
+        return;
+    }
+#endif
+    sUnisonSource.note = note;
+    sUnisonSource.sample = note->sound->sample;
+    sUnisonSource.samplePosInt = note->samplePosInt;
+    sUnisonSource.samplePosFrac = note->samplePosFrac;
+    sUnisonSource.resamplingRate = resamplingRate;
+    sUnisonSource.nParts = nParts;
+    sUnisonSource.restart = note->restart;
+}
+
+/**
+ * Advance a note in unison with the last synthesized note the way decoding would have, and have the RSP copy
+ * that note's decoder and resampler state over its own, so it picks up seamlessly once they stop playing in unison.
+ */
+static u64 *note_follow_unison_source(u64 *cmd, struct Note *note) {
+    struct Note *source = sUnisonSource.note;
+
+    note->samplePosInt = source->samplePosInt;
+    note->restart = source->restart;
+    if (source->finished) {
+        note->finished = TRUE;
+        ((struct vNote *)note)->enabled = 0;
+    }
+
+    // adpcmdecState and finalResampleState are adjacent
+    aSetBuffer(cmd++, 0, DMEM_ADDR_COMPRESSED_ADPCM_DATA, DMEM_ADDR_COMPRESSED_ADPCM_DATA, sizeof(ADPCM_STATE) + sizeof(RESAMPLE_STATE));
+    aLoadBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(source->synthesisBuffers->adpcmdecState));
+    aSaveBuffer(cmd++, VIRTUAL_TO_PHYSICAL2(note->synthesisBuffers->adpcmdecState));
+    return cmd;
+}
+#endif
+
 u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
     s32 noteIndex;                           // sp174
     struct Note *note;                       // s7
@@ -538,6 +781,11 @@ u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
             break;
     }
 
+    sAuxBuffers.dryRight = 0;
+#ifdef MERGE_UNISON_NOTES
+    sUnisonSource.note = NULL;
+#endif
+
     for (noteIndex = 0; noteIndex < gMaxSimultaneousNotes; noteIndex++) {
         note = &gNotes[noteIndex];
         //! This function requires note->enabled to be volatile, but it breaks other functions like note_enable.
@@ -572,6 +820,22 @@ u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
             samplesLenFixedPoint = note->samplePosFrac + (resamplingRateFixedPoint * bufLen);
             note->samplePosFrac = samplesLenFixedPoint & 0xFFFF; // 16-bit store, can't reuse
 
+#ifdef INAUDIBLE_NOTE_VOLUME_THRESHOLD
+            if (note_is_inaudible(note)) {
+                note_skip_synthesis(note, samplesLenFixedPoint >> 16, nParts);
+                continue;
+            }
+#endif
+
+#ifdef MERGE_UNISON_NOTES
+            if (note_is_in_unison(note, resamplingRateFixedPoint, nParts)) {
+                // DMEM_ADDR_TEMP already holds this note's resampled samples, only its envelope is its own
+                cmd = note_follow_unison_source(cmd, note);
+                goto mix_envelope;
+            }
+            set_unison_source(note, resamplingRateFixedPoint, nParts);
+#endif
+
             if (note->sound == NULL) {
                 // A wave synthesis note (not ADPCM)
 
@@ -772,6 +1036,9 @@ u64 *synthesis_process_notes(s16 *aiBuf, u32 bufLen, u64 *cmd) {
             aSetBuffer(cmd++, /*flags*/ 0, noteSamplesDmemAddrBeforeResampling, /*dmemout*/ DMEM_ADDR_TEMP, bufLen);
             aResample(cmd++, flags, resamplingRateFixedPoint, VIRTUAL_TO_PHYSICAL2(note->synthesisBuffers->finalResampleState));
 
+#ifdef MERGE_UNISON_NOTES
+        mix_envelope:
+#endif
 #ifdef ENABLE_STEREO_HEADSET_EFFECTS
             if (note->headsetPanRight != 0 || note->prevHeadsetPanRight != 0) {
                 leftRight = 1;
@@ -860,18 +1127,15 @@ u64 *process_envelope(u64 *cmd, struct Note *note, s32 nSamples, u16 inBuf) {
         switch (headsetPanSettings) {
             case 1:
                 aSetBuffer(cmd++, 0, inBuf, DMEM_ADDR_NOTE_PAN_TEMP, nSamples);
-                aSetBuffer(cmd++, A_AUX, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_WET_LEFT_CH,
-                           DMEM_ADDR_WET_RIGHT_CH);
+                cmd = set_aux_buffers(cmd, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_WET_LEFT_CH, DMEM_ADDR_WET_RIGHT_CH);
                 break;
             case 2:
                 aSetBuffer(cmd++, 0, inBuf, DMEM_ADDR_LEFT_CH, nSamples);
-                aSetBuffer(cmd++, A_AUX, DMEM_ADDR_NOTE_PAN_TEMP, DMEM_ADDR_WET_LEFT_CH,
-                           DMEM_ADDR_WET_RIGHT_CH);
+                cmd = set_aux_buffers(cmd, DMEM_ADDR_NOTE_PAN_TEMP, DMEM_ADDR_WET_LEFT_CH, DMEM_ADDR_WET_RIGHT_CH);
                 break;
             default:
                 aSetBuffer(cmd++, 0, inBuf, DMEM_ADDR_LEFT_CH, nSamples);
-                aSetBuffer(cmd++, A_AUX, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_WET_LEFT_CH,
-                           DMEM_ADDR_WET_RIGHT_CH);
+                cmd = set_aux_buffers(cmd, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_WET_LEFT_CH, DMEM_ADDR_WET_RIGHT_CH);
                 break;
         }
     } else {
@@ -881,21 +1145,19 @@ u64 *process_envelope(u64 *cmd, struct Note *note, s32 nSamples, u16 inBuf) {
         if (note->stereoStrongRight) {
             aClearBuffer(cmd++, DMEM_ADDR_STEREO_STRONG_TEMP_DRY, DEFAULT_LEN_2CH);
             aSetBuffer(cmd++, 0, inBuf, DMEM_ADDR_STEREO_STRONG_TEMP_DRY, nSamples);
-            aSetBuffer(cmd++, A_AUX, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_STEREO_STRONG_TEMP_WET,
-                       DMEM_ADDR_WET_RIGHT_CH);
+            cmd = set_aux_buffers(cmd, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_STEREO_STRONG_TEMP_WET, DMEM_ADDR_WET_RIGHT_CH);
         } else if (note->stereoStrongLeft) {
             aClearBuffer(cmd++, DMEM_ADDR_STEREO_STRONG_TEMP_DRY, DEFAULT_LEN_2CH);
             aSetBuffer(cmd++, 0, inBuf, DMEM_ADDR_LEFT_CH, nSamples);
-            aSetBuffer(cmd++, A_AUX, DMEM_ADDR_STEREO_STRONG_TEMP_DRY, DMEM_ADDR_WET_LEFT_CH,
-                       DMEM_ADDR_STEREO_STRONG_TEMP_WET);
+            cmd = set_aux_buffers(cmd, DMEM_ADDR_STEREO_STRONG_TEMP_DRY, DMEM_ADDR_WET_LEFT_CH, DMEM_ADDR_STEREO_STRONG_TEMP_WET);
         } else {
             aSetBuffer(cmd++, 0, inBuf, DMEM_ADDR_LEFT_CH, nSamples);
-            aSetBuffer(cmd++, A_AUX, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_WET_LEFT_CH, DMEM_ADDR_WET_RIGHT_CH);
+            cmd = set_aux_buffers(cmd, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_WET_LEFT_CH, DMEM_ADDR_WET_RIGHT_CH);
         }
     }
 #else
     aSetBuffer(cmd++, 0, inBuf, DMEM_ADDR_LEFT_CH, nSamples);
-    aSetBuffer(cmd++, A_AUX, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_WET_LEFT_CH, DMEM_ADDR_WET_RIGHT_CH);
+    cmd = set_aux_buffers(cmd, DMEM_ADDR_RIGHT_CH, DMEM_ADDR_WET_LEFT_CH, DMEM_ADDR_WET_RIGHT_CH);
 #endif
 
     if (vol.targetLeft == vol.sourceLeft && vol.targetRight == vol.sourceRight
@@ -22,6 +22,7 @@
 #include "game/puppyprint.h"
 #include "game/profiling.h"
 #include "game/emutest.h"
+#include "print_buffer.h"
 
 // Message IDs
 enum MessageIDs {
@@ -31,6 +32,9 @@ enum MessageIDs {
     MESG_START_GFX_SPTASK,
     MESG_NMI_REQUEST,
     MESG_RCP_HUNG,
+#ifdef RSP_DECOMPRESS
+    MESG_START_DECOMPRESS_SPTASK,
+#endif
 };
 
 // OSThread gUnkThread; // unused?
@@ -66,6 +70,9 @@ struct SPTask        *sCurrentAudioSPTask   = NULL;
 struct SPTask        *sCurrentDisplaySPTask = NULL;
 struct SPTask        *sNextAudioSPTask      = NULL;
 struct SPTask        *sNextDisplaySPTask    = NULL;
+#ifdef RSP_DECOMPRESS
+struct SPTask        *sCurrentDecompressSPTask = NULL;
+#endif
 s8  gAudioEnabled      = TRUE;
 u32 gNumVblanks        = 0;
 s8  gResetTimer        = 0;
@@ -166,6 +173,10 @@ void receive_new_tasks(void) {
 void start_sptask(s32 taskType) {
     if (taskType == M_AUDTASK) {
         gActiveSPTask = sCurrentAudioSPTask;
+#ifdef RSP_DECOMPRESS
+    } else if (taskType == M_DECOMPRESSTASK) {
+        gActiveSPTask = sCurrentDecompressSPTask;
+#endif
     } else {
         gActiveSPTask = sCurrentDisplaySPTask;
     }
@@ -191,6 +202,20 @@ void start_gfx_sptask(void) {
     }
 }
 
+#ifdef RSP_DECOMPRESS
+/**
+ * Decompression tasks can't yield, so they only start when the RSP is idle
+ * and run in short slices to keep the audio tasks on time.
+ */
+void start_decompress_sptask(void) {
+    if (gActiveSPTask == NULL
+     && sCurrentDecompressSPTask != NULL
+     && sCurrentDecompressSPTask->state == SPTASK_STATE_NOT_STARTED) {
+        start_sptask(M_DECOMPRESSTASK);
+    }
+}
+#endif
+
 void pretend_audio_sptask_done(void) {
     gActiveSPTask = sCurrentAudioSPTask;
     gActiveSPTask->state = SPTASK_STATE_RUNNING;
@@ -228,6 +253,9 @@ void handle_vblank(void) {
             start_sptask(M_GFXTASK);
             profiler_rsp_started(PROFILER_RSP_GFX);
         }
+#ifdef RSP_DECOMPRESS
+        start_decompress_sptask();
+#endif
     }
 #if ENABLE_RUMBLE
     rumble_thread_update_vi();
@@ -277,15 +305,43 @@ void handle_sp_complete(void) {
                 }
                 start_sptask(M_GFXTASK);
             }
+#ifdef RSP_DECOMPRESS
+            start_decompress_sptask();
+#endif
             sCurrentAudioSPTask = NULL;
             if (curSPTask->msgqueue != NULL) {
                 osSendMesg(curSPTask->msgqueue, curSPTask->msg, OS_MESG_NOBLOCK);
             }
+#ifdef RSP_DECOMPRESS
+        } else if (curSPTask->task.t.type == M_DECOMPRESSTASK) {
+            sCurrentDecompressSPTask = NULL;
+            osSendMesg(curSPTask->msgqueue, curSPTask->msg, OS_MESG_NOBLOCK);
+            // Run whatever had to wait for the slice, audio first.
+            if (sCurrentAudioSPTask != NULL && sCurrentAudioSPTask->state == SPTASK_STATE_NOT_STARTED) {
+                if (gAudioEnabled) {
+                    start_sptask(M_AUDTASK);
+                } else {
+                    pretend_audio_sptask_done();
+                }
+                profiler_rsp_started(PROFILER_RSP_AUDIO);
+            } else if (sCurrentDisplaySPTask != NULL
+                    && sCurrentDisplaySPTask->state != SPTASK_STATE_FINISHED) {
+                if (sCurrentDisplaySPTask->state == SPTASK_STATE_INTERRUPTED) {
+                    profiler_rsp_resumed();
+                } else {
+                    profiler_rsp_started(PROFILER_RSP_GFX);
+                }
+                start_sptask(M_GFXTASK);
+            }
+#endif
         } else {
             // The SP process is done, but there is still a Display Processor notification
             // that needs to arrive before we can consider the task completely finished and
             // null out sCurrentDisplaySPTask. That happens in handle_dp_complete.
             profiler_rsp_completed(PROFILER_RSP_GFX);
+#ifdef RSP_DECOMPRESS
+            start_decompress_sptask();
+#endif
         }
     }
 }
@@ -356,6 +412,10 @@ void thread3_main(UNUSED void *arg) {
 
 #ifdef UNF
     debug_initialize();
+#ifdef BUFFERED_DEBUG_PRINT
+    // debug_initialize() replaces the osSyncPrintf output function.
+    print_buffer_init();
+#endif
 #endif
 
 #ifdef DEBUG
@@ -427,6 +487,11 @@ void thread3_main(UNUSED void *arg) {
             case MESG_RCP_HUNG:
                 alert_rcp_hung_up();
                 break;
+#ifdef RSP_DECOMPRESS
+            case MESG_START_DECOMPRESS_SPTASK:
+                start_decompress_sptask();
+                break;
+#endif
         }
     }
 }
@@ -474,6 +539,15 @@ void exec_display_list(struct SPTask *spTask) {
     }
 }
 
+#ifdef RSP_DECOMPRESS
+void dispatch_decompress_sptask(struct SPTask *spTask) {
+    osWritebackDCacheAll();
+    spTask->state = SPTASK_STATE_NOT_STARTED;
+    sCurrentDecompressSPTask = spTask;
+    osSendMesg(&gIntrMesgQueue, (OSMesg) MESG_START_DECOMPRESS_SPTASK, OS_MESG_NOBLOCK);
+}
+#endif
+
 void turn_on_audio(void) {
     gAudioEnabled = TRUE;
 }
@@ -546,6 +620,9 @@ void thread1_idle(UNUSED void *arg) {
     osViSetSpecialFeatures(OS_VI_DITHER_FILTER_ON);
     osViSetSpecialFeatures(OS_VI_GAMMA_OFF);
     osCreatePiManager(OS_PRIORITY_PIMGR, &gPIMesgQueue, gPIMesgBuf, ARRAY_COUNT(gPIMesgBuf));
+#ifdef BUFFERED_DEBUG_PRINT
+    create_print_buffer_thread();
+#endif
     create_thread(&gMainThread, THREAD_3_MAIN, thread3_main, NULL, gThread3Stack + THREAD3_STACK, 100);
     osStartThread(&gMainThread);
 
@@ -575,6 +652,9 @@ void osInitialize_fakeisv() {
 
     /* `__printfunc`, used by `osSyncPrintf` will be set. */
     __osInitialize_isv();
+#ifdef BUFFERED_DEBUG_PRINT
+    print_buffer_init();
+#endif
 }
 #endif
 
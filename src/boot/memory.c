@@ -7,6 +7,7 @@
 #include "game/game_init.h"
 #include "game/main.h"
 #include "game/memory.h"
+#include "game/debug.h"
 #include "segment_symbols.h"
 #include "segments.h"
 #ifdef GZIP
@@ -59,6 +60,9 @@ extern struct MainPoolBlock *sPoolListHeadR;
  */
 struct MemoryPool *gEffectsMemoryPool;
 
+// ROM address each segment was last loaded from, so data built from a segment can tell whether it's still loaded.
+uintptr_t gSegmentROMTable[32];
+
 
 uintptr_t sSegmentTable[32];
 u32 sPoolFreeSpace;
@@ -84,6 +88,15 @@ void *segmented_to_virtual(const void *addr) {
     size_t segment = ((uintptr_t) addr >> 24);
     size_t offset  = ((uintptr_t) addr & 0x00FFFFFF);
 
+#ifdef SEGMENT_RELOCATION
+    // Pointers relocated when their segment was loaded are already virtual.
+    if (segment >= ARRAY_COUNT(sSegmentTable)) {
+        PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.segment_relocated);
+        return (void *) addr;
+    }
+#endif
+    PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.segment_lookup);
+
     return (void *) ((sSegmentTable[segment] + offset) | 0x80000000);
 }
 
@@ -328,12 +341,14 @@ void *load_segment(s32 segment, u8 *srcStart, u8 *srcEnd, u32 side, u8 *bssStart
         if (addr != NULL) {
             u8 *realAddr = (u8 *)ALIGN((uintptr_t)addr, TLB_PAGE_SIZE);
             set_segment_base_addr(segment, realAddr);
+            gSegmentROMTable[segment] = (uintptr_t) srcStart;
             mapTLBPages((segment << 24), VIRTUAL_TO_PHYSICAL(realAddr), ((srcEnd - srcStart) + ((uintptr_t)bssEnd - (uintptr_t)bssStart)), segment);
         }
     } else {
         addr = dynamic_dma_read(srcStart, srcEnd, side, 0, 0);
         if (addr != NULL) {
             set_segment_base_addr(segment, addr);
+            gSegmentROMTable[segment] = (uintptr_t) srcStart;
         }
     }
 #ifdef PUPPYPRINT_DEBUG
@@ -367,6 +382,104 @@ void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd) {
     return dest;
 }
 
+#ifdef RSP_DECOMPRESS
+// Bytes decompressed per RSP task, short enough not to hold up the audio task for long
+#define RSP_DECOMPRESS_SLICE_SIZE 0x4000
+
+static struct Yay0SPState sYay0SPState ALIGNED16;
+static struct SPTask sYay0SPTask;
+static OSMesgQueue sYay0SPTaskMesgQueue;
+static OSMesg sYay0SPTaskMesgBuf[1];
+
+/**
+ * Decompress Yay0 data with the RSP, in slices scheduled between the audio and
+ * graphics tasks. The calling thread has nothing else to do until the data is
+ * there, so it just sleeps: this doesn't make loading any faster, it only leaves
+ * the CPU to the other threads in the meantime. decompress must be 8-byte aligned
+ * and padded to a multiple of 8 bytes, which main pool allocations always are.
+ */
+void rsp_slidstart(u8 *compress, u8 *decompress) {
+    struct Yay0SPState *state = &sYay0SPState;
+    OSTask_t *task = &sYay0SPTask.task.t;
+    u32 size = *(u32 *) (compress + 4);
+
+    osCreateMesgQueue(&sYay0SPTaskMesgQueue, sYay0SPTaskMesgBuf, ARRAY_COUNT(sYay0SPTaskMesgBuf));
+
+    state->maskPtr   = VIRTUAL_TO_PHYSICAL(compress + 16);
+    state->linkPtr   = VIRTUAL_TO_PHYSICAL(compress + *(u32 *) (compress + 8));
+    state->chunkPtr  = VIRTUAL_TO_PHYSICAL(compress + *(u32 *) (compress + 12));
+    state->dest      = VIRTUAL_TO_PHYSICAL(decompress);
+    state->destStart = state->dest;
+    state->destEnd   = state->dest + size;
+    state->mask      = 0;
+    state->maskBits  = 0;
+    state->sliceSize = RSP_DECOMPRESS_SLICE_SIZE;
+
+    task->type = M_DECOMPRESSTASK;
+    task->flags = 0;
+    task->ucode_boot = rspbootTextStart;
+    task->ucode_boot_size = ((u8 *) rspbootTextEnd - (u8 *) rspbootTextStart);
+    task->ucode = yay0MainTextStart;
+    task->ucode_size = ((u8 *) yay0MainTextEnd - (u8 *) yay0MainTextStart);
+    task->ucode_data = yay0MainDataStart;
+    task->ucode_data_size = ((u8 *) yay0MainDataEnd - (u8 *) yay0MainDataStart);
+    task->dram_stack = NULL;
+    task->dram_stack_size = 0;
+    task->output_buff = NULL;
+    task->output_buff_size = NULL;
+    task->data_ptr = (u64 *) state;
+    task->data_size = sizeof(*state);
+    task->yield_data_ptr = NULL;
+    task->yield_data_size = 0;
+    sYay0SPTask.msgqueue = &sYay0SPTaskMesgQueue;
+    sYay0SPTask.msg = NULL;
+
+    // Drop any cached lines of the output buffer, so they can't be written back over the RSP's output.
+    osInvalDCache(decompress, ALIGN16(size));
+    do {
+        dispatch_decompress_sptask(&sYay0SPTask);
+        osRecvMesg(&sYay0SPTaskMesgQueue, NULL, OS_MESG_BLOCK);
+        osInvalDCache(state, sizeof(*state));
+    } while (state->dest < state->destEnd);
+
+#ifdef DEBUG
+    // Check the microcode's output against the CPU decoder.
+    u8 *check = main_pool_alloc(size, MEMORY_POOL_RIGHT);
+    if (check != NULL) {
+        slidstart(compress, check);
+        assert(bcmp(check, decompress, size) == 0, "RSP Yay0 decompression doesn't match the CPU decoder");
+        main_pool_free(check);
+    }
+#endif
+}
+#endif
+
+#ifdef SEGMENT_RELOCATION
+/**
+ * Turn a segment's pointers to its own data into virtual addresses, so reading them doesn't
+ * need a segment table lookup. The build appends a table of their offsets to the segment's
+ * data (see tools/segment_relocs.py), which ends with its length and SEGMENT_RELOCATION_MAGIC,
+ * and is padded to end on the 16 byte boundary the ROM pads uncompressed segments to.
+ */
+static void relocate_segment(s32 segment, u8 *data, u32 size) {
+    // Every segment gets a table, even if it has no pointers to relocate.
+    assert(size >= (2 * sizeof(u32)), "Segment too small for a relocation table");
+    if (size < (2 * sizeof(u32))) return;
+
+    u32 *footer = (u32 *) (data + size - (2 * sizeof(u32)));
+    assert(footer[1] == SEGMENT_RELOCATION_MAGIC, "Segment has no relocation table at its end");
+    if (footer[1] != SEGMENT_RELOCATION_MAGIC) return;
+
+    u32 count = footer[0];
+    u32 *offsets = (footer - count);
+    uintptr_t base = ((uintptr_t) data - ((uintptr_t) segment << 24));
+
+    for (u32 i = 0; i < count; i++) {
+        *(uintptr_t *) (data + offsets[i]) += base;
+    }
+}
+#endif
+
 /**
  * Decompress the block of ROM data from srcStart to srcEnd and return a
  * pointer to an allocated buffer holding the decompressed data. Set the
@@ -404,13 +517,23 @@ void *load_segment_decompress(s32 segment, u8 *srcStart, u8 *srcEnd) {
             Propack_UnpackM1(compressed, dest);
 #elif RNC2
             Propack_UnpackM2(compressed, dest);
+#elif defined(YAY0) && defined(RSP_DECOMPRESS)
+            rsp_slidstart(compressed, dest);
 #elif YAY0
             slidstart(compressed, dest);
 #elif MIO0
             decompress(compressed, dest);
 #endif
             osSyncPrintf("end decompress\n");
+#ifdef SEGMENT_RELOCATION
+#ifdef UNCOMPRESSED
+            relocate_segment(segment, dest, (srcEnd - srcStart));
+#else
+            relocate_segment(segment, dest, *size);
+#endif
+#endif
             set_segment_base_addr(segment, dest);
+            gSegmentROMTable[segment] = (uintptr_t) srcStart;
             main_pool_free(compressed);
         }
     }
@@ -0,0 +1,177 @@
+#include <ultra64.h>
+#include <PR/os_internal_reg.h>
+#include <stdio.h>
+
+#include "sm64.h"
+#include "print_buffer.h"
+#include "buffers/buffers.h"
+
+#ifdef BUFFERED_DEBUG_PRINT
+
+/**
+ * Non-blocking debug print channel.
+ *
+ * osSyncPrintf and UNF's debug_printf write their output synchronously: the IS-Viewer path
+ * goes through the PI for every chunk, and UNF waits on the USB thread. print_buffer_init()
+ * puts print_buffer_write() in front of that sink, which only copies the text into a ring
+ * buffer. A thread running just above the idle thread then hands it to the real sink,
+ * PRINT_BUFFER_DRAIN_BUDGET bytes at a time, whenever nothing else needs the CPU.
+ * Both sinks can block, which the idle thread itself is never allowed to do.
+ *
+ * Any thread may print, so writers copy with interrupts disabled, which is cheap for the
+ * short strings _Printf hands over. The print thread is the only reader, and sleeps on
+ * sPrintMesgQueue while the buffer is empty.
+ */
+
+typedef void *(*PrintFunc)(void *arg, const char *str, size_t len);
+
+extern void *__printfunc;
+
+static char sPrintBuffer[PRINT_BUFFER_SIZE];
+// Free running positions, wrapped with PRINT_BUFFER_SIZE when indexing.
+static volatile u32 sPrintWritePos = 0;
+static volatile u32 sPrintReadPos = 0;
+static PrintFunc sPrintSink = NULL;
+
+static OSThread sPrintThread;
+static OSMesgQueue sPrintMesgQueue;
+static OSMesg sPrintMesgBuf[1];
+
+u32 gPrintBufferDroppedBytes = 0;
+static u32 sPrintReportedDroppedBytes = 0;
+// Write position at the first drop that hasn't been reported yet.
+static u32 sPrintDropPos = 0;
+
+#ifdef DEBUG_PRINT_TIMESTAMPS
+static u8 sPrintAtLineStart = TRUE;
+#endif
+
+static void print_buffer_copy(const char *str, size_t len) {
+    u32 offset = (sPrintWritePos & (PRINT_BUFFER_SIZE - 1));
+    u32 chunk = MIN(len, (PRINT_BUFFER_SIZE - offset));
+
+    bcopy(str, &sPrintBuffer[offset], chunk);
+    bcopy((str + chunk), sPrintBuffer, (len - chunk));
+    sPrintWritePos += len;
+}
+
+/**
+ * _Printf output function, queues the text instead of printing it.
+ * Text that doesn't fit is dropped as a whole, so lines aren't cut off halfway.
+ */
+void *print_buffer_write(void *arg, const char *str, size_t len) {
+    size_t needed = len;
+#ifdef DEBUG_PRINT_TIMESTAMPS
+    char stamp[16];
+    size_t stampLen = 0;
+
+    if (sPrintAtLineStart && len > 0) {
+        stampLen = sprintf(stamp, "[%8u] ", (u32)(osGetTime() / (OS_CPU_COUNTER / 1000)));
+        needed += stampLen;
+    }
+#endif
+
+    u32 saved = __osDisableInt();
+
+    if (needed > (PRINT_BUFFER_SIZE - (sPrintWritePos - sPrintReadPos))) {
+        if (gPrintBufferDroppedBytes == sPrintReportedDroppedBytes) {
+            sPrintDropPos = sPrintWritePos;
+        }
+        gPrintBufferDroppedBytes += len;
+    } else {
+#ifdef DEBUG_PRINT_TIMESTAMPS
+        print_buffer_copy(stamp, stampLen);
+        if (len > 0) {
+            sPrintAtLineStart = (str[len - 1] == '\n');
+        }
+#endif
+        print_buffer_copy(str, len);
+    }
+
+    __osRestoreInt(saved);
+
+    // Wakes the print thread up. If the queue is already full, it hasn't gone back to sleep yet anyway.
+    osSendMesg(&sPrintMesgQueue, NULL, OS_MESG_NOBLOCK);
+
+    // Returning NULL would make _Printf stop.
+    return (arg != NULL) ? arg : (void *) str;
+}
+
+/**
+ * Puts the buffer in front of the current osSyncPrintf output function.
+ * Called again whenever something else replaces it, such as UNF's debug_initialize().
+ */
+void print_buffer_init(void) {
+    if (__printfunc != (void *) print_buffer_write) {
+        if (sPrintSink == NULL) {
+            osCreateMesgQueue(&sPrintMesgQueue, sPrintMesgBuf, ARRAY_COUNT(sPrintMesgBuf));
+        }
+        sPrintSink = (PrintFunc) __printfunc;
+        __printfunc = (void *) print_buffer_write;
+    }
+}
+
+/**
+ * Writes out up to PRINT_BUFFER_DRAIN_BUDGET bytes of queued text.
+ * Dropped output is reported at the point in the text where it went missing.
+ * Returns FALSE once there is nothing left to write.
+ */
+static s32 print_buffer_drain(void) {
+    if (sPrintSink == NULL) {
+        return FALSE;
+    }
+
+    u32 saved = __osDisableInt();
+    u32 end = sPrintWritePos;
+    u32 dropped = (gPrintBufferDroppedBytes - sPrintReportedDroppedBytes);
+    if (dropped != 0) {
+        end = sPrintDropPos;
+    }
+    __osRestoreInt(saved);
+
+    if (dropped != 0 && sPrintReadPos == end) {
+        char message[48];
+        sPrintSink(NULL, message, sprintf(message, "\n[print buffer full, dropped %u bytes]\n", dropped));
+
+        saved = __osDisableInt();
+        sPrintReportedDroppedBytes += dropped;
+        // Anything dropped while the message was being written went missing right here too.
+        sPrintDropPos = sPrintWritePos;
+        __osRestoreInt(saved);
+        return TRUE;
+    }
+
+    u32 offset = (sPrintReadPos & (PRINT_BUFFER_SIZE - 1));
+    u32 chunk = (end - sPrintReadPos);
+    chunk = MIN(chunk, (PRINT_BUFFER_SIZE - offset));
+    chunk = MIN(chunk, PRINT_BUFFER_DRAIN_BUDGET);
+
+    if (chunk > 0) {
+        sPrintSink(NULL, &sPrintBuffer[offset], chunk);
+        sPrintReadPos += chunk;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void print_buffer_thread(UNUSED void *arg) {
+    OSMesg msg;
+
+    while (TRUE) {
+        if (!print_buffer_drain()) {
+            osRecvMesg(&sPrintMesgQueue, &msg, OS_MESG_BLOCK);
+        }
+    }
+}
+
+/**
+ * Starts the thread that writes the buffer out. Needs the PI manager to be running.
+ */
+void create_print_buffer_thread(void) {
+    osCreateThread(&sPrintThread, THREAD_10_PRINT_BUFFER, print_buffer_thread, NULL,
+                   gThread10Stack + THREAD10_STACK, PRINT_BUFFER_THREAD_PRI);
+    osStartThread(&sPrintThread);
+}
+
+#endif
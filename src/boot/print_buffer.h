@@ -0,0 +1,29 @@
+#ifndef PRINT_BUFFER_H
+#define PRINT_BUFFER_H
+
+#include <PR/ultratypes.h>
+
+#include "config.h"
+
+#ifdef BUFFERED_DEBUG_PRINT
+
+// Size of the ring buffer, must be a power of two.
+#define PRINT_BUFFER_SIZE 0x2000
+
+// Most bytes written to the print channel at a time, which bounds how long a higher priority
+// thread can be kept waiting on the PI or USB while the print thread is draining the buffer.
+// Must be smaller than UNF's 256 byte debug buffer.
+#define PRINT_BUFFER_DRAIN_BUDGET 128
+
+// Just above the idle thread, which runs at 0 and must never block.
+#define PRINT_BUFFER_THREAD_PRI 1
+
+extern u32 gPrintBufferDroppedBytes;
+
+void *print_buffer_write(void *arg, const char *str, size_t len);
+void print_buffer_init(void);
+void create_print_buffer_thread(void);
+
+#endif
+
+#endif // PRINT_BUFFER_H
@@ -5,4 +5,29 @@ void slidstart(unsigned char *compress, unsigned char *decompress);
 
 void decompress(void *mio0, void *dest);
 
+#ifdef RSP_DECOMPRESS
+/**
+ * State of an RSP Yay0 decompression task (rsp/yay0.s), passed as the task data.
+ * All pointers are physical addresses. The RSP updates the stream positions,
+ * dest and the mask at the end of each slice.
+ */
+struct Yay0SPState {
+    /*0x00*/ u32 maskPtr;
+    /*0x04*/ u32 linkPtr;
+    /*0x08*/ u32 chunkPtr;
+    /*0x0C*/ u32 dest;
+    /*0x10*/ u32 destStart;
+    /*0x14*/ u32 destEnd;
+    /*0x18*/ u32 mask;
+    /*0x1C*/ s32 maskBits;
+    /*0x20*/ u32 sliceSize;
+    /*0x24*/ u32 pad[3]; // fills the last cache line, the RSP only uses the first 0x28 bytes
+}; /*0x30*/
+
+extern u64 yay0MainTextStart[], yay0MainTextEnd[];
+extern u64 yay0MainDataStart[], yay0MainDataEnd[];
+
+void rsp_slidstart(u8 *compress, u8 *decompress);
+#endif
+
 #endif // SLIDEC_H
@@ -18,6 +18,9 @@ ALIGNED8 u8 gThread5Stack[THREAD5_STACK];
 #if ENABLE_RUMBLE
 ALIGNED8 u8 gThread6Stack[THREAD6_STACK];
 #endif
+#ifdef BUFFERED_DEBUG_PRINT
+ALIGNED8 u8 gThread10Stack[THREAD10_STACK];
+#endif
 // 0x400 bytes
 __attribute__((aligned(32))) u8 gGfxSPTaskStack[SP_DRAM_STACK_SIZE8];
 __attribute__((aligned(32))) u8 gGfxSPTaskYieldBuffer[OS_YIELD_DATA_SIZE];
@@ -5,6 +5,7 @@
 #include "behavior_script.h"
 #include "game/area.h"
 #include "game/behavior_actions.h"
+#include "game/clock_mover.h"
 #include "game/game_init.h"
 #include "game/mario.h"
 #include "game/memory.h"
@@ -823,6 +824,9 @@ void cur_obj_update(void) {
 
     if (inRoom == MARIO_OUTSIDE_ROOM && (objFlags & OBJ_FLAG_ONLY_PROCESS_INSIDE_ROOM)) {
         cur_obj_disable_rendering_in_room();
+        if (objFlags & OBJ_FLAG_CLOCK_MOVER) {
+            obj_hold_clock_mover(o);
+        }
         return;
     }
 
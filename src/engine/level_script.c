@@ -69,6 +69,168 @@ static s16 sScriptStatus;
 static s32 sRegister;
 static struct LevelCommand *sCurrentCmd;
 
+#ifdef GEO_LAYOUT_CACHE
+/**
+ * Graph node trees of models from the actor groups, kept across level loads.
+ *
+ * The same groups get loaded by many levels, and their models are processed into the level pool
+ * again every time. The trees built from a group's geo segment are kept in a pool of their own
+ * instead, and reused whenever the same geo layout is loaded while its segment still holds the
+ * same data from ROM. The trees only reference their geo and display lists by segmented address,
+ * so they stay valid wherever the segments end up in memory.
+ */
+struct GeoLayoutCacheEntry {
+    const void *geo;
+    uintptr_t romAddr; // Where the geo's segment was loaded from when the tree was built
+    struct GraphNode *root;
+    u16 nodeCount;
+    u32 buildTime;
+};
+
+// Larger than any single allocation a model's geo layout makes, see cache_geo_layout().
+#define GEO_LAYOUT_CACHE_MAX_ALLOC 0x200
+
+static u8 sGeoLayoutCacheBuffer[GEO_LAYOUT_CACHE_SIZE] ALIGNED8;
+static struct AllocOnlyPool sGeoLayoutCachePool = {
+    GEO_LAYOUT_CACHE_SIZE, 0, sGeoLayoutCacheBuffer, sGeoLayoutCacheBuffer
+};
+static struct GeoLayoutCacheEntry sGeoLayoutCache[GEO_LAYOUT_CACHE_ENTRIES];
+static s32 sGeoLayoutCacheCount = 0;
+static u8 sGeoLayoutCacheFull = FALSE;
+
+struct GeoLayoutCacheStats gGeoLayoutCacheStats;
+
+static u32 count_graph_nodes(struct GraphNode *firstNode) {
+    struct GraphNode *node = firstNode;
+    u32 count = 0;
+
+    if (node != NULL) {
+        do {
+            count += 1 + count_graph_nodes(node->children);
+            node = node->next;
+        } while (node != firstNode);
+    }
+
+    return count;
+}
+
+static s32 is_geo_layout_cacheable(const void *geo) {
+    switch ((uintptr_t) geo >> 24) {
+        case SEGMENT_GROUPA_GEO:
+        case SEGMENT_GROUPB_GEO:
+        case SEGMENT_COMMON0_GEO:
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/**
+ * Runs GEO_CONTEXT_CREATE again on the nodes of a reused tree, the same way process_geo_layout() did
+ * when it built it, so their functions can set up whatever they need for the new level.
+ */
+static void geo_layout_cache_create_nodes(struct GraphNode *firstNode, struct AllocOnlyPool *pool) {
+    struct GraphNode *node = firstNode;
+    struct FnGraphNode *asFnNode;
+
+    do {
+        asFnNode = (struct FnGraphNode *) node;
+
+        // Whether the type's corresponding struct has a FnGraphNode fnNode struct.
+        if (node->type == GRAPH_NODE_TYPE_PERSPECTIVE
+         || node->type == GRAPH_NODE_TYPE_SWITCH_CASE
+         || node->type == GRAPH_NODE_TYPE_CAMERA
+         || node->type == GRAPH_NODE_TYPE_GENERATED_LIST
+         || node->type == GRAPH_NODE_TYPE_BACKGROUND
+         || node->type == GRAPH_NODE_TYPE_HELD_OBJ) {
+            if (asFnNode->func != NULL) {
+                asFnNode->func(GEO_CONTEXT_CREATE, node, pool);
+            }
+        }
+
+        if (node->children != NULL) {
+            geo_layout_cache_create_nodes(node->children, pool);
+        }
+    } while ((node = node->next) != firstNode);
+}
+
+/**
+ * Processes a geo layout, or reuses the tree built from it on an earlier load.
+ */
+static struct GraphNode *cache_geo_layout(void *geo) {
+    struct GeoLayoutCacheEntry *entry;
+    struct GraphNode *root;
+    s32 i;
+
+    if (!is_geo_layout_cacheable(geo)) {
+        return process_geo_layout(sLevelPool, geo);
+    }
+
+    uintptr_t romAddr = gSegmentROMTable[(uintptr_t) geo >> 24];
+
+    for (i = 0; i < sGeoLayoutCacheCount; i++) {
+        entry = &sGeoLayoutCache[i];
+        if (entry->geo == geo && entry->romAddr == romAddr) {
+            if (entry->root != NULL) {
+                geo_layout_cache_create_nodes(entry->root, sLevelPool);
+            }
+
+            gGeoLayoutCacheStats.modelsReused++;
+            gGeoLayoutCacheStats.nodesReused += entry->nodeCount;
+            gGeoLayoutCacheStats.cyclesSaved += entry->buildTime;
+            return entry->root;
+        }
+    }
+
+    u32 first = osGetCount();
+
+    if (!sGeoLayoutCacheFull && sGeoLayoutCacheCount < GEO_LAYOUT_CACHE_ENTRIES) {
+        s32 usedSpace = sGeoLayoutCachePool.usedSpace;
+        u8 *freePtr = sGeoLayoutCachePool.freePtr;
+
+        root = process_geo_layout(&sGeoLayoutCachePool, geo);
+
+        // Allocations only fail once the pool has less space left than they asked for,
+        // so as long as there's more left than any of them could take, none have.
+        if ((sGeoLayoutCachePool.totalSpace - sGeoLayoutCachePool.usedSpace) >= GEO_LAYOUT_CACHE_MAX_ALLOC) {
+            entry = &sGeoLayoutCache[sGeoLayoutCacheCount++];
+            entry->geo = geo;
+            entry->romAddr = romAddr;
+            entry->root = root;
+            entry->nodeCount = count_graph_nodes(root);
+            entry->buildTime = (osGetCount() - first);
+
+            gGeoLayoutCacheStats.modelsBuilt++;
+            gGeoLayoutCacheStats.nodesBuilt += entry->nodeCount;
+            return root;
+        }
+
+        // Out of space, undo the partial tree and start over once this level is unloaded.
+        sGeoLayoutCachePool.usedSpace = usedSpace;
+        sGeoLayoutCachePool.freePtr = freePtr;
+        sGeoLayoutCacheFull = TRUE;
+    }
+
+    root = process_geo_layout(sLevelPool, geo);
+
+    gGeoLayoutCacheStats.modelsBuilt++;
+    gGeoLayoutCacheStats.nodesBuilt += count_graph_nodes(root);
+    return root;
+}
+
+/**
+ * Empties the cache once it has filled up, so it refills with the groups that are in use now.
+ * Only called while no level is loaded, since the level's objects point into the trees.
+ */
+static void reset_geo_layout_cache(void) {
+    if (sGeoLayoutCacheFull || sGeoLayoutCacheCount == GEO_LAYOUT_CACHE_ENTRIES) {
+        sGeoLayoutCachePool.usedSpace = 0;
+        sGeoLayoutCachePool.freePtr = sGeoLayoutCachePool.startPtr;
+        sGeoLayoutCacheCount = 0;
+        sGeoLayoutCacheFull = FALSE;
+    }
+}
+#endif
+
 static s32 eval_script_op(s8 op, s32 arg) {
     s32 result = FALSE;
 
@@ -368,6 +530,9 @@ static void level_cmd_clear_level(void) {
     // the game does a push on level load and a pop on level unload, we need to add another push to store state after the level has been loaded, so one more pop is needed
     main_pool_pop_state();
     unmap_tlbs();
+#ifdef GEO_LAYOUT_CACHE
+    reset_geo_layout_cache();
+#endif
 
     sCurrentCmd = CMD_NEXT;
 }
@@ -377,6 +542,9 @@ static void level_cmd_alloc_level_pool(void) {
         sLevelPool = alloc_only_pool_init(main_pool_available() - sizeof(struct AllocOnlyPool),
                                           MEMORY_POOL_LEFT);
     }
+#ifdef GEO_LAYOUT_CACHE
+    bzero(&gGeoLayoutCacheStats, sizeof(gGeoLayoutCacheStats));
+#endif
 
     sCurrentCmd = CMD_NEXT;
 }
@@ -387,6 +555,13 @@ static void level_cmd_free_level_pool(void) {
     alloc_only_pool_resize(sLevelPool, sLevelPool->usedSpace);
     sLevelPool = NULL;
 
+#if defined(GEO_LAYOUT_CACHE) && defined(DEBUG)
+    osSyncPrintf("geo cache: reused %d models (%d nodes, %uus), built %d (%d nodes)\n",
+                 gGeoLayoutCacheStats.modelsReused, gGeoLayoutCacheStats.nodesReused,
+                 (u32) OS_CYCLES_TO_USEC(gGeoLayoutCacheStats.cyclesSaved),
+                 gGeoLayoutCacheStats.modelsBuilt, gGeoLayoutCacheStats.nodesBuilt);
+#endif
+
     for (i = 0; i < AREA_COUNT; i++) {
         if (gAreaData[i].terrainData != NULL) {
             alloc_surface_pools();
@@ -446,7 +621,11 @@ static void level_cmd_load_model_from_geo(void) {
 
     assert(model < MODEL_ID_COUNT, "Tried to load an invalid model ID.");
     if (model < MODEL_ID_COUNT) {
+#ifdef GEO_LAYOUT_CACHE
+        gLoadedGraphNodes[model] = cache_geo_layout(geo);
+#else
         gLoadedGraphNodes[model] = process_geo_layout(sLevelPool, geo);
+#endif
     }
 
     sCurrentCmd = CMD_NEXT;
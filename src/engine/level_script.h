@@ -5,6 +5,19 @@
 
 struct LevelCommand;
 
+#ifdef GEO_LAYOUT_CACHE
+// Models taken from the geo layout cache by the current level's load, and the ones it had to build.
+struct GeoLayoutCacheStats {
+    u16 modelsReused;
+    u16 modelsBuilt;
+    u32 nodesReused;
+    u32 nodesBuilt;
+    u32 cyclesSaved; // What building the reused models took when they were first loaded
+};
+
+extern struct GeoLayoutCacheStats gGeoLayoutCacheStats;
+#endif
+
 extern LevelScript level_script_entry[];
 
 struct LevelCommand *level_script_execute(struct LevelCommand *cmd);
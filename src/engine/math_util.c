@@ -170,9 +170,27 @@ UNUSED void mtxf_rotate_xyz_and_translate(Mat4 dest, Vec3f trans, Vec3s rot) {
     MTXF_END(dest);
 }
 
+#ifdef MTXF_SKIP_ZERO_ROTATION
+/// Translate and multiply, which is what the rotate and translate and multiply builders reduce to without a rotation.
+static void mtxf_translate_and_mul(Vec3f trans, Mat4 dest, Mat4 src) {
+    vec3f_copy(dest[0], src[0]);
+    vec3f_copy(dest[1], src[1]);
+    vec3f_copy(dest[2], src[2]);
+    linear_mtxf_mul_vec3f(src, dest[3], trans);
+    vec3f_add(dest[3], src[3]);
+    MTXF_END(dest);
+}
+#endif
+
 /// Build a matrix that rotates around the z axis, then the x axis, then the y axis, and then translates and multiplies.
 void mtxf_rotate_zxy_and_translate_and_mul(Vec3s rot, Vec3f trans, Mat4 dest, Mat4 src) {
     PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.matrix);
+#ifdef MTXF_SKIP_ZERO_ROTATION
+    if (!rot[0] && !rot[1] && !rot[2]) {
+        mtxf_translate_and_mul(trans, dest, src);
+        return;
+    }
+#endif
     f32 sx = sins(rot[0]);
     f32 cx = coss(rot[0]);
     f32 sy = sins(rot[1]);
@@ -204,6 +222,12 @@ void mtxf_rotate_zxy_and_translate_and_mul(Vec3s rot, Vec3f trans, Mat4 dest, Ma
 /// Build a matrix that rotates around the x axis, then the y axis, then the z axis, and then translates and multiplies.
 void mtxf_rotate_xyz_and_translate_and_mul(Vec3s rot, Vec3f trans, Mat4 dest, Mat4 src) {
     PUPPYPRINT_ADD_COUNTER(gPuppyCallCounter.matrix);
+#ifdef MTXF_SKIP_ZERO_ROTATION
+    if (!rot[0] && !rot[1] && !rot[2]) {
+        mtxf_translate_and_mul(trans, dest, src);
+        return;
+    }
+#endif
     f32 sx = sins(rot[0]);
     f32 cx = coss(rot[0]);
     f32 sy = sins(rot[1]);
@@ -629,11 +653,19 @@ s16 abs_angle_diff(s16 a0, s16 a1) {
 /**
  * Helper function for atan2s. Does a look up of the arctangent of y/x assuming
  * the resulting angle is in range [0, 0x2000] (1/8 of a circle).
+ * With ATAN2S_POLYNOMIAL, evaluates an odd polynomial for the arctangent instead
+ * (Hastings' approximation, off by about 0.1 angle units before rounding).
  */
 static u16 atan2_lookup(f32 y, f32 x) {
-    return x == 0
-        ? 0x0
-        : atans(y / x);
+    if (x == 0) return 0x0;
+#ifdef ATAN2S_POLYNOMIAL
+    f32 t  = (y / x);
+    f32 t2 = (t * t);
+    f32 atan = (t * (0.9998660f + (t2 * (-0.3302995f + (t2 * (0.1801410f + (t2 * (-0.0851330f + (t2 * 0.0208351f)))))))));
+    return (u16)((atan * (0x8000 / (f32) M_PI)) + 0.5f);
+#else
+    return atans(y / x);
+#endif
 }
 
 /**
@@ -939,6 +971,99 @@ void find_surface_on_ray_cell(s32 cellX, s32 cellZ, Vec3f orig, Vec3f normalized
     }
 }
 
+/**
+ * Finds where a ray enters a collision primitive, if that's closer than *max_length, like the
+ * triangle version would: only the sides facing the ray can be hit, so a ray starting inside
+ * it hits nothing. Cylinders are hit on their side as a wall, with walls[0] set to the plane
+ * touching it there.
+ */
+static void find_surface_on_ray_primitive(struct SurfacePrimitive *prim, Vec3f orig, Vec3f dir, struct Surface **hit_surface, Vec3f hit_pos, f32 *max_length, s32 flags) {
+    // Ignored by ray_surface_intersect too
+    if ((prim->floor.type == SURFACE_INTANGIBLE) || (prim->floor.flags & SURFACE_FLAG_NO_CAM_COLLISION)) return;
+
+    f32 enter = -__FLT_MAX__;
+    f32 exit = __FLT_MAX__;
+    struct Surface *surf = NULL;
+    f32 axisEnter, axisExit;
+
+    // Top and bottom
+    if (absf(dir[1]) < NEAR_ZERO) {
+        if ((orig[1] < prim->minY) || (orig[1] > prim->maxY)) return;
+    } else {
+        axisEnter = ((((dir[1] > 0.0f) ? prim->minY : prim->maxY) - orig[1]) / dir[1]);
+        axisExit  = ((((dir[1] > 0.0f) ? prim->maxY : prim->minY) - orig[1]) / dir[1]);
+        enter = axisEnter;
+        exit = axisExit;
+        surf = ((dir[1] > 0.0f) ? &prim->ceil : &prim->floor);
+    }
+
+    f32 dx = (orig[0] - prim->x);
+    f32 dz = (orig[2] - prim->z);
+
+    if (prim->shape == SURFACE_PRIMITIVE_CYLINDER) {
+        f32 a = (sqr(dir[0]) + sqr(dir[2]));
+        f32 b = ((dx * dir[0]) + (dz * dir[2]));
+        f32 c = (sqr(dx) + sqr(dz) - sqr(prim->halfX));
+
+        if (a < NEAR_ZERO) {
+            if (c > 0.0f) return;
+        } else {
+            f32 disc = (sqr(b) - (a * c));
+            if (disc < 0.0f) return;
+            disc = sqrtf(disc);
+            axisEnter = ((-b - disc) / a);
+            axisExit  = ((-b + disc) / a);
+            if (axisEnter > enter) {
+                enter = axisEnter;
+                surf = &prim->walls[0];
+            }
+            exit = MIN(exit, axisExit);
+        }
+    } else {
+        // The box's rotated space, where it's a rectangle around the origin
+        f32 localOrig[2] = { ((dx * prim->cosYaw) - (dz * prim->sinYaw)), ((dx * prim->sinYaw) + (dz * prim->cosYaw)) };
+        f32 localDir[2] = { ((dir[0] * prim->cosYaw) - (dir[2] * prim->sinYaw)), ((dir[0] * prim->sinYaw) + (dir[2] * prim->cosYaw)) };
+        f32 half[2] = { prim->halfX, prim->halfZ };
+        s32 i;
+
+        for (i = 0; i < 2; i++) {
+            if (absf(localDir[i]) < NEAR_ZERO) {
+                if (absf(localOrig[i]) > half[i]) return;
+                continue;
+            }
+            axisEnter = (((localDir[i] > 0.0f) ? -half[i] :  half[i]) - localOrig[i]) / localDir[i];
+            axisExit  = (((localDir[i] > 0.0f) ?  half[i] : -half[i]) - localOrig[i]) / localDir[i];
+            if (axisEnter > enter) {
+                enter = axisEnter;
+                surf = &prim->walls[(i == 0) ? ((localDir[i] > 0.0f) ? SURFACE_PRIMITIVE_WALL_NEG_X : SURFACE_PRIMITIVE_WALL_POS_X)
+                                             : ((localDir[i] > 0.0f) ? SURFACE_PRIMITIVE_WALL_NEG_Z : SURFACE_PRIMITIVE_WALL_POS_Z)];
+            }
+            exit = MIN(exit, axisExit);
+        }
+    }
+
+    if ((surf == NULL) || (enter > exit) || (enter <= NEAR_ZERO) || (enter > *max_length)) return;
+
+    if (surf == &prim->floor) {
+        if (!(flags & RAYCAST_FIND_FLOOR)) return;
+    } else if (surf == &prim->ceil) {
+        if (!(flags & RAYCAST_FIND_CEIL)) return;
+    } else if (!(flags & RAYCAST_FIND_WALL)) {
+        return;
+    }
+
+    Vec3f add_dir;
+    vec3_scale_dest(add_dir, dir, enter);
+    vec3f_sum(hit_pos, orig, add_dir);
+    if (prim->shape == SURFACE_PRIMITIVE_CYLINDER && surf == &prim->walls[0]) {
+        surf->normal.x = ((hit_pos[0] - prim->x) / prim->halfX);
+        surf->normal.z = ((hit_pos[2] - prim->z) / prim->halfX);
+        surf->originOffset = -((surf->normal.x * prim->x) + (surf->normal.z * prim->z) + prim->halfX);
+    }
+    *hit_surface = surf;
+    *max_length = enter;
+}
+
 f32 find_surface_on_ray(Vec3f orig, Vec3f dir, struct Surface **hit_surface, Vec3f hit_pos, s32 flags) {
     Vec3f normalized_dir;
     const f32 invcell = 1.0f / CELL_SIZE;
@@ -954,6 +1079,11 @@ f32 find_surface_on_ray(Vec3f orig, Vec3f dir, struct Surface **hit_surface, Vec
     vec3f_copy(normalized_dir, dir);
     vec3f_normalize(normalized_dir);
 
+    // Object collision primitives aren't in the partitions.
+    for (s32 i = 0; i < gNumSurfacePrimitives; i++) {
+        find_surface_on_ray_primitive(&gSurfacePrimitives[i], orig, normalized_dir, hit_surface, hit_pos, &max_length, flags);
+    }
+
     // Get the start and end coords converted to cell-space
     f32 start_cell_coord_x = (orig[0] + LEVEL_BOUNDARY_MAX) * invcell;
     f32 start_cell_coord_z = (orig[2] + LEVEL_BOUNDARY_MAX) * invcell;
@@ -1078,3 +1208,25 @@ OPTIMIZE_OS void mtxf_to_mtx_fast(s16* dst, float* src) {
     //  to set the top half.
     dst[15] = 1;
 }
+
+// Copies the rotation and scale rows of an already converted fixed point matrix, and converts only a new translation row.
+// Produces the same result as mtxf_to_mtx_fast for matrices that only differ from the source in their translation.
+OPTIMIZE_OS void mtx_copy_with_translation_fast(s16* dst, s16* src, float* translation) {
+    float scale = construct_float(65536.0f / WORLD_SCALE);
+    s32* dst32 = (s32*) dst;
+    s32* src32 = (s32*) src;
+
+    // Integer and fractional halves of the first three rows
+    for (int i = 0; i < 6; i++) {
+        dst32[i + 0] = src32[i + 0];
+        dst32[i + 8] = src32[i + 8];
+    }
+
+    for (int i = 0; i < 3; i++) {
+        s32 t_int = (s32)(translation[i] * scale);
+        dst[12 + i] = (s16)(t_int >> 16);
+        dst[28 + i] = (s16)(t_int >>  0);
+    }
+    dst[15] = 1;
+    dst[31] = 0;
+}
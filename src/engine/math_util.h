@@ -644,6 +644,7 @@ void mtxf_scale_vec3f(Mat4 dest, Mat4 mtx, Vec3f s);
 void mtxf_mul_vec3s(Mat4 mtx, Vec3s b);
 
 extern void mtxf_to_mtx_fast(s16 *dest, float *src);
+extern void mtx_copy_with_translation_fast(s16 *dest, s16 *src, float *translation);
 ALWAYS_INLINE void mtxf_to_mtx(void *dest, void *src) {
     mtxf_to_mtx_fast((s16*)dest, (float*)src);
     // guMtxF2L(src, dest);
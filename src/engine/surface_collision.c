@@ -10,6 +10,24 @@
 #include "surface_load.h"
 #include "game/puppyprint.h"
 
+/**************************************************
+ *               SURFACE PROPERTIES               *
+ **************************************************/
+
+STATIC_ASSERT(SURFACE_TRAPDOOR < NUM_SURFACE_TYPE_PROPERTIES, "Surface types don't fit in gSurfaceTypeProperties!");
+
+#define SURFACE_TYPE_PROPERTIES_4(cmd)  SURFACE_TYPE_PROPERTIES((cmd) + 0), SURFACE_TYPE_PROPERTIES((cmd) + 1), \
+                                        SURFACE_TYPE_PROPERTIES((cmd) + 2), SURFACE_TYPE_PROPERTIES((cmd) + 3)
+#define SURFACE_TYPE_PROPERTIES_16(cmd) SURFACE_TYPE_PROPERTIES_4((cmd) + 0x0), SURFACE_TYPE_PROPERTIES_4((cmd) + 0x4), \
+                                        SURFACE_TYPE_PROPERTIES_4((cmd) + 0x8), SURFACE_TYPE_PROPERTIES_4((cmd) + 0xC)
+#define SURFACE_TYPE_PROPERTIES_64(cmd) SURFACE_TYPE_PROPERTIES_16((cmd) + 0x00), SURFACE_TYPE_PROPERTIES_16((cmd) + 0x10), \
+                                        SURFACE_TYPE_PROPERTIES_16((cmd) + 0x20), SURFACE_TYPE_PROPERTIES_16((cmd) + 0x30)
+
+const u16 gSurfaceTypeProperties[NUM_SURFACE_TYPE_PROPERTIES] = {
+    SURFACE_TYPE_PROPERTIES_64(0x00), SURFACE_TYPE_PROPERTIES_64(0x40),
+    SURFACE_TYPE_PROPERTIES_64(0x80), SURFACE_TYPE_PROPERTIES_64(0xC0),
+};
+
 /**************************************************
  *                      WALLS                     *
  **************************************************/
@@ -46,6 +64,31 @@ s32 check_wall_edge(Vec3f vert, Vec3f v2, f32 *d00, f32 *d01, f32 *invDenom, f32
     return TRUE;
 }
 
+/**
+ * Whether a wall should be skipped for the current collision check.
+ */
+ALWAYS_INLINE static s32 wall_is_intangible(struct Surface *surf) {
+    TerrainData type = surf->type;
+
+    // Determine if checking for the camera or not.
+    if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+        if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) return TRUE;
+    } else {
+        // Ignore camera only surfaces.
+        if (type == SURFACE_CAMERA_BOUNDARY) return TRUE;
+
+        // If an object can pass through a vanish cap wall, pass through.
+        if (type == SURFACE_VANISH_CAP_WALLS && o != NULL) {
+            // If an object can pass through a vanish cap wall, pass through.
+            if (o->activeFlags & ACTIVE_FLAG_MOVE_THROUGH_GRATE) return TRUE;
+            // If Mario has a vanish cap, pass through the vanish cap wall.
+            if (o == gMarioObject && gMarioState->flags & MARIO_VANISH_CAP) return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 /**
  * Iterate through the list of walls until all walls are checked and
  * have given their wall push.
@@ -60,7 +103,6 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struc
     Vec3f v0, v1, v2;
     f32 d00, d01, d11, d20, d21;
     f32 invDenom;
-    TerrainData type = SURFACE_DEFAULT;
     s32 numCols = 0;
 
     f32 margin_radius = radius - 1.0f;
@@ -69,26 +111,11 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struc
     while (surfaceNode != NULL) {
         surf        = surfaceNode->surface;
         surfaceNode = surfaceNode->next;
-        type        = surf->type;
 
         // Exclude a large number of walls immediately to optimize.
         if (pos[1] < surf->lowerY || pos[1] > surf->upperY) continue;
 
-        // Determine if checking for the camera or not.
-        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
-            if (surf->flags & SURFACE_FLAG_NO_CAM_COLLISION) continue;
-        } else {
-            // Ignore camera only surfaces.
-            if (type == SURFACE_CAMERA_BOUNDARY) continue;
-
-            // If an object can pass through a vanish cap wall, pass through.
-            if (type == SURFACE_VANISH_CAP_WALLS && o != NULL) {
-                // If an object can pass through a vanish cap wall, pass through.
-                if (o->activeFlags & ACTIVE_FLAG_MOVE_THROUGH_GRATE) continue;
-                // If Mario has a vanish cap, pass through the vanish cap wall.
-                if (o == gMarioObject && gMarioState->flags & MARIO_VANISH_CAP) continue;
-            }
-        }
+        if (wall_is_intangible(surf)) continue;
 
         // Dot of normal and pos, + origin offset
         offset = (surf->normal.x * pos[0])
@@ -168,6 +195,98 @@ static s32 find_wall_collisions_from_list(struct SurfaceNode *surfaceNode, struc
     return numCols;
 }
 
+/**
+ * Push the collision data out of the sides of the loaded collision primitives.
+ */
+static s32 find_wall_collisions_from_primitives(struct WallCollisionData *data) {
+    struct SurfacePrimitive *prim = gSurfacePrimitives;
+    struct Surface *surf;
+    f32 radius = data->radius;
+    f32 y = (data->y + data->offsetY);
+    s32 numCols = 0;
+    s32 i;
+
+    for (i = 0; i < gNumSurfacePrimitives; i++, prim++) {
+        surf = &prim->walls[0];
+
+        if (y < surf->lowerY || y > surf->upperY) continue;
+        if (wall_is_intangible(surf)) continue;
+
+        f32 dx = (data->x - prim->x);
+        f32 dz = (data->z - prim->z);
+        f32 reach = (prim->boundRadius + radius);
+        if ((sqr(dx) + sqr(dz)) > sqr(reach)) continue;
+
+        f32 pushX, pushZ;
+
+        if (prim->shape == SURFACE_PRIMITIVE_CYLINDER) {
+            f32 dist = sqrtf(sqr(dx) + sqr(dz));
+            f32 nx = 0.0f;
+            f32 nz = 1.0f;
+            if (dist > NEAR_ZERO) {
+                nx = (dx / dist);
+                nz = (dz / dist);
+            }
+
+            pushX = (nx * (reach - dist));
+            pushZ = (nz * (reach - dist));
+
+            // The cylinder's wall is the plane touching it where it was hit.
+            surf->normal.x = nx;
+            surf->normal.z = nz;
+            surf->originOffset = -((nx * prim->x) + (nz * prim->z) + prim->halfX);
+        } else {
+            // Move into the box's rotated space, where it's a rectangle around the origin.
+            f32 localX = ((dx * prim->cosYaw) - (dz * prim->sinYaw));
+            f32 localZ = ((dx * prim->sinYaw) + (dz * prim->cosYaw));
+            f32 outX = (absf(localX) - prim->halfX);
+            f32 outZ = (absf(localZ) - prim->halfZ);
+            f32 localPushX = 0.0f;
+            f32 localPushZ = 0.0f;
+
+            if (outX > radius || outZ > radius) continue;
+
+            if (outX > 0.0f && outZ > 0.0f) {
+                // Past a corner, so push away from it.
+                f32 dist = sqrtf(sqr(outX) + sqr(outZ));
+                if (dist >= radius) continue;
+                localPushX = (outX * ((radius / dist) - 1.0f));
+                localPushZ = (outZ * ((radius / dist) - 1.0f));
+            } else if (outX > outZ) {
+                localPushX = (radius - outX);
+            } else {
+                localPushZ = (radius - outZ);
+            }
+
+            if (outX > outZ) {
+                surf = &prim->walls[(localX >= 0.0f) ? SURFACE_PRIMITIVE_WALL_POS_X : SURFACE_PRIMITIVE_WALL_NEG_X];
+            } else {
+                surf = &prim->walls[(localZ >= 0.0f) ? SURFACE_PRIMITIVE_WALL_POS_Z : SURFACE_PRIMITIVE_WALL_NEG_Z];
+            }
+            if (localX < 0.0f) localPushX = -localPushX;
+            if (localZ < 0.0f) localPushZ = -localPushZ;
+
+            pushX = ((localPushX * prim->cosYaw) + (localPushZ * prim->sinYaw));
+            pushZ = ((localPushZ * prim->cosYaw) - (localPushX * prim->sinYaw));
+        }
+
+        data->x += pushX;
+        data->z += pushZ;
+
+        // Has collision
+        if (data->numWalls < MAX_REFERENCED_WALLS) {
+            data->walls[data->numWalls++] = surf;
+        }
+        numCols++;
+
+        if (gCollisionFlags & COLLISION_FLAG_RETURN_FIRST) {
+            break;
+        }
+    }
+
+    return numCols;
+}
+
 /**
  * Formats the position and wall search for find_wall_collisions.
  */
@@ -230,6 +349,11 @@ s32 find_wall_collisions(struct WallCollisionData *colData) {
         }
     }
 
+    if (!(gCollisionFlags & COLLISION_FLAG_EXCLUDE_DYNAMIC)) {
+        // Check for object collision primitives.
+        numCollisions += find_wall_collisions_from_primitives(colData);
+    }
+
     gCollisionFlags &= ~(COLLISION_FLAG_RETURN_FIRST | COLLISION_FLAG_EXCLUDE_DYNAMIC | COLLISION_FLAG_INCLUDE_INTANGIBLE);
 #ifdef VANILLA_DEBUG
     // Increment the debug tracker.
@@ -346,6 +470,45 @@ static struct Surface *find_ceil_from_list(struct SurfaceNode *surfaceNode, s32
     return ceil;
 }
 
+/**
+ * Whether a point is within a collision primitive's footprint.
+ */
+static s32 check_within_primitive_bounds(s32 x, s32 z, struct SurfacePrimitive *prim) {
+    f32 dx = (x - prim->x);
+    f32 dz = (z - prim->z);
+
+    if ((sqr(dx) + sqr(dz)) > sqr(prim->boundRadius)) return FALSE;
+    if (prim->shape == SURFACE_PRIMITIVE_CYLINDER) return TRUE;
+
+    return (absf((dx * prim->cosYaw) - (dz * prim->sinYaw)) <= prim->halfX
+         && absf((dx * prim->sinYaw) + (dz * prim->cosYaw)) <= prim->halfZ);
+}
+
+/**
+ * Find the lowest collision primitive bottom above a point that's lower than *pheight.
+ */
+static struct Surface *find_ceil_from_primitives(s32 x, s32 y, s32 z, f32 *pheight) {
+    struct SurfacePrimitive *prim = gSurfacePrimitives;
+    struct Surface *ceil = NULL;
+    s32 i;
+
+    for (i = 0; i < gNumSurfacePrimitives; i++, prim++) {
+        if (y > prim->minY || prim->minY > *pheight) continue;
+
+        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+            if (prim->ceil.flags & SURFACE_FLAG_NO_CAM_COLLISION) continue;
+        } else if (prim->ceil.type == SURFACE_CAMERA_BOUNDARY) {
+            continue;
+        }
+
+        if (!check_within_primitive_bounds(x, z, prim)) continue;
+
+        *pheight = prim->minY;
+        ceil = &prim->ceil;
+    }
+    return ceil;
+}
+
 /**
  * Find the lowest ceiling above a given position and return the height.
  */
@@ -379,6 +542,12 @@ f32 find_ceil(f32 posX, f32 posY, f32 posZ, struct Surface **pceil) {
         surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS].next;
         dynamicCeil = find_ceil_from_list(surfaceList, x, y, z, &dynamicHeight);
 
+        // Check for object collision primitives.
+        struct Surface *primitiveCeil = find_ceil_from_primitives(x, y, z, &dynamicHeight);
+        if (primitiveCeil != NULL) {
+            dynamicCeil = primitiveCeil;
+        }
+
         // In the next check, only check for ceilings lower than the previous check.
         height = dynamicHeight;
     }
@@ -484,6 +653,36 @@ static struct Surface *find_floor_from_list(struct SurfaceNode *surfaceNode, s32
     return floor;
 }
 
+/**
+ * Find the highest collision primitive top under a point that's higher than *pheight.
+ */
+static struct Surface *find_floor_from_primitives(s32 x, s32 y, s32 z, f32 *pheight) {
+    struct SurfacePrimitive *prim = gSurfacePrimitives;
+    struct Surface *floor = NULL;
+    s32 bufferY = (y + FIND_FLOOR_BUFFER);
+    s32 i;
+
+    for (i = 0; i < gNumSurfacePrimitives; i++, prim++) {
+        if (bufferY < prim->maxY || prim->maxY <= *pheight) continue;
+
+        if (!(gCollisionFlags & COLLISION_FLAG_INCLUDE_INTANGIBLE) && (prim->floor.type == SURFACE_INTANGIBLE)) {
+            continue;
+        }
+
+        if (gCollisionFlags & COLLISION_FLAG_CAMERA) {
+            if (prim->floor.flags & SURFACE_FLAG_NO_CAM_COLLISION) continue;
+        } else if (prim->floor.type == SURFACE_CAMERA_BOUNDARY) {
+            continue;
+        }
+
+        if (!check_within_primitive_bounds(x, z, prim)) continue;
+
+        *pheight = prim->maxY;
+        floor = &prim->floor;
+    }
+    return floor;
+}
+
 // Generic triangle bounds func
 ALWAYS_INLINE static s32 check_within_bounds_y_norm(s32 x, s32 z, struct Surface *surf) {
     if (surf->normal.y >= NORMAL_FLOOR_THRESHOLD) return check_within_floor_triangle_bounds(x, z, surf);
@@ -618,6 +817,12 @@ f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
         surfaceList = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS].next;
         dynamicFloor = find_floor_from_list(surfaceList, x, y, z, &dynamicHeight);
 
+        // Check for object collision primitives.
+        struct Surface *primitiveFloor = find_floor_from_primitives(x, y, z, &dynamicHeight);
+        if (primitiveFloor != NULL) {
+            dynamicFloor = primitiveFloor;
+        }
+
         // In the next check, only check for floors higher than the previous check.
         height = dynamicHeight;
     }
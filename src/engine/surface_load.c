@@ -1,6 +1,7 @@
 #include <PR/ultratypes.h>
 
 #include "sm64.h"
+#include "game/clock_mover.h"
 #include "game/ingame_menu.h"
 #include "graph_node.h"
 #include "behavior_script.h"
@@ -52,6 +53,12 @@ void *gDynamicSurfacePoolEnd;
  */
 u32 gTotalStaticSurfaceData;
 
+/**
+ * Object collision primitives loaded this frame. Cleared along with the dynamic surfaces.
+ */
+struct SurfacePrimitive gSurfacePrimitives[MAX_SURFACE_PRIMITIVES];
+s32 gNumSurfacePrimitives;
+
 /**
  * Allocate the part of the surface node pool to contain a surface node.
  */
@@ -568,6 +575,7 @@ void clear_dynamic_surfaces(void) {
         }
         sNumCellsUsed = 0;
         sClearAllCells = FALSE;
+        gNumSurfacePrimitives = 0;
     }
     profiler_collision_update(first);
 }
@@ -658,12 +666,118 @@ void load_object_surfaces(TerrainData **data, TerrainData *vertexData, u32 dynam
     }
 }
 
+/**
+ * Sets up one of a primitive's surfaces. The vertices only matter to code reading
+ * the surface after a hit, since the primitive's shape is what gets tested.
+ */
+static void init_primitive_surface(struct Surface *surf, struct SurfacePrimitive *prim, s32 surfaceType, s32 flags,
+                                   f32 nx, f32 ny, f32 nz, Vec3f v1, Vec3f v2, Vec3f v3) {
+    surf->type = surfaceType;
+    surf->force = 0;
+    surf->flags = flags;
+    surf->room = 0;
+    surf->lowerY = (prim->minY - SURFACE_VERTICAL_BUFFER);
+    surf->upperY = (prim->maxY + SURFACE_VERTICAL_BUFFER);
+    vec3_copy(surf->vertex1, v1);
+    vec3_copy(surf->vertex2, v2);
+    vec3_copy(surf->vertex3, v3);
+    surf->normal.x = nx;
+    surf->normal.y = ny;
+    surf->normal.z = nz;
+    surf->originOffset = -((nx * v1[0]) + (ny * v1[1]) + (nz * v1[2]));
+    surf->object = o;
+}
+
+/**
+ * Gets the world position of a point on a primitive, from its offset in the primitive's rotated space.
+ */
+static void primitive_local_to_world(Vec3f dest, struct SurfacePrimitive *prim, f32 localX, f32 y, f32 localZ) {
+    dest[0] = (prim->x + (localX * prim->cosYaw) + (localZ * prim->sinYaw));
+    dest[1] = y;
+    dest[2] = (prim->z - (localX * prim->sinYaw) + (localZ * prim->cosYaw));
+}
+
+/**
+ * Load an object's collision primitive (see COL_PRIMITIVE_BOX), placing it with the object's transform.
+ */
+static void load_object_surface_primitive(TerrainData *data) {
+    Mat4 *objectTransform = &o->transform;
+    f32 *scale = o->header.gfx.scale;
+    Vec3f c[4], top[4];
+    s32 i;
+
+    if (gNumSurfacePrimitives >= MAX_SURFACE_PRIMITIVES) return;
+
+    if (o->header.gfx.throwMatrix == NULL) {
+        o->header.gfx.throwMatrix = objectTransform;
+        obj_build_transform_from_pos_and_angle(o, O_POS_INDEX, O_FACE_ANGLE_INDEX);
+    }
+
+    struct SurfacePrimitive *prim = &gSurfacePrimitives[gNumSurfacePrimitives++];
+    s32 surfaceType = data[2];
+    assert(!SURFACE_IS_NEW_WATER(surfaceType), "Collision primitives can't be water.");
+    s32 flags = (surf_has_no_cam_collision(surfaceType) | SURFACE_FLAG_DYNAMIC);
+
+    prim->shape = data[1];
+    prim->x = (*objectTransform)[3][0];
+    prim->z = (*objectTransform)[3][2];
+    prim->minY = ((*objectTransform)[3][1] + (data[4] * scale[1]));
+    prim->maxY = ((*objectTransform)[3][1] + (data[5] * scale[1]));
+
+    // The yaw is taken from the transform's x axis, so any pitch or roll is ignored.
+    f32 axisLength = sqrtf(sqr((*objectTransform)[0][0]) + sqr((*objectTransform)[0][2]));
+    if (axisLength > NEAR_ZERO) {
+        prim->cosYaw =  ((*objectTransform)[0][0] / axisLength);
+        prim->sinYaw = -((*objectTransform)[0][2] / axisLength);
+    } else {
+        prim->cosYaw = 1.0f;
+        prim->sinYaw = 0.0f;
+    }
+
+    if (prim->shape == SURFACE_PRIMITIVE_CYLINDER) {
+        prim->halfX = prim->halfZ = prim->boundRadius = (data[3] * scale[0]);
+    } else {
+        prim->halfX = (data[3] * scale[0]);
+        prim->halfZ = (data[6] * scale[2]);
+        prim->boundRadius = sqrtf(sqr(prim->halfX) + sqr(prim->halfZ));
+    }
+
+    // The box's corners. Cylinders use the square around them.
+    primitive_local_to_world(c[0], prim, -prim->halfX, prim->minY, -prim->halfZ);
+    primitive_local_to_world(c[1], prim, -prim->halfX, prim->minY,  prim->halfZ);
+    primitive_local_to_world(c[2], prim,  prim->halfX, prim->minY,  prim->halfZ);
+    primitive_local_to_world(c[3], prim,  prim->halfX, prim->minY, -prim->halfZ);
+    for (i = 0; i < 4; i++) {
+        vec3_copy(top[i], c[i]);
+        top[i][1] = prim->maxY;
+    }
+
+    init_primitive_surface(&prim->floor, prim, surfaceType, flags, 0.0f,  1.0f, 0.0f, top[0], top[1], top[2]);
+    init_primitive_surface(&prim->ceil,  prim, surfaceType, flags, 0.0f, -1.0f, 0.0f, c[0], c[2], c[1]);
+
+    init_primitive_surface(&prim->walls[SURFACE_PRIMITIVE_WALL_POS_X], prim, surfaceType, flags,
+                            prim->cosYaw, 0.0f, -prim->sinYaw, c[3], c[2], top[2]);
+    init_primitive_surface(&prim->walls[SURFACE_PRIMITIVE_WALL_NEG_X], prim, surfaceType, flags,
+                           -prim->cosYaw, 0.0f,  prim->sinYaw, c[1], c[0], top[0]);
+    init_primitive_surface(&prim->walls[SURFACE_PRIMITIVE_WALL_POS_Z], prim, surfaceType, flags,
+                            prim->sinYaw, 0.0f,  prim->cosYaw, c[2], c[1], top[1]);
+    init_primitive_surface(&prim->walls[SURFACE_PRIMITIVE_WALL_NEG_Z], prim, surfaceType, flags,
+                           -prim->sinYaw, 0.0f, -prim->cosYaw, c[0], c[3], top[3]);
+}
+
 #ifdef AUTO_COLLISION_DISTANCE
 static void get_optimal_coll_dist(struct Object *obj) {
     register f32 thisVertDist, maxDist = 0.0f;
     Vec3f v;
     TerrainData *collisionData = o->collisionData;
     obj->oFlags |= OBJ_FLAG_DONT_CALC_COLL_DIST;
+    if (*collisionData == TERRAIN_LOAD_PRIMITIVE) {
+        // The farthest point is a top or bottom corner (or rim, for cylinders).
+        vec3_set(v, collisionData[3], MAX(ABS(collisionData[4]), ABS(collisionData[5])), collisionData[6]);
+        vec3_mul(v, obj->header.gfx.scale);
+        obj->oCollisionDistance = (sqrtf(vec3_sumsq(v)) + 100.0f);
+        return;
+    }
     collisionData++;
     register u32 vertsLeft = *(collisionData)++;
     while (vertsLeft) {
@@ -716,12 +830,21 @@ void load_object_collision_model(void) {
         && inColRadius
         && !(o->activeFlags & ACTIVE_FLAG_IN_DIFFERENT_ROOM)
     ) {
-        collisionData++;
-        transform_object_vertices(&collisionData, sVertexData);
+        // Clock movers are only brought up to date when their collision is needed.
+        if (o->oFlags & OBJ_FLAG_CLOCK_MOVER) {
+            obj_sync_clock_mover(o);
+        }
 
-        // TERRAIN_LOAD_CONTINUE acts as an "end" to the terrain data.
-        while (*collisionData != TERRAIN_LOAD_CONTINUE) {
-            load_object_surfaces(&collisionData, sVertexData, TRUE);
+        if (*collisionData == TERRAIN_LOAD_PRIMITIVE) {
+            load_object_surface_primitive(collisionData);
+        } else {
+            collisionData++;
+            transform_object_vertices(&collisionData, sVertexData);
+
+            // TERRAIN_LOAD_CONTINUE acts as an "end" to the terrain data.
+            while (*collisionData != TERRAIN_LOAD_CONTINUE) {
+                load_object_surfaces(&collisionData, sVertexData, TRUE);
+            }
         }
     }
 
@@ -745,6 +868,9 @@ void load_object_static_model(void) {
     TerrainData *collisionData = o->collisionData;
     u32 surfacePoolData;
 
+    // Collision primitives are only tested while they're loaded as dynamic collision.
+    if (*collisionData == TERRAIN_LOAD_PRIMITIVE) return;
+
     // Initialise a new surface pool for this block of surface data
     gCurrStaticSurfacePool = main_pool_alloc(main_pool_available() - 0x10, MEMORY_POOL_LEFT);
     gCurrStaticSurfacePoolEnd = gCurrStaticSurfacePool;
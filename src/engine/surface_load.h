@@ -13,8 +13,42 @@
 
 /**
  * The size of the dynamic surface pool, in bytes.
+ * Building with POOL_SIZES=1 sizes this from the level data instead.
  */
+#ifndef DYNAMIC_SURFACE_POOL_SIZE
 #define DYNAMIC_SURFACE_POOL_SIZE 0x8000
+#endif
+
+/**
+ * The max amount of object collision primitives that can be loaded at once.
+ */
+#define MAX_SURFACE_PRIMITIVES 32
+
+enum SurfacePrimitiveWalls {
+    SURFACE_PRIMITIVE_WALL_POS_X,
+    SURFACE_PRIMITIVE_WALL_NEG_X,
+    SURFACE_PRIMITIVE_WALL_POS_Z,
+    SURFACE_PRIMITIVE_WALL_NEG_Z,
+    NUM_SURFACE_PRIMITIVE_WALLS
+};
+
+/**
+ * Object collision loaded from COL_PRIMITIVE_BOX or COL_PRIMITIVE_CYLINDER. Instead of being split into
+ * triangles and added to the dynamic partition, the shape is tested directly by find_floor, find_ceil,
+ * find_wall_collisions and find_surface_on_ray, which return one of its surfaces as the hit, and the visual
+ * surface view draws it as a box. Only the object's yaw is applied, and primitives can't be water.
+ */
+struct SurfacePrimitive {
+    /*0x00*/ u8 shape;
+    /*0x04*/ f32 x, z;
+    /*0x0C*/ f32 cosYaw, sinYaw;
+    /*0x14*/ f32 halfX, halfZ; // The cylinder's radius is in both
+    /*0x1C*/ f32 minY, maxY;
+    /*0x24*/ f32 boundRadius;
+    /*0x28*/ struct Surface floor;
+    /*0x58*/ struct Surface ceil;
+    /*0x88*/ struct Surface walls[NUM_SURFACE_PRIMITIVE_WALLS]; // Cylinders only use the first, set on each hit
+};
 
 struct SurfaceNode {
     struct SurfaceNode *next;
@@ -38,6 +72,8 @@ extern void *gDynamicSurfacePool;
 extern void *gCurrStaticSurfacePoolEnd;
 extern void *gDynamicSurfacePoolEnd;
 extern u32 gTotalStaticSurfaceData;
+extern struct SurfacePrimitive gSurfacePrimitives[MAX_SURFACE_PRIMITIVES];
+extern s32 gNumSurfacePrimitives;
 
 void alloc_surface_pools(void);
 #ifdef NO_SEGMENTED_MEMORY
@@ -60,6 +60,16 @@ Color gWarpTransBlue = 0;
 s16 gCurrSaveFileNum = 1;
 s16 gCurrLevelNum = LEVEL_MIN;
 
+#ifdef PAUSE_FROZEN_BACKGROUND
+u8 gPauseBackgroundFrozen = FALSE;
+static u8 sPauseRenderFrames = 0;
+// The background was rendered into the current framebuffer last frame and isn't in the Z-buffer yet.
+static u8 sPauseBackgroundInFramebuffer = FALSE;
+
+// The pause screen camera zooms out a couple of frames into the pause (see zoom_out_if_paused_and_outside).
+#define PAUSE_BACKGROUND_CAPTURE_FRAME 3
+#endif
+
 /*
  * The following two tables are used in get_mario_spawn_type() to determine spawn type
  * from warp behavior.
@@ -135,9 +145,11 @@ void print_intro_text(void) {
     }
 }
 
-u32 get_mario_spawn_type(struct Object *obj) {
+/**
+ * Get the spawn type of a warp behavior, as found in a SpawnInfo.
+ */
+u32 get_mario_spawn_type_from_behavior(const BehaviorScript *behavior) {
     s32 i;
-    const BehaviorScript *behavior = virtual_to_segmented(SEGMENT_BEHAVIOR_DATA, obj->behavior);
 
     for (i = 0; i < 20; i++) {
         if (sWarpBhvSpawnTable[i] == behavior) {
@@ -147,6 +159,10 @@ u32 get_mario_spawn_type(struct Object *obj) {
     return MARIO_SPAWN_NONE;
 }
 
+u32 get_mario_spawn_type(struct Object *obj) {
+    return get_mario_spawn_type_from_behavior(virtual_to_segmented(SEGMENT_BEHAVIOR_DATA, obj->behavior));
+}
+
 struct ObjectWarpNode *area_get_warp_node(u8 id) {
     struct ObjectWarpNode *node = NULL;
 
@@ -394,9 +410,113 @@ void play_transition_after_delay(s16 transType, s16 time, u8 red, u8 green, u8 b
     play_transition(transType, time, red, green, blue);
 }
 
+#ifdef PAUSE_FROZEN_BACKGROUND
+/**
+ * Copies a full screen image from src into the current color image with the RDP,
+ * as many rows at a time as fit in TMEM.
+ */
+static void copy_screen_image(uintptr_t src) {
+    s32 stripRows = 4096 / (SCREEN_WIDTH * sizeof(u16));
+    s32 rows;
+    s32 y;
+
+    gDPPipeSync(gDisplayListHead++);
+    gDPSetCycleType(gDisplayListHead++, G_CYC_COPY);
+    gDPSetRenderMode(gDisplayListHead++, G_RM_NOOP, G_RM_NOOP2);
+    gDPSetAlphaCompare(gDisplayListHead++, G_AC_NONE);
+    gDPSetTexturePersp(gDisplayListHead++, G_TP_NONE);
+    gDPSetTextureFilter(gDisplayListHead++, G_TF_POINT);
+    gDPSetTextureLUT(gDisplayListHead++, G_TT_NONE);
+    gDPSetScissor(gDisplayListHead++, G_SC_NON_INTERLACE, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    for (y = 0; y < SCREEN_HEIGHT; y += rows) {
+        rows = MIN(stripRows, SCREEN_HEIGHT - y);
+
+        gDPLoadSync(gDisplayListHead++);
+        gDPLoadTextureTile(gDisplayListHead++,
+            src, G_IM_FMT_RGBA, G_IM_SIZ_16b, SCREEN_WIDTH, SCREEN_HEIGHT, 0, y, (SCREEN_WIDTH - 1), ((y + rows) - 1), 0,
+            (G_TX_NOMIRROR | G_TX_CLAMP), (G_TX_NOMIRROR | G_TX_CLAMP), G_TX_NOMASK, G_TX_NOMASK, G_TX_NOLOD, G_TX_NOLOD);
+        // Copy mode rectangles include their lower right edge.
+        gSPTextureRectangle(gDisplayListHead++,
+            0, (y << 2), ((SCREEN_WIDTH - 1) << 2), (((y + rows) - 1) << 2),
+            G_TX_RENDERTILE, 0, (y << 5), (4 << 10), (1 << 10));
+    }
+
+    gDPPipeSync(gDisplayListHead++);
+    gDPSetCycleType(gDisplayListHead++, G_CYC_1CYCLE);
+    gDPSetRenderMode(gDisplayListHead++, G_RM_OPA_SURF, G_RM_OPA_SURF2);
+    gDPSetTexturePersp(gDisplayListHead++, G_TP_PERSP);
+    gDPSetTextureFilter(gDisplayListHead++, G_TF_BILERP);
+}
+
+/**
+ * Freezes the pause background as rendered so far. The rest of this frame isn't drawn and
+ * the frame isn't displayed, so the next one starts from the background in the same framebuffer.
+ */
+static void capture_pause_background(void) {
+#ifdef PAUSE_FROZEN_BACKGROUND_SHADED
+    shade_screen();
+#endif
+    gPauseBackgroundFrozen = TRUE;
+    sPauseBackgroundInFramebuffer = TRUE;
+    gKeepRenderingFramebuffer = TRUE;
+}
+
+/**
+ * Copies the background captured last frame into the Z-buffer, which isn't needed for depth
+ * until unpausing. The RDP is done with last frame by now, which it may not be while drawing it.
+ */
+static void store_pause_background(void) {
+    gDPPipeSync(gDisplayListHead++);
+    gDPSetColorImage(gDisplayListHead++, G_IM_FMT_RGBA, G_IM_SIZ_16b, SCREEN_WIDTH, gPhysicalZBuffer);
+    copy_screen_image(gPhysicalFramebuffers[sRenderingFramebuffer]);
+    select_framebuffer();
+
+    sPauseBackgroundInFramebuffer = FALSE;
+}
+
+/**
+ * Counts the frames rendered on the pause screen, and thaws the pause background once the
+ * game is no longer paused.
+ */
+static void update_pause_background(void) {
+    if (sCurrPlayMode == PLAY_MODE_PAUSED && gMenuMode == MENU_MODE_RENDER_PAUSE_SCREEN) {
+        if (sPauseRenderFrames < PAUSE_BACKGROUND_CAPTURE_FRAME) {
+            sPauseRenderFrames++;
+        }
+        return;
+    }
+
+    sPauseRenderFrames = 0;
+
+    if (gPauseBackgroundFrozen) {
+        gPauseBackgroundFrozen = FALSE;
+        sPauseBackgroundInFramebuffer = FALSE;
+        // init_rcp skipped this frame's clear, and the Z-buffer is still full of the background.
+#ifdef ALTERNATE_ZBUFFER_RANGES
+        gZBufferNearRange = TRUE;
+#endif
+        init_z_buffer(CLEAR_ZBUFFER);
+        select_framebuffer();
+    }
+}
+#endif
+
 void render_game(void) {
     PROFILER_GET_SNAPSHOT_TYPE(PROFILER_DELTA_COLLISION);
+#ifdef PAUSE_FROZEN_BACKGROUND
+    Gfx *captureHead = NULL;
+
+    update_pause_background();
+#endif
     if (gCurrentArea != NULL && !gWarpTransition.pauseRendering) {
+#ifdef PAUSE_FROZEN_BACKGROUND
+        if (sPauseBackgroundInFramebuffer) {
+            store_pause_background();
+        } else if (gPauseBackgroundFrozen) {
+            copy_screen_image(gPhysicalZBuffer);
+        } else
+#endif
         if (gCurrentArea->graphNode) {
             geo_process_root(gCurrentArea->graphNode, gViewportOverride, gViewportClip, gFBSetColor);
         }
@@ -408,7 +528,18 @@ void render_game(void) {
 
         gDPSetScissor(gDisplayListHead++, G_SC_NON_INTERLACE, 0, gBorderHeight, SCREEN_WIDTH,
                       SCREEN_HEIGHT - gBorderHeight);
+#ifdef PAUSE_FROZEN_BACKGROUND
+        // The HUD doesn't change while paused, so it's captured along with the area.
+        if (!gPauseBackgroundFrozen) {
+            render_hud();
+            if (sPauseRenderFrames == PAUSE_BACKGROUND_CAPTURE_FRAME) {
+                capture_pause_background();
+                captureHead = gDisplayListHead;
+            }
+        }
+#else
         render_hud();
+#endif
 
         gDPSetScissor(gDisplayListHead++, G_SC_NON_INTERLACE, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
         render_text_labels();
@@ -474,4 +605,10 @@ void render_game(void) {
 #ifdef PUPPYPRINT_DEBUG
     puppyprint_render_profiler();
 #endif
+#ifdef PAUSE_FROZEN_BACKGROUND
+    // The menus still run on the capture frame, but what was drawn after the background is dropped.
+    if (captureHead != NULL) {
+        gDisplayListHead = captureHead;
+    }
+#endif
 }
@@ -177,12 +177,20 @@ extern struct SpawnInfo *gMarioSpawnInfo;
 extern struct Area *gAreas;
 extern struct Area *gCurrentArea;
 
+extern Vp *gViewportOverride;
+extern Vp *gViewportClip;
+
 extern s16 gCurrSaveFileNum;
 extern s16 gCurrLevelNum;
 
+#ifdef PAUSE_FROZEN_BACKGROUND
+extern u8 gPauseBackgroundFrozen;
+#endif
+
 
 void override_viewport_and_clip(Vp *a, Vp *b, u8 c, u8 d, u8 e);
 void print_intro_text(void);
+u32 get_mario_spawn_type_from_behavior(const BehaviorScript *behavior);
 u32 get_mario_spawn_type(struct Object *obj);
 struct ObjectWarpNode *area_get_warp_node(u8 id);
 void clear_areas(void);
@@ -447,7 +447,6 @@ void bhv_wooden_post_update(void);
 void bhv_chain_chomp_gate_init(void);
 void bhv_chain_chomp_gate_update(void);
 void bhv_wiggler_update(void);
-void bhv_wiggler_body_part_update(void);
 void bhv_enemy_lakitu_update(void);
 void bhv_camera_lakitu_init(void);
 void bhv_camera_lakitu_update(void);
@@ -484,6 +483,7 @@ void bhv_ttc_elevator_init(void);
 void bhv_ttc_elevator_update(void);
 void bhv_ttc_2d_rotator_init(void);
 void bhv_ttc_2d_rotator_update(void);
+void bhv_ttc_spinner_init(void);
 void bhv_ttc_spinner_update(void);
 void bhv_mr_blizzard_init(void);
 void bhv_mr_blizzard_update(void);
@@ -491,7 +491,6 @@ void bhv_mr_blizzard_snowball(void);
 void bhv_sliding_platform_init(void);
 void bhv_sliding_platform_loop(void);
 void bhv_rotating_octagonal_plat_init(void);
-void bhv_rotating_octagonal_plat_loop(void);
 void bhv_animates_on_floor_switch_press_init(void);
 void bhv_animates_on_floor_switch_press_loop(void);
 void bhv_activated_back_and_forth_platform_init(void);
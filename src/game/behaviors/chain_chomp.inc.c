@@ -1,12 +1,12 @@
 
 /**
  * Behavior for bhvChainChomp, bhvChainChompChainPart, bhvWoodenPost, and bhvChainChompGate.
- * bhvChainChomp spawns its bhvWoodenPost in its behavior script. It spawns 5 chain
- * parts. Part 0 is the "pivot", which is positioned at the wooden post while
- * the chomp is chained up. Parts 1-4 are the other parts, starting from the
- * chain chomp and moving toward the pivot.
+ * bhvChainChomp spawns its bhvWoodenPost in its behavior script. It spawns the
+ * "pivot" chain part, which is positioned at the wooden post while the chomp is
+ * chained up. The other chain parts aren't objects but segments of the chomp's
+ * compound actor, starting from the chain chomp and moving toward the pivot.
  * Processing order is bhvWoodenPost, bhvChainChompGate, bhvChainChomp, bhvChainChompChainPart.
- * The chain parts are processed starting at the post and ending at the chomp.
+ * The pivot moves the other chain parts once it has moved itself.
  */
 
 #define CHAIN_CHOMP_CHAIN_MAX_DIST_BETWEEN_PARTS 180.0f
@@ -30,32 +30,52 @@ static struct ObjectHitbox sChainChompHitbox = {
 };
 
 /**
- * Update function for chain chomp part / pivot.
+ * Update function for the pivot. Also places the other chain parts relative to it.
  */
 void bhv_chain_chomp_chain_part_update(void) {
-    if (o->parentObj->oAction == CHAIN_CHOMP_ACT_UNLOAD_CHAIN) {
+    struct Object *chainChomp = o->parentObj;
+    struct CompoundActor *chain = chainChomp->compound;
+    s32 i;
+
+    if (chainChomp->oAction == CHAIN_CHOMP_ACT_UNLOAD_CHAIN) {
         obj_mark_for_deletion(o);
-    } else if (o->oBehParams2ndByte != CHAIN_CHOMP_CHAIN_PART_BP_PIVOT) {
-        struct ChainSegment *segment = &o->parentObj->oChainChompSegments[o->oBehParams2ndByte];
+        return;
+    }
 
-        // Set position relative to the pivot
-        vec3f_sum(&o->oPosVec, &o->parentObj->parentObj->oPosVec, segment->pos);
-    } else if (o->parentObj->oChainChompReleaseStatus != CHAIN_CHOMP_NOT_RELEASED) {
+    if (chainChomp->oChainChompReleaseStatus != CHAIN_CHOMP_NOT_RELEASED) {
         cur_obj_update_floor_and_walls();
         cur_obj_move_standard(78);
     }
+
+    if (chain != NULL) {
+        for (i = 1; i < CHAIN_CHOMP_NUM_SEGMENTS; i++) {
+            struct GraphNodeObject *part = &chain->segments[i - 1].gfx;
+
+            vec3f_sum(part->pos, &o->oPosVec, chainChomp->oChainChompSegments[i].pos);
+            part->pos[1] += 40.0f;
+        }
+    }
 }
 
 /**
- * When mario gets close enough, allocate chain segments and spawn their objects.
+ * When mario gets close enough, allocate chain segments and spawn the pivot.
  */
 static void chain_chomp_act_uninitialized(void) {
     struct ChainSegment *segments;
+    struct CompoundActor *chain;
     s32 i;
 
     if (o->oDistanceToMario < CHAIN_CHOMP_LOAD_DIST) {
         segments = mem_pool_alloc(gObjectMemoryPool, CHAIN_CHOMP_NUM_SEGMENTS * sizeof(struct ChainSegment));
-        if (segments != NULL) {
+        if (segments == NULL) {
+            return;
+        }
+
+        // The chain parts between the chomp and the pivot, starting from the chain chomp
+        chain = obj_alloc_compound_actor(o, CHAIN_CHOMP_NUM_SEGMENTS - 1, MODEL_METALLIC_BALL);
+        if (chain == NULL) {
+            mem_pool_free(gObjectMemoryPool, segments);
+        } else {
             // Each segment represents the offset of a chain part to the pivot.
             // Segment 0 connects the pivot to the chain chomp itself. Segment
             // 1 connects the pivot to the chain part next to the chain chomp
@@ -67,17 +87,19 @@ static void chain_chomp_act_uninitialized(void) {
 
             cur_obj_set_pos_to_home();
 
+            for (i = 0; i < chain->numSegments; i++) {
+                chain->segments[i].gfx.node.flags |= GRAPH_RENDER_BILLBOARD;
+                vec3f_set(chain->segments[i].gfx.scale, 2.0f, 2.0f, 2.0f);
+            }
+
             // Spawn the pivot and set to parent
             o->parentObj = spawn_object(o, CHAIN_CHOMP_CHAIN_PART_BP_PIVOT, bhvChainChompChainPart);
             if (o->parentObj != NULL) {
-                // Spawn the non-pivot chain parts, starting from the chain
-                // chomp and moving toward the pivot
-                for (i = 1; i < CHAIN_CHOMP_NUM_SEGMENTS; i++) {
-                    spawn_object_relative(i, 0, 0, 0, o, MODEL_METALLIC_BALL, bhvChainChompChainPart);
-                }
-
                 o->oAction = CHAIN_CHOMP_ACT_MOVE;
                 cur_obj_unhide();
+            } else {
+                mem_pool_free(gObjectMemoryPool, segments);
+                obj_free_compound_actor(o);
             }
         }
     }
@@ -398,12 +420,13 @@ static void chain_chomp_act_move(void) {
 }
 
 /**
- * Hide and free the chain chomp segments. The chain objects will unload
- * themselves when they see that the chain chomp is in this action.
+ * Hide and free the chain chomp segments and chain parts. The pivot will unload
+ * itself when it sees that the chain chomp is in this action.
  */
 static void chain_chomp_act_unload_chain(void) {
     cur_obj_hide();
     mem_pool_free(gObjectMemoryPool, o->oChainChompSegments);
+    obj_free_compound_actor(o);
 
     o->oAction = CHAIN_CHOMP_ACT_UNINITIALIZED;
 
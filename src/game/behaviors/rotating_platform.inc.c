@@ -37,7 +37,7 @@ void bhv_rotating_platform_loop(void) {
         obj_set_collision_data(o, sWFRotatingPlatformData[o->oBehParams2ndByte].collisionData);
         o->oCollisionDistance = sWFRotatingPlatformData[o->oBehParams2ndByte].collisionDistance;
         cur_obj_scale(sWFRotatingPlatformData[o->oBehParams2ndByte].scale * 0.01f);
+        o->oAngleVelYaw = speed << 4;
+        obj_start_clock_mover(o);
     }
-    o->oAngleVelYaw = speed << 4;
-    o->oFaceAngleYaw += o->oAngleVelYaw;
 }
@@ -29,25 +29,29 @@ void bhv_ttc_cog_init(void) {
     o->collisionData = segmented_to_virtual(
         sTTCCogCollisionModels[(o->oBehParams2ndByte & TTC_COG_BP_SHAPE_MASK) >> 1]);
     o->oTTCCogDir = sTTCCogDirections[o->oBehParams2ndByte & TTC_COG_BP_DIR_MASK];
+
+    // Outside of the random setting, the cog turns at a constant speed, so let the
+    // clock turn it.
+    if (gTTCSpeedSetting != TTC_SPEED_RANDOM) {
+        if (gTTCSpeedSetting != TTC_SPEED_STOPPED) {
+            o->oTTCCogSpeed = sTTCCogNormalSpeeds[gTTCSpeedSetting];
+        }
+
+        o->oAngleVelYaw = (s32)(o->oTTCCogSpeed * o->oTTCCogDir);
+        obj_start_clock_mover(o);
+    }
 }
 
 /**
  * Update function for bhvTTCCog.
  */
 void bhv_ttc_cog_update(void) {
-    switch (gTTCSpeedSetting) {
-        case TTC_SPEED_SLOW:
-        case TTC_SPEED_FAST:
-            o->oTTCCogSpeed = sTTCCogNormalSpeeds[gTTCSpeedSetting];
-            break;
-
-        case TTC_SPEED_RANDOM:
-            if (approach_f32_ptr(&o->oTTCCogSpeed, o->oTTCCogTargetVel, 50.0f)) {
-                o->oTTCCogTargetVel = 200.0f * (random_u16() % 7) * random_sign();
-            }
+    if (o->oFlags & OBJ_FLAG_CLOCK_MOVER) {
+        return;
+    }
 
-        case TTC_SPEED_STOPPED:
-            break;
+    if (approach_f32_ptr(&o->oTTCCogSpeed, o->oTTCCogTargetVel, 50.0f)) {
+        o->oTTCCogTargetVel = 200.0f * (random_u16() % 7) * random_sign();
     }
 
     o->oAngleVelYaw = (s32)(o->oTTCCogSpeed * o->oTTCCogDir);
@@ -13,23 +13,37 @@ static s16 sTTCSpinnerSpeeds[] = {
     /* TTC_SPEED_STOPPED */ 0,
 };
 
+/**
+ * Init function for bhvTTCSpinner.
+ */
+void bhv_ttc_spinner_init(void) {
+    // Outside of the random setting, the spinner turns at a constant speed, so let
+    // the clock turn it.
+    if (gTTCSpeedSetting != TTC_SPEED_RANDOM) {
+        o->oAngleVelPitch = sTTCSpinnerSpeeds[gTTCSpeedSetting];
+        obj_start_clock_mover(o);
+    }
+}
+
 /**
  * Update function for bhvTTCSpinner.
  */
 void bhv_ttc_spinner_update(void) {
+    if (o->oFlags & OBJ_FLAG_CLOCK_MOVER) {
+        return;
+    }
+
     o->oAngleVelPitch = sTTCSpinnerSpeeds[gTTCSpeedSetting];
 
-    if (gTTCSpeedSetting == TTC_SPEED_RANDOM) {
-        if (o->oTimer > o->oTTCChangeDirTimer) {
-            o->oTTCSpinnerDir = random_sign();
-            o->oTTCChangeDirTimer = random_mod_offset(30, 30, 4);
-            o->oTimer = 0;
-        } else if (o->oTimer > 5) {
-            o->oAngleVelPitch *= o->oTTCSpinnerDir;
-        } else {
-            // Stop for 5 frames after changing direction
-            o->oAngleVelPitch = 0;
-        }
+    if (o->oTimer > o->oTTCChangeDirTimer) {
+        o->oTTCSpinnerDir = random_sign();
+        o->oTTCChangeDirTimer = random_mod_offset(30, 30, 4);
+        o->oTimer = 0;
+    } else if (o->oTimer > 5) {
+        o->oAngleVelPitch *= o->oTTCSpinnerDir;
+    } else {
+        // Stop for 5 frames after changing direction
+        o->oAngleVelPitch = 0;
     }
 
     o->oFaceAnglePitch += o->oAngleVelPitch;
@@ -1,10 +1,10 @@
 
 /**
- * Behavior for bhvWigglerHead and bhvWigglerBody.
+ * Behavior for bhvWigglerHead.
  * The bhvWigglerHead object controls the wiggler's behavior, and physically manifests
- * as the wiggler's head. The bhvWigglerBody objects represent the 3 tail body
- * parts, numbered 1 closest to the head, and 3 at the end of the tail.
- * Processing order is bhvWigglerHead, then bhvWigglerBody 1, 2, then 3.
+ * as the wiggler's head. The tail body parts are the segments of its compound actor,
+ * numbered 1 closest to the head, and 3 at the end of the tail.
+ * The head updates body parts 1, 2, then 3 after itself.
  */
 
 /**
@@ -55,65 +55,76 @@ static u8 sWigglerAttackHandlers[] = {
 static f32 sWigglerSpeeds[] = { 2.0f, 40.0f, 30.0f, 16.0f };
 
 /**
- * Update function for bhvWigglerBody.
- * Set object position and angle based on wiggler segment data and avoid falling
- * through the floor.
+ * Set each body part's position and angle based on wiggler segment data and avoid
+ * falling through the floor.
  * Tangible if the wiggler is not in the shrinking action, but does nothing on
  * attack.
  */
-void bhv_wiggler_body_part_update(void) {
+static void wiggler_update_body_parts(void) {
+    struct CompoundActor *body = o->compound;
     Vec3f d;
-    struct ChainSegment *segment = &o->parentObj->oWigglerSegments[o->oBehParams2ndByte];
-
-    cur_obj_scale(o->parentObj->header.gfx.scale[0]);
-
-    o->oFaceAnglePitch = segment->angle[0];
-    o->oFaceAngleYaw = segment->angle[1];
-
-    // TODO: What is this for?
-    f32 posOffset = -37.5f * o->header.gfx.scale[0];
-    d[1] = posOffset * coss(o->oFaceAnglePitch) - posOffset;
-    f32 dxz = posOffset * sins(o->oFaceAnglePitch);
-    d[0] = dxz * sins(o->oFaceAngleYaw);
-    d[2] = dxz * coss(o->oFaceAngleYaw);
-
-    vec3f_sum(&o->oPosVec, segment->pos, d);
-
-    if (o->oPosY < o->parentObj->oWigglerFallThroughFloorsHeight) {
-        //! Since position is recomputed each frame, tilting the wiggler up
-        //  while on the ground could cause the tail segments to clip through
-        //  the floor
-        o->oPosY -= 30.0f;
-        cur_obj_update_floor_height();
-        if (o->oFloorHeight > o->oPosY) { // TODO: Check ineq swap
-            o->oPosY = o->oFloorHeight;
+    s32 i;
+
+    for (i = 1; i < WIGGLER_NUM_SEGMENTS; i++) {
+        struct ChainSegment *segment = &o->oWigglerSegments[i];
+        struct CompoundSegment *bodyPart = &body->segments[i - 1];
+        struct GraphNodeObject *gfx = &bodyPart->gfx;
+
+        vec3f_set(gfx->scale, o->header.gfx.scale[0], o->header.gfx.scale[0], o->header.gfx.scale[0]);
+        vec3s_set(gfx->angle, segment->angle[0], segment->angle[1], 0);
+
+        // TODO: What is this for?
+        f32 posOffset = -37.5f * gfx->scale[0];
+        d[1] = posOffset * coss(gfx->angle[0]) - posOffset;
+        f32 dxz = posOffset * sins(gfx->angle[0]);
+        d[0] = dxz * sins(gfx->angle[1]);
+        d[2] = dxz * coss(gfx->angle[1]);
+
+        vec3f_sum(gfx->pos, segment->pos, d);
+
+        if (gfx->pos[1] < o->oWigglerFallThroughFloorsHeight) {
+            //! Since position is recomputed each frame, tilting the wiggler up
+            //  while on the ground could cause the tail segments to clip through
+            //  the floor
+            struct Surface *floor;
+            gfx->pos[1] -= 30.0f;
+            f32 floorHeight = find_floor(gfx->pos[0], gfx->pos[1], gfx->pos[2], &floor);
+            if (floorHeight > gfx->pos[1]) { // TODO: Check ineq swap
+                gfx->pos[1] = floorHeight;
+            }
         }
-    }
 
-    segment->pos[1] = o->oPosY;
+        segment->pos[1] = gfx->pos[1];
 
-    // Inherit walking animation speed from wiggler
-    cur_obj_init_animation_with_accel_and_sound(0, o->parentObj->oWigglerWalkAnimSpeed);
-    if (o->parentObj->oWigglerWalkAnimSpeed == 0.0f) {
-        cur_obj_reverse_animation();
-    }
+        // Inherit walking animation speed from wiggler
+        geo_obj_init_animation_accel(gfx, &((struct Animation **) wiggler_seg5_anims_0500C874)[0],
+                                     (s32)(o->oWigglerWalkAnimSpeed * 65536.0f));
+        if (o->oWigglerWalkAnimSpeed == 0.0f && gfx->animInfo.animFrame >= 0) {
+            gfx->animInfo.animFrame--;
+        }
 
-    if (o->parentObj->oAction == WIGGLER_ACT_SHRINK) {
-        cur_obj_become_intangible();
-    } else {
-        obj_check_attacks(&sWigglerBodyPartHitbox, o->oAction);
+        if (o->oAction == WIGGLER_ACT_SHRINK) {
+            bodyPart->hitbox = NULL;
+        }
+        compound_segment_check_attacks(bodyPart);
     }
 }
 
 /**
- * Initialize the segment data and spawn the body part objects.
+ * Initialize the segment data and the body parts.
  */
 void wiggler_init_segments(void) {
     s32 i;
-    struct Object *bodyPart;
+    struct CompoundActor *body;
     struct ChainSegment *segments = mem_pool_alloc(gObjectMemoryPool, WIGGLER_NUM_SEGMENTS * sizeof(struct ChainSegment));
 
     if (segments != NULL) {
+        body = obj_alloc_compound_actor(o, WIGGLER_NUM_SEGMENTS - 1, MODEL_WIGGLER_BODY);
+        if (body == NULL) {
+            mem_pool_free(gObjectMemoryPool, segments);
+            return;
+        }
+
         // Each segment represents the global position and orientation of each
         // object. Segment 0 represents the wiggler's head, and segment i>0
         // represents body part i.
@@ -129,14 +140,12 @@ void wiggler_init_segments(void) {
 
         o->header.gfx.animInfo.animFrame = -1;
 
-        // Spawn each body part
         for (i = 1; i < WIGGLER_NUM_SEGMENTS; i++) {
-            bodyPart =
-                spawn_object_relative(i, 0, 0, 0, o, MODEL_WIGGLER_BODY, bhvWigglerBody);
-            if (bodyPart != NULL) {
-                obj_init_animation_with_sound(bodyPart, wiggler_seg5_anims_0500C874, 0);
-                bodyPart->header.gfx.animInfo.animFrame = (23 * i) % 26 - 1;
-            }
+            struct CompoundSegment *bodyPart = &body->segments[i - 1];
+
+            geo_obj_init_animation(&bodyPart->gfx, &((struct Animation **) wiggler_seg5_anims_0500C874)[0]);
+            bodyPart->gfx.animInfo.animFrame = (23 * i) % 26 - 1;
+            bodyPart->hitbox = &sWigglerBodyPartHitbox;
         }
 
         o->oAction = WIGGLER_ACT_WALK;
@@ -425,4 +434,8 @@ void bhv_wiggler_update(void) {
         // Update the rest of the segments to follow segment 0
         wiggler_update_segments();
     }
+
+    if (o->compound != NULL) {
+        wiggler_update_body_parts();
+    }
 }
@@ -0,0 +1,74 @@
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "clock_mover.h"
+#include "object_list_processor.h"
+
+/**
+ * Clock movers are objects that turn at a constant angular velocity, like the TTC cogs
+ * on the slow and fast settings. Instead of adding oAngleVel to oFaceAngle every frame,
+ * their angle is a function of gObjectClock: oFaceAngle holds the angle at the clock
+ * value in oClockMoverSyncTime, and is only brought up to date when something needs
+ * it, which is when the object's collision gets loaded near Mario. Rendering evaluates
+ * the angle without storing it.
+ *
+ * The clock runs on every frame time stop doesn't freeze objects. Objects far from Mario
+ * still run their behaviors, and an unloaded mover restarts from its spawn angle when it
+ * respawns, as it would stepping itself. A mover can still miss frames, like one that
+ * only updates with Mario in its room, or be updated during a time stop. Those frames are
+ * made up for by moving oClockMoverSyncTime, so the mover only turns on frames its
+ * behavior runs on.
+ *
+ * Angles are added with unsigned wraparound, so the result is exactly what stepping
+ * the object once per frame would have given.
+ */
+
+u32 gObjectClock = 0;
+
+/**
+ * Make obj a clock mover, turning by its current oAngleVel every frame from this one
+ * on. Call this from the object's behavior before it would have stepped this frame.
+ */
+void obj_start_clock_mover(struct Object *obj) {
+    obj->oFlags |= OBJ_FLAG_CLOCK_MOVER;
+    obj->oClockMoverSyncTime = gObjectClock - 1;
+}
+
+/**
+ * Keep obj from turning on this frame, for when its behavior doesn't run.
+ */
+void obj_hold_clock_mover(struct Object *obj) {
+    obj->oClockMoverSyncTime++;
+}
+
+/**
+ * Turn obj by a frame's worth without the clock, for when it's updated during a time stop.
+ */
+void obj_step_clock_mover(struct Object *obj) {
+    obj->oClockMoverSyncTime--;
+}
+
+/**
+ * Bring obj's oFaceAngle up to date with gObjectClock.
+ */
+void obj_sync_clock_mover(struct Object *obj) {
+    u32 elapsed = gObjectClock - (u32) obj->oClockMoverSyncTime;
+
+    if (elapsed != 0) {
+        obj->oFaceAnglePitch = (u32) obj->oFaceAnglePitch + ((u32) obj->oAngleVelPitch * elapsed);
+        obj->oFaceAngleYaw   = (u32) obj->oFaceAngleYaw   + ((u32) obj->oAngleVelYaw   * elapsed);
+        obj->oFaceAngleRoll  = (u32) obj->oFaceAngleRoll  + ((u32) obj->oAngleVelRoll  * elapsed);
+        obj->oClockMoverSyncTime = gObjectClock;
+    }
+}
+
+/**
+ * Get obj's current angle without updating its fields.
+ */
+void obj_get_clock_mover_angle(struct Object *obj, Vec3s angle) {
+    u32 elapsed = gObjectClock - (u32) obj->oClockMoverSyncTime;
+
+    angle[0] = (u32) obj->oFaceAnglePitch + ((u32) obj->oAngleVelPitch * elapsed);
+    angle[1] = (u32) obj->oFaceAngleYaw   + ((u32) obj->oAngleVelYaw   * elapsed);
+    angle[2] = (u32) obj->oFaceAngleRoll  + ((u32) obj->oAngleVelRoll  * elapsed);
+}
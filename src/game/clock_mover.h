@@ -0,0 +1,20 @@
+#ifndef CLOCK_MOVER_H
+#define CLOCK_MOVER_H
+
+#include <PR/ultratypes.h>
+
+#include "types.h"
+
+/**
+ * Number of frames objects have been updated on, not counting frames where time stop
+ * froze them. Clock movers are evaluated against it.
+ */
+extern u32 gObjectClock;
+
+void obj_start_clock_mover(struct Object *obj);
+void obj_hold_clock_mover(struct Object *obj);
+void obj_step_clock_mover(struct Object *obj);
+void obj_sync_clock_mover(struct Object *obj);
+void obj_get_clock_mover_angle(struct Object *obj, Vec3s angle);
+
+#endif // CLOCK_MOVER_H
@@ -0,0 +1,208 @@
+#include <PR/ultratypes.h>
+
+#include "sm64.h"
+#include "area.h"
+#include "compound_actor.h"
+#include "engine/graph_node.h"
+#include "engine/math_util.h"
+#include "interaction.h"
+#include "memory.h"
+#include "object_list_processor.h"
+
+/**
+ * Compound actors are objects made of several segments, like the chain chomp's chain or
+ * the wiggler's tail. Rather than spawning an object for every segment, the owner keeps
+ * them in one array, moves them from its own behavior and has them drawn by
+ * geo_process_compound_actors() after the other objects.
+ */
+
+struct CompoundActor *gCompoundActorList = NULL;
+
+/**
+ * The owner's fields while a segment stands in for it during an interaction.
+ */
+static struct {
+    Vec3f pos;
+    f32 hitboxRadius;
+    f32 hitboxHeight;
+    f32 hurtboxRadius;
+    f32 hurtboxHeight;
+    f32 hitboxDownOffset;
+    u32 interactType;
+    s32 damageOrCoinValue;
+    u32 interactStatus;
+    u32 interactionSubtype;
+} sOwnerInteractionState;
+
+/**
+ * Allocate a compound actor with numSegments segments for obj, all using the given
+ * model and starting at obj's position. Returns NULL if the object memory pool is full.
+ */
+struct CompoundActor *obj_alloc_compound_actor(struct Object *obj, s32 numSegments, ModelID32 model) {
+    struct CompoundActor *compound = mem_pool_alloc(gObjectMemoryPool,
+        sizeof(struct CompoundActor) + (numSegments * sizeof(struct CompoundSegment)));
+    s32 i;
+
+    if (compound == NULL) {
+        return NULL;
+    }
+
+    compound->owner = obj;
+    compound->segments = (struct CompoundSegment *) (compound + 1);
+    compound->numSegments = numSegments;
+    compound->hitSegment = -1;
+    compound->hitHitbox = NULL;
+
+    for (i = 0; i < numSegments; i++) {
+        struct CompoundSegment *segment = &compound->segments[i];
+
+        init_graph_node_object(NULL, &segment->gfx, gLoadedGraphNodes[model], &obj->oPosVec, gVec3sZero, gVec3fOne);
+        segment->hitbox = NULL;
+        segment->interactStatus = INT_STATUS_NONE;
+        segment->interactionSubtype = 0;
+    }
+
+    compound->next = gCompoundActorList;
+    gCompoundActorList = compound;
+    obj->compound = compound;
+
+    return compound;
+}
+
+/**
+ * Free obj's compound actor, which stops its segments from being drawn or touched.
+ */
+void obj_free_compound_actor(struct Object *obj) {
+    struct CompoundActor **link = &gCompoundActorList;
+
+    if (obj->compound == NULL) {
+        return;
+    }
+
+    while (*link != NULL) {
+        if (*link == obj->compound) {
+            *link = obj->compound->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+
+    mem_pool_free(gObjectMemoryPool, obj->compound);
+    obj->compound = NULL;
+}
+
+/**
+ * Forget every compound actor. Called along with clearing the object memory pool.
+ */
+void clear_compound_actors(void) {
+    gCompoundActorList = NULL;
+}
+
+/**
+ * Whether the owner of compound is being shown: its segments are only drawn and touched
+ * while it is. This follows the owner's own culling, including being unloaded for
+ * distance, hidden in another room or made invisible by its behavior.
+ */
+s32 compound_actor_is_shown(struct CompoundActor *compound) {
+    struct Object *owner = compound->owner;
+
+    return (owner->activeFlags & ACTIVE_FLAG_ACTIVE)
+        && !(owner->activeFlags & (ACTIVE_FLAG_FAR_AWAY | ACTIVE_FLAG_IN_DIFFERENT_ROOM))
+        && (owner->header.gfx.node.flags & GRAPH_RENDER_ACTIVE)
+        && !(owner->header.gfx.node.flags & GRAPH_RENDER_INVISIBLE);
+}
+
+/**
+ * Counterpart of obj_check_attacks for a segment: return the attack Mario hit the
+ * segment with, if any, and clear its interaction status.
+ */
+s32 compound_segment_check_attacks(struct CompoundSegment *segment) {
+    s32 attackType = 0;
+
+    if ((segment->interactStatus & INT_STATUS_INTERACTED)
+        && !(segment->interactStatus & INT_STATUS_ATTACKED_MARIO)) {
+        attackType = (segment->interactStatus & INT_STATUS_ATTACK_MASK);
+    }
+
+    segment->interactStatus = INT_STATUS_NONE;
+    return attackType;
+}
+
+/**
+ * The interaction type Mario collided with obj through: its own, or the one of the
+ * segment he touched.
+ */
+u32 obj_get_collided_interact_type(struct Object *obj) {
+    struct CompoundActor *compound = obj->compound;
+
+    if (compound != NULL && compound->hitSegment >= 0) {
+        return compound->hitHitbox->interactType;
+    }
+
+    return obj->oInteractType;
+}
+
+/**
+ * If Mario collided with one of obj's segments, have the segment stand in for obj until
+ * compound_actor_end_interaction. The interaction handlers read the position, hitbox and
+ * interaction fields straight from the object, so these are swapped in.
+ */
+void compound_actor_begin_interaction(struct Object *obj) {
+    struct CompoundActor *compound = obj->compound;
+
+    if (compound == NULL || compound->hitSegment < 0) {
+        return;
+    }
+
+    struct CompoundSegment *segment = &compound->segments[compound->hitSegment];
+    struct ObjectHitbox *hitbox = compound->hitHitbox;
+
+    vec3f_copy(sOwnerInteractionState.pos, &obj->oPosVec);
+    sOwnerInteractionState.hitboxRadius       = obj->hitboxRadius;
+    sOwnerInteractionState.hitboxHeight       = obj->hitboxHeight;
+    sOwnerInteractionState.hurtboxRadius      = obj->hurtboxRadius;
+    sOwnerInteractionState.hurtboxHeight      = obj->hurtboxHeight;
+    sOwnerInteractionState.hitboxDownOffset   = obj->hitboxDownOffset;
+    sOwnerInteractionState.interactType       = obj->oInteractType;
+    sOwnerInteractionState.damageOrCoinValue  = obj->oDamageOrCoinValue;
+    sOwnerInteractionState.interactStatus     = obj->oInteractStatus;
+    sOwnerInteractionState.interactionSubtype = obj->oInteractionSubtype;
+
+    vec3f_copy(&obj->oPosVec, segment->gfx.pos);
+    obj->hitboxRadius        = segment->gfx.scale[0] * hitbox->radius;
+    obj->hitboxHeight        = segment->gfx.scale[1] * hitbox->height;
+    obj->hurtboxRadius       = segment->gfx.scale[0] * hitbox->hurtboxRadius;
+    obj->hurtboxHeight       = segment->gfx.scale[1] * hitbox->hurtboxHeight;
+    obj->hitboxDownOffset    = segment->gfx.scale[1] * hitbox->downOffset;
+    obj->oInteractType       = hitbox->interactType;
+    obj->oDamageOrCoinValue  = hitbox->damageOrCoinValue;
+    obj->oInteractStatus     = segment->interactStatus;
+    obj->oInteractionSubtype = segment->interactionSubtype;
+}
+
+/**
+ * Hand the result of the interaction to the segment and restore obj.
+ */
+void compound_actor_end_interaction(struct Object *obj) {
+    struct CompoundActor *compound = obj->compound;
+
+    if (compound == NULL || compound->hitSegment < 0) {
+        return;
+    }
+
+    struct CompoundSegment *segment = &compound->segments[compound->hitSegment];
+
+    segment->interactStatus     = obj->oInteractStatus;
+    segment->interactionSubtype = obj->oInteractionSubtype;
+
+    vec3f_copy(&obj->oPosVec, sOwnerInteractionState.pos);
+    obj->hitboxRadius        = sOwnerInteractionState.hitboxRadius;
+    obj->hitboxHeight        = sOwnerInteractionState.hitboxHeight;
+    obj->hurtboxRadius       = sOwnerInteractionState.hurtboxRadius;
+    obj->hurtboxHeight       = sOwnerInteractionState.hurtboxHeight;
+    obj->hitboxDownOffset    = sOwnerInteractionState.hitboxDownOffset;
+    obj->oInteractType       = sOwnerInteractionState.interactType;
+    obj->oDamageOrCoinValue  = sOwnerInteractionState.damageOrCoinValue;
+    obj->oInteractStatus     = sOwnerInteractionState.interactStatus;
+    obj->oInteractionSubtype = sOwnerInteractionState.interactionSubtype;
+}
@@ -0,0 +1,50 @@
+#ifndef COMPOUND_ACTOR_H
+#define COMPOUND_ACTOR_H
+
+#include <PR/ultratypes.h>
+
+#include "types.h"
+
+/**
+ * A body part of a compound actor, such as a link of a chain or a piece of a tail.
+ * It's drawn like an object, but has no behavior, object slot or collision list entry
+ * of its own: its owner moves it, and Mario's collision checks look at its hitbox
+ * while checking the owner.
+ *
+ * Segments are only drawn and touched while their owner is shown, see compound_actor_is_shown.
+ * gfx is rendered outside of any Object, like mirror Mario, so the segment's model
+ * can't use switch case or generated list nodes, whose callbacks read object fields:
+ * these are skipped for segments. Shadows are supported and are cast below gfx.pos.
+ */
+struct CompoundSegment {
+    struct GraphNodeObject gfx;
+    // Hitbox Mario can touch, centered on gfx.pos. NULL while the segment is intangible.
+    struct ObjectHitbox *hitbox;
+    u32 interactStatus;
+    u32 interactionSubtype;
+};
+
+struct CompoundActor {
+    struct CompoundActor *next;
+    struct Object *owner;
+    struct CompoundSegment *segments;
+    s16 numSegments;
+    // Segment Mario collided with this frame instead of the owner, or -1,
+    // and the hitbox it had then.
+    s16 hitSegment;
+    struct ObjectHitbox *hitHitbox;
+};
+
+extern struct CompoundActor *gCompoundActorList;
+
+struct CompoundActor *obj_alloc_compound_actor(struct Object *obj, s32 numSegments, ModelID32 model);
+void obj_free_compound_actor(struct Object *obj);
+void clear_compound_actors(void);
+s32 compound_actor_is_shown(struct CompoundActor *compound);
+
+s32 compound_segment_check_attacks(struct CompoundSegment *segment);
+u32 obj_get_collided_interact_type(struct Object *obj);
+void compound_actor_begin_interaction(struct Object *obj);
+void compound_actor_end_interaction(struct Object *obj);
+
+#endif // COMPOUND_ACTOR_H
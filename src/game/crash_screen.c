@@ -396,7 +396,6 @@ OSThread *get_crashed_thread(void) {
 extern u16 sRenderedFramebuffer;
 extern void audio_signal_game_loop_tick(void);
 extern void stop_sounds_in_continuous_banks(void);
-extern void read_controller_inputs(s32 threadID);
 extern struct SequenceQueueItem sBackgroundMusicQueue[6];
 
 void thread2_crash_screen(UNUSED void *arg) {
@@ -425,12 +424,7 @@ void thread2_crash_screen(UNUSED void *arg) {
                 continue;
             }
         } else {
-            if (gControllerBits) {
-#if ENABLE_RUMBLE
-                block_until_rumble_pak_free();
-#endif
-                osContStartReadDataEx(&gSIEventMesgQueue);
-            }
+            start_controller_read();
             read_controller_inputs(THREAD_2_CRASH_SCREEN);
             draw_crash_screen(thread);
         }
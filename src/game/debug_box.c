@@ -193,90 +193,185 @@ void debug_box_input(void) {
 }
 
 s16 gVisualSurfaceCount;
-s32 gVisualOffset;
 extern s32 gSurfaceNodesAllocated;
 extern s32 gSurfacesAllocated;
 
-void iterate_surfaces_visual(s32 x, s32 z, Vtx *verts) {
-    struct SurfaceNode *node;
-    struct Surface *surf;
-    s32 i = 0;
-    ColorRGB col = COLOR_RGB_RED;
+// VERTCOUNT = The highest number divisible by 6, which is less than the maximum vertex buffer divided by 2.
+#define VERTCOUNT 30
 
-    if (is_outside_level_bounds(x, z)) return;
+/**
+ * Worst case display list size for VISUAL_SURFACE_CACHE_VERTS vertices: per batch of VERTCOUNT vertices,
+ * one gSPVertex, (VERTCOUNT / 6) gSP2Triangles and a trailing gSP1Triangle, plus the gSPEndDisplayList.
+ */
+#define VISUAL_SURFACE_CACHE_DL_SIZE ((((VISUAL_SURFACE_CACHE_VERTS / VERTCOUNT) + 1) * ((VERTCOUNT / 6) + 2)) + 1)
 
-    s32 cellX = GET_CELL_COORD(x);
-    s32 cellZ = GET_CELL_COORD(z);
+static const ColorRGB sVisualSurfaceColors[NUM_SPATIAL_PARTITIONS] = {
+    [SPATIAL_PARTITION_FLOORS] = COLOR_RGB_BLUE,
+    [SPATIAL_PARTITION_CEILS ] = COLOR_RGB_RED,
+    [SPATIAL_PARTITION_WALLS ] = COLOR_RGB_GREEN,
+    [SPATIAL_PARTITION_WATER ] = COLOR_RGB_YELLOW,
+};
 
-    for (i = 0; i < (2 * NUM_SPATIAL_PARTITIONS); i++) {
-        switch (i) {
-            case 0: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ].next; colorRGB_copy(col, (ColorRGB)COLOR_RGB_GREEN ); break;
-            case 1: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ].next; colorRGB_copy(col, (ColorRGB)COLOR_RGB_GREEN ); break;
-            case 2: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS].next; colorRGB_copy(col, (ColorRGB)COLOR_RGB_BLUE  ); break;
-            case 3: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS].next; colorRGB_copy(col, (ColorRGB)COLOR_RGB_BLUE  ); break;
-            case 4: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ].next; colorRGB_copy(col, (ColorRGB)COLOR_RGB_RED   ); break;
-            case 5: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ].next; colorRGB_copy(col, (ColorRGB)COLOR_RGB_RED   ); break;
-            case 6: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ].next; colorRGB_copy(col, (ColorRGB)COLOR_RGB_YELLOW); break;
-            case 7: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ].next; colorRGB_copy(col, (ColorRGB)COLOR_RGB_YELLOW); break;
-        }
+/**
+ * The cells drawn this frame, VISUAL_DEBUG_SURFACE_RADIUS cells around Mario's.
+ */
+static s32 sVisualMinCellX, sVisualMaxCellX;
+static s32 sVisualMinCellZ, sVisualMaxCellZ;
 
-        while (node != NULL) {
-            surf = node->surface;
-            node = node->next;
-
-            if (SURFACE_IS_INSTANT_WARP(surf->type)) {
-                make_vertex(verts, (gVisualSurfaceCount + 0), surf->vertex1[0], surf->vertex1[1], surf->vertex1[2], 0, 0, 0xFF, 0xA0, 0x00, 0x80);
-                make_vertex(verts, (gVisualSurfaceCount + 1), surf->vertex2[0], surf->vertex2[1], surf->vertex2[2], 0, 0, 0xFF, 0xA0, 0x00, 0x80);
-                make_vertex(verts, (gVisualSurfaceCount + 2), surf->vertex3[0], surf->vertex3[1], surf->vertex3[2], 0, 0, 0xFF, 0xA0, 0x00, 0x80);
-            } else {
-                make_vertex(verts, (gVisualSurfaceCount + 0), surf->vertex1[0], surf->vertex1[1], surf->vertex1[2], 0, 0, col[0], col[1], col[2], 0x80);
-                make_vertex(verts, (gVisualSurfaceCount + 1), surf->vertex2[0], surf->vertex2[1], surf->vertex2[2], 0, 0, col[0], col[1], col[2], 0x80);
-                make_vertex(verts, (gVisualSurfaceCount + 2), surf->vertex3[0], surf->vertex3[1], surf->vertex3[2], 0, 0, col[0], col[1], col[2], 0x80);
-            }
+/**
+ * Static surfaces never change while an area is loaded, so their vertices and display list are only rebuilt
+ * when Mario moves to another cell or the area changes. Both are double buffered, since the RSP may still be
+ * drawing the previous frame while the next one is built.
+ */
+static Vtx sVisualStaticVerts[2][VISUAL_SURFACE_CACHE_VERTS];
+static Gfx sVisualStaticDL[2][VISUAL_SURFACE_CACHE_DL_SIZE];
+static Gfx *sVisualStaticDLHead = NULL; // NULL while the visible cells don't fit in the cache
+static u8  sVisualStaticBufferIndex = 0;
+static s32 sVisualStaticVertCount;
+static u8  sVisualCacheValid = FALSE;
+static s16 sVisualCacheLevel, sVisualCacheArea;
+static s16 sVisualCacheCellX, sVisualCacheCellZ;
+static s32 sVisualCacheSurfaces;
 
-            gVisualSurfaceCount += 3;
+/**
+ * Same as the lower cell index surfaces are added from in surface_load.c.
+ */
+static s32 visual_surface_cell_index(s32 coord) {
+    s32 index = ((coord + LEVEL_BOUNDARY_MAX) / CELL_SIZE);
+
+    return CLAMP(index, 0, (NUM_CELLS - 1));
+}
+
+/**
+ * Surfaces are linked into every cell they overlap, so only draw them from the first visible one.
+ */
+static s32 visual_surface_in_first_cell(struct Surface *surf, s32 cellX, s32 cellZ) {
+    s32 minX = MIN(MIN(surf->vertex1[0], surf->vertex2[0]), surf->vertex3[0]);
+    s32 minZ = MIN(MIN(surf->vertex1[2], surf->vertex2[2]), surf->vertex3[2]);
+
+    return (cellX == MAX(visual_surface_cell_index(minX), sVisualMinCellX)
+         && cellZ == MAX(visual_surface_cell_index(minZ), sVisualMinCellZ));
+}
+
+/**
+ * Writes a vertex triangle for every surface of the given partition in the visible cells.
+ * Returns the new vertex count, which never goes past maxVerts.
+ */
+static s32 iterate_surfaces_visual(SpatialPartitionCell partition[NUM_CELLS][NUM_CELLS], Vtx *verts, s32 count, s32 maxVerts) {
+    struct SurfaceNode *node;
+    struct Surface *surf;
+    s32 cellX, cellZ, i;
+
+    for (cellZ = sVisualMinCellZ; cellZ <= sVisualMaxCellZ; cellZ++) {
+        for (cellX = sVisualMinCellX; cellX <= sVisualMaxCellX; cellX++) {
+            for (i = 0; i < NUM_SPATIAL_PARTITIONS; i++) {
+                const u8 *col = sVisualSurfaceColors[i];
+
+                for (node = partition[cellZ][cellX][i].next; node != NULL; node = node->next) {
+                    surf = node->surface;
+
+                    if (!visual_surface_in_first_cell(surf, cellX, cellZ)) continue;
+                    if ((count + 3) > maxVerts) return count;
+
+                    if (SURFACE_IS_INSTANT_WARP(surf->type)) {
+                        make_vertex(verts, (count + 0), surf->vertex1[0], surf->vertex1[1], surf->vertex1[2], 0, 0, 0xFF, 0xA0, 0x00, 0x80);
+                        make_vertex(verts, (count + 1), surf->vertex2[0], surf->vertex2[1], surf->vertex2[2], 0, 0, 0xFF, 0xA0, 0x00, 0x80);
+                        make_vertex(verts, (count + 2), surf->vertex3[0], surf->vertex3[1], surf->vertex3[2], 0, 0, 0xFF, 0xA0, 0x00, 0x80);
+                    } else {
+                        make_vertex(verts, (count + 0), surf->vertex1[0], surf->vertex1[1], surf->vertex1[2], 0, 0, col[0], col[1], col[2], 0x80);
+                        make_vertex(verts, (count + 1), surf->vertex2[0], surf->vertex2[1], surf->vertex2[2], 0, 0, col[0], col[1], col[2], 0x80);
+                        make_vertex(verts, (count + 2), surf->vertex3[0], surf->vertex3[1], surf->vertex3[2], 0, 0, col[0], col[1], col[2], 0x80);
+                    }
+
+                    count += 3;
+                }
+            }
         }
     }
+
+    return count;
 }
 
-void iterate_surfaces_envbox(Vtx *verts) {
+s32 iterate_surfaces_envbox(Vtx *verts) {
     TerrainData *p = gEnvironmentRegions;
     ColorRGB col = COLOR_RGB_YELLOW;
+    s32 count = 0;
     s32 i = 0;
 
     if (p != NULL) {
         s32 numRegions = *p++;
         for (i = 0; i < numRegions; i++) {
-            make_vertex(verts, (gVisualSurfaceCount + 0), p[1], p[5], p[2], 0, 0, col[0], col[1], col[2], 0x80);
-            make_vertex(verts, (gVisualSurfaceCount + 1), p[1], p[5], p[4], 0, 0, col[0], col[1], col[2], 0x80);
-            make_vertex(verts, (gVisualSurfaceCount + 2), p[3], p[5], p[2], 0, 0, col[0], col[1], col[2], 0x80);
+            make_vertex(verts, (count + 0), p[1], p[5], p[2], 0, 0, col[0], col[1], col[2], 0x80);
+            make_vertex(verts, (count + 1), p[1], p[5], p[4], 0, 0, col[0], col[1], col[2], 0x80);
+            make_vertex(verts, (count + 2), p[3], p[5], p[2], 0, 0, col[0], col[1], col[2], 0x80);
 
-            make_vertex(verts, (gVisualSurfaceCount + 3), p[3], p[5], p[2], 0, 0, col[0], col[1], col[2], 0x80);
-            make_vertex(verts, (gVisualSurfaceCount + 4), p[1], p[5], p[4], 0, 0, col[0], col[1], col[2], 0x80);
-            make_vertex(verts, (gVisualSurfaceCount + 5), p[3], p[5], p[4], 0, 0, col[0], col[1], col[2], 0x80);
+            make_vertex(verts, (count + 3), p[3], p[5], p[2], 0, 0, col[0], col[1], col[2], 0x80);
+            make_vertex(verts, (count + 4), p[1], p[5], p[4], 0, 0, col[0], col[1], col[2], 0x80);
+            make_vertex(verts, (count + 5), p[3], p[5], p[4], 0, 0, col[0], col[1], col[2], 0x80);
 
-            gVisualSurfaceCount += 6;
-            gVisualOffset       += 6;
-            p                   += 6;
+            count += 6;
+            p     += 6;
         }
     }
+
+    return count;
 }
 
-// VERTCOUNT = The highest number divisible by 6, which is less than the maximum vertex buffer divided by 2.
-#define VERTCOUNT 30
+static s32 make_visual_quad(Vtx *verts, s32 count, Vec3f v0, Vec3f v1, Vec3f v2, Vec3f v3, const u8 *col) {
+    make_vertex(verts, (count + 0), v0[0], v0[1], v0[2], 0, 0, col[0], col[1], col[2], 0x80);
+    make_vertex(verts, (count + 1), v1[0], v1[1], v1[2], 0, 0, col[0], col[1], col[2], 0x80);
+    make_vertex(verts, (count + 2), v2[0], v2[1], v2[2], 0, 0, col[0], col[1], col[2], 0x80);
+    make_vertex(verts, (count + 3), v0[0], v0[1], v0[2], 0, 0, col[0], col[1], col[2], 0x80);
+    make_vertex(verts, (count + 4), v2[0], v2[1], v2[2], 0, 0, col[0], col[1], col[2], 0x80);
+    make_vertex(verts, (count + 5), v3[0], v3[1], v3[2], 0, 0, col[0], col[1], col[2], 0x80);
 
-void visual_surface_display(Gfx **gfx, Vtx *verts, s32 iteration) {
-    s32 vts = (iteration ? gVisualOffset : gVisualSurfaceCount);
+    return (count + 6);
+}
+
+/**
+ * Writes the 12 triangles of every loaded collision primitive's box, which aren't in the partitions.
+ * Cylinders are drawn as the square around them.
+ */
+static s32 iterate_surfaces_primitives(Vtx *verts) {
+    struct SurfacePrimitive *prim = gSurfacePrimitives;
+    Vec3f top[4], bottom[4];
+    s32 count = 0;
+    s32 i, j;
+
+    for (i = 0; i < gNumSurfacePrimitives; i++, prim++) {
+        // The floor and ceiling each hold three of the corners, with the middle one between the others.
+        vec3_copy(top[0], prim->floor.vertex1);
+        vec3_copy(top[1], prim->floor.vertex2);
+        vec3_copy(top[2], prim->floor.vertex3);
+        vec3_copy(bottom[0], prim->ceil.vertex1);
+        vec3_copy(bottom[2], prim->ceil.vertex2);
+        vec3_copy(bottom[1], prim->ceil.vertex3);
+        for (j = 0; j < 3; j++) {
+            top[3][j] = ((top[0][j] + top[2][j]) - top[1][j]);
+            bottom[3][j] = ((bottom[0][j] + bottom[2][j]) - bottom[1][j]);
+        }
+
+        count = make_visual_quad(verts, count, top[0], top[1], top[2], top[3], sVisualSurfaceColors[SPATIAL_PARTITION_FLOORS]);
+        count = make_visual_quad(verts, count, bottom[0], bottom[1], bottom[2], bottom[3], sVisualSurfaceColors[SPATIAL_PARTITION_CEILS]);
+        for (j = 0; j < 4; j++) {
+            count = make_visual_quad(verts, count, bottom[j], bottom[(j + 1) % 4], top[(j + 1) % 4], top[j],
+                                     sVisualSurfaceColors[SPATIAL_PARTITION_WALLS]);
+        }
+    }
+
+    return count;
+}
+
+void visual_surface_display(Gfx **gfx, Vtx *verts, s32 numVerts) {
+    s32 vts = numVerts;
     s32 vtl = 0;
     s32 count = VERTCOUNT;
     s32 ntx = 0;
 
-    Gfx *tempGfxHead = gDisplayListHead;
-
     while (vts > 0) {
         if (count == VERTCOUNT) {
             ntx = MIN(VERTCOUNT, vts);
-            gSPVertex((*gfx)++, VIRTUAL_TO_PHYSICAL(verts + (gVisualSurfaceCount - vts)), ntx, 0);
+            gSPVertex((*gfx)++, VIRTUAL_TO_PHYSICAL(verts + (numVerts - vts)), ntx, 0);
             count = 0;
             vtl   = VERTCOUNT;
         }
@@ -300,45 +395,74 @@ void visual_surface_display(Gfx **gfx, Vtx *verts, s32 iteration) {
             count += 3;
         }
     }
-
-    gDisplayListHead = tempGfxHead;
 }
 
-s32 iterate_surface_count(s32 x, s32 z) {
+s32 iterate_surface_count(SpatialPartitionCell partition[NUM_CELLS][NUM_CELLS]) {
     struct SurfaceNode *node;
-    s32 i = 0;
+    s32 cellX, cellZ, i;
     s32 j = 0;
-    TerrainData *p = gEnvironmentRegions;
-    s32 numRegions;
-
-    if (is_outside_level_bounds(x, z)) return 0;
-
-    s32 cellX = GET_CELL_COORD(x);
-    s32 cellZ = GET_CELL_COORD(z);
 
-    for (i = 0; i < (2 * NUM_SPATIAL_PARTITIONS); i++) {
-        switch (i) {
-            case 0: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ].next; break;
-            case 1: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WALLS ].next; break;
-            case 2: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS].next; break;
-            case 3: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_FLOORS].next; break;
-            case 4: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ].next; break;
-            case 5: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_CEILS ].next; break;
-            case 6: node = gDynamicSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ].next; break;
-            case 7: node =  gStaticSurfacePartition[cellZ][cellX][SPATIAL_PARTITION_WATER ].next; break;
+    for (cellZ = sVisualMinCellZ; cellZ <= sVisualMaxCellZ; cellZ++) {
+        for (cellX = sVisualMinCellX; cellX <= sVisualMaxCellX; cellX++) {
+            for (i = 0; i < NUM_SPATIAL_PARTITIONS; i++) {
+                for (node = partition[cellZ][cellX][i].next; node != NULL; node = node->next) {
+                    j++;
+                }
+            }
         }
+    }
 
-        while (node != NULL) {
-            node = node->next;
-            j++;
-        }
+    return j;
+}
+
+/**
+ * Rebuilds the static surface vertices and display list if Mario has moved to another cell or the area has changed.
+ */
+static void update_visual_static_surfaces(s32 cellX, s32 cellZ) {
+    if (sVisualCacheValid
+     && sVisualCacheLevel    == gCurrLevelNum
+     && sVisualCacheArea     == gCurrAreaIndex
+     && sVisualCacheSurfaces == gNumStaticSurfaces
+     && sVisualCacheCellX    == cellX
+     && sVisualCacheCellZ    == cellZ) {
+        return;
     }
-    if (p != NULL) {
-        numRegions = *p++;
-        j += (numRegions * 6);
+
+    sVisualCacheLevel    = gCurrLevelNum;
+    sVisualCacheArea     = gCurrAreaIndex;
+    sVisualCacheSurfaces = gNumStaticSurfaces;
+    sVisualCacheCellX    = cellX;
+    sVisualCacheCellZ    = cellZ;
+    sVisualCacheValid    = TRUE;
+
+    // Counts surfaces once per cell they're in, so this may give up on the cache a little early.
+    if ((iterate_surface_count(gStaticSurfacePartition) * 3) > VISUAL_SURFACE_CACHE_VERTS) {
+        sVisualStaticDLHead = NULL;
+        return;
     }
 
-    return j;
+    sVisualStaticBufferIndex ^= 1;
+    Vtx *verts = sVisualStaticVerts[sVisualStaticBufferIndex];
+    Gfx *dl = sVisualStaticDL[sVisualStaticBufferIndex];
+
+    sVisualStaticVertCount = iterate_surfaces_visual(gStaticSurfacePartition, verts, 0, VISUAL_SURFACE_CACHE_VERTS);
+    sVisualStaticDLHead = dl;
+    visual_surface_display(&dl, verts, sVisualStaticVertCount);
+    gSPEndDisplayList(dl++);
+}
+
+/**
+ * Writes a partition's surfaces in the visible cells to the display list pool, for this frame only.
+ */
+static void visual_surface_display_uncached(Gfx **gfx, SpatialPartitionCell partition[NUM_CELLS][NUM_CELLS]) {
+    s32 numVerts = (iterate_surface_count(partition) * 3);
+    Vtx *verts;
+
+    if (numVerts > 0 && (verts = alloc_display_list(numVerts * sizeof(Vtx))) != NULL) {
+        numVerts = iterate_surfaces_visual(partition, verts, 0, numVerts);
+        visual_surface_display(gfx, verts, numVerts);
+        gVisualSurfaceCount += numVerts;
+    }
 }
 
 void visual_surface_loop(Gfx **gfx) {
@@ -347,27 +471,55 @@ void visual_surface_loop(Gfx **gfx) {
      || !gMarioState->marioObj) {
         return;
     }
-    Vtx *verts = alloc_display_list((iterate_surface_count(gMarioState->pos[0], gMarioState->pos[2]) * 3) * sizeof(Vtx));
+
+    s32 x = gMarioState->pos[0];
+    s32 z = gMarioState->pos[2];
 
     gVisualSurfaceCount = 0;
-    gVisualOffset       = 0;
 
-    if (verts == NULL) {
-        return;
-    }
+    if (is_outside_level_bounds(x, z)) return;
+
+    s32 cellX = GET_CELL_COORD(x);
+    s32 cellZ = GET_CELL_COORD(z);
+
+    sVisualMinCellX = MAX((cellX - VISUAL_DEBUG_SURFACE_RADIUS), 0);
+    sVisualMaxCellX = MIN((cellX + VISUAL_DEBUG_SURFACE_RADIUS), (NUM_CELLS - 1));
+    sVisualMinCellZ = MAX((cellZ - VISUAL_DEBUG_SURFACE_RADIUS), 0);
+    sVisualMaxCellZ = MIN((cellZ + VISUAL_DEBUG_SURFACE_RADIUS), (NUM_CELLS - 1));
+
+    update_visual_static_surfaces(cellX, cellZ);
 
     gSPDisplayList((*gfx)++, dl_visual_surface);
+    if (sVisualStaticDLHead != NULL) {
+        gSPDisplayList((*gfx)++, sVisualStaticDLHead);
+        gVisualSurfaceCount += sVisualStaticVertCount;
+    } else {
+        visual_surface_display_uncached(gfx, gStaticSurfacePartition);
+    }
 
-    iterate_surfaces_visual(gMarioState->pos[0], gMarioState->pos[2], verts);
+    // Dynamic surfaces move every frame, so they're rebuilt into the display list pool.
+    visual_surface_display_uncached(gfx, gDynamicSurfacePartition);
 
-    visual_surface_display(gfx, verts, 0);
+    s32 numVerts;
+    Vtx *verts;
 
-    gDPPipeSync((*gfx)++);
-    iterate_surfaces_envbox(verts);
+    if (gNumSurfacePrimitives > 0
+     && (verts = alloc_display_list((gNumSurfacePrimitives * 36) * sizeof(Vtx))) != NULL) {
+        numVerts = iterate_surfaces_primitives(verts);
+        visual_surface_display(gfx, verts, numVerts);
+        gVisualSurfaceCount += numVerts;
+    }
 
-    gDPSetRenderMode((*gfx)++, G_RM_ZB_XLU_SURF, G_RM_NOOP2);
+    if (gEnvironmentRegions != NULL && gEnvironmentRegions[0] > 0
+     && (verts = alloc_display_list((gEnvironmentRegions[0] * 6) * sizeof(Vtx))) != NULL) {
+        numVerts = iterate_surfaces_envbox(verts);
 
-    visual_surface_display(gfx, verts, 1);
+        gDPPipeSync((*gfx)++);
+        gDPSetRenderMode((*gfx)++, G_RM_ZB_XLU_SURF, G_RM_NOOP2);
+
+        visual_surface_display(gfx, verts, numVerts);
+        gVisualSurfaceCount += numVerts;
+    }
 
     gSPDisplayList((*gfx)++, dl_debug_box_end);
 }
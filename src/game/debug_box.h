@@ -16,6 +16,12 @@
  */
 #define MAX_DEBUG_BOXES 512
 
+/**
+ * The max amount of static surface vertices the visual surface view keeps between frames. The cache is double buffered,
+ * so it takes up (2 * 16) bytes of RAM per vertex. Cells with more surfaces than this are rebuilt into the gfx pool every frame instead.
+ */
+#define VISUAL_SURFACE_CACHE_VERTS (3 * 256)
+
 enum DebugBoxFlags {
     DEBUG_SHAPE_BOX      = (1 << 0), // 0x01
     DEBUG_SHAPE_CYLINDER = (1 << 1), // 0x02
@@ -19,6 +19,7 @@
 #include "segment2.h"
 #include "segment_symbols.h"
 #include "rumble_init.h"
+#include "area.h"
 #ifdef HVQM
 #include <hvqm/hvqm.h>
 #endif
@@ -47,6 +48,9 @@ OSContStatus gControllerStatuses[MAXCONTROLLERS];
 OSContPadEx gControllerPads[MAXCONTROLLERS];
 u8 gControllerBits = 0b0000;
 u8 gBorderHeight;
+#ifdef ALTERNATE_ZBUFFER_RANGES
+u8 gZBufferNearRange = TRUE;
+#endif
 #ifdef VANILLA_STYLE_CUSTOM_DEBUG
 u8 gCustomDebugMode;
 #endif
@@ -82,6 +86,13 @@ u8 *gAreaSkyboxEnd[AREA_COUNT];
 // Framebuffer rendering values (max 3)
 u16 sRenderedFramebuffer = 0;
 u16 sRenderingFramebuffer = 0;
+#ifdef PAUSE_FROZEN_BACKGROUND
+// Set for a frame that isn't displayed: the next one is drawn into the same framebuffer.
+u8 gKeepRenderingFramebuffer = FALSE;
+#endif
+
+// Whether the controllers are being read, see start_controller_read.
+static u8 sControllerReadStarted = FALSE;
 
 // Goddard Vblank Function Caller
 void (*gGoddardVblankCallback)(void) = NULL;
@@ -152,11 +163,97 @@ void my_rsp_init(void) {
 }
 #endif
 
+/**
+ * Computes the screen rectangle a viewport is scissored to, as done by make_viewport_clip_rect.
+ * The lower right corner is exclusive.
+ */
+static void get_viewport_clip_rect(Vp *viewport, s16 *ulx, s16 *uly, s16 *lrx, s16 *lry) {
+    *ulx = (viewport->vp.vtrans[0] - viewport->vp.vscale[0]) / 4 + 1;
+    *uly = (viewport->vp.vtrans[1] - viewport->vp.vscale[1]) / 4 + 1;
+    *lrx = (viewport->vp.vtrans[0] + viewport->vp.vscale[0]) / 4 - 1;
+    *lry = (viewport->vp.vtrans[1] + viewport->vp.vscale[1]) / 4 - 1;
+}
+
+#ifdef CLIP_ZBUFFER_CLEAR
+// Screen rectangles below are { ulx, uly, lrx, lry }, with the lower right corner exclusive.
+
+// The part of the Z-buffer that may have been drawn to since it was last cleared.
+static s16 sZBufferDirtyRect[4] = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+#ifdef ALTERNATE_ZBUFFER_RANGES
+// The part of the Z-buffer that the last clear covered. Only far frames have drawn to it since.
+static s16 sZBufferClearedRect[4] = { 0, 0, 0, 0 };
+#endif
+
+/**
+ * Gets the part of the screen the area will be drawn to this frame: the override or clip viewport
+ * it gets scissored to, or the whole screen inside the borders.
+ */
+static void get_z_buffer_draw_rect(s16 rect[4]) {
+    Vp *clip = (gViewportOverride != NULL) ? gViewportOverride : gViewportClip;
+
+    if (clip != NULL) {
+        get_viewport_clip_rect(clip, &rect[0], &rect[1], &rect[2], &rect[3]);
+    } else {
+        rect[0] = 0;
+        rect[1] = gBorderHeight;
+        rect[2] = SCREEN_WIDTH;
+        rect[3] = SCREEN_HEIGHT - gBorderHeight;
+    }
+}
+
+static void add_rect(s16 dst[4], s16 src[4]) {
+    dst[0] = MIN(dst[0], src[0]);
+    dst[1] = MIN(dst[1], src[1]);
+    dst[2] = MAX(dst[2], src[2]);
+    dst[3] = MAX(dst[3], src[3]);
+}
+#endif
+
 /**
  * Initialize the z buffer for the current frame.
  */
 void init_z_buffer(s32 resetZB) {
     Gfx *tempGfxHead = gDisplayListHead;
+#ifdef CLIP_ZBUFFER_CLEAR
+    s16 drawRect[4];
+    s16 clearRect[4];
+
+    // The viewports are set by the level update, which has already run this frame.
+    get_z_buffer_draw_rect(drawRect);
+#endif
+
+#ifdef PAUSE_FROZEN_BACKGROUND
+    // The Z-buffer holds the frozen pause background (see render_game).
+    if (gPauseBackgroundFrozen) {
+        resetZB = FALSE;
+#ifdef CLIP_ZBUFFER_CLEAR
+        // All of it, so all of it gets cleared once the background is released.
+        drawRect[0] = 0;
+        drawRect[1] = 0;
+        drawRect[2] = SCREEN_WIDTH;
+        drawRect[3] = SCREEN_HEIGHT;
+#endif
+    }
+#endif
+#ifdef ALTERNATE_ZBUFFER_RANGES
+    // Frames alternate between the far and the near half of the depth range (see geo_process_root).
+    // Anything left behind by a far frame is behind everything drawn in the following near frame,
+    // so the clear can be skipped on near frames.
+    if (resetZB) {
+        gZBufferNearRange ^= TRUE;
+        if (gZBufferNearRange) {
+            resetZB = FALSE;
+#ifdef CLIP_ZBUFFER_CLEAR
+            // Outside of what the last clear covered, there may be depth from older near frames.
+            if (drawRect[0] < sZBufferClearedRect[0] || drawRect[1] < sZBufferClearedRect[1]
+             || drawRect[2] > sZBufferClearedRect[2] || drawRect[3] > sZBufferClearedRect[3]) {
+                gZBufferNearRange = FALSE;
+                resetZB = TRUE;
+            }
+#endif
+        }
+    }
+#endif
 
     gDPPipeSync(tempGfxHead++);
 
@@ -164,13 +261,30 @@ void init_z_buffer(s32 resetZB) {
     gDPSetDepthImage(tempGfxHead++, gPhysicalZBuffer);
 
     gDPSetColorImage(tempGfxHead++, G_IM_FMT_RGBA, G_IM_SIZ_16b, SCREEN_WIDTH, gPhysicalZBuffer);
-    if (!resetZB)
-        return;
-    gDPSetFillColor(tempGfxHead++,
-                    GPACK_ZDZ(G_MAXFBZ, 0) << 16 | GPACK_ZDZ(G_MAXFBZ, 0));
-
-    gDPFillRectangle(tempGfxHead++, 0, gBorderHeight, SCREEN_WIDTH - 1,
-                     SCREEN_HEIGHT - 1 - gBorderHeight);
+    if (resetZB) {
+        gDPSetFillColor(tempGfxHead++,
+                        GPACK_ZDZ(G_MAXFBZ, 0) << 16 | GPACK_ZDZ(G_MAXFBZ, 0));
+#ifdef CLIP_ZBUFFER_CLEAR
+        // Nothing outside of the area's viewport uses the Z-buffer, but whatever earlier frames
+        // left in it has to go as well, in case the viewport grew.
+        vec4_copy(clearRect, drawRect);
+        add_rect(clearRect, sZBufferDirtyRect);
+        gDPFillRectangle(tempGfxHead++, clearRect[0], clearRect[1], clearRect[2] - 1, clearRect[3] - 1);
+
+        vec4_copy(sZBufferDirtyRect, drawRect);
+#ifdef ALTERNATE_ZBUFFER_RANGES
+        vec4_copy(sZBufferClearedRect, clearRect);
+#endif
+#else
+        gDPFillRectangle(tempGfxHead++, 0, gBorderHeight, SCREEN_WIDTH - 1,
+                         SCREEN_HEIGHT - 1 - gBorderHeight);
+#endif
+    }
+#ifdef CLIP_ZBUFFER_CLEAR
+    else {
+        add_rect(sZBufferDirtyRect, drawRect);
+    }
+#endif
 
     gDisplayListHead = tempGfxHead;
 }
@@ -216,6 +330,52 @@ void clear_framebuffer(s32 color) {
     gDisplayListHead = tempGfxHead;
 }
 
+/**
+ * Clear the parts of the framebuffer outside of a viewport's clip rectangle.
+ * Used instead of clear_framebuffer when a full-screen background will cover the viewport anyway.
+ */
+void clear_framebuffer_outside_viewport(Vp *viewport, s32 color) {
+    s16 left = GFX_DIMENSIONS_RECT_FROM_LEFT_EDGE(0);
+    s16 top = gBorderHeight;
+    s16 right = GFX_DIMENSIONS_RECT_FROM_RIGHT_EDGE(0);
+    s16 bottom = SCREEN_HEIGHT - gBorderHeight;
+    s16 ulx, uly, lrx, lry;
+    Gfx *tempGfxHead = gDisplayListHead;
+
+    get_viewport_clip_rect(viewport, &ulx, &uly, &lrx, &lry);
+    ulx = CLAMP(ulx, left, right);
+    lrx = CLAMP(lrx, ulx, right);
+    uly = CLAMP(uly, top, bottom);
+    lry = CLAMP(lry, uly, bottom);
+
+    gDPPipeSync(tempGfxHead++);
+
+    gDPSetRenderMode(tempGfxHead++, G_RM_OPA_SURF, G_RM_OPA_SURF2);
+    gDPSetCycleType(tempGfxHead++, G_CYC_FILL);
+
+    gDPSetFillColor(tempGfxHead++, color);
+    if (uly > top) {
+        gDPFillRectangle(tempGfxHead++, left, top, right - 1, uly - 1);
+    }
+    if (lry < bottom) {
+        gDPFillRectangle(tempGfxHead++, left, lry, right - 1, bottom - 1);
+    }
+    if (lry > uly) {
+        if (ulx > left) {
+            gDPFillRectangle(tempGfxHead++, left, uly, ulx - 1, lry - 1);
+        }
+        if (lrx < right) {
+            gDPFillRectangle(tempGfxHead++, lrx, uly, right - 1, lry - 1);
+        }
+    }
+
+    gDPPipeSync(tempGfxHead++);
+
+    gDPSetCycleType(tempGfxHead++, G_CYC_1CYCLE);
+
+    gDisplayListHead = tempGfxHead;
+}
+
 /**
  * Resets the viewport, readying it for the final image.
  */
@@ -277,11 +437,9 @@ void draw_screen_borders(void) {
  * Scissoring: https://jrra.zone/n64/doc/pro-man/pro12/12-03.htm#01
  */
 void make_viewport_clip_rect(Vp *viewport) {
-    s16 vpUlx = (viewport->vp.vtrans[0] - viewport->vp.vscale[0]) / 4 + 1;
-    s16 vpPly = (viewport->vp.vtrans[1] - viewport->vp.vscale[1]) / 4 + 1;
-    s16 vpLrx = (viewport->vp.vtrans[0] + viewport->vp.vscale[0]) / 4 - 1;
-    s16 vpLry = (viewport->vp.vtrans[1] + viewport->vp.vscale[1]) / 4 - 1;
+    s16 vpUlx, vpPly, vpLrx, vpLry;
 
+    get_viewport_clip_rect(viewport, &vpUlx, &vpPly, &vpLrx, &vpLry);
     gDPSetScissor(gDisplayListHead++, G_SC_NON_INTERLACE, vpUlx, vpPly, vpLrx, vpLry);
 }
 
@@ -461,6 +619,11 @@ void display_and_vsync(void) {
     osViSwapBuffer((void *) PHYSICAL_TO_VIRTUAL(gPhysicalFramebuffers[sRenderedFramebuffer]));
 #ifndef UNLOCK_FPS
     osRecvMesg(&gGameVblankQueue, &gMainReceivedMesg, OS_MESG_BLOCK);
+#endif
+#ifdef PAUSE_FROZEN_BACKGROUND
+    if (gKeepRenderingFramebuffer) {
+        gKeepRenderingFramebuffer = FALSE;
+    } else
 #endif
     // Skip swapping buffers on inaccurate emulators other than VC so that they display immediately as the Gfx task finishes
     if (gEmulator & INSTANT_INPUT_BLACKLIST) {
@@ -593,18 +756,38 @@ void adjust_analog_stick(struct Controller *controller) {
     }
 }
 
+/**
+ * Start reading the controllers for read_controller_inputs, if any are plugged in.
+ * This never waits for the rumble thread: while it's still talking to the pak, the read is skipped
+ * and read_controller_inputs keeps the previous inputs.
+ */
+void start_controller_read(void) {
+    if (gControllerBits) {
+#if ENABLE_RUMBLE
+        if (!try_take_rumble_pak_control()) {
+            return;
+        }
+#endif
+        osContStartReadDataEx(&gSIEventMesgQueue);
+        sControllerReadStarted = TRUE;
+    }
+}
+
 /**
  * Update the controller struct with available inputs if present.
  */
 void read_controller_inputs(s32 threadID) {
-    // If any controllers are plugged in, update the controller information.
-    if (gControllerBits) {
+    // If any controllers are plugged in and were read, update the controller information.
+    if (sControllerReadStarted) {
+        sControllerReadStarted = FALSE;
         if (threadID == THREAD_5_GAME_LOOP) {
             osRecvMesg(&gSIEventMesgQueue, &gMainReceivedMesg, OS_MESG_BLOCK);
         }
         osContGetReadDataEx(gControllerPads);
 #if ENABLE_RUMBLE
         release_rumble_pak_control();
+        // The SI is idle until the next read is started, so let the rumble thread talk to the pak now.
+        rumble_thread_update_motor();
 #endif
     }
 #if !defined(DISABLE_DEMO) && defined(KEEP_MARIO_HEAD)
@@ -794,6 +977,10 @@ void thread5_game_loop(UNUSED void *arg) {
         profiler_frame_setup();
         // If the reset timer is active, run the process to reset the game.
         if (gResetTimer != 0) {
+#if ENABLE_RUMBLE
+            // Controllers aren't read while resetting, so make sure the motor still gets stopped.
+            rumble_thread_update_motor();
+#endif
             draw_reset_bars();
             continue;
         }
@@ -802,12 +989,7 @@ void thread5_game_loop(UNUSED void *arg) {
 #endif
         // If any controllers are plugged in, start read the data for when
         // read_controller_inputs is called later.
-        if (gControllerBits) {
-#if ENABLE_RUMBLE
-            block_until_rumble_pak_free();
-#endif
-            osContStartReadDataEx(&gSIEventMesgQueue);
-        }
+        start_controller_read();
 
         audio_game_loop_tick();
         select_gfx_pool();
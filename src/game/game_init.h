@@ -48,6 +48,9 @@ extern u8 *gGfxPoolEnd;
 extern struct GfxPool *gGfxPool;
 extern u8 gControllerBits;
 extern u8 gBorderHeight;
+#ifdef ALTERNATE_ZBUFFER_RANGES
+extern u8 gZBufferNearRange;
+#endif
 #ifdef VANILLA_STYLE_CUSTOM_DEBUG
 extern u8 gCustomDebugMode;
 #endif
@@ -78,17 +81,25 @@ extern u8 gMarioAnims[];
 extern u8 gDemoInputs[];
 
 extern u16 sRenderingFramebuffer;
+#ifdef PAUSE_FROZEN_BACKGROUND
+extern u8 gKeepRenderingFramebuffer;
+#endif
 extern u32 gGlobalTimer;
 
 void setup_game_memory(void);
 void thread5_game_loop(UNUSED void *arg);
 void clear_framebuffer(s32 color);
+void clear_framebuffer_outside_viewport(Vp *viewport, s32 color);
 void clear_viewport(Vp *viewport, s32 color);
 void make_viewport_clip_rect(Vp *viewport);
+void init_z_buffer(s32 resetZB);
+void select_framebuffer(void);
 void init_rcp(s32 resetZB);
 void end_master_display_list(void);
 void render_init(void);
 void select_gfx_pool(void);
 void display_and_vsync(void);
+void start_controller_read(void);
+void read_controller_inputs(s32 threadID);
 
 #endif // GAME_INIT_H
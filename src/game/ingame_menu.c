@@ -1470,6 +1470,13 @@ void change_dialog_camera_angle(void) {
 void shade_screen(void) {
     Gfx* dlHead = gDisplayListHead;
 
+#ifdef PAUSE_FROZEN_BACKGROUND_SHADED
+    // Already part of the frozen pause background.
+    if (gPauseBackgroundFrozen) {
+        return;
+    }
+#endif
+
     gSPDisplayList(dlHead++, dl_shade_screen_begin);
     gDPFillRectangle(dlHead++, GFX_DIMENSIONS_RECT_FROM_LEFT_EDGE(0), gBorderHeight,
         (GFX_DIMENSIONS_RECT_FROM_RIGHT_EDGE(0) - 1), ((SCREEN_HEIGHT - gBorderHeight) - 1));
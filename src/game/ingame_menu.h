@@ -51,6 +51,8 @@ enum HUDFlashModes {
 
 extern s8 gHudFlash;
 
+extern s16 gMenuMode;
+
 extern s8 gDialogCourseActNum;
 extern s16 gInGameLanguage;
 
@@ -174,6 +176,7 @@ void set_cutscene_message(s16 xOffset, s16 yOffset, s16 msgIndex, s16 msgDuratio
 void do_cutscene_handler(void);
 void render_hud_cannon_reticle(void);
 void reset_red_coins_collected(void);
+void shade_screen(void);
 s32 render_menus_and_dialogs(void);
 
 #endif // INGAME_MENU_H
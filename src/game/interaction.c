@@ -6,6 +6,7 @@
 #include "behavior_actions.h"
 #include "behavior_data.h"
 #include "camera.h"
+#include "compound_actor.h"
 #include "course_table.h"
 #include "dialog_ids.h"
 #include "engine/math_util.h"
@@ -398,7 +399,7 @@ struct Object *mario_get_collided_object(struct MarioState *m, u32 interactType)
     for (i = 0; i < m->marioObj->numCollidedObjs; i++) {
         object = m->marioObj->collidedObjs[i];
 
-        if (object->oInteractType == interactType) {
+        if (obj_get_collided_interact_type(object) == interactType) {
             return object;
         }
     }
@@ -1829,13 +1830,18 @@ void mario_process_interactions(struct MarioState *m) {
             u32 interactType = sInteractionHandlers[i].interactType;
             if (m->collidedObjInteractTypes & interactType) {
                 struct Object *object = mario_get_collided_object(m, interactType);
+                u32 stop = FALSE;
 
                 m->collidedObjInteractTypes &= ~interactType;
 
+                compound_actor_begin_interaction(object);
                 if (!(object->oInteractStatus & INT_STATUS_INTERACTED)) {
-                    if (sInteractionHandlers[i].handler(m, interactType, object)) {
-                        break;
-                    }
+                    stop = sInteractionHandlers[i].handler(m, interactType, object);
+                }
+                compound_actor_end_interaction(object);
+
+                if (stop) {
+                    break;
                 }
             }
         }
@@ -1902,7 +1908,7 @@ void mario_handle_special_floors(struct MarioState *m) {
         return;
     }
 
-    if (m->floor != NULL) {
+    if (m->floor != NULL && SURFACE_TYPE_HAS_PROPERTY(m->floor->type, SURFACE_PROP_SPECIAL_FLOOR)) {
         s32 floorType = m->floor->type;
 
         switch (floorType) {
@@ -15,6 +15,7 @@ enum VIModes {
 #define THREAD4_STACK 0x2000
 #define THREAD5_STACK 0x2000
 #define THREAD6_STACK 0x400
+#define THREAD10_STACK 0x400
 
 enum ThreadID {
     THREAD_0,
@@ -27,6 +28,7 @@ enum ThreadID {
     THREAD_7_HVQM,
     THREAD_8_TIMEKEEPER,
     THREAD_9_DA_COUNTER,
+    THREAD_10_PRINT_BUFFER,
 };
 
 struct RumbleData {
@@ -79,7 +81,7 @@ extern OSMesgQueue gDmaMesgQueue;
 extern OSMesgQueue gSIEventMesgQueue;
 #if ENABLE_RUMBLE
 extern OSMesg gRumblePakSchedulerMesgBuf[1];
-extern OSMesg gRumbleThreadVIMesgBuf[1];
+extern OSMesg gRumbleThreadVIMesgBuf[2];
 
 extern struct RumbleData gRumbleDataQueue[3];
 extern struct RumbleSettings gCurrRumbleSettings;
@@ -110,6 +112,11 @@ typedef struct {
 void set_vblank_handler(s32 index, struct VblankHandler *handler, OSMesgQueue *queue, OSMesg *msg);
 void dispatch_audio_sptask(struct SPTask *spTask);
 void exec_display_list(struct SPTask *spTask);
+#ifdef RSP_DECOMPRESS
+// Task type of the RSP Yay0 decompression microcode
+#define M_DECOMPRESSTASK 8
+void dispatch_decompress_sptask(struct SPTask *spTask);
+#endif
 void change_vi(OSViMode *mode, int width, int height);
 
 #endif // MAIN_H
@@ -390,30 +390,9 @@ s32 mario_get_floor_class(struct MarioState *m) {
     }
 
     if (m->floor != NULL) {
-        switch (m->floor->type) {
-            case SURFACE_NOT_SLIPPERY:
-            case SURFACE_HARD_NOT_SLIPPERY:
-            case SURFACE_SWITCH:
-                floorClass = SURFACE_CLASS_NOT_SLIPPERY;
-                break;
-
-            case SURFACE_SLIPPERY:
-            case SURFACE_NOISE_SLIPPERY:
-            case SURFACE_HARD_SLIPPERY:
-            case SURFACE_NO_CAM_COL_SLIPPERY:
-                floorClass = SURFACE_CLASS_SLIPPERY;
-                break;
-
-            case SURFACE_SUPER_SLIPPERY:
-            case SURFACE_VERY_SLIPPERY:
-            case SURFACE_ICE:
-            case SURFACE_HARD_VERY_SLIPPERY:
-            case SURFACE_NOISE_VERY_SLIPPERY_73:
-            case SURFACE_NOISE_VERY_SLIPPERY_74:
-            case SURFACE_NOISE_VERY_SLIPPERY:
-            case SURFACE_NO_CAM_COL_VERY_SLIPPERY:
-                floorClass = SURFACE_CLASS_VERY_SLIPPERY;
-                break;
+        s32 typeClass = SURFACE_TYPE_GET_FLOOR_CLASS(m->floor->type);
+        if (typeClass != SURFACE_CLASS_DEFAULT) {
+            floorClass = typeClass;
         }
     }
 
@@ -451,7 +430,6 @@ s8 sTerrainSounds[7][6] = {
  * This depends on surfaces and terrain.
  */
 u32 mario_get_terrain_sound_addend(struct MarioState *m) {
-    s16 floorSoundType;
     s16 terrainType = m->area->terrainType & TERRAIN_MASK;
     s32 ret = SOUND_TERRAIN_DEFAULT << 16;
     s32 floorType;
@@ -462,48 +440,10 @@ u32 mario_get_terrain_sound_addend(struct MarioState *m) {
         if ((gCurrLevelNum != LEVEL_LLL) && (m->floorHeight < (m->waterLevel - 10))) {
             // Water terrain sound, excluding LLL since it uses water in the volcano.
             ret = SOUND_TERRAIN_WATER << 16;
-        } else if (SURFACE_IS_QUICKSAND(floorType)) {
+        } else if (SURFACE_TYPE_HAS_PROPERTY(floorType, SURFACE_PROP_QUICKSAND)) {
             ret = SOUND_TERRAIN_SAND << 16;
         } else {
-            switch (floorType) {
-                default:
-                    floorSoundType = 0;
-                    break;
-
-                case SURFACE_NOT_SLIPPERY:
-                case SURFACE_HARD:
-                case SURFACE_HARD_NOT_SLIPPERY:
-                case SURFACE_SWITCH:
-                    floorSoundType = 1;
-                    break;
-
-                case SURFACE_SLIPPERY:
-                case SURFACE_HARD_SLIPPERY:
-                case SURFACE_NO_CAM_COL_SLIPPERY:
-                    floorSoundType = 2;
-                    break;
-
-                case SURFACE_SUPER_SLIPPERY:
-                case SURFACE_VERY_SLIPPERY:
-                case SURFACE_ICE:
-                case SURFACE_HARD_VERY_SLIPPERY:
-                case SURFACE_NOISE_VERY_SLIPPERY_73:
-                case SURFACE_NOISE_VERY_SLIPPERY_74:
-                case SURFACE_NOISE_VERY_SLIPPERY:
-                case SURFACE_NO_CAM_COL_VERY_SLIPPERY:
-                    floorSoundType = 3;
-                    break;
-
-                case SURFACE_NOISE_DEFAULT:
-                    floorSoundType = 4;
-                    break;
-
-                case SURFACE_NOISE_SLIPPERY:
-                    floorSoundType = 5;
-                    break;
-            }
-
-            ret = sTerrainSounds[terrainType][floorSoundType] << 16;
+            ret = sTerrainSounds[terrainType][SURFACE_TYPE_GET_TERRAIN_SOUND(floorType)] << 16;
         }
     }
 
@@ -112,7 +112,7 @@ s32 should_get_stuck_in_ground(struct MarioState *m) {
     s32 type = floor->type;
 
     if (floor != NULL && (terrainType == TERRAIN_SNOW || terrainType == TERRAIN_SAND)
-        && type != SURFACE_BURNING && SURFACE_IS_NOT_HARD(type)) {
+        && type != SURFACE_BURNING && SURFACE_TYPE_HAS_PROPERTY(type, SURFACE_PROP_NOT_HARD)) {
         if (!(flags & SURFACE_FLAG_DYNAMIC) && m->peakHeight - m->pos[1] > 1000.0f && floor->normal.y >= COS30) {
             return TRUE;
         }
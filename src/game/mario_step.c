@@ -316,7 +316,7 @@ static s32 perform_ground_quarter_step(struct MarioState *m, Vec3f nextPos) {
     vec3f_set(m->pos, nextPos[0], floorHeight, nextPos[2]);
 
     // H64 TODO: Add config opt & check if floor is slippery
-    if (!SURFACE_IS_UNSAFE(floor->type)) {
+    if (!SURFACE_TYPE_HAS_PROPERTY(floor->type, SURFACE_PROP_UNSAFE)) {
         vec3f_copy(m->lastSafePos, m->pos);
     }
 
@@ -41,6 +41,7 @@ struct DmaHandlerList {
 #define EFFECTS_MEMORY_POOL 0x4000
 
 extern struct MemoryPool *gEffectsMemoryPool;
+extern uintptr_t gSegmentROMTable[32];
 
 uintptr_t set_segment_base_addr(s32 segment, void *addr);
 void *get_segment_base_addr(s32 segment);
@@ -56,6 +57,9 @@ u32 main_pool_available(void);
 u32 main_pool_push_state(void);
 u32 main_pool_pop_state(void);
 
+// Marks the end of the relocation table appended to segments by tools/segment_relocs.py
+#define SEGMENT_RELOCATION_MAGIC 0x52454C4F // 'RELO'
+
 #ifndef NO_SEGMENTED_MEMORY
 void *load_segment(s32 segment, u8 *srcStart, u8 *srcEnd, u32 side, u8 *bssStart, u8 *bssEnd);
 void *load_to_fixed_pool_addr(u8 *destAddr, u8 *srcStart, u8 *srcEnd);
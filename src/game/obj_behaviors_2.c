@@ -8,6 +8,8 @@
 #include "behavior_actions.h"
 #include "behavior_data.h"
 #include "camera.h"
+#include "clock_mover.h"
+#include "compound_actor.h"
 #include "dialog_ids.h"
 #include "engine/behavior_script.h"
 #include "engine/math_util.h"
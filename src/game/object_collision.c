@@ -1,6 +1,7 @@
 #include <PR/ultratypes.h>
 
 #include "sm64.h"
+#include "compound_actor.h"
 #include "debug.h"
 #include "interaction.h"
 #include "mario.h"
@@ -86,6 +87,9 @@ void clear_object_collision(struct Object *a) {
     while (nextObj != a) {
         nextObj->numCollidedObjs = 0;
         nextObj->collidedObjInteractTypes = 0;
+        if (nextObj->compound != NULL) {
+            nextObj->compound->hitSegment = -1;
+        }
         if (nextObj->oIntangibleTimer > 0) {
             nextObj->oIntangibleTimer--;
         }
@@ -93,13 +97,75 @@ void clear_object_collision(struct Object *a) {
     }
 }
 
+/**
+ * Check Mario against the segments of b's compound actor. The first segment he touches
+ * is registered in his collision list as b, and only there: segments don't collide with
+ * other objects, and b's own list is left alone.
+ */
+s32 detect_compound_segment_overlap(struct Object *a, struct Object *b) {
+    struct CompoundActor *compound = b->compound;
+    f32 dya_bottom = a->oPosY - a->hitboxDownOffset;
+    f32 dya_top = a->hitboxHeight + dya_bottom;
+    s32 i;
+
+    if (a->numCollidedObjs >= 4) {
+        return FALSE;
+    }
+
+    for (i = 0; i < compound->numSegments; i++) {
+        struct CompoundSegment *segment = &compound->segments[i];
+        struct ObjectHitbox *hitbox = segment->hitbox;
+
+        if (hitbox == NULL || !(segment->gfx.node.flags & GRAPH_RENDER_ACTIVE)) {
+            continue;
+        }
+
+        f32 dx = a->oPosX - segment->gfx.pos[0];
+        f32 dz = a->oPosZ - segment->gfx.pos[2];
+        f32 distance = sqr(dx) + sqr(dz);
+        f32 collisionRadius = a->hitboxRadius + (segment->gfx.scale[0] * hitbox->radius);
+
+        if (sqr(collisionRadius) > distance) {
+            f32 dyb_bottom = segment->gfx.pos[1] - (segment->gfx.scale[1] * hitbox->downOffset);
+            f32 dyb_top = (segment->gfx.scale[1] * hitbox->height) + dyb_bottom;
+
+            if (dya_bottom > dyb_top || dya_top < dyb_bottom) {
+                continue;
+            }
+
+            // Same as detect_object_hurtbox_overlap
+            segment->interactionSubtype |= INT_SUBTYPE_DELAY_INVINCIBILITY;
+            if (hitbox->hurtboxRadius != 0) {
+                collisionRadius = a->hurtboxRadius + (segment->gfx.scale[0] * hitbox->hurtboxRadius);
+                dyb_top = (segment->gfx.scale[1] * hitbox->hurtboxHeight) + dyb_bottom;
+                if (sqr(collisionRadius) > distance && dya_bottom <= dyb_top && dya_top >= dyb_bottom) {
+                    segment->interactionSubtype &= ~INT_SUBTYPE_DELAY_INVINCIBILITY;
+                }
+            }
+
+            a->collidedObjs[a->numCollidedObjs] = b;
+            a->collidedObjInteractTypes |= hitbox->interactType;
+            a->numCollidedObjs++;
+            compound->hitSegment = i;
+            compound->hitHitbox = hitbox;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 void check_collision_in_list(struct Object *a, struct Object *b, struct Object *c) {
     if (a->oIntangibleTimer == 0) {
         while (b != c) {
-            if (b->oIntangibleTimer == 0) {
-                if (detect_object_hitbox_overlap(a, b) && b->hurtboxRadius != 0.0f) {
+            if (b->oIntangibleTimer == 0 && detect_object_hitbox_overlap(a, b)) {
+                if (b->hurtboxRadius != 0.0f) {
                     detect_object_hurtbox_overlap(a, b);
                 }
+            } else if (b->compound != NULL && a == gMarioObject
+                       && compound_actor_is_shown(b->compound)) {
+                // Segments are tangible on their own, regardless of their owner's intangibility
+                detect_compound_segment_overlap(a, b);
             }
             b = (struct Object *) b->header.next;
         }
@@ -4,6 +4,8 @@
 #include "area.h"
 #include "behavior_data.h"
 #include "camera.h"
+#include "clock_mover.h"
+#include "compound_actor.h"
 #include "debug.h"
 #include "engine/behavior_script.h"
 #include "engine/graph_node.h"
@@ -139,7 +141,8 @@ s32 gNumStaticSurfaceNodes;
 s32 gNumStaticSurfaces;
 
 /**
- * A pool used by chain chomp and wiggler to allocate their body parts.
+ * A pool used by chain chomp and wiggler to allocate their body parts, and by
+ * compound actors for their segments.
  */
 struct MemoryPool *gObjectMemoryPool;
 
@@ -339,6 +342,11 @@ s32 update_objects_during_time_stop(struct ObjectNode *objList, struct ObjectNod
 
         // Only update if unfrozen
         if (unfrozen) {
+            // The clock is stopped, but this object still moves
+            if (gCurrentObject->oFlags & OBJ_FLAG_CLOCK_MOVER) {
+                obj_step_clock_mover(gCurrentObject);
+            }
+
             gCurrentObject->header.gfx.node.flags |= GRAPH_RENDER_HAS_ANIMATION;
             cur_obj_update();
         } else {
@@ -418,6 +426,30 @@ void set_object_respawn_info_bits(struct Object *obj, u8 bits) {
     }
 }
 
+#ifdef TIME_SLICED_SPAWNING
+/**
+ * Spawn infos of the current area that haven't been spawned yet, sorted by their
+ * distance to the warp Mario enters the area from.
+ */
+static struct SpawnInfo *sDeferredSpawns[OBJECT_POOL_CAPACITY];
+static f32 sDeferredSpawnDists[OBJECT_POOL_CAPACITY];
+static s32 sNumDeferredSpawns = 0;
+static s32 sNextDeferredSpawn = 0;
+
+/**
+ * Behaviors of objects that other objects look for when they initialize, so they're never deferred.
+ * Red coin stars and hidden stars count the red coins and triggers left in the area to get their
+ * totals, and red coins bind to the nearest red coin star.
+ */
+static const BehaviorScript *sNeverDeferredBehaviors[] = {
+    bhvRedCoin,
+    bhvHiddenRedCoinStar,
+    bhvBowserCourseRedCoinStar,
+    bhvHiddenStar,
+    bhvHiddenStarTrigger,
+};
+#endif
+
 /**
  * Unload all objects whose activeAreaIndex is areaIndex.
  */
@@ -428,6 +460,12 @@ void unload_objects_from_area(UNUSED s32 unused, s32 areaIndex) {
     s32 i;
     gObjectLists = gObjectListArray;
 
+#ifdef TIME_SLICED_SPAWNING
+    // Anything still waiting belongs to the area being unloaded.
+    sNumDeferredSpawns = 0;
+    sNextDeferredSpawn = 0;
+#endif
+
     for (i = 0; i < NUM_OBJ_LISTS; i++) {
         list = gObjectLists + i;
         node = list->next;
@@ -443,10 +481,142 @@ void unload_objects_from_area(UNUSED s32 unused, s32 areaIndex) {
     }
 }
 
+/**
+ * Spawn the object described by a SpawnInfo, unless it was previously killed or collected.
+ */
+static void spawn_object_from_info(struct SpawnInfo *spawnInfo) {
+    struct Object *object;
+    const BehaviorScript *script;
+
+    script = segmented_to_virtual(spawnInfo->behaviorScript);
+
+    // If the object was previously killed/collected, don't respawn it
+    if ((spawnInfo->behaviorArg & (RESPAWN_INFO_DONT_RESPAWN << 8))
+        != (RESPAWN_INFO_DONT_RESPAWN << 8)) {
+        object = create_object(script);
+
+        // Behavior parameters are often treated as four separate bytes, but
+        // are stored as an s32.
+        object->oBehParams = spawnInfo->behaviorArg;
+        // The second byte of the behavior parameters is copied over to a special field
+        // as it is the most frequently used by objects.
+        object->oBehParams2ndByte = GET_BPARAM2(spawnInfo->behaviorArg);
+
+        object->behavior = script;
+        object->unused1 = 0;
+
+        // Record death/collection in the SpawnInfo
+        object->respawnInfoType = RESPAWN_INFO_TYPE_NORMAL;
+        object->respawnInfo = &spawnInfo->behaviorArg;
+
+        // Usually this checks if bparam4 is 1 to decide if this is mario
+        // This change allows any object to use that param
+        if (object->behavior == segmented_to_virtual(bhvMario)) {
+            gMarioObject = object;
+            geo_make_first_child(&object->header.gfx.node);
+        }
+
+        geo_obj_init_spawninfo(&object->header.gfx, spawnInfo);
+
+        vec3s_to_vec3f(&object->oPosVec, spawnInfo->startPos);
+
+        vec3s_to_vec3i(&object->oFaceAngleVec, spawnInfo->startAngle);
+
+        vec3s_to_vec3i(&object->oMoveAngleVec, spawnInfo->startAngle);
+
+        object->oFloorHeight = find_floor(object->oPosX, object->oPosY, object->oPosZ, &object->oFloor);
+    }
+}
+
+#ifdef TIME_SLICED_SPAWNING
+/**
+ * Find where Mario is going to enter the area: the spawn info of the object owning the
+ * destination warp node. gMarioSpawnInfo is only moved there once the area has loaded
+ * (see init_mario_after_warp), so it can't be used yet. Returns NULL if the area isn't
+ * being loaded by a warp.
+ */
+static struct SpawnInfo *find_entry_warp_spawn_info(struct SpawnInfo *spawnInfo) {
+    if (sWarpDest.type == WARP_TYPE_NOT_WARPING) {
+        return NULL;
+    }
+
+    for (; spawnInfo != NULL; spawnInfo = spawnInfo->next) {
+        if (GET_BPARAM2(spawnInfo->behaviorArg) == sWarpDest.nodeId
+         && get_mario_spawn_type_from_behavior(spawnInfo->behaviorScript) != MARIO_SPAWN_NONE) {
+            return spawnInfo;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Queue a spawn info for a later frame if it's far enough from where Mario enters the area.
+ * The queue stays sorted nearest first, with ties kept in list order, so spawns
+ * always happen in the same order. Returns whether the spawn was deferred.
+ */
+static s32 defer_object_spawn(struct SpawnInfo *spawnInfo, struct SpawnInfo *entryWarp) {
+    Vec3f d;
+    f32 dist;
+    s32 i;
+
+    if (sNumDeferredSpawns >= OBJECT_POOL_CAPACITY) {
+        return FALSE;
+    }
+
+    // Warp objects have to exist when load_obj_warp_nodes runs right after this, to be bound to their warp nodes.
+    if (get_mario_spawn_type_from_behavior(spawnInfo->behaviorScript) != MARIO_SPAWN_NONE) {
+        return FALSE;
+    }
+
+    for (i = 0; i < ARRAY_COUNT(sNeverDeferredBehaviors); i++) {
+        if (spawnInfo->behaviorScript == sNeverDeferredBehaviors[i]) {
+            return FALSE;
+        }
+    }
+
+    vec3_diff(d, spawnInfo->startPos, entryWarp->startPos);
+    dist = vec3_sumsq(d);
+    if (dist < sqr(TIME_SLICED_SPAWN_NEAR_DIST)) {
+        return FALSE;
+    }
+
+    for (i = sNumDeferredSpawns; i > sNextDeferredSpawn && sDeferredSpawnDists[i - 1] > dist; i--) {
+        sDeferredSpawns[i] = sDeferredSpawns[i - 1];
+        sDeferredSpawnDists[i] = sDeferredSpawnDists[i - 1];
+    }
+    sDeferredSpawns[i] = spawnInfo;
+    sDeferredSpawnDists[i] = dist;
+    sNumDeferredSpawns++;
+    return TRUE;
+}
+
+/**
+ * Spawn queued objects until this frame's time budget runs out, always at least one.
+ */
+static void spawn_deferred_objects(void) {
+    u32 startTime = osGetCount();
+
+    while (sNextDeferredSpawn < sNumDeferredSpawns) {
+        spawn_object_from_info(sDeferredSpawns[sNextDeferredSpawn++]);
+        if (osGetCount() - startTime >= OS_USEC_TO_CYCLES(TIME_SLICED_SPAWN_BUDGET)) {
+            break;
+        }
+    }
+
+    if (sNextDeferredSpawn == sNumDeferredSpawns) {
+        sNumDeferredSpawns = 0;
+        sNextDeferredSpawn = 0;
+    }
+}
+#endif
+
 /**
  * Spawn objects given a list of SpawnInfos. Called when loading an area.
  */
 void spawn_objects_from_info(UNUSED s32 unused, struct SpawnInfo *spawnInfo) {
+#ifdef TIME_SLICED_SPAWNING
+    struct SpawnInfo *entryWarp = find_entry_warp_spawn_info(spawnInfo);
+#endif
     gObjectLists = gObjectListArray;
     gTimeStopState = 0;
 
@@ -460,48 +630,13 @@ void spawn_objects_from_info(UNUSED s32 unused, struct SpawnInfo *spawnInfo) {
     }
 
     while (spawnInfo != NULL) {
-        struct Object *object;
-        const BehaviorScript *script;
-
-        script = segmented_to_virtual(spawnInfo->behaviorScript);
-
-        // If the object was previously killed/collected, don't respawn it
-        if ((spawnInfo->behaviorArg & (RESPAWN_INFO_DONT_RESPAWN << 8))
-            != (RESPAWN_INFO_DONT_RESPAWN << 8)) {
-            object = create_object(script);
-
-            // Behavior parameters are often treated as four separate bytes, but
-            // are stored as an s32.
-            object->oBehParams = spawnInfo->behaviorArg;
-            // The second byte of the behavior parameters is copied over to a special field
-            // as it is the most frequently used by objects.
-            object->oBehParams2ndByte = GET_BPARAM2(spawnInfo->behaviorArg);
-
-            object->behavior = script;
-            object->unused1 = 0;
-
-            // Record death/collection in the SpawnInfo
-            object->respawnInfoType = RESPAWN_INFO_TYPE_NORMAL;
-            object->respawnInfo = &spawnInfo->behaviorArg;
-
-            // Usually this checks if bparam4 is 1 to decide if this is mario
-            // This change allows any object to use that param
-            if (object->behavior == segmented_to_virtual(bhvMario)) {
-                gMarioObject = object;
-                geo_make_first_child(&object->header.gfx.node);
-            }
-
-            geo_obj_init_spawninfo(&object->header.gfx, spawnInfo);
-
-            vec3s_to_vec3f(&object->oPosVec, spawnInfo->startPos);
-
-            vec3s_to_vec3i(&object->oFaceAngleVec, spawnInfo->startAngle);
-
-            vec3s_to_vec3i(&object->oMoveAngleVec, spawnInfo->startAngle);
-
-            object->oFloorHeight = find_floor(object->oPosX, object->oPosY, object->oPosZ, &object->oFloor);
+#ifdef TIME_SLICED_SPAWNING
+        if (entryWarp == NULL || !defer_object_spawn(spawnInfo, entryWarp)) {
+            spawn_object_from_info(spawnInfo);
         }
-
+#else
+        spawn_object_from_info(spawnInfo);
+#endif
         spawnInfo = spawnInfo->next;
     }
 }
@@ -531,6 +666,12 @@ void clear_objects(void) {
 
     gObjectMemoryPool = mem_pool_init(OBJECT_MEMORY_POOL, MEMORY_POOL_LEFT);
     gObjectLists = gObjectListArray;
+    clear_compound_actors();
+
+#ifdef TIME_SLICED_SPAWNING
+    sNumDeferredSpawns = 0;
+    sNextDeferredSpawn = 0;
+#endif
 
     clear_dynamic_surfaces();
 }
@@ -647,6 +788,16 @@ void update_objects(UNUSED s32 unused) {
     // If time stop is not active, unload object surfaces
     clear_dynamic_surfaces();
 
+    // Clock movers only advance on frames where time stop isn't freezing them
+    if (!(gTimeStopState & TIME_STOP_ACTIVE)) {
+        gObjectClock++;
+    }
+
+#ifdef TIME_SLICED_SPAWNING
+    // Spawn some of the far objects left over from loading the area
+    spawn_deferred_objects();
+#endif
+
     // Update spawners and objects with surfaces
     update_terrain_objects();
 
@@ -23,8 +23,11 @@ enum gTimeStopStateFlags {
 
 /**
  * The maximum number of objects that can be loaded at once.
+ * Building with POOL_SIZES=1 sizes this from the level data instead.
  */
+#ifndef OBJECT_POOL_CAPACITY
 #define OBJECT_POOL_CAPACITY 240
+#endif
 
 /**
  * Every object is categorized into an object list, which controls the order
@@ -96,7 +99,7 @@ extern s32 gSurfacesAllocated;
 extern s32 gNumStaticSurfaceNodes;
 extern s32 gNumStaticSurfaces;
 
-#define OBJECT_MEMORY_POOL 0x800
+#define OBJECT_MEMORY_POOL 0x1000
 
 extern struct MemoryPool *gObjectMemoryPool;
 
@@ -324,7 +324,49 @@ void profiler_print_times() {
     }
 }
 
+#ifdef BENCHMARK_REPORT_FRAMES
+static u64 sBenchmarkTotals[PROFILER_TIME_COUNT];
+static u32 sBenchmarkFrames = 0;
+
+#define BENCHMARK_AVERAGE_USEC(which) ((u32) OS_CYCLES_TO_USEC(sBenchmarkTotals[which] / BENCHMARK_REPORT_FRAMES))
+
+/**
+ * Adds up the last PROFILING_BUFFER_SIZE frames' times, and prints their averages over the whole benchmark
+ * once it has run for BENCHMARK_REPORT_FRAMES frames. tools/opt_flag_tuner.py reads them from the debug output.
+ */
+static void benchmark_report_update() {
+    sBenchmarkFrames += PROFILING_BUFFER_SIZE;
+    if (sBenchmarkFrames <= BENCHMARK_WARMUP_FRAMES || sBenchmarkFrames > (BENCHMARK_WARMUP_FRAMES + BENCHMARK_REPORT_FRAMES)) {
+        return;
+    }
+
+    for (s32 i = 0; i < PROFILER_TIME_COUNT; i++) {
+        sBenchmarkTotals[i] += all_profiling_data[i].total;
+    }
+
+    if (sBenchmarkFrames == (BENCHMARK_WARMUP_FRAMES + BENCHMARK_REPORT_FRAMES)) {
+        u32 rdp = MAX(MAX(sBenchmarkTotals[PROFILER_TIME_PIPE], sBenchmarkTotals[PROFILER_TIME_TMEM]), sBenchmarkTotals[PROFILER_TIME_CMD]) / BENCHMARK_REPORT_FRAMES;
+
+        osSyncPrintf("BENCHMARK frames=%d cpu=%u rsp=%u rdp=%u behavior=%u gfx=%u collision=%u audio=%u\n",
+            BENCHMARK_REPORT_FRAMES,
+            BENCHMARK_AVERAGE_USEC(PROFILER_TIME_TOTAL) + BENCHMARK_AVERAGE_USEC(PROFILER_TIME_AUDIO) * 2,
+            BENCHMARK_AVERAGE_USEC(PROFILER_TIME_RSP_GFX) + BENCHMARK_AVERAGE_USEC(PROFILER_TIME_RSP_AUDIO),
+            RDP_CYCLE_CONV(rdp),
+            BENCHMARK_AVERAGE_USEC(PROFILER_TIME_BEHAVIOR_BEFORE_MARIO) + BENCHMARK_AVERAGE_USEC(PROFILER_TIME_MARIO) + BENCHMARK_AVERAGE_USEC(PROFILER_TIME_BEHAVIOR_AFTER_MARIO),
+            BENCHMARK_AVERAGE_USEC(PROFILER_TIME_GFX),
+            BENCHMARK_AVERAGE_USEC(PROFILER_TIME_COLLISION),
+            BENCHMARK_AVERAGE_USEC(PROFILER_TIME_AUDIO) * 2
+        );
+    }
+}
+#endif
+
 void profiler_frame_setup() {
+#ifdef BENCHMARK_REPORT_FRAMES
+    if (profile_buffer_index == (PROFILING_BUFFER_SIZE - 1)) {
+        benchmark_report_update();
+    }
+#endif
     profile_buffer_index++;
     preempted_time = 0;
 
@@ -389,6 +389,11 @@ static void print_audio_overview(void) {
     print_set_envcolour(255, 255, 255, 255);
     print_small_text_light(x, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
 
+    y += 12;
+    us = OS_CYCLES_TO_USEC(all_profiling_data[PROFILER_TIME_RSP_AUDIO].total / PROFILING_BUFFER_SIZE) * 2;
+    sprintf(textBytes, "RSP: %d  UNDERRUNS: %d  SKIPPED: %d", us, gAudioUnderruns, gAudioSkippedUpdates);
+    print_small_text_light(x, y, textBytes, PRINT_TEXT_ALIGN_LEFT, PRINT_ALL, FONT_OUTLINE);
+
 #ifdef AUDIO_PROFILING
     for (s32 i = 0; i < ARRAY_COUNT(audioBenchmarkNames); i++) {
         y += 12;
@@ -504,10 +509,12 @@ void print_basic_profiling(void) {
 }
 
 void puppyprint_render_standard(void) {
-    char textBytes[128];
+    char textBytes[192];
 
-    sprintf(textBytes, "Matrix Muls: %d\n\nCollision Checks\nFloors: %d\nWalls: %d\nCeilings: %d\n Water: %d\nRaycasts: %d",
+    sprintf(textBytes, "Matrix Muls: %d\nSegment Lookups: %d\nRelocated: %d\n\nCollision Checks\nFloors: %d\nWalls: %d\nCeilings: %d\n Water: %d\nRaycasts: %d",
             gPuppyCallCounter.matrix,
+            gPuppyCallCounter.segment_lookup,
+            gPuppyCallCounter.segment_relocated,
             gPuppyCallCounter.collision_floor,
             gPuppyCallCounter.collision_wall,
             gPuppyCallCounter.collision_ceil,
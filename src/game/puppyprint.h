@@ -50,6 +50,8 @@ struct CallCounter {
     u16 collision_water;
     u16 collision_raycast;
     u16 matrix;
+    u16 segment_lookup;
+    u16 segment_relocated;
 };
 
 struct PuppyPrintPage{
@@ -1,7 +1,11 @@
 #include <PR/ultratypes.h>
 
 #include "area.h"
+#include "clock_mover.h"
+#include "compound_actor.h"
+#include "debug.h"
 #include "engine/math_util.h"
+#include "engine/surface_collision.h"
 #include "game_init.h"
 #include "gfx_dimensions.h"
 #include "main.h"
@@ -159,6 +163,7 @@ ALIGNED16 struct GraphNodePerspective *gCurGraphNodeCamFrustum = NULL;
 ALIGNED16 struct GraphNodeCamera *gCurGraphNodeCamera = NULL;
 ALIGNED16 struct GraphNodeObject *gCurGraphNodeObject = NULL;
 ALIGNED16 struct GraphNodeHeldObject *gCurGraphNodeHeldObject = NULL;
+struct CompoundSegment *gCurCompoundSegment = NULL;
 u16 gAreaUpdateCounter = 0;
 LookAt* gCurLookAt;
 
@@ -190,7 +195,73 @@ static const Gfx dl_silhouette_end[] = {
     gsSPEndDisplayList(),
 };
 #undef SCHWA
-#endif
+
+// Whether the silhouette pass is skipped this frame, because Mario is in plain view.
+static u8 sSkipSilhouettePass = FALSE;
+
+#ifdef SILHOUETTE_VISIBILITY_CHECK
+// Consecutive frames Mario has been visible for. The pass is only skipped once
+// this reaches SILHOUETTE_VISIBLE_FRAMES, so it doesn't flicker on and off.
+#define SILHOUETTE_VISIBLE_FRAMES 8
+static s16 sSilhouetteVisibleFrames = 0;
+
+// Points on Mario's body tested for visibility: feet, head, and either side of the chest.
+static const Vec3f sSilhouetteTestPoints[] = {
+    {   0.0f,  20.0f, 0.0f },
+    {   0.0f, 150.0f, 0.0f },
+    { -40.0f,  90.0f, 0.0f },
+    {  40.0f,  90.0f, 0.0f },
+};
+
+/**
+ * Cast rays from the camera to a few points on Mario. If none of them hit collision,
+ * nothing is in front of him and the silhouette pass would draw him for nothing.
+ */
+static void update_silhouette_visibility(Vec3f cameraPos) {
+    struct Object *marioObj = gMarioState->marioObj;
+    struct Surface *surf;
+    Vec3f hitPos, point, dir;
+    f32 sideX, sideZ, dist;
+    s32 i;
+
+    if (marioObj == NULL) {
+        sSilhouetteVisibleFrames = 0;
+        sSkipSilhouettePass = FALSE;
+        return;
+    }
+
+    // Offset the side points perpendicular to the view direction.
+    vec3f_diff(dir, marioObj->header.gfx.pos, cameraPos);
+    dist = sqrtf(sqr(dir[0]) + sqr(dir[2]));
+    if (dist > 1.0f) {
+        sideX = -dir[2] / dist;
+        sideZ =  dir[0] / dist;
+    } else {
+        sideX = 1.0f;
+        sideZ = 0.0f;
+    }
+
+    for (i = 0; i < ARRAY_COUNT(sSilhouetteTestPoints); i++) {
+        point[0] = marioObj->header.gfx.pos[0] + sSilhouetteTestPoints[i][0] * sideX;
+        point[1] = marioObj->header.gfx.pos[1] + sSilhouetteTestPoints[i][1];
+        point[2] = marioObj->header.gfx.pos[2] + sSilhouetteTestPoints[i][0] * sideZ;
+        vec3f_diff(dir, cameraPos, point);
+        find_surface_on_ray(point, dir, &surf, hitPos, (RAYCAST_FIND_FLOOR | RAYCAST_FIND_CEIL | RAYCAST_FIND_WALL));
+        if (surf != NULL) {
+            sSilhouetteVisibleFrames = 0;
+            sSkipSilhouettePass = FALSE;
+            return;
+        }
+    }
+
+    if (sSilhouetteVisibleFrames < SILHOUETTE_VISIBLE_FRAMES) {
+        sSilhouetteVisibleFrames++;
+    } else {
+        sSkipSilhouettePass = TRUE;
+    }
+}
+#endif // SILHOUETTE_VISIBILITY_CHECK
+#endif // SILHOUETTE
 
 struct RenderPhase {
     u8 startLayer;
@@ -267,10 +338,21 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
     struct RenderModeContainer *mode1List = &renderModeTable_1Cycle[enableZBuffer];
     struct RenderModeContainer *mode2List = &renderModeTable_2Cycle[enableZBuffer];
     Gfx *tempGfxHead = gDisplayListHead;
+#if SILHOUETTE
+    // Nothing to draw a silhouette of if no object with GRAPH_RENDER_SILHOUETTE was queued.
+    s32 skipSilhouette = sSkipSilhouettePass
+                         || (node->listHeads[LAYER_SILHOUETTE_OPAQUE] == NULL
+                             && node->listHeads[LAYER_SILHOUETTE_ALPHA] == NULL);
+#endif
 
     // Loop through the render phases
     for (phaseIndex = RENDER_PHASE_FIRST; phaseIndex < finalPhase; phaseIndex++) {
         if (enableZBuffer) {
+#if SILHOUETTE
+            if (phaseIndex == RENDER_PHASE_SILHOUETTE && skipSilhouette) {
+                continue;
+            }
+#endif
             // Get the render phase information.
             renderPhase = &sRenderPhases[phaseIndex];
             startLayer  = renderPhase->startLayer;
@@ -291,7 +373,7 @@ void geo_process_master_list_sub(struct GraphNodeMasterList *node) {
             gDPSetRenderMode(tempGfxHead++, mode1List->modes[currLayer],
                                                  mode2List->modes[currLayer]);
 #else
-            if (phaseIndex == RENDER_PHASE_NON_SILHOUETTE) {
+            if (phaseIndex == RENDER_PHASE_NON_SILHOUETTE && !skipSilhouette) {
                 // To properly cover the silhouette, disable AA.
                 // The silhouette model does not have AA due to the hack used to prevent triangle overlap.
                 gDPSetRenderMode(tempGfxHead++, (mode1List->modes[currLayer] & ~IM_RD),
@@ -441,7 +523,9 @@ void geo_process_master_list(struct GraphNodeMasterList *node) {
  * Process a perspective projection node.
  */
 void geo_process_perspective(struct GraphNodePerspective *node) {
-    if (node->fnNode.func != NULL) {
+    // Switch functions read the object being drawn, which a compound segment isn't.
+    assert(gCurCompoundSegment == NULL || node->fnNode.func == NULL, "Switch case node in a compound segment model");
+    if (node->fnNode.func != NULL && gCurCompoundSegment == NULL) {
         node->fnNode.func(GEO_CONTEXT_RENDER, &node->fnNode.node, gMatStack[gMatStackIndex]);
     }
     if (node->fnNode.node.children != NULL) {
@@ -517,7 +601,9 @@ void geo_process_switch(struct GraphNodeSwitchCase *node) {
     struct GraphNode *selectedChild = node->fnNode.node.children;
     s32 i;
 
-    if (node->fnNode.func != NULL) {
+    // Switch functions read the object being drawn, which a compound segment isn't.
+    assert(gCurCompoundSegment == NULL || node->fnNode.func == NULL, "Switch case node in a compound segment model");
+    if (node->fnNode.func != NULL && gCurCompoundSegment == NULL) {
         node->fnNode.func(GEO_CONTEXT_RENDER, &node->fnNode.node, gMatStack[gMatStackIndex]);
     }
     for (i = 0; selectedChild != NULL && node->selectedCase > i; i++) {
@@ -530,6 +616,15 @@ void geo_process_switch(struct GraphNodeSwitchCase *node) {
 
 Mat4 gCameraTransform;
 
+// The camera-facing rotation of a billboard only depends on the camera, its roll and the object's scale.
+// Billboards sharing those (rings of coins, flames...) reuse the last converted rotation and only compute their translation.
+static struct {
+    Mat4 mtxf;
+    Mtx *mtx;
+    Vec3f scale;
+    s16 roll;
+} sBillboardCache;
+
 Lights1 defaultLight = gdSPDefLights1(
     0x3F, 0x3F, 0x3F, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00
 );
@@ -562,7 +657,12 @@ void geo_process_camera(struct GraphNodeCamera *node) {
     Mtx *rollMtx = alloc_display_list(sizeof(*rollMtx));
     Mtx *viewMtx = alloc_display_list(sizeof(Mtx));
 
-    if (node->fnNode.func != NULL) {
+    // The camera transform is about to change, so previously computed billboard rotations are stale.
+    sBillboardCache.mtx = NULL;
+
+    // Switch functions read the object being drawn, which a compound segment isn't.
+    assert(gCurCompoundSegment == NULL || node->fnNode.func == NULL, "Switch case node in a compound segment model");
+    if (node->fnNode.func != NULL && gCurCompoundSegment == NULL) {
         node->fnNode.func(GEO_CONTEXT_RENDER, &node->fnNode.node, gMatStack[gMatStackIndex]);
     }
     mtxf_rotate_xy(rollMtx, node->rollScreen);
@@ -570,6 +670,9 @@ void geo_process_camera(struct GraphNodeCamera *node) {
     gSPMatrix(gDisplayListHead++, VIRTUAL_TO_PHYSICAL(rollMtx), G_MTX_PROJECTION | G_MTX_MUL | G_MTX_NOPUSH);
 
     mtxf_lookat(gCameraTransform, node->pos, node->focus, node->roll);
+#ifdef SILHOUETTE_VISIBILITY_CHECK
+    update_silhouette_visibility(node->pos);
+#endif
 
     // Calculate the lookAt
 #ifdef F3DEX_GBI_2
@@ -681,6 +784,7 @@ void geo_process_scale(struct GraphNodeScale *node) {
 void geo_process_billboard(struct GraphNodeBillboard *node) {
     Vec3f translation;
     Vec3f scale = { 1.0f, 1.0f, 1.0f };
+    s16 roll = gCurGraphNodeCamera->roll;
 
     vec3s_to_vec3f(translation, node->translation);
 
@@ -690,9 +794,32 @@ void geo_process_billboard(struct GraphNodeBillboard *node) {
         vec3f_copy(scale, gCurGraphNodeObject->scale);
     }
 
-    mtxf_billboard(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex], translation, scale, gCurGraphNodeCamera->roll);
+    if (sBillboardCache.mtx != NULL && sBillboardCache.roll == roll
+        && sBillboardCache.scale[0] == scale[0]
+        && sBillboardCache.scale[1] == scale[1]
+        && sBillboardCache.scale[2] == scale[2]) {
+        // Same rotation as the previous billboard, only the translation needs to be computed.
+        Mtx *mtx = alloc_display_list(sizeof(*mtx));
+        f32 *dest = (f32 *) gMatStack[gMatStackIndex + 1];
+
+        memcpy(dest, sBillboardCache.mtxf, sizeof(Vec4f) * 3);
+        vec3f_sum(&dest[12], translation, gMatStack[gMatStackIndex][3]);
+        dest[15] = 1.0f;
+
+        gMatStackIndex++;
+        mtx_copy_with_translation_fast((s16 *) mtx, (s16 *) sBillboardCache.mtx, &dest[12]);
+        gMatStackFixed[gMatStackIndex] = mtx;
+    } else {
+        mtxf_billboard(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex], translation, scale, roll);
+
+        inc_mat_stack();
+
+        mtxf_copy(sBillboardCache.mtxf, gMatStack[gMatStackIndex]);
+        sBillboardCache.mtx = gMatStackFixed[gMatStackIndex];
+        vec3f_copy(sBillboardCache.scale, scale);
+        sBillboardCache.roll = roll;
+    }
 
-    inc_mat_stack();
     append_dl_and_return((struct GraphNodeDisplayList *)node);
 }
 
@@ -712,7 +839,9 @@ void geo_process_display_list(struct GraphNodeDisplayList *node) {
  * the list is generated on the fly by a function.
  */
 void geo_process_generated_list(struct GraphNodeGenerated *node) {
-    if (node->fnNode.func != NULL) {
+    // Same as for switch case nodes.
+    assert(gCurCompoundSegment == NULL || node->fnNode.func == NULL, "Generated list node in a compound segment model");
+    if (node->fnNode.func != NULL && gCurCompoundSegment == NULL) {
         Gfx *list = node->fnNode.func(GEO_CONTEXT_RENDER, &node->fnNode.node, (struct AllocOnlyPool *) gMatStack[gMatStackIndex]);
 
         if (list != NULL) {
@@ -1042,6 +1171,11 @@ void geo_process_object(struct Object *node) {
         // Maintain throw matrix pointer if the game is paused as it won't be updated.
         Mat4 *oldThrowMatrix = (sCurrPlayMode == PLAY_MODE_PAUSED) ? node->header.gfx.throwMatrix : NULL;
 
+        // Clock movers far from Mario aren't kept up to date, so evaluate their angle here.
+        if (noThrowMatrix && (node->oFlags & OBJ_FLAG_CLOCK_MOVER)) {
+            obj_get_clock_mover_angle(node, node->header.gfx.angle);
+        }
+
         // If the throw matrix is null and the object is invisible, there is no need
         // to update billboarding, scale, rotation, etc. 
         // This still updates translation since it is needed for sound.
@@ -1093,10 +1227,104 @@ void geo_process_object(struct Object *node) {
     }
 }
 
+#ifdef VISUAL_DEBUG
+void visualise_compound_segment_hitbox(struct CompoundSegment *segment) {
+    struct ObjectHitbox *hitbox = segment->hitbox;
+    Vec3f bnds1, bnds2;
+
+    if (hitbox != NULL) {
+        f32 downOffset = segment->gfx.scale[1] * hitbox->downOffset;
+
+        vec3f_set(bnds1, segment->gfx.pos[0], (segment->gfx.pos[1] - downOffset), segment->gfx.pos[2]);
+        vec3f_set(bnds2, segment->gfx.scale[0] * hitbox->radius, (segment->gfx.scale[1] * hitbox->height) - downOffset,
+                  segment->gfx.scale[0] * hitbox->radius);
+        debug_box_color(COLOR_RGBA32_DEBUG_HITBOX);
+        debug_box(bnds1, bnds2, (DEBUG_SHAPE_CYLINDER));
+        vec3f_set(bnds2, segment->gfx.scale[0] * hitbox->hurtboxRadius, segment->gfx.scale[1] * hitbox->hurtboxHeight,
+                  segment->gfx.scale[0] * hitbox->hurtboxRadius);
+        debug_box_color(COLOR_RGBA32_DEBUG_HURTBOX);
+        debug_box(bnds1, bnds2, (DEBUG_SHAPE_CYLINDER));
+    }
+}
+#endif
+
+/**
+ * Process a segment of a compound actor. Same as geo_process_object, except that
+ * the segment has no children and takes its animation flag from its owner.
+ */
+void geo_process_compound_segment(struct CompoundSegment *segment, s32 hasAnimation) {
+    struct GraphNodeObject *node = &segment->gfx;
+
+    if (!(node->node.flags & GRAPH_RENDER_ACTIVE)
+        || (node->node.flags & GRAPH_RENDER_INVISIBLE)
+        || node->sharedChild == NULL) {
+        return;
+    }
+
+    if (node->node.flags & GRAPH_RENDER_BILLBOARD) {
+        mtxf_billboard(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex],
+                       node->pos, node->scale, gCurGraphNodeCamera->roll);
+    } else {
+        mtxf_rotate_zxy_and_translate(gMatStack[gMatStackIndex + 1], node->pos, node->angle);
+        mtxf_scale_vec3f(gMatStack[gMatStackIndex + 1], gMatStack[gMatStackIndex + 1], node->scale);
+    }
+
+    node->throwMatrix = &gMatStack[++gMatStackIndex];
+    linear_mtxf_mul_vec3f_and_translate(gCameraTransform, node->cameraToObject, (*node->throwMatrix)[3]);
+
+    if (node->animInfo.curAnim != NULL) {
+        geo_set_animation_globals(&node->animInfo, hasAnimation);
+    }
+
+    if (obj_is_in_view(node)) {
+        gMatStackIndex--;
+        inc_mat_stack();
+
+#ifdef VISUAL_DEBUG
+        if (hitboxView) visualise_compound_segment_hitbox(segment);
+#endif
+        gCurGraphNodeObject = node;
+        gCurCompoundSegment = segment;
+        node->sharedChild->parent = &node->node;
+        geo_process_node_and_siblings(node->sharedChild);
+        node->sharedChild->parent = NULL;
+        gCurCompoundSegment = NULL;
+        gCurGraphNodeObject = NULL;
+    }
+
+    gMatStackIndex--;
+    gCurrAnimType = ANIM_TYPE_NONE;
+    node->throwMatrix = NULL;
+}
+
+/**
+ * Process the segments of every compound actor whose owner is shown in the current area.
+ */
+void geo_process_compound_actors(void) {
+    struct CompoundActor *compound;
+    s32 i;
+
+    for (compound = gCompoundActorList; compound != NULL; compound = compound->next) {
+        struct Object *owner = compound->owner;
+
+        if (owner->header.gfx.areaIndex != gCurGraphNodeRoot->areaIndex
+            || !compound_actor_is_shown(compound)) {
+            continue;
+        }
+
+        s32 hasAnimation = (owner->header.gfx.node.flags & GRAPH_RENDER_HAS_ANIMATION) != 0;
+
+        for (i = 0; i < compound->numSegments; i++) {
+            geo_process_compound_segment(&compound->segments[i], hasAnimation);
+        }
+    }
+}
+
 /**
  * Process an object parent node. Temporarily assigns itself as the parent of
  * the subtree rooted at 'sharedChild' and processes the subtree, after which the
  * actual children are be processed. (in practice they are null though)
+ * Compound actor segments aren't in the object graph, so they're drawn here too.
  */
 void geo_process_object_parent(struct GraphNodeObjectParent *node) {
     if (node->sharedChild != NULL) {
@@ -1107,6 +1335,7 @@ void geo_process_object_parent(struct GraphNodeObjectParent *node) {
     if (node->node.children != NULL) {
         geo_process_node_and_siblings(node->node.children);
     }
+    geo_process_compound_actors();
 }
 
 /**
@@ -1121,7 +1350,9 @@ void geo_process_held_object(struct GraphNodeHeldObject *node) {
     gSPLookAt(gDisplayListHead++, gCurLookAt);
 #endif
 
-    if (node->fnNode.func != NULL) {
+    // Switch functions read the object being drawn, which a compound segment isn't.
+    assert(gCurCompoundSegment == NULL || node->fnNode.func == NULL, "Switch case node in a compound segment model");
+    if (node->fnNode.func != NULL && gCurCompoundSegment == NULL) {
         node->fnNode.func(GEO_CONTEXT_RENDER, &node->fnNode.node, gMatStack[gMatStackIndex]);
     }
     if (node->objNode != NULL && node->objNode->header.gfx.sharedChild != NULL) {
@@ -1235,6 +1466,31 @@ void geo_process_node_and_siblings(struct GraphNode *firstNode) {
     } while (iterateChildren && (curGraphNode = curGraphNode->next) != firstNode);
 }
 
+/**
+ * Whether the scene draws a background (skybox or solid color) near the top of the graph,
+ * which covers the entire viewport and makes clearing it redundant.
+ */
+static s32 geo_has_background(struct GraphNode *firstNode, s32 depth) {
+    struct GraphNode *curGraphNode = firstNode;
+
+    if (curGraphNode == NULL) {
+        return FALSE;
+    }
+
+    do {
+        if (curGraphNode->flags & GRAPH_RENDER_ACTIVE) {
+            if (curGraphNode->type == GRAPH_NODE_TYPE_BACKGROUND) {
+                return TRUE;
+            }
+            if (depth > 0 && geo_has_background(curGraphNode->children, depth - 1)) {
+                return TRUE;
+            }
+        }
+    } while ((curGraphNode = curGraphNode->next) != firstNode);
+
+    return FALSE;
+}
+
 /**
  * Process a root node. This is the entry point for processing the scene graph.
  * The root node itself sets up the viewport, then all its children are processed
@@ -1252,20 +1508,38 @@ void geo_process_root(struct GraphNodeRoot *node, Vp *b, Vp *c, s32 clearColor)
 
         gMatStackIndex = 0;
         gCurrAnimType = ANIM_TYPE_NONE;
+        // The cached billboard matrix was allocated in the previous frame's display list heap.
+        sBillboardCache.mtx = NULL;
         vec3s_set(viewport->vp.vtrans, node->x * 4, node->y * 4, 511);
         vec3s_set(viewport->vp.vscale, node->width * 4, node->height * 4, 511);
 
+        // Master list -> ortho projection -> background
+        s32 hasBackground = (b != NULL || c != NULL) && geo_has_background(node->node.children, 2);
+
         if (b != NULL) {
-            clear_framebuffer(clearColor);
+            if (hasBackground) {
+                clear_framebuffer_outside_viewport(b, clearColor);
+            } else {
+                clear_framebuffer(clearColor);
+            }
             make_viewport_clip_rect(b);
             *viewport = *b;
         }
 
         else if (c != NULL) {
-            clear_framebuffer(clearColor);
+            if (hasBackground) {
+                clear_framebuffer_outside_viewport(c, clearColor);
+            } else {
+                clear_framebuffer(clearColor);
+            }
             make_viewport_clip_rect(c);
         }
 
+#ifdef ALTERNATE_ZBUFFER_RANGES
+        viewport->vp.vscale[2] = G_MAXZ / 4;
+        viewport->vp.vtrans[2] = gZBufferNearRange ? (G_MAXZ / 4) : (G_MAXZ - (G_MAXZ / 4));
+#endif
+
         mtxf_identity(gMatStack[gMatStackIndex]);
         mtxf_to_mtx(initialMatrix, gMatStack[gMatStackIndex]);
         gMatStackFixed[gMatStackIndex] = initialMatrix;
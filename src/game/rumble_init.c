@@ -14,17 +14,44 @@ OSPfs gRumblePakPfs;
 
 OSMesg gRumblePakSchedulerMesgBuf[1];
 OSMesgQueue gRumblePakSchedulerMesgQueue;
-OSMesg gRumbleThreadVIMesgBuf[1];
+OSMesg gRumbleThreadVIMesgBuf[2];
 OSMesgQueue gRumbleThreadVIMesgQueue;
 
 struct RumbleData gRumbleDataQueue[3];
 struct RumbleSettings gCurrRumbleSettings;
 
+enum RumbleMotorStates {
+    RUMBLE_MOTOR_STOP,
+    RUMBLE_MOTOR_START,
+    RUMBLE_MOTOR_UNKNOWN,
+};
+
 s32 sRumblePakThreadActive = FALSE;
 s32 sRumblePakActive = FALSE;
 s32 sRumblePakErrorCount = 0;
 s32 gRumblePakTimer = 0;
 
+// Messages that wake the rumble thread up. They carry no work themselves: a VI is counted by gNumVblanks
+// and a motor update by sRumbleMotorUpdateRequested, so nothing is lost if the queue is full.
+#define VRTC 0x56525443 // Once per VI, to run the rumble logic.
+#define MOTR 0x4D4F5452 // Right after the controllers were read, to send the motor command to the pak.
+
+// How often to look for a rumble pak while none is found, doubling up to the max after every failed attempt.
+#define RUMBLE_PAK_PROBE_INTERVAL     60
+#define RUMBLE_PAK_PROBE_INTERVAL_MAX (RUMBLE_PAK_PROBE_INTERVAL * 8)
+
+// The VI-rate rumble logic only decides what the motor should be doing. The SI transactions themselves are
+// issued by process_rumble_pak_motor when the game thread has just read the controllers, so they don't
+// compete with the next read.
+static volatile s32 sRumbleMotorCommand = RUMBLE_MOTOR_STOP;
+static s32 sRumbleMotorState = RUMBLE_MOTOR_UNKNOWN;
+static volatile s32 sRumblePakInitRequested = TRUE;
+static u32 sRumblePakInitVblank = 0;
+static u32 sRumblePakProbeInterval = RUMBLE_PAK_PROBE_INTERVAL;
+static volatile s32 sRumbleMotorUpdateRequested = FALSE;
+// The last VI the rumble logic ran for.
+static u32 sRumbleVblank = 0;
+
 void init_rumble_pak_scheduler_queue(void) {
     osCreateMesgQueue(&gRumblePakSchedulerMesgQueue, gRumblePakSchedulerMesgBuf, 1);
     osSendMesg(&gRumblePakSchedulerMesgQueue, (OSMesg) 0, OS_MESG_NOBLOCK);
@@ -35,40 +62,25 @@ void block_until_rumble_pak_free(void) {
     osRecvMesg(&gRumblePakSchedulerMesgQueue, &msg, OS_MESG_BLOCK);
 }
 
+/**
+ * Takes the rumble pak scheduler queue if it's free, without waiting for the rumble thread.
+ * Returns whether it was taken.
+ */
+s32 try_take_rumble_pak_control(void) {
+    OSMesg msg;
+    return (osRecvMesg(&gRumblePakSchedulerMesgQueue, &msg, OS_MESG_NOBLOCK) == 0);
+}
+
 void release_rumble_pak_control(void) {
     osSendMesg(&gRumblePakSchedulerMesgQueue, (OSMesg) 0, OS_MESG_NOBLOCK);
 }
 
 static void start_rumble(void) {
-    if (!sRumblePakActive) {
-        return;
-    }
-
-    block_until_rumble_pak_free();
-
-    if (!osMotorStart(&gRumblePakPfs)) {
-        sRumblePakErrorCount = 0;
-    } else {
-        sRumblePakErrorCount++;
-    }
-
-    release_rumble_pak_control();
+    sRumbleMotorCommand = RUMBLE_MOTOR_START;
 }
 
 static void stop_rumble(void) {
-    if (!sRumblePakActive) {
-        return;
-    }
-
-    block_until_rumble_pak_free();
-
-    if (!osMotorStop(&gRumblePakPfs)) {
-        sRumblePakErrorCount = 0;
-    } else {
-        sRumblePakErrorCount++;
-    }
-
-    release_rumble_pak_control();
+    sRumbleMotorCommand = RUMBLE_MOTOR_STOP;
 }
 
 static void update_rumble_pak(void) {
@@ -104,7 +116,7 @@ static void update_rumble_pak(void) {
 
         if (gCurrRumbleSettings.slip >= 5) {
             start_rumble();
-        } else if ((gCurrRumbleSettings.slip >= 2) && (gNumVblanks % gCurrRumbleSettings.vibrate == 0)) {
+        } else if ((gCurrRumbleSettings.slip >= 2) && (sRumbleVblank % gCurrRumbleSettings.vibrate == 0)) {
             start_rumble();
         } else {
             stop_rumble();
@@ -211,43 +223,104 @@ void queue_rumble_submerged(void) {
     gCurrRumbleSettings.vibrate = 4;
 }
 
+/**
+ * Sends the motor command chosen by update_rumble_pak to the rumble pak, or retries initializing the pak.
+ * Must only be called while holding the rumble pak scheduler queue. The motor is only written to when its
+ * state changes, or after an error.
+ */
+static void process_rumble_pak_motor(void) {
+    s32 command;
+    s32 error;
+
+    if (!sRumblePakActive) {
+        if (sRumblePakInitRequested) {
+            sRumblePakInitRequested = FALSE;
+            sRumblePakProbeInterval = RUMBLE_PAK_PROBE_INTERVAL;
+        } else if ((gNumVblanks - sRumblePakInitVblank) < sRumblePakProbeInterval) {
+            return;
+        }
+
+        sRumblePakInitVblank = gNumVblanks;
+        sRumblePakActive = osMotorInitEx(&gSIEventMesgQueue, &gRumblePakPfs, gPlayer1Controller->port) < 1;
+        sRumblePakErrorCount = 0;
+        sRumbleMotorState = RUMBLE_MOTOR_UNKNOWN;
+
+        if (!sRumblePakActive) {
+            // Most likely there's no pak inserted, so don't keep spending SI time on looking for one.
+            sRumblePakProbeInterval = MIN(sRumblePakProbeInterval * 2, RUMBLE_PAK_PROBE_INTERVAL_MAX);
+            return;
+        }
+
+        sRumblePakProbeInterval = RUMBLE_PAK_PROBE_INTERVAL;
+    }
+
+    command = sRumbleMotorCommand;
+    if (command == sRumbleMotorState) {
+        return;
+    }
+
+    error = (command == RUMBLE_MOTOR_START) ? osMotorStart(&gRumblePakPfs) : osMotorStop(&gRumblePakPfs);
+
+    if (!error) {
+        sRumbleMotorState = command;
+        sRumblePakErrorCount = 0;
+    } else {
+        sRumbleMotorState = RUMBLE_MOTOR_UNKNOWN;
+        if (++sRumblePakErrorCount >= 30) {
+            sRumblePakActive = FALSE;
+        }
+    }
+}
+
+/**
+ * Runs the rumble logic once for every VI since it last ran, then sends the motor command to the pak
+ * if the controllers were read since.
+ */
+static void process_rumble_thread_work(void) {
+    u32 numVblanks = gNumVblanks;
+
+    while (sRumbleVblank != numVblanks) {
+        sRumbleVblank++;
+
+        update_rumble_data_queue();
+        update_rumble_pak();
+
+        if (gRumblePakTimer > 0) {
+            gRumblePakTimer--;
+        }
+    }
+
+    if (sRumbleMotorUpdateRequested) {
+        sRumbleMotorUpdateRequested = FALSE;
+        block_until_rumble_pak_free();
+        process_rumble_pak_motor();
+        release_rumble_pak_control();
+    }
+}
+
 static void thread6_rumble_loop(UNUSED void *arg) {
     OSMesg msg;
 
 	osSyncPrintf("start motor thread\n");
     cancel_rumble();
+    sRumbleVblank = gNumVblanks;
 
     sRumblePakThreadActive = TRUE;
 	osSyncPrintf("go motor thread\n");
 
     while (TRUE) {
-        // Block until VI
+        // Block until VI or until the controllers were read
         osRecvMesg(&gRumbleThreadVIMesgQueue, &msg, OS_MESG_BLOCK);
 
-        update_rumble_data_queue();
-        update_rumble_pak();
-
-        if (sRumblePakActive) {
-            if (sRumblePakErrorCount >= 30) {
-                sRumblePakActive = FALSE;
-            }
-        } else if (gNumVblanks % 60 == 0) {
-            sRumblePakActive = osMotorInitEx(&gSIEventMesgQueue, &gRumblePakPfs, gPlayer1Controller->port) < 1;
-            sRumblePakErrorCount = 0;
-        }
-
-        if (gRumblePakTimer > 0) {
-            gRumblePakTimer--;
-        }
+        process_rumble_thread_work();
     }
 }
 
 void cancel_rumble(void) {
-    sRumblePakActive = osMotorInitEx(&gSIEventMesgQueue, &gRumblePakPfs, gPlayer1Controller->port) < 1;
-
-    if (sRumblePakActive) {
-        osMotorStop(&gRumblePakPfs);
-    }
+    // Reinitialize the pak and stop the motor once the controllers have been read.
+    sRumblePakActive = FALSE;
+    sRumblePakInitRequested = TRUE;
+    sRumbleMotorCommand = RUMBLE_MOTOR_STOP;
 
     gRumbleDataQueue[0].comm = 0;
     gRumbleDataQueue[1].comm = 0;
@@ -260,13 +333,11 @@ void cancel_rumble(void) {
 }
 
 void create_thread_6(void) {
-    osCreateMesgQueue(&gRumbleThreadVIMesgQueue, gRumbleThreadVIMesgBuf, 1);
+    osCreateMesgQueue(&gRumbleThreadVIMesgQueue, gRumbleThreadVIMesgBuf, ARRAY_COUNT(gRumbleThreadVIMesgBuf));
     osCreateThread(&gRumblePakThread, THREAD_6_RUMBLE, thread6_rumble_loop, NULL, gThread6Stack + THREAD6_STACK, 30);
     osStartThread(&gRumblePakThread);
 }
 
-#define VRTC 0x56525443
-
 void rumble_thread_update_vi(void) {
     if (!sRumblePakThreadActive) {
         return;
@@ -275,6 +346,20 @@ void rumble_thread_update_vi(void) {
     osSendMesg(&gRumbleThreadVIMesgQueue, (OSMesg) VRTC, OS_MESG_NOBLOCK);
 }
 
+/**
+ * Has the rumble thread send its motor command to the pak. Called right after the controllers were read,
+ * when the SI won't be needed again until the next frame.
+ */
+void rumble_thread_update_motor(void) {
+    if (!sRumblePakThreadActive) {
+        return;
+    }
+
+    sRumbleMotorUpdateRequested = TRUE;
+    osSendMesg(&gRumbleThreadVIMesgQueue, (OSMesg) MOTR, OS_MESG_NOBLOCK);
+}
+
 #undef VRTC
+#undef MOTR
 
 #endif
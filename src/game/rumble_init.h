@@ -11,6 +11,7 @@ extern s32 gRumblePakTimer;
 
 void init_rumble_pak_scheduler_queue(void);
 void block_until_rumble_pak_free(void);
+s32  try_take_rumble_pak_control(void);
 void release_rumble_pak_control(void);
 void queue_rumble_data(s16 time, s16 level);
 void queue_rumble_decay(s16 decay);
@@ -21,6 +22,7 @@ void queue_rumble_submerged(void);
 void cancel_rumble(void);
 void create_thread_6(void);
 void rumble_thread_update_vi(void);
+void rumble_thread_update_motor(void);
 
 #endif // ENABLE_RUMBLE
 
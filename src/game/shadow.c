@@ -207,7 +207,7 @@ Gfx *create_shadow_below_xyz(Vec3f pos, s16 shadowScale, u8 shadowSolidity, s8 s
         // The object is Mario and has a referenced floor.
         floor       = gMarioState->floor;
         floorHeight = gMarioState->floorHeight;
-    } else if (notHeldObj && (gCurGraphNodeObject != &gMirrorMario) && obj->oFloor) {
+    } else if (notHeldObj && (gCurGraphNodeObject != &gMirrorMario) && gCurCompoundSegment == NULL && obj->oFloor) {
         // The object is not Mario but has a referenced floor.
         //! Some objects only get their oFloor from bhv_init_room, which skips dynamic floors.
         floor       = obj->oFloor;
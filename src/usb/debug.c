@@ -9,6 +9,7 @@ https://github.com/buu342/N64-UNFLoader
 #ifndef LIBDRAGON
     #include <ultra64.h> 
     #include <PR/os_internal.h> // Needed for Crash's Linux toolchain
+    #include "boot/print_buffer.h"
 #else
     #include <libdragon.h>
     #include <stdio.h>
@@ -345,6 +346,20 @@ https://github.com/buu342/N64-UNFLoader
         usbMesg msg;
         va_list args;
         
+        // Queue the string in the print buffer instead of waiting on the USB thread. The
+        // print buffer thread (THREAD_10) sends it once nothing else needs the CPU. Queueing
+        // copies the text with interrupts disabled, which is enough on the single core.
+        // Crash reports are still sent right away, since nothing may be left to drain them.
+        #ifdef BUFFERED_DEBUG_PRINT
+            if (osGetThreadId(NULL) != FAULT_THREAD_ID)
+            {
+                va_start(args, message);
+                _Printf(&print_buffer_write, NULL, message, args);
+                va_end(args);
+                return;
+            }
+        #endif
+        
         // use the internal libultra printf function to format the string
         va_start(args, message);
         #ifndef LIBDRAGON
@@ -7,12 +7,15 @@ import struct
 import subprocess
 import sys
 
+import seq_compiler
+
 TYPE_CTL = 1
 TYPE_TBL = 2
 TYPE_SEQ = 3
 
 STACK_TRACES = False
 DUMP_INDIVIDUAL_BINS = False
+PACK_SAMPLES = True
 ENDIAN_MARKER = ">"
 WORD_BYTES = 4
 
@@ -29,6 +32,8 @@ class Aifc:
         self.loop = loop
         self.used = False
         self.offset = None
+        self.trimmed = 0
+        self.tail = b""
 
 
 class SampleBank:
@@ -37,6 +42,8 @@ class SampleBank:
         self.uses = []
         self.index = None
         self.entries = entries
+        self.trimmed_bytes = 0
+        self.shared_bytes = 0
         self.name_to_entry = {}
         for e in entries:
             self.name_to_entry[e.name] = e
@@ -574,9 +581,7 @@ def serialize_ctl(bank, base_ser, is_shindou):
         # Loop
         loop_addr_buf.append(pack("P", ser.size))
         if aifc.loop is None:
-            assert sample_len % 9 in [0, 1]
-            end = sample_len // 9 * 16 + (sample_len % 2) + (sample_len % 9)
-            ser.add(pack("IIiI", 0, end, 0, 0))
+            ser.add(pack("IIiI", 0, sample_end(aifc), 0, 0))
         else:
             ser.add(pack("IIiI", aifc.loop.start, aifc.loop.end, aifc.loop.count, 0))
             assert aifc.loop.count != 0
@@ -663,15 +668,100 @@ def serialize_ctl(bank, base_ser, is_shindou):
     )
 
 
-def serialize_tbl(sample_bank, ser, is_shindou):
+def sample_end(aifc):
+    if aifc.loop is not None:
+        return aifc.loop.end
+    sample_len = len(aifc.data)
+    assert sample_len % 9 in [0, 1]
+    return sample_len // 9 * 16 + (sample_len % 2) + (sample_len % 9)
+
+
+def keep_sample_tails(sample_banks, is_shindou):
+    """
+    The synthesis decodes whole ADPCM frames up to a sample's end, and some samples end partway
+    into a frame they only have the first byte of. The rest of it is decoded from whatever comes
+    after the sample in the .tbl, which moves once samples are packed. Those bytes are taken from
+    the unpacked layout, and written after the sample.
+    """
+    ser = GarbageSerializer()
+    positions = []
+    for sample_bank in sample_banks:
+        base_addr = ser.size
+        serialize_tbl(sample_bank, ser, is_shindou, pack=False)
+        positions.extend((aifc, base_addr + aifc.offset) for aifc in sample_bank.entries if aifc.used)
+    data = ser.finish()
+
+    for aifc, pos in positions:
+        read_len = (sample_end(aifc) + 15) // 16 * 9
+        if read_len > len(aifc.data):
+            tail_len = read_len - len(aifc.data)
+            # Past the last bank there's only padding.
+            aifc.tail = data[pos + len(aifc.data) : pos + read_len].ljust(tail_len, b"\0")
+
+
+def trim_sample(aifc):
+    """
+    Drops the ADPCM frames after a sample's loop end. Looped notes go back to the loop
+    start once they reach the end (the loop count is only ever checked against 0), and
+    the synthesis never decodes past the frame holding the last sample before it.
+    """
+    if aifc.loop is None or aifc.loop.count == 0:
+        return
+    keep = (aifc.loop.end + 15) // 16 * 9
+    if keep < len(aifc.data):
+        aifc.trimmed = len(aifc.data) - keep
+        aifc.data = aifc.data[:keep]
+
+
+class SharedSamples:
+    """
+    On US/JP/EU the game reads samples straight from the .tbl in ROM, at their sample bank's
+    address plus their offset, so identical samples can be shared across sample banks. Each is
+    written once, to the last sample bank that uses it, and earlier banks point forward to that
+    copy, so their offsets never go negative. SH may copy a single sample bank to RAM (see
+    load_sh.c), so samples are only shared within a bank there.
+    """
+
+    def __init__(self, sample_banks):
+        self.owners = {}
+        self.positions = {}
+        self.forward_refs = []
+        for sample_bank in sample_banks:
+            for aifc in sample_bank.entries:
+                if aifc.used:
+                    self.owners[aifc.data + aifc.tail] = sample_bank
+
+    def resolve_forward_refs(self):
+        for aifc, base_addr in self.forward_refs:
+            aifc.offset = self.positions[aifc.data + aifc.tail] - base_addr
+            assert aifc.offset > 0
+
+
+def serialize_tbl(sample_bank, ser, is_shindou, pack=True, shared=None):
+    pack = pack and PACK_SAMPLES
     ser.reset_garbage_pos()
     base_addr = ser.size
+    sample_offsets = {}
     for aifc in sample_bank.entries:
         if not aifc.used:
             continue
+        sample_bank.trimmed_bytes += aifc.trimmed
+        data = aifc.data + aifc.tail
+        if pack and data in sample_offsets:
+            aifc.offset = sample_offsets[data]
+            sample_bank.shared_bytes += len(aifc.data)
+            continue
+        if pack and shared is not None and shared.owners[data] is not sample_bank:
+            # Written by a later sample bank, the offset is filled in once it has been.
+            shared.forward_refs.append((aifc, base_addr))
+            sample_bank.shared_bytes += len(aifc.data)
+            continue
         ser.align(16)
         aifc.offset = ser.size - base_addr
-        ser.add(aifc.data)
+        sample_offsets[data] = aifc.offset
+        if shared is not None:
+            shared.positions[data] = ser.size
+        ser.add(data)
     ser.align(2)
     if is_shindou and sample_bank.index not in [4, 10]:
         ser.align(16)
@@ -771,6 +861,24 @@ def validate_and_normalize_sequence_json(json, bank_names, defines):
             validate(seq is None, "bad JSON type, expected null, array or object", key)
 
 
+def precompile_sequence(name, data, max_size):
+    """Appends a precompiled layer event stream to a sequence, if it compiles and fits."""
+    try:
+        events = seq_compiler.compile_sequence(data)
+    except seq_compiler.CompileError:
+        return data
+
+    # The footer must end the sequence exactly, so keep the total size a multiple of 16
+    # so that no alignment padding follows it.
+    start = align(len(data), 16)
+    if len(events) % 2 == 1:
+        start += 8
+    stream = seq_compiler.serialize_events(events, start)
+    if start + len(stream) > max_size:
+        return data
+    return data + b"\0" * (start - len(data)) + stream
+
+
 def write_sequences(
     inputs,
     out_filename,
@@ -780,6 +888,7 @@ def write_sequences(
     seq_json,
     defines,
     is_shindou,
+    precompile_max_size=None,
 ):
     bank_names = sorted(
         [os.path.splitext(os.path.basename(x))[0] for x in os.listdir(sound_bank_dir)]
@@ -847,7 +956,10 @@ def write_sequences(
             return
         ser.reset_garbage_pos()
         with open(name_to_fname[name], "rb") as f:
-            ser.add(f.read())
+            data = f.read()
+        if precompile_max_size is not None:
+            data = precompile_sequence(name, data, precompile_max_size)
+        ser.add(data)
         if is_shindou and name.startswith("17"):
             ser.align(16)
         else:
@@ -880,6 +992,7 @@ def write_sequences(
 def main():
     global STACK_TRACES
     global DUMP_INDIVIDUAL_BINS
+    global PACK_SAMPLES
     global ENDIAN_MARKER
     global WORD_BYTES
     need_help = False
@@ -930,6 +1043,8 @@ def main():
             DUMP_INDIVIDUAL_BINS = True
         elif a == "--print-samples":
             print_samples = True
+        elif a == "--no-sample-packing":
+            PACK_SAMPLES = False
         elif a == "--sequences":
             sequences_out_file = sys.argv[i + 1]
             sequences_header_out_file = sys.argv[i + 2]
@@ -946,6 +1061,13 @@ def main():
     defines_set = {d.split("=")[0] for d in defines}
     is_shindou = "VERSION_SH" in defines_set
 
+    precompile_max_size = None
+    if "PRECOMPILE_SEQUENCES" in defines_set and not (is_shindou or "VERSION_EU" in defines_set):
+        precompile_max_size = 0x7400
+        for d in defines:
+            if d.startswith("PRECOMPILE_SEQUENCES_MAX_SIZE="):
+                precompile_max_size = int(d.split("=")[1], 0)
+
     if sequences_out_file is not None and not need_help:
         write_sequences(
             args,
@@ -956,6 +1078,7 @@ def main():
             sequence_json,
             defines_set,
             is_shindou,
+            precompile_max_size,
         )
         sys.exit(0)
 
@@ -967,6 +1090,7 @@ def main():
             " [--cpp <preprocessor>]"
             " [-D <symbol>]"
             " [--stack-trace]"
+            " [--no-sample-packing]"
             " | --sequences <out sequence .bin> <out Shindou sequence header .bin> "
             "<out bank sets .bin> <sound bank dir> <sequences.json> <inputs...>".format(
                 sys.argv[0]
@@ -1053,15 +1177,25 @@ def main():
         sample_bank.index = sample_bank_index
         sample_bank_index += 1
 
+    if PACK_SAMPLES:
+        keep_sample_tails(sample_banks, is_shindou)
+        for sample_bank in sample_banks:
+            for entry in sample_bank.entries:
+                if entry.used:
+                    trim_sample(entry)
+
+    shared = None if is_shindou else SharedSamples(sample_banks)
     serialize_seqfile(
         tbl_data_out,
         tbl_data_header_out,
         sample_banks,
-        serialize_tbl,
+        lambda sample_bank, ser, is_shindou: serialize_tbl(sample_bank, ser, is_shindou, shared=shared),
         [x.sample_bank.index for x in banks],
         TYPE_TBL,
         is_shindou,
     )
+    if shared is not None:
+        shared.resolve_forward_refs()
 
     if DUMP_INDIVIDUAL_BINS:
         # Debug logic, may simplify diffing
@@ -1083,6 +1217,15 @@ def main():
         is_shindou,
     )
 
+    if PACK_SAMPLES:
+        for sample_bank in sample_banks:
+            if sample_bank.trimmed_bytes or sample_bank.shared_bytes:
+                print(
+                    "sample bank {}: trimmed 0x{:X} bytes past loop ends, shared 0x{:X} bytes".format(
+                        sample_bank.name, sample_bank.trimmed_bytes, sample_bank.shared_bytes
+                    )
+                )
+
     if print_samples:
         for sample_bank in sample_banks:
             for entry in sample_bank.entries:
@@ -0,0 +1,519 @@
+#!/usr/bin/env python3
+"""
+Bakes the global light into the vertex colors of static level geometry, so the RSP doesn't light it every frame.
+
+Level geometry is drawn with G_LIGHTING like everything else, so every vertex of it is lit by the global
+directional and ambient light, even though the result never changes. For every area model of a level
+(levels/<level>/areas/*/*/model.inc.c), this tool runs through the display lists that the area's geo layouts
+draw on opaque and alpha tested layers, and finds the vertex loads that are always lit by known light colors
+(the gsSPLightColor material commands). Those vertices get the lit color as their vertex color, and
+G_LIGHTING is cleared around their loads. The result is written to --out-dir with the same relative path,
+which the Makefile puts in front of the source tree in the include path.
+
+Vertices are left alone if they're loaded anywhere else: from display lists that objects or code could draw,
+from display lists a texture scroll patches, under texture generation or with unknown light colors.
+The light direction has to be the one the game uses (globalLightDirection in rendering_graph_node.c) and has to
+stay fixed in world space, which is why BAKE_LEVEL_LIGHTING=1 turns on WORLDSPACE_LIGHTING. It also assumes
+area geometry isn't rotated by its geo layout; display lists under rotating nodes are left alone.
+
+The lighting matches the RSP's within rounding: the ambient color plus the light color scaled by the dot
+product of the vertex normal and the normalized light direction, clamped to 255.
+
+Usage:
+  bake_level_lighting.py --out-dir build/us_n64/baked_lighting [--skip bob,wf] [--light-dir 0x28,0x28,0x28]
+  bake_level_lighting.py --report [--level bob]
+"""
+import argparse
+import glob
+import math
+import os
+import re
+import sys
+
+# Layers whose geometry is opaque, or alpha tested without blending.
+BAKED_LAYERS = {
+    "LAYER_FORCE",
+    "LAYER_OPAQUE",
+    "LAYER_OPAQUE_INTER",
+    "LAYER_OPAQUE_DECAL",
+    "LAYER_ALPHA",
+    "LAYER_ALPHA_DECAL",
+}
+
+# Geo nodes that rotate or animate what's under them, so their light direction isn't the world one.
+ROTATING_GEO_NODES = (
+    "GEO_ROTATION_NODE",
+    "GEO_ROTATE",
+    "GEO_TRANSLATE_ROTATE",
+    "GEO_BILLBOARD",
+    "GEO_ANIMATED_PART",
+    "GEO_HELD_OBJECT",
+)
+
+# Commands the G_LIGHTING state doesn't matter for, so it can stay cleared across them.
+LIGHTING_INDEPENDENT = ("gsSP1Triangle", "gsSP2Triangles", "gsSP1Quadrangle", "gsSPTexture", "gsSPLightColor")
+
+ARRAY_RE = re.compile(r"^((?:static\s+)?(?:const\s+)?(Vtx|Gfx)\s+(\w+)\s*\[[^\]]*\]\s*=\s*\{)(.*?)^\};", re.M | re.S)
+VTX_RE = re.compile(r"\{\s*\{\s*\{([^{}]*)\}\s*,\s*([^,{}]+),\s*\{([^{}]*)\}\s*,\s*\{([^{}]*)\}\s*\}\s*\}")
+CMD_RE = re.compile(r"^(\s*)(\w+)\s*\((.*)\)\s*,?\s*(//.*)?$")
+GEO_CMD_RE = re.compile(r"\b(GEO_\w+)\s*\(([^()]*)\)")
+VTX_ARG_RE = re.compile(r"^&?\s*(\w+)\s*(?:\+\s*(\w+)|\[\s*(\w+)\s*\])?$")
+IDENTIFIER_RE = re.compile(r"\b[A-Za-z_]\w*\b")
+
+UNKNOWN = None
+
+
+def parse_int(text):
+    return int(text.strip(), 0)
+
+
+def to_s8(value):
+    value &= 0xFF
+    return value - 0x100 if value >= 0x80 else value
+
+
+class Vertices:
+    def __init__(self, name, body):
+        self.name = name
+        self.body = body
+        self.entries = [m for m in VTX_RE.finditer(body)]
+        # Per vertex: the (light color, ambient color) it's always loaded with, or False once it can't be baked.
+        self.lights = [UNKNOWN] * len(self.entries)
+
+    def normal(self, i):
+        values = [parse_int(v) for v in self.entries[i].group(4).split(",")]
+        return [to_s8(v) for v in values[:3]], values[3]
+
+    def load(self, start, count, lights):
+        for i in range(start, min(start + count, len(self.entries))):
+            if lights is False or (self.lights[i] is not UNKNOWN and self.lights[i] != lights):
+                self.lights[i] = False
+            else:
+                self.lights[i] = lights
+
+    def bakeable(self, start, count):
+        loaded = self.lights[start:start + count]
+        return len(loaded) > 0 and all(lights not in (UNKNOWN, False) for lights in loaded)
+
+
+class DisplayList:
+    def __init__(self, name, header, body):
+        self.name = name
+        self.header = header
+        self.lines = body.split("\n")
+        self.commands = []  # (line index, command, args)
+        for index, line in enumerate(self.lines):
+            match = CMD_RE.match(line)
+            if match is not None:
+                self.commands.append((index, match.group(2), split_args(match.group(3))))
+
+
+def split_args(text):
+    args, depth, current = [], 0, ""
+    for c in text:
+        if c == "," and depth == 0:
+            args.append(current.strip())
+            current = ""
+            continue
+        depth += (c == "(") - (c == ")")
+        current += c
+    if current.strip():
+        args.append(current.strip())
+    return args
+
+
+def parse_vertex_arg(arg):
+    match = VTX_ARG_RE.match(arg.strip())
+    if match is None:
+        return None, 0
+    offset = match.group(2) or match.group(3) or "0"
+    return match.group(1), parse_int(offset)
+
+
+class State:
+    def __init__(self, lighting, texgen, light, ambient):
+        self.lighting = lighting
+        self.texgen = texgen
+        self.light = light
+        self.ambient = ambient
+
+    def key(self):
+        return (self.lighting, self.texgen, self.light, self.ambient)
+
+    def copy(self):
+        return State(*self.key())
+
+    def lights(self):
+        if self.lighting is True and self.texgen is False and self.light is not UNKNOWN and self.ambient is not UNKNOWN:
+            return (self.light, self.ambient)
+        return False
+
+
+def mode_flag(flags, name):
+    """Whether a geometry mode expression sets the flag, or UNKNOWN if it can't be told."""
+    if re.search(r"\b%s\b" % name, flags):
+        return True
+    if re.fullmatch(r"[\w\s|]*", flags) and not re.search(r"\b\d", flags):
+        return False
+    return UNKNOWN
+
+
+class ModelFile:
+    def __init__(self, path):
+        self.path = path
+        with open(path) as f:
+            self.text = f.read()
+        self.vertices = {}
+        self.display_lists = {}
+        self.spans = {}
+        for match in ARRAY_RE.finditer(self.text):
+            kind, name = match.group(2), match.group(3)
+            if kind == "Vtx":
+                self.vertices[name] = Vertices(name, match.group(4))
+            else:
+                self.display_lists[name] = DisplayList(name, match.group(1), match.group(4))
+            self.spans[name] = match.span(4)
+        self.walked = set()
+        self.vertex_loads = 0
+        self.baked_loads = 0
+        self.lit_vertices = 0
+        self.baked_vertices = 0
+
+    def walk(self, name, state):
+        """Run through a display list from the given state, recording its vertex loads. Returns the end state."""
+        dl = self.display_lists[name]
+        key = (name, state.key())
+        if key in self.walked:
+            return self.end_state(name, state)
+        self.walked.add(key)
+
+        state = state.copy()
+        for _, cmd, args in dl.commands:
+            if cmd == "gsSPVertex" and len(args) == 3:
+                array, offset = parse_vertex_arg(args[0])
+                if array in self.vertices:
+                    self.vertices[array].load(offset, parse_int(args[1]), state.lights())
+            elif cmd == "gsSPSetGeometryMode" and args:
+                if mode_flag(args[0], "G_LIGHTING") is not False:
+                    state.lighting = True if mode_flag(args[0], "G_LIGHTING") else UNKNOWN
+                if mode_flag(args[0], "G_TEXTURE_GEN") is not False:
+                    state.texgen = True if mode_flag(args[0], "G_TEXTURE_GEN") else UNKNOWN
+            elif cmd == "gsSPClearGeometryMode" and args:
+                if mode_flag(args[0], "G_LIGHTING") is not False:
+                    state.lighting = False if mode_flag(args[0], "G_LIGHTING") else UNKNOWN
+                if mode_flag(args[0], "G_TEXTURE_GEN") is not False:
+                    state.texgen = False if mode_flag(args[0], "G_TEXTURE_GEN") else UNKNOWN
+            elif cmd == "gsSPGeometryMode" and len(args) == 2:
+                for flag, attr in (("G_LIGHTING", "lighting"), ("G_TEXTURE_GEN", "texgen")):
+                    cleared, set_ = mode_flag(args[0], flag), mode_flag(args[1], flag)
+                    if set_ is True:
+                        setattr(state, attr, True)
+                    elif cleared is True and set_ is False:
+                        setattr(state, attr, False)
+                    elif cleared is not False or set_ is not False:
+                        setattr(state, attr, UNKNOWN)
+            elif cmd == "gsSPLoadGeometryMode" and args:
+                state.lighting = mode_flag(args[0], "G_LIGHTING")
+                state.texgen = mode_flag(args[0], "G_TEXTURE_GEN")
+            elif cmd == "gsSPLightColor" and len(args) == 2:
+                try:
+                    color = parse_int(args[1]) >> 8
+                except ValueError:
+                    color = UNKNOWN
+                if args[0] == "LIGHT_1":
+                    state.light = color
+                elif args[0] == "LIGHT_2":
+                    state.ambient = color
+                else:
+                    state.light = state.ambient = UNKNOWN
+            elif cmd.startswith("gsSPSetLights") or cmd in ("gsSPLight", "gsSPNumLights"):
+                state.light = state.ambient = UNKNOWN
+            elif cmd in ("gsSPDisplayList", "gsSPBranchList") and args:
+                if args[0] in self.display_lists:
+                    state = self.walk(args[0], state)
+                else:
+                    state = State(UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN)
+                if cmd == "gsSPBranchList":
+                    break
+            elif cmd == "gsSPEndDisplayList":
+                break
+        self.end_states[key] = state
+        return state
+
+    def end_state(self, name, state):
+        # A display list that's (indirectly) calling itself is assumed to leave everything unknown.
+        return self.end_states.get((name, state.key()), State(UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN))
+
+    def analyze(self, roots, poisoned):
+        self.end_states = {}
+        lit = State(True, False, UNKNOWN, UNKNOWN)
+        unknown = State(UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN)
+        for name in roots:
+            if name in self.display_lists:
+                self.walk(name, lit)
+        # Anything else may be drawn by objects or code, with lighting that can't be known here.
+        reached = set(name for name, _ in self.walked)
+        for name in self.display_lists:
+            if name not in reached or name in poisoned:
+                self.walk(name, unknown)
+        for name in poisoned:
+            # Scrolled display lists can't be changed, since scrolls patch their commands by index.
+            for _, cmd, args in self.display_lists[name].commands:
+                if cmd == "gsSPVertex" and len(args) == 3:
+                    array, offset = parse_vertex_arg(args[0])
+                    if array in self.vertices:
+                        self.vertices[array].load(offset, parse_int(args[1]), False)
+
+    def poison_vertices(self, names):
+        for name in names:
+            vertices = self.vertices[name]
+            vertices.load(0, len(vertices.entries), False)
+
+    def bake_vertices(self, light_dir):
+        out = {}
+        for name, vertices in self.vertices.items():
+            if not any(lights not in (UNKNOWN, False) for lights in vertices.lights):
+                continue
+            pieces, last = [], 0
+            for i, match in enumerate(vertices.entries):
+                lights = vertices.lights[i]
+                if lights in (UNKNOWN, False):
+                    continue
+                normal, alpha = vertices.normal(i)
+                color = light_vertex(normal, light_dir, lights)
+                pieces.append(vertices.body[last:match.start(4)])
+                pieces.append("0x%02x, 0x%02x, 0x%02x, 0x%02x" % (color[0], color[1], color[2], alpha))
+                last = match.end(4)
+            pieces.append(vertices.body[last:])
+            out[name] = "".join(pieces)
+        return out
+
+    def rewrite_display_list(self, dl):
+        """Clear G_LIGHTING around the baked vertex loads, restoring it before anything that depends on it."""
+        lines = list(dl.lines)
+        inserts = []
+        cleared = False
+        for index, cmd, args in dl.commands:
+            indent = CMD_RE.match(lines[index]).group(1)
+            baked = False
+            if cmd == "gsSPVertex" and len(args) == 3:
+                array, offset = parse_vertex_arg(args[0])
+                if array in self.vertices:
+                    count = parse_int(args[1])
+                    self.vertex_loads += 1
+                    self.lit_vertices += count
+                    if self.vertices[array].bakeable(offset, count):
+                        baked = True
+                        self.baked_loads += 1
+                        self.baked_vertices += count
+            if baked and not cleared:
+                inserts.append((index, indent + "gsSPClearGeometryMode(G_LIGHTING),"))
+                cleared = True
+            elif cleared and not baked and not cmd.startswith("gsDP") and cmd not in LIGHTING_INDEPENDENT:
+                inserts.append((index, indent + "gsSPSetGeometryMode(G_LIGHTING),"))
+                cleared = False
+        for index, line in reversed(inserts):
+            lines.insert(index, line)
+        return "\n".join(lines)
+
+    def bake(self, light_dir, poisoned):
+        bodies = self.bake_vertices(light_dir)
+        for name, dl in self.display_lists.items():
+            if name not in poisoned:
+                bodies[name] = self.rewrite_display_list(dl)
+
+        pieces, last = [], 0
+        for name, (start, end) in sorted(self.spans.items(), key=lambda item: item[1]):
+            if name in bodies:
+                pieces.append(self.text[last:start])
+                pieces.append(bodies[name])
+                last = end
+        pieces.append(self.text[last:])
+        return "".join(pieces)
+
+
+def light_vertex(normal, light_dir, lights):
+    light, ambient = lights
+    length = math.sqrt(sum(c * c for c in light_dir))
+    direction = [c * 127.0 / length for c in light_dir]
+    intensity = max(0.0, sum(n * d for n, d in zip(normal, direction)) / (127.0 * 127.0))
+    color = []
+    for shift in (16, 8, 0):
+        value = ((ambient >> shift) & 0xFF) + intensity * ((light >> shift) & 0xFF)
+        color.append(min(255, int(value)))
+    return color
+
+
+def area_roots(level_dir):
+    """Display lists the level's area geo layouts draw on baked layers, not under rotating nodes."""
+    roots = set()
+    excluded = set()
+    for path in sorted(glob.glob(os.path.join(level_dir, "areas", "**", "geo.inc.c"), recursive=True)):
+        with open(path) as f:
+            text = f.read()
+        stack = []
+        last = None
+        for match in GEO_CMD_RE.finditer(text):
+            cmd, args = match.group(1), split_args(match.group(2))
+            if cmd == "GEO_OPEN_NODE":
+                stack.append(last)
+                continue
+            if cmd == "GEO_CLOSE_NODE":
+                if stack:
+                    stack.pop()
+                continue
+            last = cmd
+            rotated = any(node is not None and node.startswith(ROTATING_GEO_NODES) for node in stack)
+            if cmd == "GEO_DISPLAY_LIST" and len(args) == 2:
+                if args[0] in BAKED_LAYERS and not rotated:
+                    roots.add(args[1])
+                else:
+                    excluded.add(args[1])
+            elif args and re.fullmatch(r"\w+", args[-1]):
+                excluded.add(args[-1])
+    return roots - excluded
+
+
+def level_identifiers(level_dir):
+    """The identifiers used by each of the level's files, leaving out the display list nodes of area geo layouts."""
+    identifiers = {}
+    for path in glob.glob(os.path.join(level_dir, "**", "*.c"), recursive=True):
+        with open(path) as f:
+            text = f.read()
+        if "/areas/" in path.replace(os.sep, "/") and path.endswith("geo.inc.c"):
+            text = GEO_CMD_RE.sub(lambda m: "" if m.group(1) == "GEO_DISPLAY_LIST" else m.group(0), text)
+        identifiers[os.path.abspath(path)] = set(IDENTIFIER_RE.findall(text))
+    return identifiers
+
+
+def external_references(identifiers, model_path, names, src_identifiers):
+    """Names in the model file that are used from anywhere but an area geo layout's display list node."""
+    used = names & src_identifiers
+    for path, file_identifiers in identifiers.items():
+        if path != os.path.abspath(model_path):
+            used |= names & file_identifiers
+    return used
+
+
+def scrolled_names(level_dir):
+    names = set()
+    for path in glob.glob(os.path.join(level_dir, "**", "*texscroll*"), recursive=True):
+        with open(path) as f:
+            names.update(re.findall(r"segmented_to_virtual\(\s*(\w+)\s*\)", f.read()))
+    return names
+
+
+def read_src_identifiers():
+    identifiers = set()
+    for path in glob.glob(os.path.join("src", "**", "*.c"), recursive=True):
+        with open(path, errors="replace") as f:
+            identifiers.update(IDENTIFIER_RE.findall(f.read()))
+    return identifiers
+
+
+def bake_model(level, model_path, light_dir):
+    model = ModelFile(model_path)
+    names = set(model.display_lists) | set(model.vertices)
+    used = external_references(level["identifiers"], model_path, names, level["src_identifiers"])
+    poisoned = (used | level["scrolled"]) & set(model.display_lists)
+    roots = level["roots"] - poisoned
+    model.analyze(roots, poisoned)
+    model.poison_vertices((used | level["scrolled"]) & set(model.vertices))
+    return model, model.bake(light_dir, poisoned)
+
+
+def write_if_changed(path, text):
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == text:
+                return
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def level_inputs_mtime(level_dir):
+    paths = glob.glob(os.path.join(level_dir, "**", "*.c"), recursive=True) + [os.path.abspath(__file__)]
+    return max(os.path.getmtime(path) for path in paths)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Bakes the global light into static level geometry.")
+    parser.add_argument("--out-dir", help="directory the baked model files are written to")
+    parser.add_argument("--skip", default="", help="comma separated levels to leave lit at runtime")
+    parser.add_argument("--level", help="only handle this level")
+    parser.add_argument("--light-dir", default="0x28,0x28,0x28",
+                        help="direction towards the light, as in globalLightDirection (default: 0x28,0x28,0x28)")
+    parser.add_argument("--report", action="store_true", help="print how many vertex loads skip lighting per level")
+    parser.add_argument("--quiet", action="store_true")
+    args = parser.parse_args()
+
+    if args.out_dir is None and not args.report:
+        parser.error("either --out-dir or --report is needed")
+
+    try:
+        light_dir = [parse_int(c) for c in args.light_dir.split(",")]
+        assert len(light_dir) == 3 and any(light_dir)
+    except (ValueError, AssertionError):
+        parser.error("--light-dir must be three numbers, not all 0")
+
+    skip = set(level for level in args.skip.replace(" ", ",").split(",") if level)
+    levels = sorted(os.path.basename(os.path.dirname(path)) for path in glob.glob("levels/*/header.h"))
+    if args.level is not None:
+        levels = [args.level]
+    stamp_args = "%s %s\n" % (args.light_dir, os.path.abspath(__file__))
+
+    src_identifiers = None
+    totals = [0, 0, 0, 0]
+    for level in levels:
+        level_dir = os.path.join("levels", level)
+        out_level_dir = os.path.join(args.out_dir, "levels", level) if args.out_dir else None
+        if level in skip:
+            if out_level_dir is not None:
+                for path in glob.glob(os.path.join(out_level_dir, "**", "*"), recursive=True):
+                    if os.path.isfile(path):
+                        os.remove(path)
+            continue
+
+        # Levels whose sources haven't changed since they were last baked with the same arguments are skipped.
+        stamp = os.path.join(out_level_dir, "bake_level_lighting.stamp") if out_level_dir else None
+        if stamp is not None and not args.report and os.path.exists(stamp):
+            with open(stamp) as f:
+                if f.read() == stamp_args and os.path.getmtime(stamp) >= level_inputs_mtime(level_dir):
+                    continue
+
+        if src_identifiers is None:
+            src_identifiers = read_src_identifiers()
+        level_data = {
+            "identifiers": level_identifiers(level_dir),
+            "src_identifiers": src_identifiers,
+            "scrolled": scrolled_names(level_dir),
+            "roots": area_roots(level_dir),
+        }
+
+        counts = [0, 0, 0, 0]
+        for model_path in sorted(glob.glob(os.path.join(level_dir, "areas", "*", "*", "model.inc.c"))):
+            model, text = bake_model(level_data, model_path, light_dir)
+            counts = [a + b for a, b in zip(counts, (model.baked_loads, model.vertex_loads,
+                                                      model.baked_vertices, model.lit_vertices))]
+            if out_level_dir is not None:
+                out_path = os.path.join(args.out_dir, model_path)
+                if text != model.text:
+                    write_if_changed(out_path, text)
+                elif os.path.exists(out_path):
+                    os.remove(out_path)
+
+        if stamp is not None:
+            write_if_changed(stamp, stamp_args)
+            os.utime(stamp)
+        totals = [a + b for a, b in zip(totals, counts)]
+        if args.report or not args.quiet:
+            print("%-16s %5d/%5d vertex loads, %6d/%6d vertices no longer lit" % ((level,) + tuple(counts)),
+                  file=sys.stdout if args.report else sys.stderr)
+
+    if args.report:
+        print("%-16s %5d/%5d vertex loads, %6d/%6d vertices no longer lit" % (("total",) + tuple(totals)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,426 @@
+#!/usr/bin/env python3
+"""
+Profile-guided code placement for the VR4300's 16 KB direct-mapped instruction cache.
+
+Code is linked in object file order by default, so hot functions from unrelated files can end up
+sharing I-cache lines and evicting each other every frame. Given a function hit profile, this tool
+generates linker script fragments that place the hottest input sections first in the main and
+engine segments (see HOT_TEXT_PROFILE in the Makefile), and can estimate the effect on a recorded
+PC trace with a simple cache model.
+
+Profiles are text files in one of two formats:
+  - function counts: "<function> <count>" per line, e.g. exported from an emulator's profiler
+  - PC samples: one hexadecimal address per line, from the build described by --profile-map.
+    Transitions between consecutive samples are used as call graph edges, so callers and
+    callees end up next to each other instead of aliasing.
+Lines starting with '#' are ignored.
+
+Usage:
+  hot_link_order.py generate --map build/us_n64/sm64_prelim.map --out-dir build/us_n64 profile.txt
+  hot_link_order.py simulate --map build/us_n64/sm64.us.map trace.txt
+"""
+import argparse
+import os
+import re
+import sys
+from collections import defaultdict
+
+ICACHE_SIZE = 0x4000
+ICACHE_LINE_SIZE = 0x20
+
+# Segments whose text can be reordered, as named by BEGIN_SEG in sm64.ld.
+SEGMENTS = ("main", "engine")
+
+SECTION_HEADER_RE = re.compile(r"^ (\.text[^\s]*)\s*$")
+SECTION_LINE_RE = re.compile(r"^ (\.text[^\s]*)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)\s*$")
+SYMBOL_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_.$][\w.$]*)\s*$")
+ASSIGNMENT_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_][\w]*) = ")
+
+
+class InputSection:
+    """A .text input section, the unit the linker can place."""
+
+    def __init__(self, name, addr, size, obj):
+        self.name = name
+        self.addr = addr
+        self.size = size
+        self.obj = obj
+        self.symbols = []  # (addr, name)
+        self.segment = None
+        self.hits = 0
+
+    def key(self):
+        return (self.obj, self.name)
+
+    def label(self):
+        if self.name.startswith(".text."):
+            return self.name[len(".text."):]
+        return self.symbols[0][1] if self.symbols else os.path.basename(self.obj)
+
+    def linker_pattern(self):
+        obj = self.obj
+        archive = re.match(r"^(.*?)([^/]+\.a)\(([^)]+)\)$", obj)
+        if archive is not None:
+            return "*%s:%s(%s);" % (archive.group(2), archive.group(3), self.name)
+        return "%s(%s);" % (obj, self.name)
+
+
+class LinkMap:
+    def __init__(self, path):
+        self.sections = []
+        self.symbols = {}
+        self.segment_ranges = {}
+        self._parse(path)
+
+    def _parse(self, path):
+        assignments = {}
+        pending_name = None
+        current = None
+        in_memory_map = False
+
+        with open(path) as f:
+            for line in f:
+                line = line.rstrip("\n")
+                if not in_memory_map:
+                    in_memory_map = line.startswith("Linker script and memory map")
+                    continue
+
+                match = ASSIGNMENT_RE.match(line)
+                if match is not None:
+                    assignments[match.group(2)] = int(match.group(1), 16)
+                    continue
+
+                match = SECTION_HEADER_RE.match(line)
+                if match is not None:
+                    pending_name = match.group(1)
+                    current = None
+                    continue
+
+                match = SECTION_LINE_RE.match(line)
+                if match is not None:
+                    name = match.group(1) or pending_name
+                    pending_name = None
+                    current = None
+                    size = int(match.group(3), 16)
+                    if name is not None and size != 0:
+                        current = InputSection(name, int(match.group(2), 16), size, match.group(4))
+                        self.sections.append(current)
+                    continue
+
+                match = SYMBOL_RE.match(line)
+                if match is not None and current is not None:
+                    addr = int(match.group(1), 16)
+                    if current.addr <= addr < current.addr + current.size:
+                        current.symbols.append((addr, match.group(2)))
+                    continue
+
+                # Any other line (e.g. a non-text section header) ends the current section.
+                if line.startswith(" ."):
+                    pending_name = None
+                    current = None
+
+        for segment in SEGMENTS:
+            start = assignments.get("_%sSegmentStart" % segment)
+            end = assignments.get("_%sSegmentTextEnd" % segment)
+            if start is not None and end is not None:
+                self.segment_ranges[segment] = (start, end)
+
+        if not self.segment_ranges:
+            raise ValueError("%s: no segment text ranges found, is this an sm64 link map?" % path)
+
+        for section in self.sections:
+            for segment, (start, end) in self.segment_ranges.items():
+                if start <= section.addr < end:
+                    section.segment = segment
+            for addr, name in section.symbols:
+                self.symbols.setdefault(name, section)
+
+        self.sections.sort(key=lambda s: s.addr)
+        self._addrs = [s.addr for s in self.sections]
+
+    def section_at(self, addr):
+        lo, hi = 0, len(self._addrs)
+        while lo < hi:
+            mid = (lo + hi) // 2
+            if self._addrs[mid] <= addr:
+                lo = mid + 1
+            else:
+                hi = mid
+        if lo == 0:
+            return None
+        section = self.sections[lo - 1]
+        if addr < section.addr + section.size:
+            return section
+        return None
+
+    def find(self, name):
+        # Function sections are named after their function, which also covers static functions.
+        if ":" in name:
+            obj, name = name.rsplit(":", 1)
+        else:
+            obj = None
+        for section in self.sections:
+            if section.name == ".text." + name and (obj is None or section.obj.endswith(obj)):
+                return section
+        if obj is None:
+            return self.symbols.get(name)
+        # Static functions can share a name, so look for the one in the requested file.
+        for section in self.sections:
+            if section.obj.endswith(obj) and any(symbol == name for _, symbol in section.symbols):
+                return section
+        return None
+
+
+def read_profile(path):
+    """Returns ("counts", [(name, count)]) or ("samples", [addr])."""
+    counts = []
+    samples = []
+    with open(path) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            tokens = line.split()
+            if len(tokens) == 1:
+                samples.append(int(tokens[0], 16))
+            else:
+                counts.append((tokens[0], int(tokens[1], 0)))
+    if counts and samples:
+        raise ValueError("%s: mixes function counts and PC samples" % path)
+    return ("samples", samples) if samples else ("counts", counts)
+
+
+def translate_samples(samples, profile_map, target_map):
+    """Maps PC samples recorded on profile_map's build to (section in target_map, offset) pairs."""
+    translated = []
+    for addr in samples:
+        section = profile_map.section_at(addr)
+        if section is None:
+            continue
+        target = target_map.sections_by_key.get(section.key()) if target_map is not profile_map else section
+        if target is None:
+            continue
+        translated.append((target, min(addr - section.addr, target.size - 1)))
+    return translated
+
+
+def order_sections(link_map, profile, profile_map, budget):
+    """Returns the hot sections of each segment in link order."""
+    kind, data = profile
+    edges = defaultdict(int)
+
+    if kind == "counts":
+        for name, count in data:
+            section = link_map.find(name)
+            if section is not None:
+                section.hits += count
+    else:
+        prev = None
+        for section, _ in translate_samples(data, profile_map, link_map):
+            section.hits += 1
+            if prev is not None and prev is not section and prev.segment == section.segment:
+                edges[(prev, section) if id(prev) < id(section) else (section, prev)] += 1
+            prev = section
+
+    candidates = [s for s in link_map.sections if s.hits > 0 and s.segment is not None]
+    # Hit density, so a huge rarely-called function doesn't push out many small hot ones.
+    candidates.sort(key=lambda s: s.hits / s.size, reverse=True)
+
+    hot = []
+    total = 0
+    for section in candidates:
+        if total + section.size > budget:
+            continue
+        hot.append(section)
+        total += section.size
+    hot_set = set(hot)
+
+    # Pettis-Hansen style chain merging: the heaviest caller/callee pairs are joined end to end,
+    # so each pair lands in neighbouring cache lines.
+    chain_of = {s: [s] for s in hot}
+    for (a, b), _ in sorted(edges.items(), key=lambda e: e[1], reverse=True):
+        if a not in hot_set or b not in hot_set:
+            continue
+        chain_a, chain_b = chain_of[a], chain_of[b]
+        if chain_a is chain_b:
+            continue
+        if chain_a[-1] is a and chain_b[0] is b:
+            merged = chain_a + chain_b
+        elif chain_b[-1] is b and chain_a[0] is a:
+            merged = chain_b + chain_a
+        elif chain_a[-1] is a and chain_b[-1] is b:
+            merged = chain_a + chain_b[::-1]
+        elif chain_a[0] is a and chain_b[0] is b:
+            merged = chain_a[::-1] + chain_b
+        else:
+            continue
+        for s in merged:
+            chain_of[s] = merged
+
+    chains = []
+    seen = set()
+    for s in hot:
+        chain = chain_of[s]
+        if id(chain) not in seen:
+            seen.add(id(chain))
+            chains.append(chain)
+    chains.sort(key=lambda c: sum(s.hits for s in c) / sum(s.size for s in c), reverse=True)
+
+    ordered = {segment: [] for segment in SEGMENTS}
+    for chain in chains:
+        for s in chain:
+            ordered[s.segment].append(s)
+    return ordered
+
+
+def relocate(link_map, ordered, pad):
+    """Returns {section: new address} for the layout the generated fragments would produce."""
+    new_addr = {}
+    prev_hot_end = None
+    for segment in SEGMENTS:
+        if segment not in link_map.segment_ranges:
+            continue
+        start, end = link_map.segment_ranges[segment]
+        sections = [s for s in link_map.sections if s.segment == segment]
+        hot = ordered.get(segment, [])
+        hot_set = set(hot)
+        if not sections:
+            continue
+        # Sections before the first movable one (entry point, KEEP'd assembly) stay in place.
+        fixed = [s for s in sections if s.obj.find("/asm/") >= 0]
+        addr = max([s.addr + s.size for s in fixed], default=sections[0].addr)
+        if pad and prev_hot_end is not None and hot:
+            addr += (prev_hot_end - addr) % ICACHE_SIZE
+        for s in hot:
+            addr = (addr + 3) & ~3
+            new_addr[s] = addr
+            addr += s.size
+        if hot:
+            prev_hot_end = addr
+        for s in sections:
+            if s in hot_set or s in fixed:
+                new_addr.setdefault(s, s.addr)
+                continue
+            addr = (addr + 3) & ~3
+            new_addr[s] = addr
+            addr += s.size
+    return new_addr
+
+
+def simulate_cache(addresses):
+    tags = [None] * (ICACHE_SIZE // ICACHE_LINE_SIZE)
+    misses = 0
+    for addr in addresses:
+        line = addr // ICACHE_LINE_SIZE
+        index = line % len(tags)
+        if tags[index] != line:
+            tags[index] = line
+            misses += 1
+    return misses
+
+
+def expand_samples(pairs, new_addr=None):
+    """Each sample touches its cache line; the line before it is assumed to have been fetched too."""
+    addresses = []
+    for section, offset in pairs:
+        base = new_addr.get(section, section.addr) if new_addr is not None else section.addr
+        addr = base + offset
+        if offset >= ICACHE_LINE_SIZE:
+            addresses.append(addr - ICACHE_LINE_SIZE)
+        addresses.append(addr)
+    return addresses
+
+
+def write_fragments(ordered, out_dir, pad):
+    for segment in SEGMENTS:
+        path = os.path.join(out_dir, "hot_text_%s.inc.ld" % segment)
+        with open(path, "w") as f:
+            f.write("/* Generated by tools/hot_link_order.py, do not edit. */\n")
+            if pad and segment != SEGMENTS[0]:
+                # Continue where the previous segment's hot code ended in the I-cache, so they don't alias.
+                f.write("      . = . + ((_%sHotTextEnd - ABSOLUTE(.)) & 0x%X);\n" % (SEGMENTS[0], ICACHE_SIZE - 1))
+            for section in ordered[segment]:
+                f.write("      %s\n" % section.linker_pattern())
+            f.write("      _%sHotTextEnd = ABSOLUTE(.);\n" % segment)
+
+
+def print_summary(ordered):
+    for segment in SEGMENTS:
+        sections = ordered[segment]
+        size = sum(s.size for s in sections)
+        print("%-7s %4d hot sections, 0x%05X bytes" % (segment, len(sections), size))
+        for s in sections[:10]:
+            print("          %-40s 0x%04X bytes %8d hits" % (s.label(), s.size, s.hits))
+
+
+def load_maps(args):
+    link_map = LinkMap(args.map)
+    link_map.sections_by_key = {s.key(): s for s in link_map.sections}
+    if args.profile_map is not None and args.profile_map != args.map:
+        profile_map = LinkMap(args.profile_map)
+        profile_map.sections_by_key = {s.key(): s for s in profile_map.sections}
+    else:
+        profile_map = link_map
+    return link_map, profile_map
+
+
+def cmd_generate(args):
+    link_map, profile_map = load_maps(args)
+    profile = read_profile(args.profile)
+    ordered = order_sections(link_map, profile, profile_map, args.budget)
+    write_fragments(ordered, args.out_dir, args.pad)
+    if args.verbose:
+        print_summary(ordered)
+
+
+def cmd_simulate(args):
+    link_map, profile_map = load_maps(args)
+    profile = read_profile(args.trace)
+    if profile[0] != "samples":
+        raise ValueError("%s: simulation needs a PC trace, not function counts" % args.trace)
+    pairs = translate_samples(profile[1], profile_map, link_map)
+    if not pairs:
+        raise ValueError("%s: no samples fall inside the main or engine segments" % args.trace)
+
+    ordered = order_sections(link_map, profile, profile_map, args.budget)
+    print_summary(ordered)
+    before = simulate_cache(expand_samples(pairs))
+    after = simulate_cache(expand_samples(pairs, relocate(link_map, ordered, args.pad)))
+    print("samples: %d" % len(pairs))
+    print("misses:  %d -> %d (%.1f%% fewer)" % (before, after, 100.0 * (before - after) / max(before, 1)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Profile-guided .text placement for the N64 I-cache.")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    def add_common(p):
+        p.add_argument("--map", required=True, help="link map to generate the layout for")
+        p.add_argument("--profile-map", help="link map of the build the PC samples were recorded on (default: --map)")
+        p.add_argument("--budget", type=lambda x: int(x, 0), default=ICACHE_SIZE,
+                       help="maximum total size of hot code (default: 0x%X, the I-cache size)" % ICACHE_SIZE)
+        p.add_argument("--pad", action="store_true",
+                       help="pad the engine segment so its hot code doesn't alias the main segment's")
+
+    p = sub.add_parser("generate", help="write hot_text_<segment>.inc.ld fragments")
+    add_common(p)
+    p.add_argument("--out-dir", required=True)
+    p.add_argument("-v", "--verbose", action="store_true")
+    p.add_argument("profile")
+    p.set_defaults(func=cmd_generate)
+
+    p = sub.add_parser("simulate", help="estimate I-cache misses of a PC trace before and after reordering")
+    add_common(p)
+    p.add_argument("trace")
+    p.set_defaults(func=cmd_simulate)
+
+    args = parser.parse_args()
+    try:
+        args.func(args)
+    except (OSError, ValueError) as e:
+        print("hot_link_order: %s" % e, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,488 @@
+#!/usr/bin/env python3
+"""
+Estimates the worst-case pool usage of every level area from its source data.
+
+OBJECT_POOL_CAPACITY, DYNAMIC_SURFACE_POOL_SIZE and GFX_POOL_SIZE are sized by hand, so they
+either waste RAM or overflow in the one area that needs more. This tool walks each level's
+script (following JUMP_LINKs into local and global scripts) and, for every area and act, adds up:
+  - objects: script objects for that act, macro and special objects, children spawned by their
+    behavior scripts, and Mario
+  - static surfaces: the area's terrain, with the exact number of partition nodes they take up
+    and the resulting static pool size (which is allocated at runtime to fit)
+  - dynamic surfaces: object collision is only loaded within its collision distance of Mario,
+    so this is the most that's in range of any one point, in dynamic surface pool bytes
+  - display list size: an estimate in Gfx commands of what the area's geo layout and every
+    spawned object's model append to the master display list each frame
+
+Objects spawned from C code (particles, coins dropped by enemies, ...) and the fixed cost of the
+HUD, skybox and other GEO_ASM nodes can't be seen in the data, so they are covered by
+--object-reserve and --gfx-base. Calibrate those against the Puppyprint pool counters.
+
+Areas that exceed the current settings are flagged with '!'. With --header, a header with limits
+that fit the largest area plus --headroom percent is written; build with POOL_SIZES=1 to
+generate and use it automatically. The display list estimate is the least reliable of these, so
+the generated GFX_POOL_SIZE is never lower than the one set in config_graphics.h.
+
+Usage:
+  level_pool_sizes.py [--level bob] [--header build/us_n64/include/pool_sizes.h] [--check]
+"""
+import argparse
+import glob
+import os
+import re
+import sys
+
+SURFACE_SIZE = 0x30  # sizeof(struct Surface)
+SURFACE_NODE_SIZE = 0x08  # sizeof(struct SurfaceNode)
+GFX_SIZE = 8  # sizeof(Gfx)
+MTX_GFX = 64 // GFX_SIZE  # an Mtx allocated from the display list pool, in Gfx
+
+# Per display list node: its transform, gSPMatrix and gSPDisplayList.
+GFX_PER_DL_NODE = MTX_GFX + 2
+# Per object: its own transform.
+GFX_PER_OBJECT = MTX_GFX
+
+NUM_ACTS = 6
+
+# oCollisionDistance unless the behavior sets it.
+DEFAULT_COLLISION_DISTANCE = 1000
+
+# (LEVEL_BOUNDARY_MAX, CELL_SIZE) for each EXTENDED_BOUNDS_MODE, see config_world.h.
+BOUNDS_MODES = {
+    0: (0x2000, 0x400),
+    1: (0x4000, 0x400),
+    2: (0x2000, 0x200),
+    3: (0x8000, 0x400),
+}
+
+ARRAY_RE = re.compile(r"\b(Collision|MacroObject|LevelScript|GeoLayout|BehaviorScript)\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\n\s*\};", re.S)
+COMMENT_RE = re.compile(r"/\*.*?\*/|//[^\n]*", re.S)
+CALL_RE = re.compile(r"\b([A-Z_][A-Z0-9_]*)\s*\(")
+DEFINE_RE = r"^\s*#\s*define\s+{}\s+(\S+)"
+
+# Geo commands that append their display list argument when it isn't NULL, and the index of it.
+GEO_DL_ARG = {
+    "GEO_DISPLAY_LIST": 1,
+    "GEO_ANIMATED_PART": 4,
+    "GEO_TRANSLATE_ROTATE_WITH_DL": 7,
+    "GEO_TRANSLATE_WITH_DL": 4,
+    "GEO_ROTATE_WITH_DL": 4,
+    "GEO_ROTATE_Y_WITH_DL": 2,
+    "GEO_TRANSLATE_NODE_WITH_DL": 4,
+    "GEO_ROTATION_NODE_WITH_DL": 4,
+    "GEO_BILLBOARD_WITH_PARAMS_AND_DL": 4,
+    "GEO_SCALE_WITH_DL": 2,
+}
+
+
+def parse_calls(body):
+    """Splits an initializer into its top level macro calls, as (name, [args])."""
+    calls = []
+    pos = 0
+    while True:
+        match = CALL_RE.search(body, pos)
+        if match is None:
+            return calls
+
+        depth = 1
+        args = []
+        start = i = match.end()
+        while depth > 0:
+            c = body[i]
+            if c == "(":
+                depth += 1
+            elif c == ")":
+                depth -= 1
+            elif c == "," and depth == 1:
+                args.append(body[start:i].strip())
+                start = i + 1
+            i += 1
+        last = body[start:i - 1].strip()
+        if last or args:
+            args.append(last)
+
+        calls.append((match.group(1), args))
+        pos = i
+
+
+def eval_int(expr, names=None):
+    """Evaluates a constant C integer expression, with optional named values."""
+    expr = re.sub(r"\b(0[xX][0-9a-fA-F]+|\d+)[uUlL]*\b", r"\1", expr)
+    expr = re.sub(r"\(\s*[su](8|16|32)\s*\)", "", expr)
+    if names:
+        expr = re.sub(r"\b[A-Za-z_]\w*\b", lambda m: str(names.get(m.group(0), m.group(0))), expr)
+    if not re.fullmatch(r"[\s\dxXa-fA-F()+\-*/|&<>~]*", expr):
+        raise ValueError(expr)
+    return int(eval(expr.replace("/", "//")))
+
+
+def read_define(path, name, default=None):
+    with open(path) as f:
+        for line in f:
+            match = re.match(DEFINE_RE.format(name), line)
+            if match:
+                return eval_int(match.group(1))
+    if default is None:
+        raise ValueError("%s not found in %s" % (name, path))
+    return default
+
+
+class Collision:
+    def __init__(self, calls):
+        self.vertices = []
+        self.tris = []
+        self.specials = []  # (preset name, x, z)
+        self.primitives = 0
+
+        for name, args in calls:
+            if name == "COL_VERTEX":
+                self.vertices.append([eval_int(a) for a in args])
+            elif name in ("COL_TRI", "COL_TRI_SPECIAL"):
+                self.tris.append([eval_int(a) for a in args[:3]])
+            elif name.startswith("SPECIAL_OBJECT"):
+                self.specials.append((args[0], eval_int(args[1]), eval_int(args[3])))
+            elif name.startswith("COL_PRIMITIVE_"):
+                self.primitives += 1
+
+    def radius(self):
+        """Distance to the farthest vertex, see get_optimal_coll_dist()."""
+        return max((x * x + y * y + z * z) ** 0.5 for x, y, z in self.vertices) if self.vertices else 0
+
+    def nodes(self, bounds, offset=(0, 0)):
+        """Partition nodes taken up by the surfaces, like add_surface() does it."""
+        boundary, cell_size = bounds
+        num_cells = (2 * boundary) // cell_size
+
+        def cell(coord):
+            return max(0, coord + boundary) // cell_size
+
+        total = 0
+        for tri in self.tris:
+            xs = [self.vertices[v][0] + offset[0] for v in tri if v < len(self.vertices)]
+            zs = [self.vertices[v][2] + offset[1] for v in tri if v < len(self.vertices)]
+            if not xs:
+                continue
+            width = min(num_cells - 1, cell(max(xs))) - max(0, cell(min(xs))) + 1
+            depth = min(num_cells - 1, cell(max(zs))) - max(0, cell(min(zs))) + 1
+            total += max(0, width) * max(0, depth)
+        return total
+
+
+class Behavior:
+    def __init__(self, calls):
+        self.collision = None
+        self.collision_distance = DEFAULT_COLLISION_DISTANCE
+        self.children = []  # behavior names
+
+        for name, args in calls:
+            if name == "LOAD_COLLISION_DATA":
+                self.collision = args[0]
+            elif name == "SET_FLOAT" and args[0] == "oCollisionDistance":
+                self.collision_distance = eval_int(args[1])
+            elif name in ("SPAWN_CHILD", "SPAWN_OBJ"):
+                self.children.append(args[1])
+            elif name == "SPAWN_CHILD_WITH_PARAM":
+                self.children.append(args[2])
+
+
+class Data:
+    """Every collision, macro list, level script, geo layout and behavior in the repo."""
+
+    def __init__(self, root):
+        self.collision = {}
+        self.macros = {}
+        self.scripts = {}
+        self.geo = {}
+        self.behaviors = {}
+
+        paths = []
+        for pattern in ("levels/**/*.c", "actors/**/*.c", "bin/**/*.c", "data/*.c"):
+            paths += glob.glob(os.path.join(root, pattern), recursive=True)
+
+        for path in sorted(paths):
+            with open(path) as f:
+                text = COMMENT_RE.sub("", f.read())
+            for kind, name, body in ARRAY_RE.findall(text):
+                calls = parse_calls(body)
+                if kind == "Collision":
+                    self.collision[name] = Collision(calls)
+                elif kind == "MacroObject":
+                    self.macros[name] = [(args[0], eval_int(args[2]), eval_int(args[4]))
+                                         for call, args in calls if call.startswith("MACRO_OBJECT") and args]
+                elif kind == "LevelScript":
+                    self.scripts[name] = calls
+                elif kind == "GeoLayout":
+                    self.geo[name] = calls
+                elif kind == "BehaviorScript":
+                    self.behaviors[name] = Behavior(calls)
+
+        self.macro_presets = self.read_macro_presets(os.path.join(root, "include/macro_presets.h"))
+        self.special_presets = self.read_special_presets(root)
+
+        self.geo_dl_nodes = {}
+
+    @staticmethod
+    def read_macro_presets(path):
+        presets = {}
+        with open(path) as f:
+            for line in f:
+                match = re.match(r"\s*\{\s*(\w+)\s*,.*\}\s*,\s*//\s*(\w+)", line)
+                if match:
+                    presets[match.group(2)] = match.group(1)
+        return presets
+
+    @staticmethod
+    def read_special_presets(root):
+        ids = {}
+        value = 0
+        with open(os.path.join(root, "include/special_preset_names.h")) as f:
+            body = COMMENT_RE.sub("", f.read())
+        for entry in body[body.index("{") + 1:body.index("}")].split(","):
+            entry = entry.strip()
+            if not entry:
+                continue
+            if "=" in entry:
+                name, expr = [s.strip() for s in entry.split("=")]
+                value = eval_int(expr, ids)
+            else:
+                name = entry
+            ids[name] = value
+            value += 1
+
+        behaviors = {}
+        with open(os.path.join(root, "include/special_presets.h")) as f:
+            for line in f:
+                match = re.match(r"\s*\{\s*(\w+)\s*,[^,]*,[^,]*,[^,]*,\s*(\w+)\s*\}", line)
+                if match:
+                    behaviors[eval_int(match.group(1))] = match.group(2)
+
+        return {name: behaviors.get(value, "NULL") for name, value in ids.items()}
+
+    def count_dl_nodes(self, geo, seen=()):
+        """Display lists appended by a geo layout. Every switch case is counted, so this is an upper bound."""
+        if geo in self.geo_dl_nodes:
+            return self.geo_dl_nodes[geo]
+        if geo not in self.geo or geo in seen:
+            return 0
+
+        total = 0
+        for name, args in self.geo[geo]:
+            index = GEO_DL_ARG.get(name)
+            if index is not None and index < len(args) and args[index] != "NULL":
+                total += 1
+            elif name == "GEO_BRANCH" or name == "GEO_BRANCH_AND_LINK":
+                total += self.count_dl_nodes(args[-1], seen + (geo,))
+        self.geo_dl_nodes[geo] = total
+        return total
+
+
+class Area:
+    def __init__(self, level, index, geo):
+        self.level = level
+        self.index = index
+        self.geo = geo
+        self.objects = []  # (behavior, model, act mask, x, z)
+        self.terrain = None
+        self.macros = []
+
+    def label(self):
+        return "%s:%d" % (self.level, self.index)
+
+
+def walk_level(data, level, entry):
+    """Finds the areas of a level, and the models it loads."""
+    areas = []
+    models = {}
+    area = None
+    visited = set()
+
+    def run(script):
+        nonlocal area
+        if script in visited or script not in data.scripts:
+            return
+        visited.add(script)
+        for name, args in data.scripts[script]:
+            if name in ("JUMP_LINK", "JUMP", "JUMP_LINK_PUSH_ARG"):
+                run(args[0])
+            elif name == "AREA":
+                area = Area(level, eval_int(args[0]), args[1])
+                areas.append(area)
+            elif name == "END_AREA":
+                area = None
+            elif name == "LOAD_MODEL_FROM_GEO":
+                models[args[0]] = data.count_dl_nodes(args[1])
+            elif name == "LOAD_MODEL_FROM_DL":
+                models[args[0]] = 1
+            elif area is None:
+                continue
+            elif name in ("OBJECT", "OBJECT_WITH_ACTS"):
+                acts = (1 << NUM_ACTS) - 1
+                if name == "OBJECT_WITH_ACTS":
+                    acts = eval_int(args[9], {"ALL_ACTS": acts, **{"ACT_%d" % (i + 1): 1 << i for i in range(NUM_ACTS)}})
+                area.objects.append((args[8], args[0], acts, eval_int(args[1]), eval_int(args[3])))
+            elif name == "TERRAIN":
+                area.terrain = args[0]
+            elif name == "MACRO_OBJECTS":
+                area.macros.append(args[0])
+
+    run(entry)
+    return areas, models
+
+
+class Usage:
+    def __init__(self):
+        self.objects = 0
+        self.static_surfaces = 0
+        self.static_nodes = 0
+        self.dynamic_surfaces = 0
+        self.dynamic_nodes = 0
+        self.gfx = 0
+
+    def static_bytes(self):
+        return (self.static_surfaces * SURFACE_SIZE) + (self.static_nodes * SURFACE_NODE_SIZE)
+
+    def dynamic_bytes(self):
+        return (self.dynamic_surfaces * SURFACE_SIZE) + (self.dynamic_nodes * SURFACE_NODE_SIZE)
+
+
+def measure_area(data, area, models, bounds, act):
+    usage = Usage()
+    terrain = data.collision.get(area.terrain)
+    if terrain is not None:
+        usage.static_surfaces = len(terrain.tris)
+        usage.static_nodes = terrain.nodes(bounds)
+
+    usage.gfx = data.count_dl_nodes(area.geo) * GFX_PER_DL_NODE
+    loaded = []  # (x, z, collision distance, surfaces, nodes)
+
+    def add_object(behavior, model, pos, depth=0):
+        usage.objects += 1
+        usage.gfx += GFX_PER_OBJECT + (models.get(model, 0) * GFX_PER_DL_NODE)
+
+        bhv = data.behaviors.get(behavior)
+        if bhv is None:
+            return
+        collision = data.collision.get(bhv.collision)
+        if collision is not None:
+            distance = max(bhv.collision_distance, collision.radius() + 100)
+            loaded.append((pos[0], pos[1], distance, len(collision.tris), collision.nodes(bounds, pos)))
+        if depth < 4:
+            for child in bhv.children:
+                add_object(child, None, pos, depth + 1)
+
+    add_object("bhvMario", "MODEL_MARIO", (0, 0))
+    for behavior, model, acts, x, z in area.objects:
+        if acts & (1 << act):
+            add_object(behavior, model, (x, z))
+    for macros in area.macros:
+        for preset, x, z in data.macros.get(macros, []):
+            add_object(data.macro_presets.get(preset), None, (x, z))
+    if terrain is not None:
+        for preset, x, z in terrain.specials:
+            behavior = data.special_presets.get(preset, "NULL")
+            if behavior != "NULL":
+                add_object(behavior, None, (x, z))
+
+    # Mario standing at each object in turn, loading the collision of everything in range.
+    for x, z, _, _, _ in loaded:
+        in_range = [l for l in loaded if ((l[0] - x) ** 2 + (l[1] - z) ** 2) < (l[2] ** 2)]
+        surfaces = sum(l[3] for l in in_range)
+        nodes = sum(l[4] for l in in_range)
+        if (surfaces * SURFACE_SIZE) + (nodes * SURFACE_NODE_SIZE) > usage.dynamic_bytes():
+            usage.dynamic_surfaces, usage.dynamic_nodes = surfaces, nodes
+    return usage
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Estimates worst-case pool usage per level area.")
+    parser.add_argument("--root", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+    parser.add_argument("--level", action="append", help="only these level directories")
+    parser.add_argument("--object-reserve", type=int, default=40, help="objects spawned from code (default 40)")
+    parser.add_argument("--gfx-base", type=int, default=2500, help="Gfx used outside of the scene graph (default 2500)")
+    parser.add_argument("--headroom", type=int, default=25, help="percent added to the generated limits (default 25)")
+    parser.add_argument("--header", help="write a header with limits that fit every area")
+    parser.add_argument("--check", action="store_true", help="exit with an error if an area exceeds the current settings")
+    parser.add_argument("--quiet", action="store_true", help="don't print the table")
+    args = parser.parse_args()
+
+    root = os.path.normpath(args.root)
+    bounds = BOUNDS_MODES[read_define(os.path.join(root, "include/config/config_world.h"), "EXTENDED_BOUNDS_MODE")]
+    limits = {
+        "OBJECT_POOL_CAPACITY": read_define(os.path.join(root, "src/game/object_list_processor.h"), "OBJECT_POOL_CAPACITY"),
+        "DYNAMIC_SURFACE_POOL_SIZE": read_define(os.path.join(root, "src/engine/surface_load.h"), "DYNAMIC_SURFACE_POOL_SIZE"),
+        "GFX_POOL_SIZE": read_define(os.path.join(root, "include/config/config_graphics.h"), "GFX_POOL_SIZE"),
+    }
+
+    data = Data(root)
+    levels = args.level or sorted(os.path.basename(os.path.dirname(p)) for p in glob.glob(os.path.join(root, "levels/*/script.c")))
+
+    rows = []
+    for level in levels:
+        areas, models = walk_level(data, level, "level_%s_entry" % level)
+        for area in areas:
+            worst = None
+            for act in range(NUM_ACTS):
+                usage = measure_area(data, area, models, bounds, act)
+                usage.objects += args.object_reserve
+                usage.gfx += args.gfx_base
+                if worst is None:
+                    worst = usage
+                worst.objects = max(worst.objects, usage.objects)
+                worst.gfx = max(worst.gfx, usage.gfx)
+                if usage.dynamic_bytes() > worst.dynamic_bytes():
+                    worst.dynamic_surfaces, worst.dynamic_nodes = usage.dynamic_surfaces, usage.dynamic_nodes
+            rows.append((area, worst))
+
+    over = False
+    if not args.quiet:
+        print("%-22s %7s %8s %8s %9s %8s %9s %7s" % ("area", "objects", "static", "nodes", "static B",
+                                                       "dynamic", "dynamic B", "gfx"))
+    for area, usage in rows:
+        flags = [usage.objects > limits["OBJECT_POOL_CAPACITY"],
+                 usage.dynamic_bytes() > limits["DYNAMIC_SURFACE_POOL_SIZE"],
+                 usage.gfx > limits["GFX_POOL_SIZE"]]
+        over |= any(flags)
+        if not args.quiet:
+            mark = ["!" if f else " " for f in flags]
+            print("%-22s %6d%s %8d %8d %9d %8d %8d%s %6d%s" % (
+                area.label(), usage.objects, mark[0], usage.static_surfaces, usage.static_nodes,
+                usage.static_bytes(), usage.dynamic_surfaces, usage.dynamic_bytes(), mark[1], usage.gfx, mark[2]))
+
+    if not args.quiet:
+        print("limits: %d objects, 0x%X dynamic surface bytes, %d Gfx" % (
+            limits["OBJECT_POOL_CAPACITY"], limits["DYNAMIC_SURFACE_POOL_SIZE"], limits["GFX_POOL_SIZE"]))
+
+    if args.header and rows:
+        def fit(value, align):
+            value = value * (100 + args.headroom) // 100
+            return (value + align - 1) // align * align
+
+        lines = [
+            "#pragma once",
+            "",
+            "// Generated by tools/level_pool_sizes.py from the level data, with %d%% headroom." % args.headroom,
+            "",
+            "#define OBJECT_POOL_CAPACITY %d" % fit(max(u.objects for a, u in rows), 8),
+            "#define DYNAMIC_SURFACE_POOL_SIZE 0x%X" % fit(max(u.dynamic_bytes() for a, u in rows), 0x400),
+            # Only ever raised, since the estimate can't see what GEO_ASM nodes and C code draw.
+            "#define GFX_POOL_SIZE %d" % max(fit(max(u.gfx for a, u in rows), 100), limits["GFX_POOL_SIZE"]),
+            "",
+        ]
+        text = "\n".join(lines)
+
+        # Only touch the header when the limits change, so it doesn't trigger a full rebuild.
+        old = None
+        if os.path.exists(args.header):
+            with open(args.header) as f:
+                old = f.read()
+        if old != text:
+            os.makedirs(os.path.dirname(os.path.abspath(args.header)), exist_ok=True)
+            with open(args.header, "w") as f:
+                f.write(text)
+
+    if args.check and over:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
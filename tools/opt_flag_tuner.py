@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""
+Measures which optimization flags suit each of a set of source files, and writes the best ones out as a
+Makefile fragment for OPT_FLAGS_FILE.
+
+For every file, each candidate flag set is built into the ROM on its own (through the Makefile's
+OPT_TUNE_FILE and OPT_TUNE_FLAGS), the credits benchmark is run in an emulator, and the frame times it
+reports are recorded along with the size of the file's code. Files are tuned one after another, each with
+the flags already picked for the ones before it, and a candidate only replaces the file's current flags if
+it's faster by more than --tolerance. Otherwise the smaller one wins.
+
+The ROM is built with CREDITS_BENCHMARK=1 and ISVPRINT=1, so it starts the credits on boot and prints a
+"BENCHMARK key=value ..." line once it's done (see BENCHMARK_REPORT_FRAMES in config_benchmark.h). The
+emulator has to pass IS-Viewer output through to its standard output, and should be cycle accurate for the
+timings to mean anything on the VR4300; ares does both. The emulator is stopped once the line appears.
+
+Candidates are "name: flags" lines, and may use the Makefile's variables, e.g.
+    main:      $(GCC_MAIN_OPT_FLAGS)
+    o2:        -O2 $(SAFETY_OPT_FLAGS) -falign-functions=32
+The "current" candidate always stands for the flags the Makefile gives the file now.
+
+Usage:
+  opt_flag_tuner.py --emulator "ares --system Nintendo64 {rom}" --out opt_flags.mk src/engine/math_util.c
+"""
+import argparse
+import glob
+import json
+import os
+import re
+import shlex
+import struct
+import subprocess
+import sys
+import threading
+
+DEFAULT_FILES = (
+    "src/engine/surface_collision.c",
+    "src/engine/math_util.c",
+    "src/engine/graph_node.c",
+    "src/engine/behavior_script.c",
+    "src/game/rendering_graph_node.c",
+    "src/game/object_list_processor.c",
+    "src/game/object_helpers.c",
+    "src/game/mario_step.c",
+    "src/game/camera.c",
+)
+
+DEFAULT_CANDIDATES = (
+    ("main", "$(GCC_MAIN_OPT_FLAGS)"),
+    ("collision", "$(GCC_COLLISION_OPT_FLAGS)"),
+    ("math_util", "$(GCC_MATH_UTIL_OPT_FLAGS)"),
+    ("graph_node", "$(GCC_GRAPH_NODE_OPT_FLAGS)"),
+    ("o2", "-O2 $(SAFETY_OPT_FLAGS) -falign-functions=32"),
+    ("os", "-Os $(SAFETY_OPT_FLAGS)"),
+    ("main_no_inline", "$(GCC_MAIN_OPT_FLAGS) -fno-inline"),
+    ("main_unroll", "$(GCC_MAIN_OPT_FLAGS) --param max-completely-peeled-insns=100 --param max-unrolled-insns=100"),
+)
+
+BENCHMARK_RE = re.compile(r"BENCHMARK((?:\s+\w+=\d+)+)")
+
+SHF_EXECINSTR = 0x4
+
+
+def read_candidates(path):
+    candidates = []
+    with open(path) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            name, sep, flags = line.partition(":")
+            if not sep or not flags.strip():
+                raise ValueError("%s: expected 'name: flags', got '%s'" % (path, line))
+            candidates.append((name.strip(), flags.strip()))
+    return candidates
+
+
+def code_size(obj_path):
+    """Size of the executable sections of a big endian ELF32 object."""
+    with open(obj_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 2:
+        raise ValueError("%s: not a big endian ELF32 file" % obj_path)
+
+    shoff, = struct.unpack_from(">I", elf, 0x20)
+    shentsize, shnum = struct.unpack_from(">HH", elf, 0x2E)
+    size = 0
+    for i in range(shnum):
+        sh_flags, = struct.unpack_from(">I", elf, shoff + (i * shentsize) + 0x08)
+        sh_size, = struct.unpack_from(">I", elf, shoff + (i * shentsize) + 0x14)
+        if sh_flags & SHF_EXECINSTR:
+            size += sh_size
+    return size
+
+
+class Tuner:
+    def __init__(self, args):
+        self.args = args
+        self.make_args = shlex.split(args.make_args) + ["CREDITS_BENCHMARK=1", "ISVPRINT=1"]
+        self.chosen = {}  # file -> (name, flags)
+        self.results = []
+
+    def log(self, message):
+        if not self.args.quiet:
+            print(message, file=sys.stderr)
+
+    def object_path(self, source):
+        return os.path.join(self.args.build_dir, os.path.splitext(source)[0] + ".o")
+
+    def write_fragment(self, path, header=None):
+        with open(path, "w") as f:
+            f.write("# Generated by tools/opt_flag_tuner.py, do not edit.\n")
+            if header is not None:
+                f.write(header)
+            for source in sorted(self.chosen):
+                name, flags = self.chosen[source]
+                f.write("\n# %s\n" % name)
+                f.write("$(BUILD_DIR)/%s: OPT_FLAGS := %s\n" % (os.path.splitext(source)[0] + ".o", flags))
+
+    def build(self, source, flags):
+        obj = self.object_path(source)
+        if os.path.exists(obj):
+            os.remove(obj)
+
+        # On a clean tree, the build directory doesn't exist until make creates it.
+        os.makedirs(self.args.build_dir, exist_ok=True)
+        interim = os.path.join(self.args.build_dir, "opt_flag_tuner.mk")
+        self.write_fragment(interim)
+
+        cmd = ["make", "-j%d" % self.args.jobs] + self.make_args + ["OPT_FLAGS_FILE=" + interim]
+        if flags is not None:
+            cmd += ["OPT_TUNE_FILE=" + source, "OPT_TUNE_FLAGS=" + flags]
+        result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        if result.returncode != 0:
+            self.log(result.stdout[-2000:])
+            return None
+
+        roms = glob.glob(os.path.join(self.args.build_dir, "*.z64"))
+        if len(roms) != 1:
+            raise RuntimeError("expected one ROM in %s, found %d" % (self.args.build_dir, len(roms)))
+        return roms[0], code_size(obj)
+
+    def run_benchmark(self, rom):
+        cmd = shlex.split(self.args.emulator.replace("{rom}", shlex.quote(rom)))
+        proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        # Reading blocks while the emulator is quiet, so the timeout has to stop it from the outside.
+        timer = threading.Timer(self.args.timeout, proc.kill)
+        timer.start()
+        report = None
+        try:
+            for line in proc.stdout:
+                match = BENCHMARK_RE.search(line)
+                if match is not None:
+                    report = dict((key, int(value)) for key, value in
+                                  (pair.split("=") for pair in match.group(1).split()))
+                    break
+        finally:
+            timer.cancel()
+            proc.kill()
+            proc.wait()
+        return report
+
+    def measure(self, source, name, flags):
+        built = self.build(source, flags)
+        if built is None:
+            self.log("  %-16s build failed" % name)
+            return None
+
+        rom, size = built
+        reports = []
+        for _ in range(self.args.runs):
+            report = self.run_benchmark(rom)
+            if report is None or self.args.metric not in report:
+                self.log("  %-16s no benchmark report" % name)
+                return None
+            reports.append(report)
+
+        # The lowest of several runs is the least disturbed by the emulator's host.
+        best = min(reports, key=lambda r: r[self.args.metric])
+        result = {"file": source, "candidate": name, "flags": flags, "code_size": size}
+        result.update(best)
+        self.results.append(result)
+        self.log("  %-16s %s=%dus  code=%d bytes" % (name, self.args.metric, best[self.args.metric], size))
+        return result
+
+    def tune(self, source, candidates):
+        self.log("%s:" % source)
+        best = self.measure(source, "current", None)
+        if best is None:
+            return
+
+        metric = self.args.metric
+        for name, flags in candidates:
+            result = self.measure(source, name, flags)
+            if result is None:
+                continue
+            limit = best[metric] * (1.0 - self.args.tolerance / 100.0)
+            if result[metric] < limit or (result[metric] <= best[metric] and result["code_size"] < best["code_size"]):
+                best = result
+
+        if best["flags"] is not None:
+            self.chosen[source] = (best["candidate"], best["flags"])
+        self.log("  -> %s" % best["candidate"])
+
+        # Make doesn't notice flag changes, so the next build has to rebuild it with the chosen ones.
+        if os.path.exists(self.object_path(source)):
+            os.remove(self.object_path(source))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("files", nargs="*", default=DEFAULT_FILES, help="source files to tune")
+    parser.add_argument("--emulator", required=True, help="emulator command, {rom} is replaced with the ROM's path")
+    parser.add_argument("--out", required=True, help="Makefile fragment to write, for OPT_FLAGS_FILE")
+    parser.add_argument("--candidates", help="file with 'name: flags' lines, replacing the default candidates")
+    parser.add_argument("--results", help="also write every measurement to this JSON file")
+    parser.add_argument("--metric", default="cpu", help="benchmark value to minimize (default: cpu)")
+    parser.add_argument("--tolerance", type=float, default=0.5,
+                        help="percentage a candidate has to be faster by to replace the current flags (default: 0.5)")
+    parser.add_argument("--runs", type=int, default=1, help="benchmark runs per candidate (default: 1)")
+    parser.add_argument("--timeout", type=float, default=300, help="seconds to wait for the benchmark (default: 300)")
+    parser.add_argument("--build-dir", default="build/us_n64", help="build directory (default: build/us_n64)")
+    parser.add_argument("--make-args", default="", help="extra arguments for make, e.g. 'VERSION=jp'")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--quiet", action="store_true")
+    args = parser.parse_args()
+
+    try:
+        candidates = read_candidates(args.candidates) if args.candidates else list(DEFAULT_CANDIDATES)
+    except (OSError, ValueError) as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+
+    tuner = Tuner(args)
+    for source in args.files:
+        if not os.path.isfile(source):
+            print("%s: no such file" % source, file=sys.stderr)
+            sys.exit(1)
+        tuner.tune(source, candidates)
+
+    tuner.write_fragment(args.out, "# Benchmark: credits, metric: %s\n" % args.metric)
+    if args.results:
+        with open(args.results, "w") as f:
+            json.dump(tuner.results, f, indent=2)
+
+    # Leave the build directory as a normal build would.
+    for path in [tuner.object_path(source) for source in args.files] + [os.path.join(args.build_dir, "opt_flag_tuner.mk")]:
+        if os.path.exists(path):
+            os.remove(path)
+
+
+if __name__ == "__main__":
+    main()
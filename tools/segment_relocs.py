@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Appends a relocation table to a segment binary extracted from its ELF.
+
+The segment ELF has to be linked with --emit-relocs, so the R_MIPS_32 relocations against
+its .data section are kept. Every one of them whose value points back into the segment is
+recorded, and load_segment_decompress() adds the segment's load address to those words,
+turning them into virtual addresses that segmented_to_virtual() passes through unchanged.
+Pointers to other segments are left alone, since those may not be loaded yet.
+
+Table layout, appended after the data, all big endian:
+    u32 offsets[count]   offset of each pointer from the start of the segment
+    u32 count
+    u32 magic            SEGMENT_RELOCATION_MAGIC ('RELO')
+
+The data is padded so the table ends on a 16 byte boundary. relocate_segment() looks for the
+footer at the end of the segment, and uncompressed segments are padded to 16 bytes in the ROM,
+so anything after the footer would hide it.
+
+Usage: segment_relocs.py <segment.elf> <segment.bin>
+"""
+
+import struct
+import sys
+
+SEGMENT_RELOCATION_MAGIC = 0x52454C4F  # 'RELO'
+
+SHT_REL = 9
+R_MIPS_32 = 2
+
+
+def read_sections(elf):
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 2:
+        raise ValueError("not a big endian ELF32 file")
+
+    shoff, = struct.unpack_from(">I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from(">HHH", elf, 0x2E)
+
+    sections = []
+    for i in range(shnum):
+        name, type, flags, addr, offset, size, link, info, align, entsize = \
+            struct.unpack_from(">IIIIIIIIII", elf, shoff + (i * shentsize))
+        sections.append({"name": name, "type": type, "addr": addr, "offset": offset,
+                         "size": size, "info": info, "entsize": entsize})
+
+    strtab = sections[shstrndx]
+    for section in sections:
+        start = strtab["offset"] + section["name"]
+        section["name"] = elf[start:elf.index(b"\0", start)].decode("ascii")
+
+    return sections
+
+
+def find_relocations(elf):
+    sections = read_sections(elf)
+    data_index = next((i for i, s in enumerate(sections) if s["name"] == ".data"), None)
+    if data_index is None:
+        return []
+
+    data = sections[data_index]
+    start = data["addr"]
+    end = start + data["size"]
+    if start & 0x00FFFFFF:
+        raise ValueError(".data starts at 0x%08X instead of the start of a segment" % start)
+
+    offsets = []
+    for rel in sections:
+        if rel["type"] != SHT_REL or rel["info"] != data_index:
+            continue
+
+        entsize = rel["entsize"] or 8
+        for i in range(rel["size"] // entsize):
+            r_offset, r_info = struct.unpack_from(">II", elf, rel["offset"] + (i * entsize))
+            if (r_info & 0xFF) != R_MIPS_32:
+                continue
+
+            if r_offset < start or (r_offset + 4) > end:
+                raise ValueError("relocation at 0x%08X is outside .data" % r_offset)
+            if r_offset & 3:
+                raise ValueError("relocation at 0x%08X is not word aligned" % r_offset)
+
+            value, = struct.unpack_from(">I", elf, data["offset"] + (r_offset - start))
+
+            # Only pointers into this segment can be relocated when it's loaded.
+            if start <= value < end:
+                offsets.append(r_offset - start)
+
+    return sorted(set(offsets))
+
+
+def build_table(data_size, offsets):
+    """
+    Returns the padding and relocation table to append to data_size bytes of segment data.
+    """
+    table = struct.pack(">%dI" % len(offsets), *offsets)
+    table += struct.pack(">II", len(offsets), SEGMENT_RELOCATION_MAGIC)
+    return (b"\0" * (-(data_size + len(table)) % 16)) + table
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+        sys.exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        elf = f.read()
+    try:
+        offsets = find_relocations(elf)
+    except ValueError as e:
+        print("%s: %s" % (sys.argv[1], e), file=sys.stderr)
+        sys.exit(1)
+
+    with open(sys.argv[2], "r+b") as f:
+        data = f.read()
+        f.write(build_table(len(data), offsets))
+
+
+if __name__ == "__main__":
+    main()
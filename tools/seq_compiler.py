@@ -0,0 +1,346 @@
+#!/usr/bin/env python3
+"""
+Ahead-of-time compiler for M64 layer scripts (US/JP command set).
+
+Walks a sequence from its entry point, discovers every layer script reachable
+through chan_setlayer and decodes it into a stream of fixed-width events.
+Each event holds the fully decoded operands of one layer command together
+with the offset of the command in the original sequence, so the runtime can
+hand a layer back to the interpreter at any point.
+
+The stream is appended to the sequence by assemble_sound.py when building
+with PRECOMPILE_SEQUENCES=1. Layout (big-endian):
+
+    header:  u32 magic 'SQEV', u16 numEvents, u16 reserved
+    events:  numEvents * { u8 op, u8 arg0, u8 arg1, u8 arg2, u16 value, u16 offset }
+    footer:  u32 magic 'SQEV', u32 offset of the header from the sequence start
+
+Events are sorted by offset. Anything that can't be compiled safely (layer
+bytes patched at runtime by chan_writeseq, sequences whose channel code
+can't be fully decoded) is left to the interpreter.
+"""
+import struct
+import sys
+
+SEQ_EVENTS_MAGIC = b"SQEV"
+
+# Must match the SEQ_EVENT_* enum in src/audio/seqplayer.h.
+(
+    SEQ_EVENT_NOP,
+    SEQ_EVENT_END,
+    SEQ_EVENT_CALL,
+    SEQ_EVENT_LOOP,
+    SEQ_EVENT_LOOPEND,
+    SEQ_EVENT_JUMP,
+    SEQ_EVENT_DELAY,
+    SEQ_EVENT_SET_VELOCITY,
+    SEQ_EVENT_SET_PAN,
+    SEQ_EVENT_TRANSPOSE,
+    SEQ_EVENT_SET_DURATION,
+    SEQ_EVENT_CONTINUOUS_ON,
+    SEQ_EVENT_CONTINUOUS_OFF,
+    SEQ_EVENT_SET_DEFAULT_PLAY_PERCENTAGE,
+    SEQ_EVENT_SET_INSTR,
+    SEQ_EVENT_PORTAMENTO,
+    SEQ_EVENT_DISABLE_PORTAMENTO,
+    SEQ_EVENT_VELOCITY_FROM_TABLE,
+    SEQ_EVENT_DURATION_FROM_TABLE,
+    SEQ_EVENT_NOTE0,
+    SEQ_EVENT_NOTE1,
+    SEQ_EVENT_NOTE2,
+    SEQ_EVENT_FALLBACK,
+) = range(23)
+
+EVENT_NAMES = [
+    "nop", "end", "call", "loop", "loopend", "jump", "delay", "setvel", "setpan",
+    "transpose", "setdur", "contnotes_on", "contnotes_off", "setdefaultpct",
+    "setinstr", "portamento", "disableportamento", "velfromtable",
+    "durfromtable", "note0", "note1", "note2", "fallback",
+]
+
+# Operand layouts for sequence and channel commands (US/JP), used only to walk
+# the control flow far enough to find every layer script and chan_writeseq.
+SEQ_COMMANDS = {
+    0xff: ["end"], 0xfe: [], 0xfd: ["var"], 0xfc: ["call"], 0xfb: ["jump"],
+    0xfa: ["branch"], 0xf9: ["branch"], 0xf8: ["u8"], 0xf7: [], 0xf5: ["branch"],
+    0xf2: ["u8"], 0xf1: [], 0xdf: ["u8"], 0xde: ["u8"], 0xdd: ["u8"],
+    0xdc: ["u8"], 0xdb: ["u8"], 0xda: ["u8"], 0xd7: ["u16"], 0xd6: ["u16"],
+    0xd5: ["u8"], 0xd4: [], 0xd3: ["u8"], 0xd2: ["u16"], 0xd1: ["u16"],
+    0xd0: ["u8"], 0xcc: ["u8"], 0xc9: ["u8"], 0xc8: ["u8"],
+}
+SEQ_ARG_COMMANDS = {0x00: [], 0x50: [], 0x70: [], 0x80: [], 0x90: ["channel"]}
+
+CHAN_COMMANDS = {
+    0xff: ["end"], 0xfe: [], 0xfd: ["var"], 0xfc: ["call"], 0xfb: ["jump"],
+    0xfa: ["branch"], 0xf9: ["branch"], 0xf8: ["u8"], 0xf7: [], 0xf6: [],
+    0xf5: ["branch"], 0xf3: ["hang"], 0xf2: ["u8"], 0xf1: [], 0xe4: ["dynamic"],
+    0xe3: ["u8"], 0xe2: ["u8", "u8", "u8"], 0xe1: ["u8", "u8", "u8"],
+    0xe0: ["u8"], 0xdf: ["u8"], 0xde: ["u16"], 0xdd: ["u8"], 0xdc: ["u8"],
+    0xdb: ["u8"], 0xda: ["u16"], 0xd9: ["u8"], 0xd8: ["u8"], 0xd7: ["u8"],
+    0xd6: ["u8"], 0xd4: ["u8"], 0xd3: ["u8"], 0xd2: ["u8"], 0xd1: ["u8"],
+    0xd0: ["u8"], 0xcc: ["u8"], 0xcb: ["u16"], 0xca: ["u8"], 0xc9: ["u8"],
+    0xc8: ["u8"], 0xc7: ["u8", "writeseq"], 0xc6: ["u8"], 0xc5: ["dynamic"],
+    0xc4: [], 0xc3: [], 0xc2: ["u16"], 0xc1: ["u8"],
+}
+CHAN_ARG_COMMANDS = {
+    0x00: [], 0x10: ["channel"], 0x20: [], 0x30: ["u8"], 0x40: ["u8"], 0x50: [],
+    0x60: [], 0x70: [], 0x80: [], 0x90: ["layer"], 0xa0: [], 0xb0: ["dynamic"],
+}
+
+
+class CompileError(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data, pos):
+        self.data = data
+        self.pos = pos
+
+    def u8(self):
+        if self.pos >= len(self.data):
+            raise CompileError("read past end of sequence")
+        ret = self.data[self.pos]
+        self.pos += 1
+        return ret
+
+    def u16(self):
+        hi = self.u8()
+        return (hi << 8) | self.u8()
+
+    def var(self):
+        ret = self.u8()
+        if ret & 0x80:
+            ret = ((ret << 8) & 0x7F00) | self.u8()
+        return ret
+
+
+def walk_scripts(data):
+    """
+    Decodes the sequence and channel scripts, returning the set of layer entry
+    points, the set of chan_writeseq targets and whether any channel code is
+    reached through a dynamic table.
+    """
+    layer_starts = set()
+    write_targets = set()
+    dynamic = False
+    visited = set()
+    work = [(0, "seq")]
+
+    while work:
+        pos, kind = work.pop()
+        if (pos, kind) in visited:
+            continue
+        visited.add((pos, kind))
+        reader = Reader(data, pos)
+        table, arg_table = (SEQ_COMMANDS, SEQ_ARG_COMMANDS) if kind == "seq" else (CHAN_COMMANDS, CHAN_ARG_COMMANDS)
+
+        cmd = reader.u8()
+        if cmd in table:
+            args = table[cmd]
+        elif (cmd & 0xF0) in arg_table:
+            args = arg_table[cmd & 0xF0]
+        else:
+            raise CompileError("unknown %s command 0x%02x at 0x%x" % (kind, cmd, pos))
+
+        follow = True
+        for arg in args:
+            if arg == "u8":
+                reader.u8()
+            elif arg in ("u16", "call", "jump", "branch", "channel", "layer", "writeseq"):
+                target = reader.u16()
+                if arg == "call" or arg == "branch":
+                    work.append((target, kind))
+                elif arg == "jump":
+                    work.append((target, kind))
+                    follow = False
+                elif arg == "channel":
+                    work.append((target, "chan"))
+                elif arg == "layer":
+                    layer_starts.add(target)
+                elif arg == "writeseq":
+                    write_targets.add(target)
+            elif arg == "var":
+                reader.var()
+            elif arg == "dynamic":
+                dynamic = True
+            elif arg in ("end", "hang"):
+                # chan_end may return to a caller, which is already queued as
+                # the fall-through of the call.
+                follow = False
+        if follow:
+            work.append((reader.pos, kind))
+
+    return layer_starts, write_targets, dynamic
+
+
+def decode_layer_command(data, pos):
+    """Decodes a single layer command, returning (event fields, next pos, branch targets, falls through)."""
+    reader = Reader(data, pos)
+    cmd = reader.u8()
+    arg0 = arg1 = arg2 = value = 0
+    targets = []
+    falls_through = True
+
+    if cmd == 0xFF:
+        op = SEQ_EVENT_END
+        falls_through = False
+    elif cmd == 0xFC:
+        op = SEQ_EVENT_CALL
+        value = reader.u16()
+        targets.append(value)
+    elif cmd == 0xF8:
+        op = SEQ_EVENT_LOOP
+        arg0 = reader.u8()
+    elif cmd == 0xF7:
+        op = SEQ_EVENT_LOOPEND
+    elif cmd == 0xFB:
+        op = SEQ_EVENT_JUMP
+        value = reader.u16()
+        targets.append(value)
+        falls_through = False
+    elif cmd == 0xC1:
+        op = SEQ_EVENT_SET_VELOCITY
+        arg0 = reader.u8()
+    elif cmd == 0xCA:
+        op = SEQ_EVENT_SET_PAN
+        arg0 = reader.u8()
+    elif cmd == 0xC2:
+        op = SEQ_EVENT_TRANSPOSE
+        arg0 = reader.u8()
+    elif cmd == 0xC9:
+        op = SEQ_EVENT_SET_DURATION
+        arg0 = reader.u8()
+    elif cmd == 0xC4:
+        op = SEQ_EVENT_CONTINUOUS_ON
+    elif cmd == 0xC5:
+        op = SEQ_EVENT_CONTINUOUS_OFF
+    elif cmd == 0xC3:
+        op = SEQ_EVENT_SET_DEFAULT_PLAY_PERCENTAGE
+        value = reader.var()
+    elif cmd == 0xC6:
+        op = SEQ_EVENT_SET_INSTR
+        arg0 = reader.u8()
+    elif cmd == 0xC7:
+        op = SEQ_EVENT_PORTAMENTO
+        arg0 = reader.u8()
+        arg1 = reader.u8()
+        value = reader.u8() if (arg0 & 0x80) else reader.var()
+    elif cmd == 0xC8:
+        op = SEQ_EVENT_DISABLE_PORTAMENTO
+    elif cmd > 0xC0 and (cmd & 0xF0) == 0xD0:
+        op = SEQ_EVENT_VELOCITY_FROM_TABLE
+        arg0 = cmd & 0xF
+    elif cmd > 0xC0 and (cmd & 0xF0) == 0xE0:
+        op = SEQ_EVENT_DURATION_FROM_TABLE
+        arg0 = cmd & 0xF
+    elif cmd > 0xC0:
+        # Unhandled layer commands are skipped by the interpreter.
+        op = SEQ_EVENT_NOP
+    elif cmd == 0xC0:
+        op = SEQ_EVENT_DELAY
+        value = reader.var()
+    else:
+        # Large notes; the runtime falls back to the interpreter when the
+        # channel has large notes disabled.
+        arg0 = cmd & 0x3F
+        if (cmd & 0xC0) == 0x00:
+            op = SEQ_EVENT_NOTE0
+            value = reader.var()
+            arg1 = reader.u8()
+            arg2 = reader.u8()
+        elif (cmd & 0xC0) == 0x40:
+            op = SEQ_EVENT_NOTE1
+            value = reader.var()
+            arg1 = reader.u8()
+        else:
+            op = SEQ_EVENT_NOTE2
+            arg1 = reader.u8()
+            arg2 = reader.u8()
+
+    return [op, arg0, arg1, arg2, value], reader.pos, targets, falls_through
+
+
+def compile_layers(data, layer_starts, write_targets):
+    commands = {}
+    work = sorted(layer_starts)
+    while work:
+        pos = work.pop()
+        while pos not in commands:
+            fields, next_pos, targets, falls_through = decode_layer_command(data, pos)
+            if any(pos <= t < next_pos for t in write_targets):
+                fields = [SEQ_EVENT_FALLBACK, 0, 0, 0, 0]
+            commands[pos] = (fields, next_pos)
+            work.extend(targets)
+            if not falls_through or fields[0] == SEQ_EVENT_FALLBACK:
+                break
+            pos = next_pos
+
+    offsets = sorted(commands)
+    for prev, cur in zip(offsets, offsets[1:]):
+        if commands[prev][1] > cur:
+            raise CompileError("overlapping layer commands at 0x%x and 0x%x" % (prev, cur))
+
+    index_of = {offset: i for i, offset in enumerate(offsets)}
+    events = []
+    for offset in offsets:
+        fields, next_pos = commands[offset]
+        op = fields[0]
+        if op in (SEQ_EVENT_CALL, SEQ_EVENT_JUMP):
+            fields[4] = index_of[fields[4]]
+        if op in (SEQ_EVENT_CALL, SEQ_EVENT_LOOP) and next_pos not in index_of:
+            # The runtime resumes at the next event after a call returns or a
+            # loop repeats, so it must be the next command in the script.
+            raise CompileError("missing return point at 0x%x" % next_pos)
+        events.append(fields + [offset])
+    return events
+
+
+def compile_sequence(data):
+    """Returns the list of events for a sequence, raising CompileError if it can't be compiled."""
+    layer_starts, write_targets, dynamic = walk_scripts(data)
+    if dynamic and write_targets:
+        # Channel code hidden behind dynamic tables may patch any layer.
+        raise CompileError("chan_writeseq used together with dynamic channel code")
+    return compile_layers(data, layer_starts, write_targets)
+
+
+def serialize_events(events, base_offset):
+    """Serializes an event stream placed at base_offset into the sequence, including the footer."""
+    if len(events) > 0xFFFF:
+        raise CompileError("too many events")
+    out = bytearray(SEQ_EVENTS_MAGIC + struct.pack(">HH", len(events), 0))
+    for op, arg0, arg1, arg2, value, offset in events:
+        out += struct.pack(">BBBBHH", op, arg0, arg1, arg2, value, offset)
+    out += SEQ_EVENTS_MAGIC + struct.pack(">I", base_offset)
+    return bytes(out)
+
+
+def main():
+    verbose = "--dump" in sys.argv
+    files = [a for a in sys.argv[1:] if not a.startswith("--")]
+    if not files:
+        print("Usage: %s [--dump] file.m64 ..." % sys.argv[0])
+        sys.exit(1)
+
+    for fname in files:
+        with open(fname, "rb") as f:
+            data = f.read()
+        try:
+            events = compile_sequence(data)
+        except CompileError as e:
+            print("%s: not compiled (%s)" % (fname, e))
+            continue
+        fallbacks = sum(1 for e in events if e[0] == SEQ_EVENT_FALLBACK)
+        notes = sum(1 for e in events if SEQ_EVENT_NOTE0 <= e[0] <= SEQ_EVENT_NOTE2)
+        print(
+            "%s: %d bytes, %d events (%d notes, %d fallbacks), %d stream bytes"
+            % (fname, len(data), len(events), notes, fallbacks, len(serialize_events(events, 0)))
+        )
+        if verbose:
+            for op, arg0, arg1, arg2, value, offset in events:
+                print("    %04x: %-18s %3d %3d %3d %5d" % (offset, EVENT_NAMES[op], arg0, arg1, arg2, value))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,65 @@
+"""
+Builds and runs host-side harnesses for game code.
+
+A harness is a C file in tools/tests/host that #includes the game source it tests, stubs out
+what that source needs from the rest of the game and libultra, and exits with 0 when its checks
+pass. It's compiled natively with the game's headers and compile_flags.txt, so it runs on the
+build machine without an emulator.
+"""
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+TOOLS_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+REPO_DIR = os.path.dirname(TOOLS_DIR)
+HOST_DIR = os.path.join(TOOLS_DIR, "tests", "host")
+
+# Let the tests import the tools they test.
+sys.path.insert(0, TOOLS_DIR)
+
+
+def compile_flags():
+    """
+    The game's include paths, forced includes and defines from compile_flags.txt, minus
+    make_const_nonconst.h, which is only there for editors and isn't used by the build.
+    """
+    flags = []
+    with open(os.path.join(REPO_DIR, "compile_flags.txt")) as f:
+        for line in f:
+            flags += line.split()
+    i = flags.index("include/make_const_nonconst.h")
+    return flags[:i - 1] + flags[i + 1:]
+
+
+def gcc_include_dir():
+    return subprocess.run(["gcc", "-print-file-name=include"], capture_output=True, text=True, check=True).stdout.strip()
+
+
+def run_harness(name, defines=(), flags=()):
+    """
+    Compiles tools/tests/host/<name>.c and runs it, with any extra gcc flags. Returns its output;
+    raises AssertionError with the output if it fails.
+    """
+    if shutil.which("gcc") is None:
+        raise unittest.SkipTest("gcc not found")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = os.path.join(tmp, name)
+        cmd = [
+            "gcc", "-O1", "-w", "-fno-strict-aliasing", "-nostdinc",
+            "-I" + REPO_DIR, "-I" + os.path.join(REPO_DIR, "include/libc"), "-I" + os.path.join(REPO_DIR, "include/hvqm"),
+            "-I" + os.path.join(REPO_DIR, "src/hvqm"), "-I" + gcc_include_dir(),
+            *compile_flags(), *("-D" + d for d in defines), *flags,
+            os.path.join(HOST_DIR, name + ".c"), "-o", exe, "-lm",
+        ]
+        build = subprocess.run(cmd, cwd=REPO_DIR, capture_output=True, text=True)
+        if build.returncode != 0:
+            raise AssertionError("building %s failed:\n%s" % (name, build.stderr))
+
+        run = subprocess.run([exe], capture_output=True, text=True, timeout=120)
+        if run.returncode != 0:
+            raise AssertionError("%s failed:\n%s%s" % (name, run.stdout, run.stderr))
+        return run.stdout
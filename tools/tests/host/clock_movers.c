@@ -0,0 +1,185 @@
+/**
+ * Runs a clock mover next to an object that turns itself every frame like vanilla's movers,
+ * through the ways an object can miss or get extra frames, and checks that the mover's angle, as
+ * rendered and as synced for collision, always matches the stepped one. It also counts how many
+ * frames the stepper turned on against how many the mover's angle was worked out on.
+ *
+ * Both objects run through the real cur_obj_update and update_objects_in_list, and the stepper's
+ * behavior script is just an ADD_INT. The scripts' loop stack holds 32 bit addresses, so this is
+ * linked at a low address with -no-pie.
+ */
+#include "tools/tests/host/harness.h"
+
+#include "src/game/object_list_processor.c"
+#include "src/engine/behavior_script.c"
+#include "src/game/clock_mover.c"
+
+#define SPEED 300
+
+// From data/behavior_data.c
+#define BHV_CMD_BEGIN_LOOP 0x08
+#define BHV_CMD_END_LOOP   0x09
+#define BHV_CMD_ADD_INT    0x0F
+
+static const BehaviorScript sMoverScript[] = {
+    BHV_CMD_BEGIN_LOOP << 24,
+    BHV_CMD_END_LOOP << 24,
+};
+
+static const BehaviorScript sStepperScript[] = {
+    BHV_CMD_BEGIN_LOOP << 24,
+    (BHV_CMD_ADD_INT << 24) | (O_FACE_ANGLE_YAW_INDEX << 16) | SPEED,
+    BHV_CMD_END_LOOP << 24,
+};
+
+struct Object *gMarioObject;
+struct MarioState gMarioStates[1];
+s16 gCurrAreaIndex = 1;
+struct WarpDest sWarpDest;
+void *gDynamicSurfacePool;
+void *gDynamicSurfacePoolEnd;
+
+static struct ObjectNode sList;
+static struct Object sMover;
+static struct Object sStepper;
+static s32 sMarioInRoom;
+
+s32 cur_obj_is_mario_in_room(void) {
+    return sMarioInRoom ? MARIO_INSIDE_ROOM : MARIO_OUTSIDE_ROOM;
+}
+
+void cur_obj_enable_rendering_in_room(void) {
+}
+
+void cur_obj_disable_rendering_in_room(void) {
+}
+
+// Only reached by the parts of object_list_processor.c and behavior_script.c this doesn't run.
+#define NOT_RUN(name) CHECK(FALSE, #name " isn't stubbed")
+
+const BehaviorScript bhvMario[1];
+const BehaviorScript bhvBreathParticleSpawner[1], bhvBubbleParticleSpawner[1], bhvDirtParticleSpawner[1],
+    bhvFireParticleSpawner[1], bhvHorStarParticleSpawner[1], bhvIdleWaterWave[1], bhvLeafParticleSpawner[1],
+    bhvMistCircParticleSpawner[1], bhvMistParticleSpawner[1], bhvPlungeBubble[1], bhvShallowWaterSplash[1],
+    bhvShallowWaterWave[1], bhvSnowParticleSpawner[1], bhvSparkleParticleSpawner[1], bhvTriangleParticleSpawner[1],
+    bhvVertStarParticleSpawner[1], bhvWaterSplash[1], bhvWaveTrail[1];
+u32 gGlobalTimer;
+struct GraphNode **gLoadedGraphNodes;
+void __n64Assert(char *fileName, u32 lineNum, char *message) { NOT_RUN(__n64Assert); }
+void apply_mario_platform_displacement(void) { NOT_RUN(apply_mario_platform_displacement); }
+void clear_compound_actors(void) { NOT_RUN(clear_compound_actors); }
+void clear_dynamic_surfaces(void) { NOT_RUN(clear_dynamic_surfaces); }
+void clear_mario_platform(void) { NOT_RUN(clear_mario_platform); }
+void clear_object_lists(struct ObjectNode *objLists) { NOT_RUN(clear_object_lists); }
+struct Object *create_object(const BehaviorScript *bhvScript) { NOT_RUN(create_object); return NULL; }
+void cur_obj_hide(void) { NOT_RUN(cur_obj_hide); }
+void cur_obj_move_xz_using_fvel_and_yaw(void) { NOT_RUN(cur_obj_move_xz_using_fvel_and_yaw); }
+void cur_obj_move_y_with_terminal_vel(void) { NOT_RUN(cur_obj_move_y_with_terminal_vel); }
+void cur_obj_scale(f32 scale) { NOT_RUN(cur_obj_scale); }
+void detect_object_collisions(void) { NOT_RUN(detect_object_collisions); }
+f32 dist_between_objects(struct Object *obj1, struct Object *obj2) { NOT_RUN(dist_between_objects); return 0; }
+s32 execute_mario_action(struct Object *obj) { NOT_RUN(execute_mario_action); return 0; }
+f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) { NOT_RUN(find_floor); return 0; }
+f32 find_floor_height(f32 x, f32 y, f32 z) { NOT_RUN(find_floor_height); return 0; }
+struct GraphNode *geo_make_first_child(struct GraphNode *newFirstChild) { NOT_RUN(geo_make_first_child); return NULL; }
+void geo_obj_init_animation(struct GraphNodeObject *graphNode, struct Animation **animPtrAddr) { NOT_RUN(geo_obj_init_animation); }
+void geo_obj_init_spawninfo(struct GraphNodeObject *graphNode, struct SpawnInfo *spawn) { NOT_RUN(geo_obj_init_spawninfo); }
+void geo_reset_object_node(struct GraphNodeObject *graphNode) { NOT_RUN(geo_reset_object_node); }
+void init_free_object_list(void) { NOT_RUN(init_free_object_list); }
+struct MemoryPool *mem_pool_init(u32 size, u32 side) { NOT_RUN(mem_pool_init); return NULL; }
+s32 obj_angle_to_object(struct Object *obj1, struct Object *obj2) { NOT_RUN(obj_angle_to_object); return 0; }
+void obj_build_transform_relative_to_parent(struct Object *obj) { NOT_RUN(obj_build_transform_relative_to_parent); }
+void obj_copy_pos_and_angle(struct Object *dst, struct Object *src) { NOT_RUN(obj_copy_pos_and_angle); }
+void obj_set_throw_matrix_from_transform(struct Object *obj) { NOT_RUN(obj_set_throw_matrix_from_transform); }
+u32 profiler_get_delta(enum ProfilerDeltaTime which) { return 0; }
+void profiler_update(enum ProfilerTime which, u32 delta) { }
+f32 random_float(void) { NOT_RUN(random_float); return 0; }
+u16 random_u16(void) { NOT_RUN(random_u16); return 0; }
+void *segmented_to_virtual(const void *addr) { NOT_RUN(segmented_to_virtual); return NULL; }
+struct Object *spawn_object_at_origin(struct Object *parent, s32 unusedArg, ModelID32 model, const BehaviorScript *behavior) {
+    NOT_RUN(spawn_object_at_origin);
+    return NULL;
+}
+struct Object *spawn_water_droplet(struct Object *parent, struct WaterDropletParams *params) {
+    NOT_RUN(spawn_water_droplet);
+    return NULL;
+}
+void unload_object(struct Object *obj) { NOT_RUN(unload_object); }
+void update_mario_platform(void) { NOT_RUN(update_mario_platform); }
+
+static void add_object(struct Object *obj, const BehaviorScript *script, u32 flags) {
+    obj->header.next = sList.next;
+    obj->header.prev = &sList;
+    sList.next->prev = &obj->header;
+    sList.next = &obj->header;
+
+    obj->activeFlags = ACTIVE_FLAG_ACTIVE;
+    obj->oFlags = flags;
+    obj->oRoom = -1;
+    obj->curBhvCommand = script;
+    obj->bhvStackIndex = 0;
+}
+
+int main(void) {
+    s32 frame;
+    s32 numStepped = 0;
+    s32 numSynced = 0;
+    Vec3s angle;
+
+    sList.next = &sList;
+    sList.prev = &sList;
+    add_object(&sStepper, sStepperScript, OBJ_FLAG_ONLY_PROCESS_INSIDE_ROOM);
+    add_object(&sMover, sMoverScript, OBJ_FLAG_ONLY_PROCESS_INSIDE_ROOM);
+    sMover.oAngleVelYaw = SPEED;
+    gObjectClock = 1234;
+
+    for (frame = 0; frame < 800; frame++) {
+        s32 before = sStepper.oFaceAngleYaw;
+
+        // Mario leaves the room on and off, and each way time stop can hold the objects is
+        // tried with him in and out of it.
+        sMarioInRoom = (frame / 50) % 2 == 0;
+        gTimeStopState = 0;
+        sStepper.activeFlags &= ~ACTIVE_FLAG_INITIATED_TIME_STOP;
+        sMover.activeFlags &= ~ACTIVE_FLAG_INITIATED_TIME_STOP;
+        if (frame >= 200 && frame < 400) {
+            gTimeStopState = TIME_STOP_ENABLED | TIME_STOP_ACTIVE | TIME_STOP_ALL_OBJECTS;
+        } else if (frame >= 400 && frame < 600) {
+            // Like the object that started a time stop, the only one that keeps moving
+            gTimeStopState = TIME_STOP_ENABLED | TIME_STOP_ACTIVE;
+            sStepper.activeFlags |= ACTIVE_FLAG_INITIATED_TIME_STOP;
+            sMover.activeFlags |= ACTIVE_FLAG_INITIATED_TIME_STOP;
+        }
+
+        // As update_objects
+        if (!(gTimeStopState & TIME_STOP_ACTIVE)) {
+            gObjectClock++;
+        }
+        if (frame == 0) {
+            // As the mover's init, which runs just before its first update
+            obj_start_clock_mover(&sMover);
+        }
+        update_objects_in_list(&sList);
+        if (sStepper.oFaceAngleYaw != before) {
+            numStepped++;
+        }
+
+        obj_get_clock_mover_angle(&sMover, angle);
+        CHECK(angle[1] == (s16) sStepper.oFaceAngleYaw, "frame %d: mover rendered at %04x, stepped object at %04x",
+              frame, (u16) angle[1], (u16) sStepper.oFaceAngleYaw);
+
+        // Mario is near enough for its collision every third frame
+        if (frame % 3 == 0) {
+            obj_sync_clock_mover(&sMover);
+            numSynced++;
+            CHECK((s16) sMover.oFaceAngleYaw == (s16) sStepper.oFaceAngleYaw,
+                  "frame %d: mover synced to %04x, stepped object at %04x",
+                  frame, (u16) sMover.oFaceAngleYaw, (u16) sStepper.oFaceAngleYaw);
+        }
+    }
+
+    printf("stepped object turned on %d of %d frames, mover's angle worked out on %d\n", numStepped, frame, numSynced);
+    CHECK(numStepped > 200 && numStepped < 600, "every frame was %s", numStepped <= 200 ? "skipped" : "stepped");
+    printf("OK\n");
+    return 0;
+}
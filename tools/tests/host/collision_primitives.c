@@ -0,0 +1,444 @@
+/**
+ * Loads the breakable box's collision as its old triangles and as the COL_PRIMITIVE_BOX it was
+ * converted to, at a few yaws, and checks find_floor, find_ceil, find_wall_collisions and
+ * find_surface_on_ray against each other:
+ *  - Floors and ceilings match exactly, away from the turned triangles' vertices being rounded
+ *    to whole units.
+ *  - Both wall versions push Mario out to his radius from the box and find walls in the same
+ *    places. Where they push him to differs: the triangles also push him sideways where a
+ *    side's two triangles meet, and out of another side when he's deep in the box. That's only
+ *    measured.
+ *  - Rays hit the same side at the same place, except near the edges, and the triangles miss
+ *    some that the cells the ray steps through split.
+ * A cylinder is checked against its own shape, since no vanilla object has one. The time both
+ * versions take to load and answer the queries is printed, and so are the surfaces each loads.
+ */
+#include "tools/tests/host/harness.h"
+
+// math_util.h's absf and roundf are MIPS assembly, so they're swapped for host versions. The
+// rest of the assembly is in mtxf_to_mtx_fast, which doesn't run here.
+#define __asm__(...)
+#define absf mips_absf
+#define roundf mips_roundf
+#include "src/engine/math_util.h"
+#undef absf
+#undef roundf
+
+static f32 absf(f32 in) {
+    return ((in < 0.0f) ? -in : in);
+}
+
+static s32 roundf(f32 in) {
+    return __builtin_rintf(in);
+}
+
+#include "src/engine/math_util.c"
+#undef __asm__
+#include "src/engine/surface_load.c"
+#include "src/engine/surface_collision.c"
+#include "actors/breakable_box/collision.inc.c"
+
+double fabs(double x);
+long clock(void);
+
+// The breakable box's collision before it was converted, and a SURFACE_DEFAULT copy of both for
+// rays, which skip SURFACE_NO_CAM_COLLISION.
+#define BOX_MESH(surfType)                                                                  \
+    COL_INIT(), COL_VERTEX_INIT(0x8),                                                       \
+    COL_VERTEX(-100, 0, -100), COL_VERTEX(-100, 0, 100), COL_VERTEX(-100, 200, 100),        \
+    COL_VERTEX(100, 0, 100), COL_VERTEX(100, 200, 100), COL_VERTEX(100, 0, -100),           \
+    COL_VERTEX(100, 200, -100), COL_VERTEX(-100, 200, -100),                                \
+    COL_TRI_INIT(surfType, 12),                                                             \
+    COL_TRI(0, 1, 2), COL_TRI(1, 3, 4), COL_TRI(1, 4, 2), COL_TRI(5, 3, 1), COL_TRI(5, 1, 0), \
+    COL_TRI(6, 4, 3), COL_TRI(6, 3, 5), COL_TRI(7, 4, 6), COL_TRI(7, 2, 4), COL_TRI(0, 2, 7), \
+    COL_TRI(7, 6, 5), COL_TRI(7, 5, 0), COL_TRI_STOP(), COL_END()
+
+static const Collision sBoxMesh[] = { BOX_MESH(SURFACE_NO_CAM_COLLISION) };
+static const Collision sCamBoxMesh[] = { BOX_MESH(SURFACE_DEFAULT) };
+static const Collision sCamBox[] = { COL_PRIMITIVE_BOX(SURFACE_DEFAULT, 100, 0, 200, 100), COL_END() };
+static const Collision sCylinder[] = { COL_PRIMITIVE_CYLINDER(SURFACE_DEFAULT, 150, 0, 300), COL_END() };
+
+#define BOX_X 1000.0f
+#define BOX_Y 500.0f
+#define BOX_Z -2000.0f
+#define BOX_HALF 100.0f
+#define BOX_HEIGHT 200.0f
+#define MARIO_RADIUS 50.0f
+
+struct Object *gCurrentObject;
+struct Object *gMarioObject;
+struct MarioState *gMarioState;
+u32 gTimeStopState;
+s16 gCollisionFlags;
+s32 gSurfaceNodesAllocated;
+s32 gSurfacesAllocated;
+s32 gNumStaticSurfaceNodes;
+s32 gNumStaticSurfaces;
+Mat4 gCameraTransform;
+
+static u8 sDynamicPool[0x8000];
+static struct Object sBox;
+static struct Object sMario;
+static s32 sNumSurfaces;
+
+void obj_build_transform_from_pos_and_angle(struct Object *obj, s16 posIndex, s16 angleIndex) {
+    Vec3f translate;
+    vec3f_copy(translate, &obj->rawData.asF32[posIndex]);
+    Vec3s rotation;
+    vec3i_to_vec3s(rotation, &obj->rawData.asS32[angleIndex]);
+    mtxf_rotate_zxy_and_translate(obj->transform, translate, rotation);
+}
+
+f32 dist_between_objects(struct Object *obj1, struct Object *obj2) {
+    return sqrtf(sqr(obj1->oPosX - obj2->oPosX) + sqr(obj1->oPosY - obj2->oPosY) + sqr(obj1->oPosZ - obj2->oPosZ));
+}
+
+void clear_dynamic_surface_references(void) {
+}
+
+void *segmented_to_virtual(const void *addr) {
+    return (void *) addr;
+}
+
+void __n64Assert(char *fileName, u32 lineNum, char *message) {
+    CHECK(FALSE, "%s:%d: %s", fileName, lineNum, message);
+}
+
+// Only reached by the parts of the collision code this doesn't run.
+#define NOT_RUN(name) CHECK(FALSE, #name " isn't stubbed")
+const BehaviorScript bhvDddWarp[1];
+s16 gCCMEnteredSlide;
+struct Area *gCurrentArea;
+s32 gEnvironmentLevels[20];
+TerrainData *gEnvironmentRegions;
+struct LakituState gLakituState;
+s32 gNumFindFloorMisses;
+void *main_pool_alloc(u32 size, u32 side) { NOT_RUN(main_pool_alloc); return NULL; }
+u32 main_pool_available(void) { NOT_RUN(main_pool_available); return 0; }
+void *main_pool_realloc(void *addr, u32 size) { NOT_RUN(main_pool_realloc); return NULL; }
+void obj_sync_clock_mover(struct Object *obj) { NOT_RUN(obj_sync_clock_mover); }
+void reset_red_coins_collected(void) { NOT_RUN(reset_red_coins_collected); }
+void spawn_macro_objects(s32 areaIndex, MacroObject *macroObjList) { NOT_RUN(spawn_macro_objects); }
+void spawn_macro_objects_hardcoded(s32 areaIndex, MacroObject *macroObjList) { NOT_RUN(spawn_macro_objects_hardcoded); }
+void spawn_special_objects(s32 areaIndex, TerrainData **specialObjList) { NOT_RUN(spawn_special_objects); }
+
+/**
+ * Clears the dynamic collision and loads the box's, as on a new frame.
+ */
+static void load_box(const Collision *collision, s16 yaw) {
+    clear_dynamic_surfaces();
+    gDynamicSurfacePoolEnd = gDynamicSurfacePool;
+
+    sBox.collisionData = (void *) collision;
+    sBox.oFaceAngleYaw = yaw;
+    sBox.header.gfx.throwMatrix = NULL;
+    gCurrentObject = &sBox;
+    load_object_collision_model();
+    sNumSurfaces = (gSurfacesAllocated - gNumStaticSurfaces);
+}
+
+/**
+ * A point in the box's turned space, where it's a square around the origin.
+ */
+static void to_local(f32 x, f32 z, s16 yaw, f32 *localX, f32 *localZ) {
+    f32 c = coss(yaw);
+    f32 s = sins(yaw);
+
+    *localX = (((x - BOX_X) * c) - ((z - BOX_Z) * s));
+    *localZ = (((x - BOX_X) * s) + ((z - BOX_Z) * c));
+}
+
+/**
+ * How far a point at x, z is from the box's outline, looking from above.
+ */
+static f32 dist_from_outline(f32 x, f32 z, s16 yaw) {
+    f32 localX, localZ;
+
+    to_local(x, z, yaw, &localX, &localZ);
+    if (fabs(localX) <= BOX_HALF && fabs(localZ) <= BOX_HALF) {
+        return MIN(BOX_HALF - fabs(localX), BOX_HALF - fabs(localZ));
+    }
+    if (fabs(localX) <= BOX_HALF) return (fabs(localZ) - BOX_HALF);
+    if (fabs(localZ) <= BOX_HALF) return (fabs(localX) - BOX_HALF);
+    return sqrtf(sqr(fabs(localX) - BOX_HALF) + sqr(fabs(localZ) - BOX_HALF));
+}
+
+#define GRID_MIN  -160
+#define GRID_MAX   160
+#define GRID_STEP    4
+#define GRID_SIZE (((GRID_MAX - GRID_MIN) / GRID_STEP) + 1)
+
+static f32 sFloors[2][GRID_SIZE][GRID_SIZE];
+static f32 sCeils[2][GRID_SIZE][GRID_SIZE];
+
+#define NUM_WALL_ANGLES 256
+#define NUM_WALL_DISTS  12
+
+static Vec3f sWalls[2][NUM_WALL_ANGLES][NUM_WALL_DISTS];
+static s32 sWallHits[2][NUM_WALL_ANGLES][NUM_WALL_DISTS];
+
+#define NUM_RAYS 2000
+
+static f32 sRayLengths[2][NUM_RAYS];
+static Vec3f sRayHits[2][NUM_RAYS];
+static s8 sRaySides[2][NUM_RAYS];
+
+static u32 sRandom = 1;
+
+static f32 random_coord(f32 range) {
+    sRandom = (sRandom * 1103515245) + 12345;
+    return ((((sRandom >> 8) & 0xFFFF) / 65535.0f) * 2.0f - 1.0f) * range;
+}
+
+/**
+ * Where the wall query at angle i and depth j starts. They go all around the box, from touching
+ * it with Mario's radius to deep into its sides, aiming at the sides and the corners alike.
+ */
+static void wall_start(Vec3f pos, s32 i, s32 j, s16 yaw) {
+    f32 dist = ((BOX_HALF + MARIO_RADIUS) - (j * 5.0f));
+    f32 localX = (coss(i * 0x100) * dist);
+    f32 localZ = (sins(i * 0x100) * dist);
+
+    pos[0] = (BOX_X + (localX * coss(yaw)) + (localZ * sins(yaw)));
+    pos[1] = BOX_Y;
+    pos[2] = (BOX_Z - (localX * sins(yaw)) + (localZ * coss(yaw)));
+}
+
+/**
+ * Runs every query against the loaded box, into the arrays for version v.
+ */
+static void run_queries(s32 v, s16 yaw) {
+    struct Surface *surf;
+    s32 i, j;
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        for (j = 0; j < GRID_SIZE; j++) {
+            f32 x = (BOX_X + GRID_MIN + (i * GRID_STEP));
+            f32 z = (BOX_Z + GRID_MIN + (j * GRID_STEP));
+
+            sFloors[v][i][j] = find_floor(x, (BOX_Y + BOX_HEIGHT + 50.0f), z, &surf);
+            CHECK((surf == NULL) == (sFloors[v][i][j] == FLOOR_LOWER_LIMIT) && (surf == NULL || surf->object == &sBox),
+                  "floor at %.0f, %.0f isn't the box's", x, z);
+            sCeils[v][i][j] = find_ceil(x, (BOX_Y - 50.0f), z, &surf);
+            CHECK((surf == NULL) == (sCeils[v][i][j] == CELL_HEIGHT_LIMIT) && (surf == NULL || surf->object == &sBox),
+                  "ceiling at %.0f, %.0f isn't the box's", x, z);
+        }
+    }
+
+    for (i = 0; i < NUM_WALL_ANGLES; i++) {
+        for (j = 0; j < NUM_WALL_DISTS; j++) {
+            f32 *pos = sWalls[v][i][j];
+
+            wall_start(pos, i, j, yaw);
+            sWallHits[v][i][j] = f32_find_wall_collision(&pos[0], &pos[1], &pos[2], 60.0f, MARIO_RADIUS);
+        }
+    }
+
+    // Rays from all around the box to points in and around it
+    sRandom = 1;
+    for (i = 0; i < NUM_RAYS; i++) {
+        Vec3f orig = { (BOX_X + random_coord(400.0f)), (BOX_Y + 100.0f + random_coord(400.0f)), (BOX_Z + random_coord(400.0f)) };
+        Vec3f target = { (BOX_X + random_coord(150.0f)), (BOX_Y + 100.0f + random_coord(150.0f)), (BOX_Z + random_coord(150.0f)) };
+        Vec3f dir;
+
+        vec3f_diff(dir, target, orig);
+        vec3_scale(dir, 2.0f);
+        sRayLengths[v][i] = find_surface_on_ray(orig, dir, &surf, sRayHits[v][i], RAYCAST_FIND_ALL);
+        sRaySides[v][i] = ((surf == NULL) ? 0 : (surf->normal.y > 0.5f) ? 1 : (surf->normal.y < -0.5f) ? -1 : 2);
+    }
+}
+
+/**
+ * How many of a point's coordinates in the box's space are within margin of its sides. A ray
+ * hit on 2 or more is on one of its edges.
+ */
+static s32 num_sides_near(Vec3f pos, s16 yaw, f32 margin) {
+    f32 localX, localZ;
+
+    to_local(pos[0], pos[2], yaw, &localX, &localZ);
+    return ((fabs(fabs(localX) - BOX_HALF) < margin)
+          + (fabs(fabs(localZ) - BOX_HALF) < margin)
+          + (fabs(pos[1] - BOX_Y) < margin)
+          + (fabs(pos[1] - (BOX_Y + BOX_HEIGHT)) < margin));
+}
+
+/**
+ * How far a point is from the box's surface, inside or out.
+ */
+static f32 dist_from_surface(Vec3f pos, s16 yaw) {
+    f32 localX, localZ;
+    f32 y = (pos[1] - (BOX_Y + (BOX_HEIGHT / 2.0f)));
+
+    to_local(pos[0], pos[2], yaw, &localX, &localZ);
+    localX = (fabs(localX) - BOX_HALF);
+    localZ = (fabs(localZ) - BOX_HALF);
+    y = (fabs(y) - (BOX_HEIGHT / 2.0f));
+    if (localX <= 0.0f && localZ <= 0.0f && y <= 0.0f) {
+        return -MAX(MAX(localX, localZ), y);
+    }
+    return sqrtf(sqr(MAX(localX, 0.0f)) + sqr(MAX(localZ, 0.0f)) + sqr(MAX(y, 0.0f)));
+}
+
+static void compare_box(s16 yaw) {
+    // The turned triangles' vertices are rounded to whole units.
+    f32 margin = ((yaw == 0) ? 0.0f : 1.5f);
+    f32 maxWallDiff = 0.0f;
+    s32 numWallDiffs = 0;
+    s32 numMeshShort = 0;
+    f32 edgeMargin = ((yaw == 0) ? 0.5f : 5.0f);
+    s32 numEdgeRays = 0;
+    s32 numMissedRays = 0;
+    s32 i, j;
+
+    load_box(sBoxMesh, yaw);
+    run_queries(0, yaw);
+    load_box(breakable_box_seg8_collision, yaw);
+    CHECK(gNumSurfacePrimitives == 1 && sNumSurfaces == 0, "the breakable box isn't a primitive");
+    run_queries(1, yaw);
+
+    for (i = 0; i < GRID_SIZE; i++) {
+        for (j = 0; j < GRID_SIZE; j++) {
+            f32 x = (BOX_X + GRID_MIN + (i * GRID_STEP));
+            f32 z = (BOX_Z + GRID_MIN + (j * GRID_STEP));
+
+            if (dist_from_outline(x, z, yaw) <= margin) continue;
+            CHECK(sFloors[0][i][j] == sFloors[1][i][j], "yaw %04x: floor at %.0f, %.0f is %.1f, was %.1f",
+                  (u16) yaw, x, z, sFloors[1][i][j], sFloors[0][i][j]);
+            CHECK(sCeils[0][i][j] == sCeils[1][i][j], "yaw %04x: ceiling at %.0f, %.0f is %.1f, was %.1f",
+                  (u16) yaw, x, z, sCeils[1][i][j], sCeils[0][i][j]);
+        }
+    }
+
+    for (i = 0; i < NUM_WALL_ANGLES; i++) {
+        for (j = 0; j < NUM_WALL_DISTS; j++) {
+            f32 *mesh = sWalls[0][i][j];
+            f32 *prim = sWalls[1][i][j];
+            f32 diff = sqrtf(sqr(mesh[0] - prim[0]) + sqr(mesh[2] - prim[2]));
+            f32 localX, localZ;
+            Vec3f start;
+
+            // Both push Mario out to his radius from the sides. Where they push him along the
+            // sides differs, so that's only measured.
+            maxWallDiff = MAX(maxWallDiff, diff);
+            numWallDiffs += (diff > (margin + 0.01f));
+            CHECK(sWallHits[1][i][j] == 0 || fabs(dist_from_outline(prim[0], prim[2], yaw) - MARIO_RADIUS) < 0.01f,
+                  "yaw %04x: wall push to %.2f, %.2f isn't out of the box", (u16) yaw, prim[0], prim[2]);
+            if (sWallHits[0][i][j] > 0 && dist_from_outline(mesh[0], mesh[2], yaw) < (MARIO_RADIUS - margin - 0.01f)) {
+                numMeshShort++;
+            }
+
+            // Touching the sides, the turned triangles may or may not count a wall, and past a
+            // corner they can miss it.
+            wall_start(start, i, j, yaw);
+            to_local(start[0], start[2], yaw, &localX, &localZ);
+            if ((j == 0 && margin > 0.0f) || (fabs(localX) > (BOX_HALF - margin) && fabs(localZ) > (BOX_HALF - margin))) {
+                continue;
+            }
+            CHECK((sWallHits[0][i][j] > 0) == (sWallHits[1][i][j] > 0), "yaw %04x: %s wall at %.2f, %.2f",
+                  (u16) yaw, (sWallHits[1][i][j] > 0) ? "extra" : "missed", prim[0], prim[2]);
+        }
+    }
+
+    // The breakable box doesn't block the camera either way.
+    for (i = 0; i < NUM_RAYS; i++) {
+        CHECK(sRaySides[0][i] == 0 && sRaySides[1][i] == 0, "yaw %04x: ray %d hit the breakable box", (u16) yaw, i);
+    }
+
+    load_box(sCamBoxMesh, yaw);
+    run_queries(0, yaw);
+    load_box(sCamBox, yaw);
+    run_queries(1, yaw);
+    for (i = 0; i < NUM_RAYS; i++) {
+        // A glancing ray can slip past a turned triangle's rounded edge a few units from it, and
+        // one starting right on a side may or may not hit it.
+        if (num_sides_near(sRayHits[0][i], yaw, edgeMargin) >= 2 || num_sides_near(sRayHits[1][i], yaw, edgeMargin) >= 2
+            || (sRaySides[0][i] != 0 && sRayLengths[0][i] < edgeMargin)) {
+            numEdgeRays++;
+            continue;
+        }
+        // The triangles are only looked for in the cells the ray steps through, which can miss
+        // the ones a cell border splits.
+        if (sRaySides[0][i] == 0 && sRaySides[1][i] != 0) {
+            numMissedRays++;
+            CHECK(dist_from_surface(sRayHits[1][i], yaw) < 0.01f, "yaw %04x: ray %d hit %.2f from the box", (u16) yaw, i,
+                  dist_from_surface(sRayHits[1][i], yaw));
+            continue;
+        }
+        // Rays hitting the sides at a glancing angle go a few units further or shorter to the
+        // turned triangles, so it's where they hit that's compared.
+        CHECK(sRaySides[0][i] == sRaySides[1][i] && (sRaySides[1][i] == 0
+                  || (dist_from_surface(sRayHits[1][i], yaw) < 0.01f
+                      && dist_from_surface(sRayHits[0][i], yaw) <= (margin + 0.01f)
+                      && (margin > 0.0f || fabs(sRayLengths[0][i] - sRayLengths[1][i]) < 0.01f))),
+              "yaw %04x: ray %d hit side %d at %.2f, was side %d at %.2f", (u16) yaw, i,
+              sRaySides[1][i], sRayLengths[1][i], sRaySides[0][i], sRayLengths[0][i]);
+    }
+
+    printf("yaw %04x: %d of %d wall pushes differ, by up to %.2f, and the triangles' leave Mario in the box on %d;"
+           " %d rays on an edge or starting on a side, the triangles miss %d\n", (u16) yaw, numWallDiffs,
+           (NUM_WALL_ANGLES * NUM_WALL_DISTS), maxWallDiff, numMeshShort, numEdgeRays, numMissedRays);
+}
+
+static void check_cylinder(void) {
+    struct Surface *surf;
+    f32 x, z;
+    s32 i;
+
+    load_box(sCylinder, 0x1234);
+    for (i = 0; i < 64; i++) {
+        // find_floor truncates the position to whole units.
+        f32 dist = ((i % 2) ? 148.0f : 152.0f);
+        f32 height = find_floor((BOX_X + (coss(i * 0x400) * dist)), (BOX_Y + 400.0f), (BOX_Z + (sins(i * 0x400) * dist)), &surf);
+
+        CHECK((dist < 150.0f) == (surf != NULL) && (surf == NULL || height == (BOX_Y + 300.0f)),
+              "cylinder floor %.0f from its center is %.1f", dist, height);
+
+        x = (BOX_X + (coss(i * 0x400) * 180.0f));
+        z = (BOX_Z + (sins(i * 0x400) * 180.0f));
+        f32_find_wall_collision(&x, &(f32) { BOX_Y }, &z, 60.0f, MARIO_RADIUS);
+        CHECK(fabs(sqrtf(sqr(x - BOX_X) + sqr(z - BOX_Z)) - 200.0f) < 0.01f, "cylinder wall pushed to %.2f from its center",
+              sqrtf(sqr(x - BOX_X) + sqr(z - BOX_Z)));
+    }
+}
+
+static f64 time_queries(const Collision *collision) {
+    long start = clock();
+    s32 i;
+
+    for (i = 0; i < 20; i++) {
+        load_box(collision, (i * 0x800));
+        run_queries(0, (i * 0x800));
+    }
+    return ((f64) (clock() - start) / 20);
+}
+
+int main(void) {
+    gDynamicSurfacePool = sDynamicPool;
+    gDynamicSurfacePoolEnd = sDynamicPool;
+    sClearAllCells = TRUE;
+
+    sMario.oPosX = BOX_X;
+    sMario.oPosY = BOX_Y;
+    sMario.oPosZ = BOX_Z;
+    gMarioObject = &sMario;
+
+    sBox.oPosX = BOX_X;
+    sBox.oPosY = BOX_Y;
+    sBox.oPosZ = BOX_Z;
+    sBox.oCollisionDistance = 1000.0f;
+    sBox.oFlags = OBJ_FLAG_DONT_CALC_COLL_DIST;
+    vec3_same(sBox.header.gfx.scale, 1.0f);
+
+    compare_box(0);
+    compare_box(0x2000);
+    compare_box(0x1234);
+    compare_box(-0x5C00);
+    check_cylinder();
+
+    load_box(sBoxMesh, 0);
+    printf("triangles load %d surfaces, the primitive none", sNumSurfaces);
+    printf("; host time for the same queries: triangles %.0f, primitive %.0f\n",
+           time_queries(sCamBoxMesh), time_queries(sCamBox));
+    printf("OK\n");
+    return 0;
+}
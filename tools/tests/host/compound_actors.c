@@ -0,0 +1,577 @@
+/**
+ * Runs the chain chomp's chain and the wiggler's tail as compound actor segments next to copies of
+ * vanilla's bhvChainChompChainPart and bhvWigglerBody objects, driven by the same chomp and head
+ * movement, and checks that every segment is drawn where, how and when its object would be:
+ *  - the chain parts' positions, with the objects' oGraphYOffset,
+ *  - the tail parts' positions, angles and scale, their animation and when they're tangible,
+ *    including the tail being pushed up out of the floor, which feeds back into the tail's shape.
+ * It also times both versions' updates on the host: the objects through update_objects_in_list
+ * and the behavior interpreter, the segments through their owner. Drawing and collision aren't
+ * timed. The behavior scripts hold 32 bit addresses, so this is linked at a low address with
+ * -no-pie.
+ */
+#include "tools/tests/host/harness.h"
+
+// math_util.h's absf and roundf are MIPS assembly, so they're swapped for host versions. The
+// rest of the assembly is in mtxf_to_mtx_fast, which doesn't run here.
+#define __asm__(...)
+#define absf mips_absf
+#define roundf mips_roundf
+#include "src/engine/math_util.h"
+#undef absf
+#undef roundf
+
+static f32 absf(f32 in) {
+    return ((in < 0.0f) ? -in : in);
+}
+
+static s32 roundf(f32 in) {
+    return __builtin_rintf(in);
+}
+
+#include "src/engine/math_util.c"
+#undef __asm__
+#include "src/game/object_list_processor.c"
+// CALL_NATIVE holds a function's KSEG0 address in 24 bits. Linked with -no-pie, the host's
+// functions are all below 16MB, so they're used as they are.
+#undef OS_PHYSICAL_TO_K0
+#define OS_PHYSICAL_TO_K0(x) ((void *) (uintptr_t) (x))
+#include "src/engine/behavior_script.c"
+#include "src/engine/graph_node.c"
+#include "src/game/object_helpers.c"
+#include "src/game/compound_actor.c"
+
+#include "actors/group11.h"
+#include "audio/external.h"
+#include "seq_ids.h"
+
+long clock(void);
+
+// Referenced by the parts of the game code this doesn't run.
+#define NOT_RUN(name) CHECK(FALSE, #name " isn't stubbed")
+
+/**
+ * The obj_behaviors_2.c helpers the behaviors call. Only clamp_s16, from wiggler_update_segments,
+ * and obj_check_attacks, from vanilla's tail objects, run, and the floor is never lava.
+ */
+static s32 clamp_s16(s16 *value, s16 minimum, s16 maximum) {
+    if (*value <= minimum) {
+        *value = minimum;
+    } else if (*value >= maximum) {
+        *value = maximum;
+    } else {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static s32 obj_die_if_above_lava_and_health_non_positive(void) {
+    return FALSE;
+}
+
+static void obj_die_if_health_non_positive(void) {
+    NOT_RUN(obj_die_if_health_non_positive);
+}
+
+static s32 obj_check_attacks(struct ObjectHitbox *hitbox, s32 attackedMarioAction) {
+    s32 attackType;
+
+    obj_set_hitbox(o, hitbox);
+
+    //! Dies immediately if above lava
+    if (obj_die_if_above_lava_and_health_non_positive()) {
+        return ATTACK_HANDLER_DIE_IF_HEALTH_NON_POSITIVE;
+    } else if (o->oInteractStatus & INT_STATUS_INTERACTED) {
+        if (o->oInteractStatus & INT_STATUS_ATTACKED_MARIO) {
+            if (o->oAction != attackedMarioAction) {
+                o->oAction = attackedMarioAction;
+                o->oTimer = 0;
+            }
+        } else {
+            attackType = o->oInteractStatus & INT_STATUS_ATTACK_MASK;
+            obj_die_if_health_non_positive();
+            o->oInteractStatus = INT_STATUS_NONE;
+            return attackType;
+        }
+    }
+
+    o->oInteractStatus = INT_STATUS_NONE;
+    return ATTACK_HANDLER_NOP;
+}
+
+static s32 approach_f32_ptr(f32 *px, f32 target, f32 delta) { NOT_RUN(approach_f32_ptr); return 0; }
+static s32 obj_bounce_off_walls_edges_objects(s32 *targetYaw) { NOT_RUN(obj_bounce_off_walls_edges_objects); return 0; }
+static s32 obj_face_pitch_approach(s16 targetPitch, s16 deltaPitch) { NOT_RUN(obj_face_pitch_approach); return 0; }
+static s32 obj_face_yaw_approach(s16 targetYaw, s16 deltaYaw) { NOT_RUN(obj_face_yaw_approach); return 0; }
+static s32 obj_forward_vel_approach(f32 target, f32 delta) { NOT_RUN(obj_forward_vel_approach); return 0; }
+static s16 obj_get_pitch_from_vel(void) { NOT_RUN(obj_get_pitch_from_vel); return 0; }
+static s32 obj_handle_attacks(struct ObjectHitbox *hitbox, s32 attackedMarioAction,
+                              u8 *attackHandlers) {
+    NOT_RUN(obj_handle_attacks);
+    return 0;
+}
+static s32 obj_move_pitch_approach(s16 target, s16 delta) { NOT_RUN(obj_move_pitch_approach); return 0; }
+static s16 random_linear_offset(s16 base, s16 range) { NOT_RUN(random_linear_offset); return 0; }
+static void treat_far_home_as_mario(f32 threshold) { NOT_RUN(treat_far_home_as_mario); }
+
+#include "src/game/behaviors/chain_chomp.inc.c"
+#include "src/game/behaviors/wiggler.inc.c"
+
+/**
+ * Vanilla's update function for the chain parts, before they became segments.
+ */
+static void vanilla_chain_chomp_chain_part_update(void) {
+    if (o->parentObj->oAction == CHAIN_CHOMP_ACT_UNLOAD_CHAIN) {
+        obj_mark_for_deletion(o);
+    } else if (o->oBehParams2ndByte != CHAIN_CHOMP_CHAIN_PART_BP_PIVOT) {
+        struct ChainSegment *segment = &o->parentObj->oChainChompSegments[o->oBehParams2ndByte];
+
+        // Set position relative to the pivot
+        vec3f_sum(&o->oPosVec, &o->parentObj->parentObj->oPosVec, segment->pos);
+    } else if (o->parentObj->oChainChompReleaseStatus != CHAIN_CHOMP_NOT_RELEASED) {
+        cur_obj_update_floor_and_walls();
+        cur_obj_move_standard(78);
+    }
+}
+
+/**
+ * Vanilla's update function for bhvWigglerBody, before the tail became segments.
+ */
+static void vanilla_wiggler_body_part_update(void) {
+    Vec3f d;
+    struct ChainSegment *segment = &o->parentObj->oWigglerSegments[o->oBehParams2ndByte];
+
+    cur_obj_scale(o->parentObj->header.gfx.scale[0]);
+
+    o->oFaceAnglePitch = segment->angle[0];
+    o->oFaceAngleYaw = segment->angle[1];
+
+    // TODO: What is this for?
+    f32 posOffset = -37.5f * o->header.gfx.scale[0];
+    d[1] = posOffset * coss(o->oFaceAnglePitch) - posOffset;
+    f32 dxz = posOffset * sins(o->oFaceAnglePitch);
+    d[0] = dxz * sins(o->oFaceAngleYaw);
+    d[2] = dxz * coss(o->oFaceAngleYaw);
+
+    vec3f_sum(&o->oPosVec, segment->pos, d);
+
+    if (o->oPosY < o->parentObj->oWigglerFallThroughFloorsHeight) {
+        //! Since position is recomputed each frame, tilting the wiggler up
+        //  while on the ground could cause the tail segments to clip through
+        //  the floor
+        o->oPosY -= 30.0f;
+        cur_obj_update_floor_height();
+        if (o->oFloorHeight > o->oPosY) { // TODO: Check ineq swap
+            o->oPosY = o->oFloorHeight;
+        }
+    }
+
+    segment->pos[1] = o->oPosY;
+
+    // Inherit walking animation speed from wiggler
+    cur_obj_init_animation_with_accel_and_sound(0, o->parentObj->oWigglerWalkAnimSpeed);
+    if (o->parentObj->oWigglerWalkAnimSpeed == 0.0f) {
+        cur_obj_reverse_animation();
+    }
+
+    if (o->parentObj->oAction == WIGGLER_ACT_SHRINK) {
+        cur_obj_become_intangible();
+    } else {
+        obj_check_attacks(&sWigglerBodyPartHitbox, o->oAction);
+    }
+}
+
+// From data/behavior_data.c
+#define BHV_CMD_BEGIN_LOOP  0x08
+#define BHV_CMD_END_LOOP    0x09
+#define BHV_CMD_CALL_NATIVE 0x0C
+
+// Behavior scripts looping over a CALL_NATIVE, filled in by make_native_loop
+static BehaviorScript sChainPartScript[3];
+static BehaviorScript sPivotScript[3];
+static BehaviorScript sWigglerBodyScript[3];
+
+static void make_native_loop(BehaviorScript *script, void (*func)(void)) {
+    CHECK((uintptr_t) func < 0x1000000, "%p doesn't fit in CALL_NATIVE", func);
+    script[0] = (BHV_CMD_BEGIN_LOOP << 24);
+    script[1] = ((BHV_CMD_CALL_NATIVE << 24) | (uintptr_t) func);
+    script[2] = (BHV_CMD_END_LOOP << 24);
+}
+
+static struct Animation sWigglerWalkAnim = { .flags = ANIM_FLAG_FORWARD, .startFrame = 0, .loopEnd = 26 };
+static struct Animation *sWigglerAnims[] = { &sWigglerWalkAnim };
+const struct Animation *const wiggler_seg5_anims_0500C874[1] = { &sWigglerWalkAnim };
+
+static struct GraphNode sModel;
+static struct GraphNode *sLoadedGraphNodes[MODEL_ID_COUNT];
+static u8 sObjectPool[0x1000];
+static u8 *sObjectPoolEnd = sObjectPool;
+
+// The object memory pool, which nothing here frees
+void *mem_pool_alloc(struct MemoryPool *pool, u32 size) {
+    void *addr = sObjectPoolEnd;
+
+    sObjectPoolEnd += ALIGN16(size);
+    CHECK(sObjectPoolEnd <= sObjectPool + sizeof(sObjectPool), "object memory pool full");
+    return addr;
+}
+
+void mem_pool_free(struct MemoryPool *pool, void *addr) {
+}
+
+void *segmented_to_virtual(const void *addr) {
+    return (void *) addr;
+}
+
+/**
+ * The floor the wiggler's tail is pushed out of: a slope, so the parts each find their own height.
+ */
+f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
+    static struct Surface floor;
+
+    *pfloor = &floor;
+    return ((xPos * 0.02f) - 40.0f);
+}
+
+s16 gCurrAreaIndex = 1;
+struct WarpDest sWarpDest;
+u32 gObjectClock;
+u32 gGlobalTimer;
+u16 gAreaUpdateCounter;
+void *gDynamicSurfacePool;
+void *gDynamicSurfacePoolEnd;
+struct MarioState gMarioStates[1];
+struct MarioState *gMarioState = &gMarioStates[0];
+struct GraphNode **gLoadedGraphNodes;
+
+// Referenced by the parts of the game code this doesn't run.
+const BehaviorScript bhvMario[1], bhvChainChomp[1], bhvChainChompChainPart[1], bhvBowser[1],
+    bhvBlueCoinJumping[1], bhvCarrySomethingDropped[1], bhvCarrySomethingHeld[1], bhvCarrySomethingThrown[1],
+    bhvMrIBlueCoin[1], bhvSingleCoinGetsSpawned[1], bhvWhitePuffExplosion[1];
+const BehaviorScript bhvBreathParticleSpawner[1], bhvBubbleParticleSpawner[1], bhvDirtParticleSpawner[1],
+    bhvFireParticleSpawner[1], bhvHorStarParticleSpawner[1], bhvIdleWaterWave[1], bhvLeafParticleSpawner[1],
+    bhvMistCircParticleSpawner[1], bhvMistParticleSpawner[1], bhvPlungeBubble[1], bhvShallowWaterSplash[1],
+    bhvShallowWaterWave[1], bhvSnowParticleSpawner[1], bhvSparkleParticleSpawner[1], bhvTriangleParticleSpawner[1],
+    bhvVertStarParticleSpawner[1], bhvWaterSplash[1], bhvWaveTrail[1];
+struct GraphNodeRoot *gCurGraphNodeRoot;
+struct GraphNodeMasterList *gCurGraphNodeMasterList;
+struct GraphNodePerspective *gCurGraphNodeCamFrustum;
+struct GraphNodeCamera *gCurGraphNodeCamera;
+struct GraphNodeObject *gCurGraphNodeObject;
+struct GraphNodeHeldObject *gCurGraphNodeHeldObject;
+struct GraphNode gObjParentGraphNode;
+Mat4 gCameraTransform;
+SpatialPartitionCell gStaticSurfacePartition[NUM_CELLS][NUM_CELLS];
+SpatialPartitionCell gDynamicSurfacePartition[NUM_CELLS][NUM_CELLS];
+struct SurfacePrimitive gSurfacePrimitives[MAX_SURFACE_PRIMITIVES];
+s32 gNumSurfacePrimitives;
+s32 gDialogResponse;
+s32 gObjCutsceneDone;
+struct Object *gSecondCameraFocus;
+struct PlayerCameraState gPlayerCameraState[2];
+struct Controller *const gPlayer1Controller;
+void *alloc_display_list(u32 size) { NOT_RUN(alloc_display_list); return NULL; }
+void *alloc_only_pool_alloc(struct AllocOnlyPool *pool, s32 size) { NOT_RUN(alloc_only_pool_alloc); return NULL; }
+void apply_mario_platform_displacement(void) { NOT_RUN(apply_mario_platform_displacement); }
+void clear_dynamic_surfaces(void) { NOT_RUN(clear_dynamic_surfaces); }
+void clear_mario_platform(void) { NOT_RUN(clear_mario_platform); }
+void clear_object_lists(struct ObjectNode *objLists) { NOT_RUN(clear_object_lists); }
+void create_dialog_box(s16 dialog) { NOT_RUN(create_dialog_box); }
+void create_dialog_box_with_response(s16 dialog) { NOT_RUN(create_dialog_box_with_response); }
+void create_sound_spawner(s32 soundMagic) { NOT_RUN(create_sound_spawner); }
+void cur_obj_play_sound_2(s32 soundMagic) { NOT_RUN(cur_obj_play_sound_2); }
+s16 cutscene_object(u8 cutscene, struct Object *obj) { NOT_RUN(cutscene_object); return 0; }
+s16 cutscene_object_with_dialog(u8 cutscene, struct Object *obj, s16 dialogID) { NOT_RUN(cutscene_object_with_dialog); return 0; }
+s16 cutscene_object_without_dialog(u8 cutscene, struct Object *obj) { NOT_RUN(cutscene_object_without_dialog); return 0; }
+void detect_object_collisions(void) { NOT_RUN(detect_object_collisions); }
+s32 execute_mario_action(struct Object *obj) { NOT_RUN(execute_mario_action); return 0; }
+s32 f32_find_wall_collision(f32 *xPtr, f32 *yPtr, f32 *zPtr, f32 offsetY, f32 radius) { NOT_RUN(f32_find_wall_collision); return 0; }
+f32 find_floor_height(f32 x, f32 y, f32 z) { NOT_RUN(find_floor_height); return 0; }
+s32 find_wall_collisions(struct WallCollisionData *colData) { NOT_RUN(find_wall_collisions); return 0; }
+s32 find_water_level(s32 x, s32 z) { NOT_RUN(find_water_level); return 0; }
+s32 get_dialog_id(void) { NOT_RUN(get_dialog_id); return 0; }
+s32 get_room_at_pos(f32 x, f32 y, f32 z) { NOT_RUN(get_room_at_pos); return 0; }
+void init_free_object_list(void) { NOT_RUN(init_free_object_list); }
+s32 mario_ready_to_speak(void) { NOT_RUN(mario_ready_to_speak); return 0; }
+struct MemoryPool *mem_pool_init(u32 size, u32 side) { NOT_RUN(mem_pool_init); return NULL; }
+void obj_hold_clock_mover(struct Object *obj) { NOT_RUN(obj_hold_clock_mover); }
+void obj_step_clock_mover(struct Object *obj) { NOT_RUN(obj_step_clock_mover); }
+void play_puzzle_jingle(void) { NOT_RUN(play_puzzle_jingle); }
+void set_camera_shake_from_point(s16 shake, f32 posX, f32 posY, f32 posZ) { NOT_RUN(set_camera_shake_from_point); }
+s32 set_mario_npc_dialog(s32 actionArg) { NOT_RUN(set_mario_npc_dialog); return 0; }
+void spawn_default_star(f32 x, f32 y, f32 z) { NOT_RUN(spawn_default_star); }
+void spawn_mist_particles_variable(s32 count, s32 offsetY, f32 size) { NOT_RUN(spawn_mist_particles_variable); }
+void spawn_triangle_break_particles(s16 numTris, s16 triModel, f32 triSize, s16 triAnimState) {
+    NOT_RUN(spawn_triangle_break_particles);
+}
+void stop_background_music(u16 seqId) { NOT_RUN(stop_background_music); }
+void unload_object(struct Object *obj) { NOT_RUN(unload_object); }
+void update_mario_platform(void) { NOT_RUN(update_mario_platform); }
+
+static struct ObjectNode sVanillaChain;
+static struct ObjectNode sCompoundChain;
+static struct ObjectNode sVanillaTail;
+static struct Object sChainParts[CHAIN_CHOMP_NUM_SEGMENTS];
+static struct Object sPivot;
+static struct Object sVanillaChomp;
+static struct Object sCompoundChomp;
+static struct Object sTailParts[WIGGLER_NUM_SEGMENTS];
+static struct Object sVanillaHead;
+static struct Object sCompoundHead;
+
+/**
+ * Only spawns the chain chomp's pivot, which is set up in init_chain_chomps.
+ */
+struct Object *create_object(const BehaviorScript *bhvScript) {
+    CHECK(bhvScript == bhvChainChompChainPart, "only the pivot is spawned");
+    return &sPivot;
+}
+
+static s32 vec3f_equal(Vec3f a, Vec3f b) {
+    return (a[0] == b[0] && a[1] == b[1] && a[2] == b[2]);
+}
+
+static void add_object(struct ObjectNode *list, struct Object *obj, const BehaviorScript *script) {
+    obj->header.next = list;
+    obj->header.prev = list->prev;
+    list->prev->next = &obj->header;
+    list->prev = &obj->header;
+
+    obj->activeFlags = ACTIVE_FLAG_ACTIVE;
+    obj->oFlags = OBJ_FLAG_UPDATE_GFX_POS_AND_ANGLE;
+    obj->oRoom = -1;
+    obj->oIntangibleTimer = -1;
+    obj->curBhvCommand = script;
+    obj->bhvStackIndex = 0;
+    vec3f_set(obj->header.gfx.scale, 1.0f, 1.0f, 1.0f);
+}
+
+static void init_list(struct ObjectNode *list) {
+    list->next = list;
+    list->prev = list;
+}
+
+/**
+ * Sets up the chomps on their posts. The vanilla one's chain is objects as vanilla's
+ * chain_chomp_act_uninitialized spawned them, the other's is made by the real one.
+ */
+static void init_chain_chomps(void) {
+    s32 i;
+
+    init_list(&sVanillaChain);
+    init_list(&sCompoundChain);
+
+    // The pivot starts at the post, and the chain is pulled straight out of it.
+    vec3f_set(&sVanillaChomp.oHomeVec, 500.0f, 0.0f, -300.0f);
+    sVanillaChomp.oDistanceToMario = 0.0f;
+    sVanillaChomp.oChainChompMaxDistFromPivotPerChainPart = (750.0f / CHAIN_CHOMP_NUM_SEGMENTS);
+    sVanillaChomp.oChainChompMaxDistBetweenChainParts = sVanillaChomp.oChainChompMaxDistFromPivotPerChainPart;
+    sCompoundChomp = sVanillaChomp;
+
+    sVanillaChomp.oChainChompSegments = mem_pool_alloc(gObjectMemoryPool, CHAIN_CHOMP_NUM_SEGMENTS * sizeof(struct ChainSegment));
+    for (i = 0; i < CHAIN_CHOMP_NUM_SEGMENTS; i++) {
+        chain_segment_init(&sVanillaChomp.oChainChompSegments[i]);
+    }
+    vec3f_copy(&sVanillaChomp.oPosVec, &sVanillaChomp.oHomeVec);
+    add_object(&sVanillaChain, &sChainParts[0], sChainPartScript);
+    sChainParts[0].oBehParams2ndByte = CHAIN_CHOMP_CHAIN_PART_BP_PIVOT;
+    for (i = 0; i < CHAIN_CHOMP_NUM_SEGMENTS; i++) {
+        sChainParts[i].parentObj = &sVanillaChomp;
+        vec3f_copy(&sChainParts[i].oPosVec, &sVanillaChomp.oPosVec);
+        if (i > 0) {
+            add_object(&sVanillaChain, &sChainParts[i], sChainPartScript);
+            sChainParts[i].oBehParams2ndByte = i;
+            sChainParts[i].oGraphYOffset = 40.0f;
+            sChainParts[i].header.gfx.node.flags |= GRAPH_RENDER_BILLBOARD;
+            vec3f_set(sChainParts[i].header.gfx.scale, 2.0f, 2.0f, 2.0f);
+        }
+    }
+    sVanillaChomp.parentObj = &sChainParts[0];
+
+    gCurrentObject = &sCompoundChomp;
+    chain_chomp_act_uninitialized();
+    CHECK(sCompoundChomp.compound != NULL && sCompoundChomp.oAction == CHAIN_CHOMP_ACT_MOVE,
+          "chain_chomp_act_uninitialized didn't make the chain");
+    add_object(&sCompoundChain, &sPivot, sPivotScript);
+    sPivot.parentObj = &sCompoundChomp;
+    vec3f_copy(&sPivot.oPosVec, &sCompoundChomp.oPosVec);
+    sCompoundChomp.parentObj = &sPivot;
+}
+
+/**
+ * Sets up the wigglers. The vanilla one's tail is objects as vanilla's wiggler_init_segments
+ * spawned them, the other's is made by the real one.
+ */
+static void init_wigglers(void) {
+    s32 i;
+
+    init_list(&sVanillaTail);
+
+    vec3f_set(&sVanillaHead.oPosVec, -800.0f, 50.0f, 400.0f);
+    vec3f_set(sVanillaHead.header.gfx.scale, 4.0f, 4.0f, 4.0f);
+    sVanillaHead.oWigglerFallThroughFloorsHeight = 60.0f;
+    sCompoundHead = sVanillaHead;
+
+    sVanillaHead.oWigglerSegments = mem_pool_alloc(gObjectMemoryPool, WIGGLER_NUM_SEGMENTS * sizeof(struct ChainSegment));
+    for (i = 0; i < WIGGLER_NUM_SEGMENTS; i++) {
+        chain_segment_init(&sVanillaHead.oWigglerSegments[i]);
+        vec3f_copy(sVanillaHead.oWigglerSegments[i].pos, &sVanillaHead.oPosVec);
+    }
+    sVanillaHead.oAction = WIGGLER_ACT_WALK;
+    for (i = 1; i < WIGGLER_NUM_SEGMENTS; i++) {
+        add_object(&sVanillaTail, &sTailParts[i], sWigglerBodyScript);
+        sTailParts[i].parentObj = &sVanillaHead;
+        sTailParts[i].oBehParams2ndByte = i;
+        vec3f_copy(&sTailParts[i].oPosVec, &sVanillaHead.oPosVec);
+        obj_init_animation_with_sound(&sTailParts[i], sWigglerAnims, 0);
+        sTailParts[i].header.gfx.animInfo.animFrame = (23 * i) % 26 - 1;
+    }
+
+    gCurrentObject = &sCompoundHead;
+    wiggler_init_segments();
+    CHECK(sCompoundHead.compound != NULL, "wiggler_init_segments didn't make the tail");
+}
+
+/**
+ * Moves a chain chomp like its lunges, out past the chain's length and back, in the air and on
+ * the ground, and applies the chain's gravity and length limits.
+ */
+static void move_chain_chomp(struct Object *chomp, s32 frame) {
+    f32 reach = (200.0f + (absi((frame % 120) - 60) * 15.0f));
+
+    chomp->oPosX = (chomp->oHomeX + (sins(frame * 0x300) * reach));
+    chomp->oPosZ = (chomp->oHomeZ + (coss(frame * 0x300) * reach));
+    chomp->oPosY = ((frame % 90) < 30 ? (sins((frame % 30) * 0x444) * 300.0f) : 0.0f);
+    chomp->oVelY = ((frame % 90) < 30 ? -10.0f : 0.0f);
+
+    vec3f_diff(chomp->oChainChompSegments[0].pos, &chomp->oPosVec, &chomp->parentObj->oPosVec);
+    gCurrentObject = chomp;
+    chain_chomp_update_chain_segments();
+}
+
+/**
+ * Moves a wiggler's head along a winding path, up and down a slope and through a shrink, and
+ * updates its segments as bhv_wiggler_update does.
+ */
+static void move_wiggler(struct Object *head, s32 frame) {
+    head->oFaceAngleYaw += (sins(frame * 0x200) * 0x600);
+    head->oFaceAnglePitch = (sins(frame * 0x380) * 0x1800);
+    head->oPosX += (sins(head->oFaceAngleYaw) * 20.0f);
+    head->oPosZ += (coss(head->oFaceAngleYaw) * 20.0f);
+    head->oPosY = ((head->oPosX * 0.02f) - 40.0f + (absi((frame % 80) - 40) * 4.0f));
+    head->oWigglerWalkAnimSpeed = (((frame / 25) % 3) == 0 ? 0.0f : (0.06f * (frame % 40)));
+    head->oAction = ((frame >= 300) ? WIGGLER_ACT_SHRINK : WIGGLER_ACT_WALK);
+    vec3f_set(head->header.gfx.scale, 4.0f, 4.0f, 4.0f);
+
+    vec3f_copy(head->oWigglerSegments[0].pos, &head->oPosVec);
+    head->oWigglerSegments[0].angle[0] = head->oFaceAnglePitch;
+    head->oWigglerSegments[0].angle[1] = head->oFaceAngleYaw;
+    gCurrentObject = head;
+    wiggler_update_segments();
+}
+
+static void check_chain(s32 frame) {
+    struct CompoundActor *chain = sCompoundChomp.compound;
+    s32 i;
+
+    for (i = 1; i < CHAIN_CHOMP_NUM_SEGMENTS; i++) {
+        struct GraphNodeObject *part = &chain->segments[i - 1].gfx;
+        struct GraphNodeObject *obj = &sChainParts[i].header.gfx;
+
+        CHECK(vec3f_equal(part->pos, obj->pos) && vec3f_equal(part->scale, obj->scale)
+              && (part->node.flags & GRAPH_RENDER_BILLBOARD),
+              "frame %d: chain part %d at %.2f, %.2f, %.2f, was %.2f, %.2f, %.2f", frame, i,
+              part->pos[0], part->pos[1], part->pos[2], obj->pos[0], obj->pos[1], obj->pos[2]);
+    }
+}
+
+static void check_tail(s32 frame) {
+    struct CompoundActor *tail = sCompoundHead.compound;
+    s32 i;
+
+    for (i = 1; i < WIGGLER_NUM_SEGMENTS; i++) {
+        struct CompoundSegment *part = &tail->segments[i - 1];
+        struct Object *obj = &sTailParts[i];
+
+        CHECK(vec3f_equal(part->gfx.pos, obj->header.gfx.pos) && vec3f_equal(part->gfx.scale, obj->header.gfx.scale)
+              && part->gfx.angle[0] == obj->header.gfx.angle[0] && part->gfx.angle[1] == obj->header.gfx.angle[1]
+              && part->gfx.angle[2] == obj->header.gfx.angle[2],
+              "frame %d: tail part %d at %.2f, %.2f, %.2f turned %04x, %04x, was %.2f, %.2f, %.2f turned %04x, %04x",
+              frame, i, part->gfx.pos[0], part->gfx.pos[1], part->gfx.pos[2], (u16) part->gfx.angle[0],
+              (u16) part->gfx.angle[1], obj->header.gfx.pos[0], obj->header.gfx.pos[1], obj->header.gfx.pos[2],
+              (u16) obj->header.gfx.angle[0], (u16) obj->header.gfx.angle[1]);
+        CHECK(part->gfx.animInfo.curAnim == obj->header.gfx.animInfo.curAnim
+              && part->gfx.animInfo.animFrame == obj->header.gfx.animInfo.animFrame
+              && part->gfx.animInfo.animAccel == obj->header.gfx.animInfo.animAccel,
+              "frame %d: tail part %d on animation frame %d at %x, was %d at %x", frame, i,
+              part->gfx.animInfo.animFrame, part->gfx.animInfo.animAccel,
+              obj->header.gfx.animInfo.animFrame, obj->header.gfx.animInfo.animAccel);
+        CHECK((part->hitbox != NULL) == (obj->oIntangibleTimer == 0) && (part->hitbox == NULL || part->hitbox == &sWigglerBodyPartHitbox),
+              "frame %d: tail part %d is %s", frame, i, (part->hitbox != NULL) ? "tangible" : "intangible");
+    }
+}
+
+#define NUM_TIMED_UPDATES 20000
+
+/**
+ * Host time for a number of updates of the vanilla chain and tail objects, or of the segments.
+ */
+static long time_updates(s32 compound) {
+    long start = clock();
+    s32 i;
+
+    for (i = 0; i < NUM_TIMED_UPDATES; i++) {
+        if (compound) {
+            update_objects_in_list(&sCompoundChain);
+            gCurrentObject = &sCompoundHead;
+            wiggler_update_body_parts();
+        } else {
+            update_objects_in_list(&sVanillaChain);
+            update_objects_in_list(&sVanillaTail);
+        }
+    }
+    return (clock() - start);
+}
+
+int main(void) {
+    s32 frame;
+    s32 numFloorPushes = 0;
+
+    sLoadedGraphNodes[MODEL_METALLIC_BALL] = &sModel;
+    sLoadedGraphNodes[MODEL_WIGGLER_BODY] = &sModel;
+    gLoadedGraphNodes = sLoadedGraphNodes;
+    gMarioObject = &sCompoundHead;
+    make_native_loop(sChainPartScript, vanilla_chain_chomp_chain_part_update);
+    make_native_loop(sPivotScript, bhv_chain_chomp_chain_part_update);
+    make_native_loop(sWigglerBodyScript, vanilla_wiggler_body_part_update);
+
+    init_chain_chomps();
+    init_wigglers();
+
+    for (frame = 0; frame < 2000; frame++) {
+        move_chain_chomp(&sVanillaChomp, frame);
+        move_chain_chomp(&sCompoundChomp, frame);
+        update_objects_in_list(&sVanillaChain);
+        update_objects_in_list(&sCompoundChain);
+        check_chain(frame);
+
+        move_wiggler(&sVanillaHead, frame);
+        move_wiggler(&sCompoundHead, frame);
+        update_objects_in_list(&sVanillaTail);
+        gCurrentObject = &sCompoundHead;
+        wiggler_update_body_parts();
+        check_tail(frame);
+
+        numFloorPushes += (sTailParts[WIGGLER_NUM_SEGMENTS - 1].oPosY == sTailParts[WIGGLER_NUM_SEGMENTS - 1].oFloorHeight);
+    }
+
+    printf("tail end pushed out of the floor on %d of %d frames\n", numFloorPushes, frame);
+    CHECK(numFloorPushes > 0 && numFloorPushes < frame, "the tail %s pushed out of the floor",
+          (numFloorPushes == 0) ? "never got" : "always got");
+
+    printf("host time for %d updates of the chain and tail: objects %ld, segments %ld\n", NUM_TIMED_UPDATES,
+           time_updates(FALSE), time_updates(TRUE));
+    printf("OK\n");
+    return 0;
+}
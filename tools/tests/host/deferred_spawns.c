@@ -0,0 +1,189 @@
+/**
+ * Loads an area laid out like a course with red coins and a secret star under TIME_SLICED_SPAWNING,
+ * and checks that:
+ *  - far objects really are deferred, and then spawn nearest first,
+ *  - the red coins, hidden star triggers and their stars all exist by the first object update, so
+ *    the stars' inits count the full totals and the coins find their star.
+ *
+ * Only object_list_processor.c's spawn paths run. The rest of the object system is stubbed out,
+ * and each spawn takes SPAWN_US of the frame's budget.
+ */
+#include "tools/tests/host/harness.h"
+
+#include "src/game/object_list_processor.c"
+
+#define SPAWN_US 150
+
+#define NUM_RED_COINS 8
+#define NUM_TRIGGERS  5
+#define NUM_GOOMBAS   20
+
+const BehaviorScript bhvMario[1];
+const BehaviorScript bhvSpinAirborneWarp[1];
+const BehaviorScript bhvRedCoin[1];
+const BehaviorScript bhvHiddenRedCoinStar[1];
+const BehaviorScript bhvBowserCourseRedCoinStar[1];
+const BehaviorScript bhvHiddenStar[1];
+const BehaviorScript bhvHiddenStarTrigger[1];
+const BehaviorScript bhvGoomba[1];
+
+// Referenced by the particle spawn table and update_objects, which don't run here.
+const BehaviorScript bhvBreathParticleSpawner[1], bhvBubbleParticleSpawner[1], bhvDirtParticleSpawner[1],
+    bhvFireParticleSpawner[1], bhvHorStarParticleSpawner[1], bhvIdleWaterWave[1], bhvLeafParticleSpawner[1],
+    bhvMistCircParticleSpawner[1], bhvMistParticleSpawner[1], bhvPlungeBubble[1], bhvShallowWaterSplash[1],
+    bhvShallowWaterWave[1], bhvSnowParticleSpawner[1], bhvSparkleParticleSpawner[1], bhvTriangleParticleSpawner[1],
+    bhvVertStarParticleSpawner[1], bhvWaterSplash[1], bhvWaveTrail[1];
+
+s16 gCurrAreaIndex = 1;
+struct WarpDest sWarpDest;
+u32 gObjectClock;
+void *gDynamicSurfacePool;
+void *gDynamicSurfacePoolEnd;
+struct MarioState gMarioStates[1];
+
+static struct Object sObjects[OBJECT_POOL_CAPACITY];
+static s32 sNumObjects;
+static u32 sCount;
+
+u32 osGetCount(void) {
+    return sCount;
+}
+
+void *segmented_to_virtual(const void *addr) {
+    return (void *) addr;
+}
+
+u32 get_mario_spawn_type_from_behavior(const BehaviorScript *behavior) {
+    return behavior == bhvSpinAirborneWarp ? MARIO_SPAWN_SPIN_AIRBORNE : MARIO_SPAWN_NONE;
+}
+
+struct Object *create_object(const BehaviorScript *bhvScript) {
+    CHECK(sNumObjects < OBJECT_POOL_CAPACITY, "object pool full");
+    sCount += OS_USEC_TO_CYCLES(SPAWN_US);
+    return &sObjects[sNumObjects++];
+}
+
+f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) {
+    *pfloor = NULL;
+    return FLOOR_LOWER_LIMIT;
+}
+
+void geo_obj_init_spawninfo(struct GraphNodeObject *graphNode, struct SpawnInfo *spawn) {
+}
+
+void clear_mario_platform(void) {
+}
+
+// Only reached by the parts of object_list_processor.c this doesn't run.
+#define NOT_RUN(name) CHECK(FALSE, #name " isn't stubbed")
+void __n64Assert(char *fileName, u32 lineNum, char *message) { NOT_RUN(__n64Assert); }
+void apply_mario_platform_displacement(void) { NOT_RUN(apply_mario_platform_displacement); }
+void clear_compound_actors(void) { NOT_RUN(clear_compound_actors); }
+void clear_dynamic_surfaces(void) { NOT_RUN(clear_dynamic_surfaces); }
+void clear_object_lists(struct ObjectNode *objLists) { NOT_RUN(clear_object_lists); }
+void cur_obj_update(void) { NOT_RUN(cur_obj_update); }
+void detect_object_collisions(void) { NOT_RUN(detect_object_collisions); }
+s32 execute_mario_action(struct Object *obj) { NOT_RUN(execute_mario_action); return 0; }
+struct GraphNode *geo_make_first_child(struct GraphNode *newFirstChild) { NOT_RUN(geo_make_first_child); return NULL; }
+void geo_reset_object_node(struct GraphNodeObject *graphNode) { NOT_RUN(geo_reset_object_node); }
+void init_free_object_list(void) { NOT_RUN(init_free_object_list); }
+struct MemoryPool *mem_pool_init(u32 size, u32 side) { NOT_RUN(mem_pool_init); return NULL; }
+void obj_copy_pos_and_angle(struct Object *dst, struct Object *src) { NOT_RUN(obj_copy_pos_and_angle); }
+void obj_step_clock_mover(struct Object *obj) { NOT_RUN(obj_step_clock_mover); }
+u32 profiler_get_delta(enum ProfilerDeltaTime which) { return 0; }
+void profiler_update(enum ProfilerTime which, u32 delta) { }
+struct Object *spawn_object_at_origin(struct Object *parent, s32 unusedArg, ModelID32 model, const BehaviorScript *behavior) {
+    NOT_RUN(spawn_object_at_origin);
+    return NULL;
+}
+void unload_object(struct Object *obj) { NOT_RUN(unload_object); }
+void update_mario_platform(void) { NOT_RUN(update_mario_platform); }
+
+static struct SpawnInfo sSpawnInfos[64];
+static s32 sNumSpawnInfos;
+
+static struct SpawnInfo *add_spawn_info(const BehaviorScript *behavior, s16 x, s16 z, u8 bparam2) {
+    struct SpawnInfo *info = &sSpawnInfos[sNumSpawnInfos];
+
+    info->startPos[0] = x;
+    info->startPos[1] = 0;
+    info->startPos[2] = z;
+    info->behaviorArg = bparam2 << 16;
+    info->behaviorScript = (void *) behavior;
+    if (sNumSpawnInfos > 0) {
+        sSpawnInfos[sNumSpawnInfos - 1].next = info;
+    }
+    sNumSpawnInfos++;
+    return info;
+}
+
+static s32 count_spawned(const BehaviorScript *behavior) {
+    s32 count = 0;
+    s32 i;
+
+    for (i = 0; i < sNumObjects; i++) {
+        if (sObjects[i].behavior == behavior) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static f32 dist_from_origin(struct Object *obj) {
+    return sqrtf(sqr(obj->oPosX) + sqr(obj->oPosZ));
+}
+
+int main(void) {
+    s32 i;
+    s32 numImmediate;
+    s32 numFirstFrame;
+
+    // The entry warp, with everything else out past TIME_SLICED_SPAWN_NEAR_DIST. The stars are
+    // listed before what they count, and the goombas are listed farthest first.
+    add_spawn_info(bhvSpinAirborneWarp, 0, 0, 0x0A);
+    add_spawn_info(bhvHiddenRedCoinStar, 6000, 0, 0);
+    add_spawn_info(bhvHiddenStar, 0, -7000, 0);
+    for (i = 0; i < NUM_GOOMBAS; i++) {
+        add_spawn_info(bhvGoomba, -5000 - 200 * (NUM_GOOMBAS - i), 0, 0);
+    }
+    for (i = 0; i < NUM_RED_COINS; i++) {
+        add_spawn_info(bhvRedCoin, 5000 + 500 * i, 1000 * i, 0);
+    }
+    for (i = 0; i < NUM_TRIGGERS; i++) {
+        add_spawn_info(bhvHiddenStarTrigger, -1000 * i, -5000 - 500 * i, 0);
+    }
+    sWarpDest.type = WARP_TYPE_CHANGE_LEVEL;
+    sWarpDest.nodeId = 0x0A;
+
+    // The area loads...
+    spawn_objects_from_info(0, sSpawnInfos);
+    numImmediate = sNumObjects;
+
+    // ...and the first frame's object update spawns what fits in its budget before any object
+    // initializes. The rest arrive over the next frames.
+    spawn_deferred_objects();
+    numFirstFrame = sNumObjects;
+    printf("%d objects spawned with the area, %d more on the first frame, %d deferred past it\n",
+           numImmediate, numFirstFrame - numImmediate, sNumSpawnInfos - numFirstFrame);
+
+    CHECK(count_spawned(bhvSpinAirborneWarp) == 1, "entry warp wasn't spawned with the area");
+    CHECK(count_spawned(bhvGoomba) < NUM_GOOMBAS, "nothing was deferred past the first frame");
+    CHECK(count_spawned(bhvRedCoin) == NUM_RED_COINS, "red coin star would count %d of %d red coins",
+          count_spawned(bhvRedCoin), NUM_RED_COINS);
+    CHECK(count_spawned(bhvHiddenStarTrigger) == NUM_TRIGGERS, "hidden star would count %d of %d triggers",
+          count_spawned(bhvHiddenStarTrigger), NUM_TRIGGERS);
+    CHECK(count_spawned(bhvHiddenRedCoinStar) == 1, "red coins wouldn't find their star");
+    CHECK(count_spawned(bhvHiddenStar) == 1, "triggers wouldn't find their star");
+
+    while (sNumDeferredSpawns > 0) {
+        spawn_deferred_objects();
+    }
+    CHECK(sNumObjects == sNumSpawnInfos, "%d of %d objects spawned", sNumObjects, sNumSpawnInfos);
+    for (i = numImmediate + 1; i < sNumObjects; i++) {
+        CHECK(dist_from_origin(&sObjects[i - 1]) <= dist_from_origin(&sObjects[i]),
+              "deferred spawns out of order at %d", i);
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,17 @@
+#ifndef HARNESS_H
+#define HARNESS_H
+
+// Host libc, which the game's headers don't declare.
+int printf(const char *fmt, ...);
+void exit(int status);
+
+#define CHECK(cond, ...) do {                                                  \
+    if (!(cond)) {                                                             \
+        printf("%s:%d: check failed: %s\n    ", __FILE__, __LINE__, #cond);    \
+        printf(__VA_ARGS__);                                                   \
+        printf("\n");                                                          \
+        exit(1);                                                               \
+    }                                                                          \
+} while (0)
+
+#endif // HARNESS_H
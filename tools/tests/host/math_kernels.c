@@ -0,0 +1,85 @@
+/**
+ * Measures the math_util.c kernels that have faster variants, for test_math_util.py to compare
+ * builds with and without them:
+ *  - atan2s against the exact angle, over points all around the circle,
+ *  - the rotate-translate-multiply matrix builders with a zero rotation, printed bit for bit.
+ */
+#include "tools/tests/host/harness.h"
+
+// Only mtxf_to_mtx_fast has MIPS assembly, and it doesn't run here.
+#define __asm__(...)
+#include "src/engine/math_util.c"
+#undef __asm__
+
+double atan2(double y, double x);
+double fabs(double x);
+
+// Referenced by the parts of math_util.c this doesn't run.
+#define NOT_RUN(name) CHECK(FALSE, #name " isn't stubbed")
+Mat4 gCameraTransform;
+SpatialPartitionCell gStaticSurfacePartition[NUM_CELLS][NUM_CELLS];
+SpatialPartitionCell gDynamicSurfacePartition[NUM_CELLS][NUM_CELLS];
+struct SurfacePrimitive gSurfacePrimitives[MAX_SURFACE_PRIMITIVES];
+s32 gNumSurfacePrimitives;
+f32 find_floor(f32 xPos, f32 yPos, f32 zPos, struct Surface **pfloor) { NOT_RUN(find_floor); return 0; }
+
+#define ATAN2S_STEPS 0x40000
+
+static void measure_atan2s(void) {
+    f64 maxError = 0.0;
+    s32 numOff = 0;
+    s32 i;
+
+    for (i = 0; i < ATAN2S_STEPS; i++) {
+        // atan2s(y, x) is the angle of (x, y) from the y axis
+        f64 angle = (i + 0.37) * (2 * M_PI / ATAN2S_STEPS);
+        f32 y = cos(angle) * 1000.0;
+        f32 x = sin(angle) * 1000.0;
+        f64 exact = atan2(x, y) * (0x8000 / M_PI);
+        f64 error = (s16) atan2s(y, x) - exact;
+
+        error -= 0x10000 * (s32) ((error + (error < 0 ? -0x8000 : 0x8000)) / 0x10000);
+        if (fabs(error) > maxError) {
+            maxError = fabs(error);
+        }
+        if (fabs(error) > 0.5) {
+            numOff++;
+        }
+    }
+    // Off means not the exact angle rounded to the nearest unit.
+    printf("atan2s max error %.3f, off for %d of %d angles\n", maxError, numOff, ATAN2S_STEPS);
+}
+
+static void print_mtx(const char *name, Mat4 mtx) {
+    s32 i;
+
+    printf("%s", name);
+    for (i = 0; i < 16; i++) {
+        printf(" %08x", ((u32 *) mtx)[i]);
+    }
+    printf("\n");
+}
+
+static void measure_mtxf(void) {
+    // A parent matrix holding negative zeros, which a real multiplication turns positive
+    Mat4 src = {
+        { 0.5f, -0.0f, 0.8660254f, 0.0f },
+        { 0.0f,  1.0f, -0.0f,      0.0f },
+        { -0.8660254f, 0.0f, 0.5f, 0.0f },
+        { 100.0f, -250.5f, 3.25f,  1.0f },
+    };
+    Vec3s rot = { 0, 0, 0 };
+    Vec3f trans = { 12.5f, -7.0f, 1024.0f };
+    Mat4 dest;
+
+    mtxf_rotate_zxy_and_translate_and_mul(rot, trans, dest, src);
+    print_mtx("zxy", dest);
+    mtxf_rotate_xyz_and_translate_and_mul(rot, trans, dest, src);
+    print_mtx("xyz", dest);
+}
+
+int main(void) {
+    measure_atan2s();
+    measure_mtxf();
+    return 0;
+}
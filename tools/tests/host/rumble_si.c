@@ -0,0 +1,271 @@
+/**
+ * Runs the rumble thread's logic against a simulated SI bus, along with the game thread's
+ * controller reads, and checks that:
+ *  - the game thread never waits for the SI or the rumble pak scheduler queue,
+ *  - rumble commands reach the pak on time and last as long as they were queued for,
+ *  - the rumble logic runs once per VI even when the rumble thread's wakeups get dropped.
+ *
+ * Time is simulated in microseconds. Threads run to completion when scheduled, and every SI
+ * transaction advances the running thread's clock by how long it keeps the bus busy.
+ */
+#include "tools/tests/host/harness.h"
+#include "src/game/game_init.h"
+
+#include "src/game/rumble_init.c"
+
+#define VI_US           16683
+#define STEP_US         1
+#define READ_DELAY_US   500  // From the VI to the game thread starting the controller read
+#define READ_US         400  // SI time of the controller read
+#define GET_DELAY_US    1500 // From starting the read to osContGetReadDataEx, after the audio tick
+#define MOTOR_US        600  // One rumble pak motor write
+#define PAK_INIT_US     2500 // osMotorInitEx with a pak inserted
+
+u32 gNumVblanks = 0;
+s8 gResetTimer = 0;
+struct DemoInput *gCurrDemoInput = NULL;
+OSMesgQueue gSIEventMesgQueue;
+u8 gThread6Stack[THREAD6_STACK];
+static struct Controller sController = { .port = 0 };
+struct Controller* const gPlayer1Controller = &sController;
+
+static u64 sNow;            // Clock of the running thread
+static u64 sBusFreeAt;      // When the SI finishes its current transaction
+static u64 sSchedFreeAt;    // When the rumble pak scheduler queue was last given back
+static s32 sSchedHeld;
+static u64 sRumbleFreeAt;   // When the rumble thread is done with its current work
+
+static s32 sPakInserted;
+static u32 sPakInitUs;
+static s32 sPakMotorOn;
+static u64 sPakMotorOnAt;
+static u64 sPakMotorOnUs;
+static s32 sPakMotorStarts;
+
+static u32 sDroppedWakeups;
+static u32 sGameReads;
+static u32 sSkippedReads;
+static u64 sGameWaitUs;     // Time the game thread spent waiting, which must stay 0
+static u64 sAvoidedWaitUs;  // Time a blocking read would have waited for the rumble thread
+
+static void si_transaction(u32 us) {
+    if (sNow < sBusFreeAt) {
+        sNow = sBusFreeAt;
+    }
+    sNow += us;
+    sBusFreeAt = sNow;
+}
+
+void osCreateMesgQueue(OSMesgQueue *mq, OSMesg *msg, s32 count) {
+    mq->validCount = 0;
+    mq->first = 0;
+    mq->msgCount = count;
+    mq->msg = msg;
+}
+
+s32 osSendMesg(OSMesgQueue *mq, OSMesg msg, s32 flag) {
+    if (mq == &gRumblePakSchedulerMesgQueue) {
+        sSchedHeld = FALSE;
+        sSchedFreeAt = sNow;
+        return 0;
+    }
+    if (mq->validCount >= mq->msgCount) {
+        CHECK(flag == OS_MESG_NOBLOCK, "a full queue would block the sender");
+        if (mq == &gRumbleThreadVIMesgQueue) {
+            sDroppedWakeups++;
+        }
+        return -1;
+    }
+    mq->msg[(mq->first + mq->validCount) % mq->msgCount] = msg;
+    mq->validCount++;
+    return 0;
+}
+
+s32 osRecvMesg(OSMesgQueue *mq, OSMesg *msg, s32 flag) {
+    if (mq == &gRumblePakSchedulerMesgQueue) {
+        if (flag == OS_MESG_NOBLOCK) {
+            if (sSchedHeld || sNow < sSchedFreeAt) {
+                return -1;
+            }
+        } else {
+            CHECK(!sSchedHeld, "the rumble thread waited for a controller read");
+            if (sNow < sSchedFreeAt) {
+                sNow = sSchedFreeAt;
+            }
+        }
+        sSchedHeld = TRUE;
+        return 0;
+    }
+    if (mq->validCount == 0) {
+        CHECK(flag == OS_MESG_NOBLOCK, "nothing would ever wake this thread");
+        return -1;
+    }
+    if (msg != NULL) {
+        *msg = mq->msg[mq->first];
+    }
+    mq->first = (mq->first + 1) % mq->msgCount;
+    mq->validCount--;
+    return 0;
+}
+
+void osCreateThread(OSThread *t, OSId id, void (*entry)(void *), void *arg, void *sp, OSPri pri) {
+}
+
+void osStartThread(OSThread *t) {
+}
+
+void osSyncPrintf(const char *fmt, ...) {
+}
+
+s32 osMotorInitEx(OSMesgQueue *mq, OSPfs *pfs, int channel) {
+    si_transaction(sPakInitUs);
+    return sPakInserted ? 0 : PFS_ERR_NOPACK;
+}
+
+s32 __osMotorAccessEx(OSPfs *pfs, s32 flag) {
+    si_transaction(MOTOR_US);
+
+    if (flag == MOTOR_START && !sPakMotorOn) {
+        sPakMotorOnAt = sNow;
+        sPakMotorStarts++;
+    } else if (flag == MOTOR_STOP && sPakMotorOn) {
+        sPakMotorOnUs += sNow - sPakMotorOnAt;
+    }
+    sPakMotorOn = (flag == MOTOR_START);
+    return 0;
+}
+
+static void reset_sim(s32 pakInserted, u32 pakInitUs) {
+    sNow = sBusFreeAt = sSchedFreeAt = sRumbleFreeAt = 0;
+    sSchedHeld = FALSE;
+    sPakInserted = pakInserted;
+    sPakInitUs = pakInitUs;
+    sPakMotorOn = FALSE;
+    sPakMotorOnUs = sPakMotorStarts = 0;
+    sDroppedWakeups = sGameReads = sSkippedReads = 0;
+    sGameWaitUs = sAvoidedWaitUs = 0;
+    gNumVblanks = 0;
+
+    sRumblePakThreadActive = FALSE;
+    init_rumble_pak_scheduler_queue();
+    create_thread_6();
+    // thread6_rumble_loop's setup
+    cancel_rumble();
+    sRumbleVblank = gNumVblanks;
+    sRumblePakThreadActive = TRUE;
+}
+
+/**
+ * Runs numVblanks VIs, calling event(vi) on each one before the game thread's frame.
+ */
+static void run_sim(u32 numVblanks, void (*event)(u32 vi)) {
+    u64 end = (u64) numVblanks * VI_US;
+    u64 readAt = (u64) -1;
+    u64 getAt = (u64) -1;
+    u64 t;
+
+    for (t = 0; t < end; t += STEP_US) {
+        // VI interrupt
+        if (t % VI_US == 0) {
+            sNow = t;
+            gNumVblanks++;
+            rumble_thread_update_vi();
+            if (event != NULL) {
+                event(gNumVblanks);
+            }
+            // The game runs every other VI
+            if (gNumVblanks % 2 == 0) {
+                readAt = t + READ_DELAY_US;
+            }
+        }
+
+        // Game thread: start the controller read...
+        if (t == readAt) {
+            sNow = t;
+            if (try_take_rumble_pak_control()) {
+                CHECK(sBusFreeAt <= t, "the controller read had to wait for the SI");
+                sSchedFreeAt = t + GET_DELAY_US;
+                si_transaction(READ_US);
+                getAt = t + GET_DELAY_US;
+                sGameReads++;
+            } else {
+                sSkippedReads++;
+                sAvoidedWaitUs += sSchedFreeAt > t ? sSchedFreeAt - t : sRumbleFreeAt - t;
+            }
+            readAt = (u64) -1;
+        }
+        // ...and get its data, as read_controller_inputs does.
+        if (t == getAt) {
+            sNow = t;
+            CHECK(sBusFreeAt <= t, "the controller data wasn't ready");
+            release_rumble_pak_control();
+            rumble_thread_update_motor();
+            getAt = (u64) -1;
+        }
+
+        // Rumble thread, whenever it's woken and not busy
+        if (sRumbleFreeAt <= t && gRumbleThreadVIMesgQueue.validCount > 0) {
+            OSMesg msg;
+            sNow = t;
+            osRecvMesg(&gRumbleThreadVIMesgQueue, &msg, OS_MESG_BLOCK);
+            process_rumble_thread_work();
+            sRumbleFreeAt = sNow;
+        }
+    }
+
+    if (sPakMotorOn) {
+        sPakMotorOnUs += end - sPakMotorOnAt;
+    }
+}
+
+#define RUMBLE_QUEUE_VI 20
+#define RUMBLE_TIME     30
+
+static void queue_strong_rumble(u32 vi) {
+    if (vi == RUMBLE_QUEUE_VI) {
+        queue_rumble_data(RUMBLE_TIME, 80);
+    }
+}
+
+static void start_pak_timer(u32 vi) {
+    if (vi == 10) {
+        gRumblePakTimer = 5000;
+    }
+}
+
+int main(void) {
+    // A pak is inserted and one strong rumble is queued.
+    reset_sim(TRUE, PAK_INIT_US);
+    run_sim(600, queue_strong_rumble);
+    {
+        // The entry moves through the 3 entry queue, then the motor runs for 4 start VIs and its time.
+        u64 expectedUs = (u64) (4 + RUMBLE_TIME) * VI_US;
+        s64 errorUs = (s64) sPakMotorOnUs - (s64) expectedUs;
+
+        printf("pak inserted: %u reads, %u skipped, game waited %llu us, motor on %llu us (expected %llu us)\n",
+               sGameReads, sSkippedReads, sGameWaitUs, sPakMotorOnUs, expectedUs);
+        CHECK(sPakMotorStarts == 1, "motor started %d times", sPakMotorStarts);
+        CHECK(!sPakMotorOn, "motor left running");
+        // The pak is only written to after a controller read, once per frame.
+        CHECK(errorUs <= 2 * VI_US && errorUs >= -2 * VI_US, "motor on for %llu us", sPakMotorOnUs);
+        CHECK(sSkippedReads == 0, "%u reads skipped", sSkippedReads);
+        CHECK(sGameWaitUs == 0, "game waited %llu us", sGameWaitUs);
+        CHECK(sRumbleVblank == gNumVblanks, "rumble logic ran for %u of %u VIs", sRumbleVblank, gNumVblanks);
+    }
+
+    // No pak, and probing for one keeps the SI busy for longer than a frame: the game thread skips
+    // reads instead of waiting, and the VIs that pass while the rumble thread is busy aren't lost.
+    reset_sim(FALSE, 3 * VI_US);
+    run_sim(2000, start_pak_timer);
+    printf("slow probe: %u reads, %u skipped, %u wakeups dropped, game waited %llu us, %llu us of waiting avoided\n",
+           sGameReads, sSkippedReads, sDroppedWakeups, sGameWaitUs, sAvoidedWaitUs);
+    CHECK(sSkippedReads > 0, "the probe never overlapped a read");
+    CHECK(sDroppedWakeups > 0, "the wakeup queue never filled up");
+    CHECK(sGameWaitUs == 0, "game waited %llu us", sGameWaitUs);
+    // Every VI from the one the timer was set on counted down once, except the ones still being waited out.
+    CHECK(gNumVblanks - sRumbleVblank <= 3, "rumble logic ran for %u of %u VIs", sRumbleVblank, gNumVblanks);
+    CHECK(gRumblePakTimer == (s32) (5000 - (sRumbleVblank - 9)), "timer at %d after %u VIs", gRumblePakTimer, sRumbleVblank);
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,557 @@
+/**
+ * Runs synthesis_process_notes under MERGE_UNISON_NOTES through a model of the audio microcode, and
+ * checks that notes merged into the note before them sound and advance exactly as if they had been
+ * synthesized on their own:
+ *  - notes doubling a voice from the start follow it through its loop,
+ *  - a follower that drops out of unison picks up from the decoder state it was handed,
+ *  - a follower of a one-shot sample finishes with it,
+ *  - and merged notes skip their sample DMA, ADPCM decoding and resampling.
+ *
+ * The reference run plays the same notes, except that each follower's sample is a byte-identical
+ * copy, which keeps it from being merged.
+ *
+ * The model decodes ADPCM like the RSP does, but its resampler and envelope mixer only approximate
+ * the real ones. What matters here is that every command reads what it would on hardware, and that
+ * the state each one leaves in DRAM depends on everything it read.
+ */
+#include "tools/tests/host/harness.h"
+
+void *memcpy(void *dst, const void *src, size_t n);
+void *memmove(void *dst, const void *src, size_t n);
+void *memset(void *dst, int c, size_t n);
+int memcmp(const void *a, const void *b, size_t n);
+
+// Acmd is twice the size of the game's u64 command slots on a 64 bit host, and uintptr_t is the
+// game's 32 bit one, so the commands synthesis_process_notes emits are packed into 32 bit words
+// here, with DRAM addresses replaced by an index into sDramAddrs.
+static u8 *sDramAddrs[0x1000];
+static u32 sNumDramAddrs;
+
+static u32 dram_index(u8 *physAddr) {
+    CHECK(sNumDramAddrs < ARRAY_COUNT(sDramAddrs), "too many DRAM addresses in one command list");
+    sDramAddrs[sNumDramAddrs] = physAddr + 0x80000000U;
+    return sNumDramAddrs++;
+}
+
+#define HARNESS_CMD(pkt, w0, w1) (*(u64 *) (pkt) = ((u64) (u32) (w0) << 32) | (u32) (w1))
+#define HARNESS_DRAM_CMD(pkt, w0, s) HARNESS_CMD(pkt, w0, dram_index((u8 *) (s)))
+
+#undef aSetBuffer
+#undef aLoadBuffer
+#undef aSaveBuffer
+#undef aADPCMdec
+#undef aResample
+#undef aLoadADPCM
+#undef aSetLoop
+#undef aDMEMMove
+#undef aClearBuffer
+#undef aSetVolume
+#undef aSetVolume32
+#undef aEnvMixer
+#undef aMix
+#undef aInterleave
+#define aSetBuffer(pkt, f, i, o, c) \
+    HARNESS_CMD(pkt, _SHIFTL(A_SETBUFF, 24, 8) | _SHIFTL(f, 16, 8) | _SHIFTL(i, 0, 16), _SHIFTL(o, 16, 16) | _SHIFTL(c, 0, 16))
+#define aLoadBuffer(pkt, s)     HARNESS_DRAM_CMD(pkt, _SHIFTL(A_LOADBUFF, 24, 8), s)
+#define aSaveBuffer(pkt, s)     HARNESS_DRAM_CMD(pkt, _SHIFTL(A_SAVEBUFF, 24, 8), s)
+#define aADPCMdec(pkt, f, s)    HARNESS_DRAM_CMD(pkt, _SHIFTL(A_ADPCM, 24, 8) | _SHIFTL(f, 16, 8), s)
+#define aResample(pkt, f, p, s) HARNESS_DRAM_CMD(pkt, _SHIFTL(A_RESAMPLE, 24, 8) | _SHIFTL(f, 16, 8) | _SHIFTL(p, 0, 16), s)
+#define aLoadADPCM(pkt, c, d)   HARNESS_DRAM_CMD(pkt, _SHIFTL(A_LOADADPCM, 24, 8) | _SHIFTL(c, 0, 24), d)
+#define aSetLoop(pkt, a)        HARNESS_DRAM_CMD(pkt, _SHIFTL(A_SETLOOP, 24, 8), a)
+#define aDMEMMove(pkt, i, o, c) HARNESS_CMD(pkt, _SHIFTL(A_DMEMMOVE, 24, 8) | _SHIFTL(i, 0, 24), _SHIFTL(o, 16, 16) | _SHIFTL(c, 0, 16))
+#define aClearBuffer(pkt, d, c) HARNESS_CMD(pkt, _SHIFTL(A_CLEARBUFF, 24, 8) | _SHIFTL(d, 0, 24), c)
+#define aSetVolume(pkt, f, v, t, r) \
+    HARNESS_CMD(pkt, _SHIFTL(A_SETVOL, 24, 8) | _SHIFTL(f, 16, 8) | _SHIFTL(v, 0, 16), _SHIFTL(t, 16, 16) | _SHIFTL(r, 0, 16))
+#define aSetVolume32(pkt, f, v, tr) HARNESS_CMD(pkt, _SHIFTL(A_SETVOL, 24, 8) | _SHIFTL(f, 16, 8) | _SHIFTL(v, 0, 16), tr)
+#define aEnvMixer(pkt, f, s)    HARNESS_DRAM_CMD(pkt, _SHIFTL(A_ENVMIXER, 24, 8) | _SHIFTL(f, 16, 8), s)
+#define aMix(pkt, f, g, i, o)   HARNESS_CMD(pkt, _SHIFTL(A_MIXER, 24, 8) | _SHIFTL(f, 16, 8) | _SHIFTL(g, 0, 16), _SHIFTL(i, 16, 16) | _SHIFTL(o, 0, 16))
+#define aInterleave(pkt, l, r)  HARNESS_CMD(pkt, _SHIFTL(A_INTERLEAVE, 24, 8), _SHIFTL(l, 16, 16) | _SHIFTL(r, 0, 16))
+
+#include "src/audio/synthesis.c"
+
+#define BUF_LEN (136 * 2)
+#define NUM_UPDATES 60
+#define NUM_NOTES 6
+#define DIVERGE_UPDATE 30
+
+struct Note *gNotes;
+s32 gMaxSimultaneousNotes = NUM_NOTES;
+u8 gBankLoadStatus[MAX_NUM_SOUNDBANKS];
+s16 gVolume = 0x7FFF;
+s32 gAudioErrorFlags;
+struct SynthesisReverb gSynthesisReverb;
+s8 gAudioUpdatesPerFrame;
+s8 gReverbDownsampleRate;
+s8 gSoundMode;
+f32 gVolRampingLhs136[1 << VOL_RAMPING_EXPONENT];
+f32 gVolRampingRhs136[1 << VOL_RAMPING_EXPONENT];
+f32 gVolRampingLhs144[1 << VOL_RAMPING_EXPONENT];
+f32 gVolRampingRhs144[1 << VOL_RAMPING_EXPONENT];
+f32 gVolRampingLhs128[1 << VOL_RAMPING_EXPONENT];
+f32 gVolRampingRhs128[1 << VOL_RAMPING_EXPONENT];
+f32 gDefaultPanVolume[128];
+f32 gStereoPanVolume[128];
+f32 gHeadsetPanVolume[128];
+u16 gHeadsetPanQuantization[10];
+#ifdef BETTER_REVERB
+struct SoundAllocPool gBetterReverbPool;
+#endif
+
+// One looped sample, one one-shot sample of two parts per update, and byte-identical copies of
+// both.
+#define LOOPED_FRAMES 40
+#define ONE_SHOT_FRAMES 120
+
+static ALIGNED16 u8 sLoopedData[2][LOOPED_FRAMES * 9];
+static ALIGNED16 u8 sOneShotData[2][ONE_SHOT_FRAMES * 9];
+
+static u32 sNumAdpcmDecodes;
+static u32 sNumSampleDmas;
+
+// The samples' addresses arrive cut down to 32 bits. They're all in this file's data, so the
+// upper half comes from there.
+void *dma_sample_data(uintptr_t devAddr, u32 size, s32 arg2, u8 *dmaIndexRef) {
+    u8 *addr = (u8 *) (((unsigned long) sLoopedData & ~0xFFFFFFFFUL) | devAddr);
+
+    CHECK((addr >= sLoopedData[0] && addr + size <= sLoopedData[2])
+              || (addr >= sOneShotData[0] && addr + size <= sOneShotData[2]),
+          "sample DMA out of range");
+    sNumSampleDmas++;
+    return addr;
+}
+
+// Only reached by the parts of synthesis.c this doesn't run.
+#define NOT_RUN(name) CHECK(FALSE, #name " isn't stubbed")
+void __n64Assert(char *fileName, u32 lineNum, char *message) { NOT_RUN(__n64Assert); }
+void osInvalDCache(void *vaddr, s32 nbytes) { NOT_RUN(osInvalDCache); }
+void process_sequences(s32 iterationsRemaining) { NOT_RUN(process_sequences); }
+void *soundAlloc(struct SoundAllocPool *pool, u32 size) { NOT_RUN(soundAlloc); return NULL; }
+
+/**
+ * A model of the audio microcode's commands, on a DMEM of its own.
+ */
+static union {
+    u8 bytes[0x1000];
+    s16 samples[0x800];
+} sDmem;
+
+static struct {
+    u16 in, out, count;
+    u16 dryRight, wetLeft, wetRight;
+    s16 book[8 * 2 * 16];
+    s16 *loopState;
+    s16 volLeft, volRight, targetLeft, targetRight, dryVol, wetVol;
+} sRsp;
+
+// The envelope mixer's state, as saved in mixEnvelopeState
+struct EnvMixerState {
+    s32 curLeft, curRight, targetLeft, targetRight, dryVol, wetVol;
+};
+
+static s16 *dmem_samples(u32 addr, u32 count) {
+    CHECK((addr & 1) == 0 && addr + count <= sizeof(sDmem), "DMEM access out of range at 0x%X", addr);
+    return &sDmem.samples[addr / 2];
+}
+
+static s16 clamp16(s32 x) {
+    return x > 0x7FFF ? 0x7FFF : x < -0x8000 ? -0x8000 : x;
+}
+
+static void adpcm_decode(s32 flags, s16 *state) {
+    s16 prev[16];
+    s16 *out;
+    u32 numFrames = ALIGN(sRsp.count, 32) / 32;
+    u32 i, j, k;
+
+    if (flags & A_INIT) {
+        memset(prev, 0, sizeof(prev));
+    } else if (flags & A_LOOP) {
+        memcpy(prev, sRsp.loopState, sizeof(prev));
+    } else {
+        memcpy(prev, state, sizeof(prev));
+    }
+    out = dmem_samples(sRsp.out, 32 + numFrames * 32);
+    memcpy(out, prev, sizeof(prev));
+    out += 16;
+
+    for (i = 0; i < numFrames; i++) {
+        u8 *frame = &sDmem.bytes[sRsp.in + i * 9];
+        s32 scale = 1 << (frame[0] >> 4);
+        s16 *pred = &sRsp.book[(frame[0] & 0xF) * 16];
+        s32 ix[16];
+
+        for (j = 0; j < 8; j++) {
+            ix[j * 2] = (s8) (frame[1 + j] & 0xF0) >> 4;
+            ix[j * 2 + 1] = (s8) (frame[1 + j] << 4) >> 4;
+        }
+        for (j = 0; j < 16; j += 8) {
+            s16 last2 = (j == 0 ? out - 2 : out + 6)[0];
+            s16 last1 = (j == 0 ? out - 1 : out + 7)[0];
+            for (k = 0; k < 8; k++) {
+                s32 acc = pred[k] * last2 + pred[8 + k] * last1 + ix[j + k] * scale * 2048;
+                u32 m;
+                for (m = 0; m < k; m++) {
+                    acc += pred[8 + (k - 1 - m)] * ix[j + m] * scale;
+                }
+                out[j + k] = clamp16(acc >> 11);
+            }
+        }
+        out += 16;
+    }
+    memcpy(state, out - 16, 16 * sizeof(s16));
+    // Splitting a note into two parts resamples each one a few samples past what was decoded for it,
+    // so both parts pick up whatever the notes before them left in DMEM there. Two notes in unison on
+    // their own would differ from each other in those samples, so this clears them instead.
+    memset(out, 0, 64);
+    sNumAdpcmDecodes++;
+}
+
+static void resample(s32 flags, u16 pitch, s16 *state) {
+    s16 *src = dmem_samples(sRsp.in - 8, 8);
+    u32 numOut = ALIGN(sRsp.count, 16) / 2;
+    s16 *out = dmem_samples(sRsp.out, numOut * 2);
+    u32 frac;
+    u32 i;
+
+    if (flags & A_INIT) {
+        memset(src, 0, 4 * sizeof(s16));
+        frac = 0;
+    } else {
+        memcpy(src, state, 4 * sizeof(s16));
+        frac = (u16) state[4];
+    }
+    for (i = 0; i < numOut; i++) {
+        CHECK(src + 4 <= &sDmem.samples[ARRAY_COUNT(sDmem.samples)], "resampler read past DMEM");
+        out[i] = clamp16(((src[1] * (0x8000 - (s32) frac) + src[2] * (s32) frac) >> 15) + ((src[0] - src[3]) >> 3));
+        frac += pitch;
+        src += frac >> 15;
+        frac &= 0x7FFF;
+    }
+    memcpy(state, src, 4 * sizeof(s16));
+    state[4] = frac;
+}
+
+static s32 ramp(s32 cur, s32 target) {
+    return cur + (target - cur) / 8 + (target > cur) - (target < cur);
+}
+
+static void env_mixer(s32 flags, s16 *stateBuf) {
+    struct EnvMixerState state;
+    u32 count = ALIGN(sRsp.count, 16) / 2;
+    s16 *in = dmem_samples(sRsp.in, count * 2);
+    s16 *dryLeft = dmem_samples(sRsp.out, count * 2);
+    s16 *dryRight = dmem_samples(sRsp.dryRight, count * 2);
+    s16 *wetLeft = dmem_samples(sRsp.wetLeft, count * 2);
+    s16 *wetRight = dmem_samples(sRsp.wetRight, count * 2);
+    u32 i;
+
+    if (flags & A_INIT) {
+        state.curLeft = sRsp.volLeft;
+        state.curRight = sRsp.volRight;
+        state.targetLeft = sRsp.targetLeft;
+        state.targetRight = sRsp.targetRight;
+        state.dryVol = sRsp.dryVol;
+        state.wetVol = sRsp.wetVol;
+    } else {
+        memcpy(&state, stateBuf, sizeof(state));
+    }
+    for (i = 0; i < count; i++) {
+        s32 left = (((in[i] * state.curLeft) >> 15) * state.dryVol) >> 15;
+        s32 right = (((in[i] * state.curRight) >> 15) * state.dryVol) >> 15;
+        dryLeft[i] = clamp16(dryLeft[i] + left);
+        dryRight[i] = clamp16(dryRight[i] + right);
+        if (flags & A_AUX) {
+            wetLeft[i] = clamp16(wetLeft[i] + ((left * state.wetVol) >> 15));
+            wetRight[i] = clamp16(wetRight[i] + ((right * state.wetVol) >> 15));
+        }
+        state.curLeft = ramp(state.curLeft, state.targetLeft);
+        state.curRight = ramp(state.curRight, state.targetRight);
+    }
+    memcpy(stateBuf, &state, sizeof(state));
+}
+
+static void run_command_list(u64 *cmd, u64 *end) {
+    for (; cmd < end; cmd++) {
+        u32 w0 = *cmd >> 32;
+        u32 w1 = (u32) *cmd;
+        u32 flags = (w0 >> 16) & 0xFF;
+        u8 *dram = sDramAddrs[w1 < sNumDramAddrs ? w1 : 0];
+        u32 i;
+
+        switch (w0 >> 24) {
+            case A_SETBUFF:
+                if (flags & A_AUX) {
+                    sRsp.dryRight = w0 & 0xFFFF;
+                    sRsp.wetLeft = w1 >> 16;
+                    sRsp.wetRight = w1 & 0xFFFF;
+                } else {
+                    sRsp.in = w0 & 0xFFFF;
+                    sRsp.out = w1 >> 16;
+                    sRsp.count = w1 & 0xFFFF;
+                }
+                break;
+            case A_LOADBUFF:
+                dmem_samples(sRsp.in, sRsp.count);
+                memcpy(&sDmem.bytes[sRsp.in], dram, sRsp.count);
+                break;
+            case A_SAVEBUFF:
+                dmem_samples(sRsp.out, sRsp.count);
+                memcpy(dram, &sDmem.bytes[sRsp.out], sRsp.count);
+                break;
+            case A_LOADADPCM:
+                CHECK((w0 & 0xFFFFFF) <= sizeof(sRsp.book), "book too big");
+                memcpy(sRsp.book, dram, w0 & 0xFFFFFF);
+                break;
+            case A_SETLOOP:
+                sRsp.loopState = (s16 *) dram;
+                break;
+            case A_ADPCM:
+                adpcm_decode(flags, (s16 *) dram);
+                break;
+            case A_RESAMPLE:
+                resample(flags, w0 & 0xFFFF, (s16 *) dram);
+                break;
+            case A_DMEMMOVE:
+                dmem_samples(w0 & 0xFFFFFF, ALIGN(w1 & 0xFFFF, 16));
+                dmem_samples(w1 >> 16, ALIGN(w1 & 0xFFFF, 16));
+                memmove(&sDmem.bytes[w1 >> 16], &sDmem.bytes[w0 & 0xFFFFFF], ALIGN(w1 & 0xFFFF, 16));
+                break;
+            case A_CLEARBUFF:
+                memset(dmem_samples(w0 & 0xFFFFFF, ALIGN(w1, 16)), 0, ALIGN(w1, 16));
+                break;
+            case A_SETVOL:
+                if (flags & A_AUX) {
+                    sRsp.dryVol = w0 & 0xFFFF;
+                    sRsp.wetVol = w1 & 0xFFFF;
+                } else if (flags & A_VOL) {
+                    *((flags & A_LEFT) ? &sRsp.volLeft : &sRsp.volRight) = w0 & 0xFFFF;
+                } else {
+                    *((flags & A_LEFT) ? &sRsp.targetLeft : &sRsp.targetRight) = w0 & 0xFFFF;
+                }
+                break;
+            case A_ENVMIXER:
+                env_mixer(flags, (s16 *) dram);
+                break;
+            case A_MIXER: {
+                s16 *in = dmem_samples(w1 >> 16, ALIGN(sRsp.count, 32));
+                s16 *out = dmem_samples(w1 & 0xFFFF, ALIGN(sRsp.count, 32));
+                for (i = 0; i < ALIGN(sRsp.count, 32) / 2; i++) {
+                    out[i] = clamp16(out[i] + ((in[i] * (s16) (w0 & 0xFFFF)) >> 15));
+                }
+                break;
+            }
+            case A_INTERLEAVE: {
+                s16 left[0x200], right[0x200];
+                u32 count = ALIGN(sRsp.count, 16) / 2;
+                s16 *out = dmem_samples(sRsp.out, count * 4);
+                memcpy(left, dmem_samples(w1 >> 16, count * 2), count * 2);
+                memcpy(right, dmem_samples(w1 & 0xFFFF, count * 2), count * 2);
+                for (i = 0; i < count; i++) {
+                    out[i * 2] = left[i];
+                    out[i * 2 + 1] = right[i];
+                }
+                break;
+            }
+            default:
+                CHECK(FALSE, "command %d isn't modeled", w0 >> 24);
+        }
+    }
+}
+
+// Each sample gets its own book, so copies also reload theirs.
+static union {
+    struct AdpcmBook book;
+    s16 raw[4 + 8 * 2 * 2]; // book.book[i] is raw[4 + i]
+} sBooks[2][2];
+static struct AdpcmLoop sLoops[2][2];
+static struct AudioBankSample sSamples[2][2];
+static struct AudioBankSound sSounds[2][2];
+
+enum { SAMPLE_LOOPED, SAMPLE_ONE_SHOT };
+
+static u32 sRandState = 1;
+
+static u32 next_rand(void) {
+    sRandState = sRandState * 1103515245 + 12345;
+    return sRandState >> 16;
+}
+
+static void random_frames(u8 *data, u32 numFrames) {
+    u32 i, j;
+
+    for (i = 0; i < numFrames; i++) {
+        data[i * 9] = ((next_rand() % 6) << 4) | (next_rand() % 2);
+        for (j = 1; j < 9; j++) {
+            data[i * 9 + j] = next_rand();
+        }
+    }
+}
+
+static void init_samples(void) {
+    u32 copy, kind, i;
+
+    random_frames(sLoopedData[0], LOOPED_FRAMES);
+    random_frames(sOneShotData[0], ONE_SHOT_FRAMES);
+    memcpy(sLoopedData[1], sLoopedData[0], sizeof(sLoopedData[0]));
+    memcpy(sOneShotData[1], sOneShotData[0], sizeof(sOneShotData[0]));
+
+    for (copy = 0; copy < 2; copy++) {
+        for (kind = 0; kind < 2; kind++) {
+            struct AudioBankSample *sample = &sSamples[copy][kind];
+
+            sBooks[copy][kind].book.order = 2;
+            sBooks[copy][kind].book.npredictors = 2;
+            for (i = 0; i < 8 * 2 * 2; i++) {
+                sBooks[copy][kind].raw[4 + i] = (kind == SAMPLE_LOOPED ? -1200 : -900) + 450 * (i / 8);
+            }
+            if (kind == SAMPLE_LOOPED) {
+                sLoops[copy][kind].start = 40;
+                sLoops[copy][kind].end = 600;
+                sLoops[copy][kind].count = -1;
+                for (i = 0; i < 16; i++) {
+                    sLoops[copy][kind].state[i] = i * 100;
+                }
+                sample->sampleAddr = sLoopedData[copy];
+            } else {
+                sLoops[copy][kind].end = ONE_SHOT_FRAMES * 16;
+                sample->sampleAddr = sOneShotData[copy];
+            }
+            sample->loop = &sLoops[copy][kind];
+            sample->book = &sBooks[copy][kind].book;
+            sSounds[copy][kind].sample = sample;
+        }
+    }
+}
+
+struct NoteSetup {
+    s32 kind;
+    s32 follower; // Whether the reference run plays a copy of the sample
+    f32 frequency;
+    u16 vol;
+    u8 reverbVol;
+};
+
+// Notes 1 and 2 double note 0, and note 5 doubles note 4. Note 1 is bent out of unison at
+// DIVERGE_UPDATE, after which note 2 is still in unison with note 0, but no longer right after it.
+// Note 3 plays the same sample at another pitch.
+static const struct NoteSetup sNoteSetups[NUM_NOTES] = {
+    { SAMPLE_LOOPED,   FALSE, 1.0f,  0x6000, 0x00 },
+    { SAMPLE_LOOPED,   TRUE,  1.0f,  0x2000, 0x40 },
+    { SAMPLE_LOOPED,   TRUE,  1.0f,  0x4000, 0x00 },
+    { SAMPLE_LOOPED,   FALSE, 1.5f,  0x3000, 0x00 },
+    { SAMPLE_ONE_SHOT, FALSE, 2.75f, 0x5000, 0x20 },
+    { SAMPLE_ONE_SHOT, TRUE,  2.75f, 0x1000, 0x00 },
+};
+
+static struct Note sNotes[NUM_NOTES];
+static struct NoteSynthesisBuffers sSynthesisBuffers[NUM_NOTES];
+
+struct RunResult {
+    s16 aiBuf[NUM_UPDATES][BUF_LEN];
+    struct Note notes[NUM_UPDATES][NUM_NOTES];
+    struct NoteSynthesisBuffers buffers[NUM_UPDATES][NUM_NOTES];
+    u32 numAdpcmDecodes;
+    u32 numSampleDmas;
+    u32 numCmds;
+};
+
+static void run(struct RunResult *result, s32 reference) {
+    static u64 cmdBuf[0x1000];
+    u32 update, i;
+
+    memset(sSynthesisBuffers, 0, sizeof(sSynthesisBuffers));
+    memset(&sDmem, 0, sizeof(sDmem));
+    memset(&sRsp, 0, sizeof(sRsp));
+    memset(sNotes, 0, sizeof(sNotes));
+    for (i = 0; i < NUM_NOTES; i++) {
+        const struct NoteSetup *setup = &sNoteSetups[i];
+        struct Note *note = &sNotes[i];
+
+        note->enabled = TRUE;
+        note->needsInit = TRUE;
+        note->envMixerNeedsInit = TRUE;
+        note->sound = &sSounds[reference && setup->follower][setup->kind];
+        note->synthesisBuffers = &sSynthesisBuffers[i];
+        note->frequency = setup->frequency;
+        note->targetVolLeft = setup->vol;
+        note->targetVolRight = setup->vol / 2;
+        note->reverbVol = setup->reverbVol;
+        note->stereoStrongRight = (i == 2);
+    }
+    sNumAdpcmDecodes = 0;
+    sNumSampleDmas = 0;
+    result->numCmds = 0;
+
+    for (update = 0; update < NUM_UPDATES; update++) {
+        u64 *end;
+
+        if (update == DIVERGE_UPDATE) {
+            sNotes[1].frequency = 1.25f;
+        }
+        sNumDramAddrs = 0;
+        memset(dmem_samples(DMEM_ADDR_LEFT_CH, DEFAULT_LEN_2CH), 0, DEFAULT_LEN_2CH);
+        end = synthesis_process_notes(result->aiBuf[update], BUF_LEN, cmdBuf);
+        CHECK(end - cmdBuf <= (s32) ARRAY_COUNT(cmdBuf), "command buffer overflow");
+        run_command_list(cmdBuf, end);
+        result->numCmds += end - cmdBuf;
+
+        for (i = 0; i < NUM_NOTES; i++) {
+            // As note_set_vel_pan_reverb would for a steady note
+            sNotes[i].envMixerNeedsInit = FALSE;
+        }
+        memcpy(result->notes[update], sNotes, sizeof(sNotes));
+        memcpy(result->buffers[update], sSynthesisBuffers, sizeof(sSynthesisBuffers));
+    }
+    result->numAdpcmDecodes = sNumAdpcmDecodes;
+    result->numSampleDmas = sNumSampleDmas;
+}
+
+static struct RunResult sMerged, sReference;
+
+int main(void) {
+    u32 update, i;
+    s32 loops = 0;
+
+    gNotes = sNotes;
+    gBankLoadStatus[0] = SOUND_LOAD_STATUS_COMPLETE;
+    init_samples();
+
+    run(&sMerged, FALSE);
+    run(&sReference, TRUE);
+
+    printf("%u ADPCM decodes and %u sample DMAs with merging, %u and %u without; %u commands vs %u\n",
+           sMerged.numAdpcmDecodes, sMerged.numSampleDmas, sReference.numAdpcmDecodes, sReference.numSampleDmas,
+           sMerged.numCmds, sReference.numCmds);
+
+    for (update = 0; update < NUM_UPDATES; update++) {
+        for (i = 0; i < NUM_NOTES; i++) {
+            struct Note *a = &sMerged.notes[update][i];
+            struct Note *b = &sReference.notes[update][i];
+
+            CHECK(a->samplePosInt == b->samplePosInt && a->samplePosFrac == b->samplePosFrac,
+                  "update %u note %u at %d.%04X, %d.%04X on its own", update, i, a->samplePosInt, a->samplePosFrac,
+                  b->samplePosInt, b->samplePosFrac);
+            CHECK(a->restart == b->restart && a->finished == b->finished && a->enabled == b->enabled,
+                  "update %u note %u restart/finished/enabled %d/%d/%d, %d/%d/%d on its own", update, i,
+                  a->restart, a->finished, a->enabled, b->restart, b->finished, b->enabled);
+            CHECK(memcmp(sMerged.buffers[update][i].adpcmdecState, sReference.buffers[update][i].adpcmdecState,
+                         sizeof(ADPCM_STATE) + sizeof(RESAMPLE_STATE)) == 0,
+                  "update %u note %u left a different decoder state", update, i);
+        }
+        if (update > 0 && sMerged.notes[update][0].samplePosInt < sMerged.notes[update - 1][0].samplePosInt) {
+            loops++;
+        }
+        CHECK(memcmp(sMerged.aiBuf[update], sReference.aiBuf[update], sizeof(sMerged.aiBuf[update])) == 0,
+              "update %u sounds different", update);
+    }
+
+    CHECK(loops >= 3, "the looped sample only looped %d times", loops);
+    CHECK(sMerged.notes[NUM_UPDATES - 1][5].finished, "the one-shot sample never finished");
+    CHECK(sMerged.notes[DIVERGE_UPDATE][1].samplePosInt != sMerged.notes[DIVERGE_UPDATE][0].samplePosInt,
+          "note 1 never left unison");
+    CHECK(sMerged.numAdpcmDecodes < sReference.numAdpcmDecodes && sMerged.numSampleDmas < sReference.numSampleDmas,
+          "nothing was merged");
+
+    printf("OK\n");
+    return 0;
+}
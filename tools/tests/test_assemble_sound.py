@@ -0,0 +1,294 @@
+import json
+import os
+import random
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+from host import TOOLS_DIR
+import disassemble_sound
+
+LOOPS = 4
+
+
+def f80(value):
+    exp = 0
+    while (1 << (exp + 1)) <= value:
+        exp += 1
+    return struct.pack(">HQ", 0x3FFF + exp, int(value * (1 << (63 - exp))))
+
+
+def pstring(name):
+    data = bytes([len(name)]) + name
+    return data + (b"\0" * (len(data) % 2))
+
+
+def chunk(tp, data):
+    return tp + struct.pack(">I", len(data)) + data + (b"\0" * (len(data) % 2))
+
+
+def make_aifc(frames, loop=None):
+    """
+    A VADPCM AIFC like vadpcm_enc writes, with an order 2 codebook of 2 predictors. loop is
+    (start, end, count).
+    """
+    book = struct.pack(">hhh", 1, 2, 2) + struct.pack(">32h", *([-1200] * 8 + [2400] * 8 + [-300] * 8 + [900] * 8))
+    body = b"AIFC"
+    body += chunk(b"COMM", struct.pack(">hIh", 1, len(frames) // 9 * 16, 16) + f80(16000) + b"VAPC" + pstring(b"VADPCM"))
+    body += chunk(b"APPL", b"stoc" + pstring(b"VADPCMCODES") + book)
+    body += chunk(b"SSND", (b"\0" * 8) + frames)
+    if loop is not None:
+        start, end, count = loop
+        state = struct.pack(">16h", *range(16))
+        body += chunk(b"APPL", b"stoc" + pstring(b"VADPCMLOOPS") + struct.pack(">HHIIi", 1, 1, start, end, count) + state)
+    return chunk(b"FORM", body)
+
+
+def random_frames(seed, count, extra=0):
+    """
+    count ADPCM frames, plus the first extra bytes of another one, like the one-shot samples
+    that end one byte into a frame.
+    """
+    rng = random.Random(seed)
+    data = b""
+    for _ in range(count + (1 if extra else 0)):
+        data += bytes([(rng.randrange(6) << 4) | rng.randrange(2)]) + bytes(rng.randrange(256) for _ in range(8))
+    return data[:(count * 9) + extra]
+
+
+# The sample banks to assemble. "shared" is in every one of them, and "twin" twice in bank b.
+SAMPLES = {
+    "a": {
+        "shared": make_aifc(random_frames(1, 11, 1)),
+        "looped": make_aifc(random_frames(2, 20), loop=(40, 200, -1)),
+        "one_shot": make_aifc(random_frames(3, 7, 1)),
+    },
+    "b": {
+        "shared": make_aifc(random_frames(1, 11, 1)),
+        "twin_1": make_aifc(random_frames(4, 6)),
+        "twin_2": make_aifc(random_frames(4, 6)),
+    },
+    "c": {
+        "shared": make_aifc(random_frames(1, 11, 1)),
+        "looped_to_end": make_aifc(random_frames(5, 9), loop=(16, 144, -1)),
+    },
+}
+
+
+def bank_json(sample_bank):
+    names = sorted(SAMPLES[sample_bank])
+    return {
+        "date": "1996-03-19",
+        "sample_bank": sample_bank,
+        "envelopes": {"envelope0": [[6, 32700], "hang"]},
+        "instruments": {
+            "inst%d" % i: {"release_rate": 10, "envelope": "envelope0", "sound": name} for i, name in enumerate(names)
+        },
+        "instrument_list": ["inst%d" % i for i in range(len(names))],
+    }
+
+
+def parse_ctl(*args):
+    # Only the samples are needed, and the envelope checks after them expect the ROM's exact layout.
+    try:
+        disassemble_sound.parse_ctl(*args)
+    except AssertionError:
+        pass
+
+
+def read_samples(out, is_shindou):
+    """
+    Returns each bank's samples as (.tbl data from the sample's bank on, offset, size, book, loop,
+    bank size), which is how the game addresses them.
+    """
+    with open(os.path.join(out, "sound_data.ctl"), "rb") as f:
+        ctl = f.read()
+    with open(os.path.join(out, "sound_data.tbl"), "rb") as f:
+        tbl = f.read()
+
+    banks = []
+    orig = disassemble_sound.parse_sample
+
+    def record(data, bank_data, sample_bank, is_shindou):
+        if is_shindou:
+            size, addr, loop, book = struct.unpack(">IIII", data)
+        else:
+            _, addr, loop, book, size = struct.unpack(">IIIII", data)
+        banks[-1].append((sample_bank.data, addr, size, disassemble_sound.parse_book(book, bank_data),
+                          disassemble_sound.parse_loop(loop, bank_data), sample_bank.size))
+        return orig(data, bank_data, sample_bank, is_shindou)
+
+    def load_sample_banks(entries):
+        sample_banks = disassemble_sound.parse_tbl(tbl, entries)
+        # Samples are read from wherever their offset points, not just within their bank.
+        for sample_bank in sample_banks[1]:
+            sample_bank.size = len(sample_bank.data)
+            sample_bank.data = tbl[sample_bank.offset:]
+        return sample_banks
+
+    disassemble_sound.parse_sample = record
+    try:
+        if is_shindou:
+            with open(os.path.join(out, "ctl_header"), "rb") as f:
+                ctl_entries = disassemble_sound.parse_sh_header(f.read(), disassemble_sound.TYPE_CTL)
+            with open(os.path.join(out, "tbl_header"), "rb") as f:
+                tbl_entries = disassemble_sound.parse_sh_header(f.read(), disassemble_sound.TYPE_TBL)
+            sample_banks = load_sample_banks(tbl_entries)[1]
+            for index, (offset, length, meta) in enumerate(ctl_entries):
+                banks.append([])
+                parse_ctl((meta[1], meta[2], "0000-00-00"), ctl[offset:offset + length], sample_banks[meta[0]],
+                          index, True)
+        else:
+            ctl_entries = disassemble_sound.parse_seqfile(ctl, disassemble_sound.TYPE_CTL)
+            tbl_entries = disassemble_sound.parse_seqfile(tbl, disassemble_sound.TYPE_TBL)
+            tbls, _, bank_map = load_sample_banks(tbl_entries)
+            for index, (offset, length), name in zip(range(len(ctl_entries)), ctl_entries, tbls):
+                banks.append([])
+                entry = ctl[offset:offset + length]
+                parse_ctl(disassemble_sound.parse_ctl_header(entry[:16]), entry[16:], bank_map[name], index, False)
+    finally:
+        disassemble_sound.parse_sample = orig
+    return banks
+
+
+def coef_table(book):
+    order = book.order
+    tables = []
+    for p in range(book.npredictors):
+        t = [[0] * (order + 8) for _ in range(8)]
+        for j in range(order):
+            for k in range(8):
+                t[k][j] = book.table[p * order * 8 + j * 8 + k]
+        for k in range(1, 8):
+            t[k][order] = t[k - 1][order - 1]
+        t[0][order] = 1 << 11
+        for k in range(1, 8):
+            for j in range(8):
+                t[j][k + order] = 0 if j < k else t[j - k][order]
+        tables.append(t)
+    return tables
+
+
+def decode_frame(frame, state, order, tables):
+    """
+    Decodes one 9 byte frame into 16 samples, as the RSP's ADPCM command does.
+    """
+    scale = 1 << (frame[0] >> 4)
+    t = tables[frame[0] & 0xF]
+    ix = []
+    for c in frame[1:9]:
+        ix += [c >> 4, c & 0xF]
+    ix = [((x - 16) if x >= 8 else x) * scale for x in ix]
+    out = [0] * 16
+    for j in range(2):
+        vec = [0] * 16
+        for i in range(order):
+            vec[i] = state[16 - order + i] if j == 0 else out[8 - order + i]
+        for i in range(8):
+            vec[order + i] = ix[j * 8 + i]
+            v = (sum(t[i][n] * vec[n] for n in range(order + i)) >> 11) + ix[j * 8 + i]
+            out[j * 8 + i] = max(-0x8000, min(0x7FFF, v))
+    return out
+
+
+def render(sample):
+    """
+    Renders a sample the way synthesis_process_notes() walks it: whole frames up to the loop
+    end, then LOOPS times back from the loop start with the loop's state.
+    """
+    data, addr, size, book, loop, _ = sample
+    order, tables = book.order, coef_table(book)
+    end = loop.end
+
+    def frame(k):
+        return data[addr + (k * 9) : addr + (k * 9) + 9].ljust(9, b"\0")
+
+    out = []
+    state = [0] * 16
+    k = 0
+    while len(out) < end:
+        state = decode_frame(frame(k), state, order, tables)
+        out += state
+        k += 1
+    out = out[:end]
+    if loop.count == 0:
+        return out
+
+    for _ in range(LOOPS):
+        state = list(loop.state)
+        seg = state[loop.start & 15:]
+        pos = (loop.start & ~15) + 16
+        while pos < end:
+            state = decode_frame(frame(pos // 16), state, order, tables)
+            seg += state
+            pos += 16
+        out += seg[:end - loop.start]
+    return out
+
+
+class AssembleSoundTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.tmp = tempfile.TemporaryDirectory()
+        samples_dir = os.path.join(cls.tmp.name, "samples")
+        banks_dir = os.path.join(cls.tmp.name, "sound_banks")
+        os.makedirs(banks_dir)
+        for i, (sample_bank, samples) in enumerate(sorted(SAMPLES.items())):
+            os.makedirs(os.path.join(samples_dir, sample_bank))
+            for name, data in samples.items():
+                with open(os.path.join(samples_dir, sample_bank, name + ".aifc"), "wb") as f:
+                    f.write(data)
+            with open(os.path.join(banks_dir, "%02X.json" % i), "w") as f:
+                json.dump(bank_json(sample_bank), f)
+
+        cls.out = {}
+        for version in ["US", "SH"]:
+            for packed in [True, False]:
+                out = os.path.join(cls.tmp.name, version + ("" if packed else "_unpacked"))
+                os.makedirs(out)
+                args = [sys.executable, os.path.join(TOOLS_DIR, "assemble_sound.py"), samples_dir, banks_dir]
+                args += [os.path.join(out, f) for f in ["sound_data.ctl", "ctl_header", "sound_data.tbl", "tbl_header"]]
+                args += ["-DVERSION_" + version, "-D_LANGUAGE_C"]
+                if not packed:
+                    args.append("--no-sample-packing")
+                subprocess.run(args, check=True, capture_output=True)
+                cls.out[version, packed] = out
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.tmp.cleanup()
+
+    def tbl_size(self, version, packed):
+        return os.path.getsize(os.path.join(self.out[version, packed], "sound_data.tbl"))
+
+    def check_renders(self, version):
+        packed = read_samples(self.out[version, True], version == "SH")
+        unpacked = read_samples(self.out[version, False], version == "SH")
+        self.assertEqual([len(bank) for bank in packed], [len(bank) for bank in unpacked])
+        self.assertEqual(sum(len(bank) for bank in packed), sum(len(s) for s in SAMPLES.values()))
+        for bank, (packed_bank, unpacked_bank) in enumerate(zip(packed, unpacked)):
+            for i, (a, b) in enumerate(zip(packed_bank, unpacked_bank)):
+                self.assertEqual(render(a), render(b), "bank %d sample %d" % (bank, i))
+        return packed
+
+    def test_us_shares_samples_across_banks(self):
+        samples = self.check_renders("US")
+        for bank in samples:
+            for data, addr, size, _, _, _ in bank:
+                # Offsets only point forward, to a later bank at most, and never wrap.
+                self.assertLess(addr + size, len(data))
+        # The 100 byte sample in all three banks is written once, the unused frames after
+        # "looped"'s loop end are dropped, and "twin_2" is shared with "twin_1".
+        self.assertLess(self.tbl_size("US", True), self.tbl_size("US", False) - 200)
+
+    def test_sh_keeps_samples_in_their_bank(self):
+        samples = self.check_renders("SH")
+        for bank in samples:
+            for data, addr, size, _, _, bank_size in bank:
+                self.assertLessEqual(addr + size, bank_size)
+
+
+if __name__ == "__main__":
+    unittest.main()
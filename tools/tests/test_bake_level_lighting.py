@@ -0,0 +1,208 @@
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import unittest
+
+from host import REPO_DIR, TOOLS_DIR
+import bake_level_lighting
+
+# An area model with a vertex load for each case the tool tells apart:
+#  - "lit" is only loaded by the area's opaque display list, lit by the colors its material sets,
+#  - "shared" is also loaded by a display list the game's code draws,
+#  - "texgen" is loaded with texture generation on,
+#  - "transparent", "rotated" and "scrolled" are loaded by display lists on a blended layer, under
+#    a rotating geo node and patched by a texture scroll.
+MODEL = """\
+// 0x07000000 - 0x07000040
+static const Vtx test_seg7_vertex_lit[] = {
+    {{{     0,      0,      0}, 0, {     0,      0}, {0x00, 0x7f, 0x00, 0xff}}},
+    {{{   100,      0,      0}, 0, {     0,      0}, {0x49, 0x49, 0x49, 0xff}}},
+    {{{     0,      0,    100}, 0, {     0,      0}, {0x00, 0x81, 0x00, 0xff}}},
+    {{{   100,      0,    100}, 0, {     0,      0}, {0x7f, 0x00, 0x00, 0xfe}}},
+};
+
+{others}
+
+static const Gfx test_seg7_dl_material[] = {
+    gsSPLightColor(LIGHT_1, 0x80ff00ff),
+    gsSPLightColor(LIGHT_2, 0x402000ff),
+    gsSPEndDisplayList(),
+};
+
+static const Gfx test_seg7_dl_area[] = {
+    gsDPPipeSync(),
+    gsSPDisplayList(test_seg7_dl_material),
+    gsSPVertex(test_seg7_vertex_lit, 4, 0),
+    gsSP2Triangles( 0,  1,  2, 0x0,  1,  3,  2, 0x0),
+    gsDPSetCombineMode(G_CC_SHADE, G_CC_SHADE),
+    gsSPVertex(test_seg7_vertex_shared, 3, 0),
+    gsSP1Triangle( 0,  1,  2, 0x0),
+    gsSPSetGeometryMode(G_TEXTURE_GEN),
+    gsSPVertex(test_seg7_vertex_texgen, 3, 0),
+    gsSP1Triangle( 0,  1,  2, 0x0),
+    gsSPClearGeometryMode(G_TEXTURE_GEN),
+    gsSPEndDisplayList(),
+};
+
+const Gfx test_seg7_dl_object[] = {
+    gsSPDisplayList(test_seg7_dl_material),
+    gsSPVertex(test_seg7_vertex_shared, 3, 0),
+    gsSP1Triangle( 0,  1,  2, 0x0),
+    gsSPEndDisplayList(),
+};
+{other_dls}"""
+
+OTHERS = ("shared", "texgen", "transparent", "rotated", "scrolled")
+
+GEO = """\
+const GeoLayout test_area_1_geo[] = {
+    GEO_NODE_START(),
+    GEO_OPEN_NODE(),
+        GEO_DISPLAY_LIST(LAYER_OPAQUE, test_seg7_dl_area),
+        GEO_DISPLAY_LIST(LAYER_TRANSPARENT, test_seg7_dl_transparent),
+        GEO_ROTATION_NODE(0x00, 0, 0, 0),
+        GEO_OPEN_NODE(),
+            GEO_DISPLAY_LIST(LAYER_OPAQUE, test_seg7_dl_rotated),
+        GEO_CLOSE_NODE(),
+        GEO_DISPLAY_LIST(LAYER_OPAQUE, test_seg7_dl_scrolled),
+    GEO_CLOSE_NODE(),
+    GEO_END(),
+};
+"""
+
+FILES = {
+    "levels/test/header.h": "",
+    "levels/test/geo.c": '#include "areas/1/geo.inc.c"\n',
+    "levels/test/areas/1/geo.inc.c": GEO,
+    "levels/test/texscroll.inc.c": "void scroll_test(void) {\n    Gfx *mat = segmented_to_virtual(test_seg7_dl_scrolled);\n}\n",
+    "src/game/test_object.c": "Gfx *geo_test_object(void) {\n    return test_seg7_dl_object;\n}\n",
+}
+
+
+def vertices(name):
+    return "static const Vtx test_seg7_vertex_%s[] = {\n%s};\n" % (name, "".join(
+        "    {{{     0,      0,    %3d}, 0, {     0,      0}, {0x00, 0x7f, 0x00, 0xff}}},\n" % (i * 10)
+        for i in range(3)))
+
+
+def display_list(name):
+    return ("\nstatic const Gfx test_seg7_dl_%s[] = {\n    gsSPDisplayList(test_seg7_dl_material),\n"
+            "    gsSPVertex(test_seg7_vertex_%s, 3, 0),\n    gsSP1Triangle( 0,  1,  2, 0x0),\n"
+            "    gsSPEndDisplayList(),\n};\n" % (name, name))
+
+
+def model():
+    return (MODEL.replace("{others}", "\n".join(vertices(name) for name in OTHERS))
+                 .replace("{other_dls}", "".join(display_list(name) for name in OTHERS[2:])))
+
+
+def vertex_array(text, name):
+    return re.search(r"Vtx test_seg7_vertex_%s\[\] = \{(.*?)\n\};" % name, text, re.S).group(1)
+
+
+def colors(text, name):
+    return re.findall(r"\{(0x\w\w, 0x\w\w, 0x\w\w, 0x\w\w)\}\}\}", vertex_array(text, name))
+
+
+def display_list_lines(text, name):
+    body = re.search(r"Gfx test_seg7_dl_%s\[\] = \{\n(.*?)\n\};" % name, text, re.S).group(1)
+    return [line.strip() for line in body.splitlines()]
+
+
+class BakeLevelLightingTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        files = dict(FILES)
+        files["levels/test/areas/1/1/model.inc.c"] = model()
+        # Only ever drawn on a blended layer, so there's nothing to bake in it.
+        files["levels/test/areas/1/2/model.inc.c"] = vertices("transparent_2") + display_list("transparent_2")
+        for path, contents in files.items():
+            os.makedirs(os.path.dirname(os.path.join(self.tmp.name, path)), exist_ok=True)
+            with open(os.path.join(self.tmp.name, path), "w") as f:
+                f.write(contents)
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def run_tool(self, *args, cwd=None):
+        return subprocess.run([sys.executable, os.path.join(TOOLS_DIR, "bake_level_lighting.py")] + list(args),
+                              cwd=cwd or self.tmp.name, check=True, capture_output=True, text=True)
+
+    def baked_path(self, area):
+        return os.path.join(self.tmp.name, "out", "levels", "test", "areas", "1", str(area), "model.inc.c")
+
+    def test_light_vertex(self):
+        lights = (0x80FF00, 0x402000)
+        light_dir = [0x28, 0x28, 0x28]
+
+        # Ambient plus the light scaled by cos(54.7 degrees), facing it and facing away, clamped to 255
+        self.assertEqual(bake_level_lighting.light_vertex([0, 127, 0], light_dir, lights), [137, 179, 0])
+        self.assertEqual(bake_level_lighting.light_vertex([73, 73, 73], light_dir, lights), [191, 255, 0])
+        self.assertEqual(bake_level_lighting.light_vertex([0, -127, 0], light_dir, lights), [64, 32, 0])
+
+    def test_mode_flag(self):
+        self.assertIs(bake_level_lighting.mode_flag("G_LIGHTING | G_CULL_BACK", "G_LIGHTING"), True)
+        self.assertIs(bake_level_lighting.mode_flag("G_FOG | G_CULL_BACK", "G_LIGHTING"), False)
+        self.assertIs(bake_level_lighting.mode_flag("0x00020000", "G_LIGHTING"), bake_level_lighting.UNKNOWN)
+
+    def test_bake(self):
+        err = self.run_tool("--out-dir", "out").stderr
+        with open(self.baked_path(1)) as f:
+            baked = f.read()
+
+        self.assertEqual(colors(baked, "lit"), ["0x89, 0xb3, 0x00, 0xff", "0xbf, 0xff, 0x00, 0xff",
+                                                "0x40, 0x20, 0x00, 0xff", "0x89, 0xb3, 0x00, 0xfe"])
+        for name in OTHERS:
+            self.assertEqual(colors(baked, name), ["0x00, 0x7f, 0x00, 0xff"] * 3, name)
+
+        # Lighting is only off for the baked load, and back on before the next load that needs it.
+        self.assertEqual(display_list_lines(baked, "area"), [
+            "gsDPPipeSync(),",
+            "gsSPDisplayList(test_seg7_dl_material),",
+            "gsSPClearGeometryMode(G_LIGHTING),",
+            "gsSPVertex(test_seg7_vertex_lit, 4, 0),",
+            "gsSP2Triangles( 0,  1,  2, 0x0,  1,  3,  2, 0x0),",
+            "gsDPSetCombineMode(G_CC_SHADE, G_CC_SHADE),",
+            "gsSPSetGeometryMode(G_LIGHTING),",
+            "gsSPVertex(test_seg7_vertex_shared, 3, 0),",
+            "gsSP1Triangle( 0,  1,  2, 0x0),",
+            "gsSPSetGeometryMode(G_TEXTURE_GEN),",
+            "gsSPVertex(test_seg7_vertex_texgen, 3, 0),",
+            "gsSP1Triangle( 0,  1,  2, 0x0),",
+            "gsSPClearGeometryMode(G_TEXTURE_GEN),",
+            "gsSPEndDisplayList(),",
+        ])
+        # Nothing else in the file changes.
+        unbaked = model()
+        self.assertEqual(baked.replace("gsSPClearGeometryMode(G_LIGHTING),\n    ", "")
+                              .replace("gsSPSetGeometryMode(G_LIGHTING),\n    ", ""),
+                         unbaked.replace(vertex_array(unbaked, "lit"), vertex_array(baked, "lit")))
+
+        self.assertFalse(os.path.exists(self.baked_path(2)))
+        self.assertEqual(err, "test                 1/    6 vertex loads,      4/    19 vertices no longer lit\n")
+
+        # Baked again only once the level or the arguments change, and removed when it's skipped.
+        self.assertEqual(self.run_tool("--out-dir", "out").stderr, "")
+        self.assertNotEqual(self.run_tool("--out-dir", "out", "--light-dir", "0,127,0").stderr, "")
+        with open(self.baked_path(1)) as f:
+            self.assertEqual(colors(f.read(), "lit")[0], "0xc0, 0xff, 0x00, 0xff")
+        self.run_tool("--out-dir", "out", "--skip", "test")
+        self.assertFalse(os.path.exists(self.baked_path(1)))
+
+    def test_report(self):
+        self.assertEqual(self.run_tool("--report").stdout.splitlines(), [
+            "test                 1/    6 vertex loads,      4/    19 vertices no longer lit",
+            "total                1/    6 vertex loads,      4/    19 vertices no longer lit",
+        ])
+
+    def test_repo_level(self):
+        out = self.run_tool("--report", "--level", "bob", cwd=REPO_DIR).stdout
+        baked, loads = [int(n) for n in re.match(r"bob\s+(\d+)/\s*(\d+) vertex loads", out).groups()]
+        self.assertGreater(baked, 0)
+        self.assertLessEqual(baked, loads)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,13 @@
+import unittest
+
+from host import run_harness
+
+
+class ClockMoverTest(unittest.TestCase):
+    def test_matches_stepping_every_frame(self):
+        # The behavior scripts' loop stack holds 32 bit addresses.
+        run_harness("clock_movers", flags=["-no-pie"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,13 @@
+import unittest
+
+from host import run_harness
+
+
+class CollisionPrimitiveTest(unittest.TestCase):
+    def test_breakable_box_matches_its_triangles(self):
+        # The profiler's assembly doesn't build for the host.
+        run_harness("collision_primitives", defines=["DISABLE_ALL"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,14 @@
+import unittest
+
+from host import run_harness
+
+
+class CompoundActorTest(unittest.TestCase):
+    def test_segments_follow_vanilla_objects(self):
+        # The behavior scripts hold 32 bit addresses, and the profiler's assembly doesn't build
+        # for the host.
+        run_harness("compound_actors", defines=["DISABLE_ALL"], flags=["-no-pie"])
+
+
+if __name__ == "__main__":
+    unittest.main()
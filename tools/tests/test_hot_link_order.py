@@ -0,0 +1,152 @@
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+from host import TOOLS_DIR
+import hot_link_order
+from hot_link_order import ICACHE_LINE_SIZE, ICACHE_SIZE
+
+# hot_a and hot_b are in different files and a whole I-cache apart, so they evict each other.
+# The long name's section header is on a line of its own, as ld prints it.
+LINK_MAP = """\
+Archive member included to satisfy reference by file (symbol)
+
+Linker script and memory map
+
+                0x0000000080246000                _mainSegmentStart = .
+ .text          0x0000000080246000       0x50 build/us_n64/asm/entry.o
+                0x0000000080246000                entry_point
+ .text.hot_a    0x0000000080246050       0x40 build/us_n64/src/game/a.o
+                0x0000000080246050                hot_a
+ .text.cold_function_with_a_long_name
+                0x0000000080246090     0x3fc0 build/us_n64/src/game/a.o
+                0x0000000080246090                cold_function_with_a_long_name
+ .text.hot_b    0x000000008024a050       0x40 build/us_n64/src/game/b.o
+                0x000000008024a050                hot_b
+ .text          0x000000008024a090       0x30 /usr/lib/n64/libultra_rom.a(sprintf.o)
+                0x000000008024a090                sprintf
+                0x000000008024a0c0                _mainSegmentTextEnd = .
+ .data          0x000000008024a0c0       0x10 build/us_n64/src/game/a.o
+                0x0000000080300000                _engineSegmentStart = .
+ .text.hot_c    0x0000000080300000       0x20 build/us_n64/src/engine/c.o
+                0x0000000080300000                hot_c
+                0x0000000080300020                _engineSegmentTextEnd = .
+"""
+
+HOT_A = 0x80246050
+HOT_B = 0x8024A050
+
+# hot_a and hot_b taking turns, one cache line each
+TRACE = "# PC samples\n" + "%08X\n%08X\n" % (HOT_A, HOT_B) * 50
+
+
+class HotLinkOrderTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.map_path = self.path("sm64.map", LINK_MAP)
+        self.link_map = hot_link_order.LinkMap(self.map_path)
+        self.link_map.sections_by_key = {s.key(): s for s in self.link_map.sections}
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def path(self, name, contents):
+        path = os.path.join(self.tmp.name, name)
+        with open(path, "w") as f:
+            f.write(contents)
+        return path
+
+    def run_tool(self, *args):
+        return subprocess.run([sys.executable, os.path.join(TOOLS_DIR, "hot_link_order.py")] + list(args),
+                               check=True, capture_output=True, text=True).stdout
+
+    def labels(self, sections):
+        return [s.label() for s in sections]
+
+    def test_link_map(self):
+        link_map = self.link_map
+        self.assertEqual(link_map.segment_ranges, {"main": (0x80246000, 0x8024A0C0), "engine": (0x80300000, 0x80300020)})
+        self.assertEqual(self.labels(link_map.sections),
+                         ["entry_point", "hot_a", "cold_function_with_a_long_name", "hot_b", "sprintf", "hot_c"])
+        self.assertEqual([s.segment for s in link_map.sections], ["main"] * 5 + ["engine"])
+
+        self.assertEqual(link_map.find("hot_b").obj, "build/us_n64/src/game/b.o")
+        self.assertEqual(link_map.find("sprintf").linker_pattern(), "*libultra_rom.a:sprintf.o(.text);")
+        self.assertEqual(link_map.find("a.o:hot_a").addr, HOT_A)
+        self.assertIsNone(link_map.find("b.o:hot_a"))
+        self.assertIs(link_map.find("entry.o:entry_point"), link_map.sections[0])
+        self.assertIsNone(link_map.find("a.o:sprintf"))
+        self.assertIs(link_map.section_at(HOT_B + 0x3F), link_map.find("hot_b"))
+        self.assertIsNone(link_map.section_at(0x80300020))
+
+    def test_not_a_link_map(self):
+        with self.assertRaisesRegex(ValueError, "no segment text ranges"):
+            hot_link_order.LinkMap(self.path("empty.map", "Linker script and memory map\n"))
+
+    def test_function_counts(self):
+        counts = "hot_a 100\ncold_function_with_a_long_name 1000\nb.o:hot_b 50\nhot_c 10\nmissing 5000\n"
+        profile = hot_link_order.read_profile(self.path("counts.txt", counts))
+        ordered = hot_link_order.order_sections(self.link_map, profile, self.link_map, 0xA0)
+
+        # By hit density, and the cold function is too big for the budget despite its hits.
+        self.assertEqual(self.labels(ordered["main"]), ["hot_a", "hot_b"])
+        self.assertEqual(self.labels(ordered["engine"]), ["hot_c"])
+
+    def test_mixed_profile(self):
+        with self.assertRaisesRegex(ValueError, "mixes"):
+            hot_link_order.read_profile(self.path("mixed.txt", "hot_a 10\n80246050\n"))
+
+    def test_samples_remove_aliasing(self):
+        profile = hot_link_order.read_profile(self.path("trace.txt", TRACE))
+        pairs = hot_link_order.translate_samples(profile[1], self.link_map, self.link_map)
+        ordered = hot_link_order.order_sections(self.link_map, profile, self.link_map, ICACHE_SIZE)
+        new_addr = hot_link_order.relocate(self.link_map, ordered, False)
+        hot_a, hot_b = self.link_map.find("hot_a"), self.link_map.find("hot_b")
+
+        self.assertEqual(sorted(self.labels(ordered["main"])), ["hot_a", "hot_b"])
+        self.assertEqual(abs(new_addr[hot_a] - new_addr[hot_b]), 0x40)
+        # The entry point stays first.
+        self.assertEqual(new_addr[self.link_map.sections[0]], 0x80246000)
+        self.assertEqual(min(new_addr[hot_a], new_addr[hot_b]), 0x80246050)
+        self.assertEqual(hot_link_order.simulate_cache(hot_link_order.expand_samples(pairs)), 100)
+        self.assertEqual(hot_link_order.simulate_cache(hot_link_order.expand_samples(pairs, new_addr)), 2)
+
+    def test_pad(self):
+        counts = "hot_a 10\nhot_b 10\nhot_c 10\n"
+        profile = hot_link_order.read_profile(self.path("counts.txt", counts))
+        ordered = hot_link_order.order_sections(self.link_map, profile, self.link_map, ICACHE_SIZE)
+        new_addr = hot_link_order.relocate(self.link_map, ordered, True)
+        main_hot_end = max(new_addr[s] + s.size for s in ordered["main"])
+
+        # The engine's hot code continues where the main segment's ends in the I-cache.
+        self.assertEqual(new_addr[self.link_map.find("hot_c")] % ICACHE_SIZE, main_hot_end % ICACHE_SIZE)
+        self.assertEqual(main_hot_end % ICACHE_LINE_SIZE, 0x10)
+
+    def test_generate(self):
+        profile = self.path("counts.txt", "hot_b 50\nhot_a 100\nsprintf 10\n")
+        out = self.run_tool("generate", "--map", self.map_path, "--out-dir", self.tmp.name, "--pad", "-v", profile)
+
+        with open(os.path.join(self.tmp.name, "hot_text_main.inc.ld")) as f:
+            self.assertEqual(f.read().splitlines()[1:], [
+                "      build/us_n64/src/game/a.o(.text.hot_a);",
+                "      build/us_n64/src/game/b.o(.text.hot_b);",
+                "      *libultra_rom.a:sprintf.o(.text);",
+                "      _mainHotTextEnd = ABSOLUTE(.);",
+            ])
+        with open(os.path.join(self.tmp.name, "hot_text_engine.inc.ld")) as f:
+            self.assertEqual(f.read().splitlines()[1:], [
+                "      . = . + ((_mainHotTextEnd - ABSOLUTE(.)) & 0x3FFF);",
+                "      _engineHotTextEnd = ABSOLUTE(.);",
+            ])
+        self.assertIn("main       3 hot sections, 0x000B0 bytes", out)
+
+    def test_simulate(self):
+        out = self.run_tool("simulate", "--map", self.map_path, self.path("trace.txt", TRACE))
+        self.assertIn("samples: 100", out)
+        self.assertIn("misses:  100 -> 2 (98.0% fewer)", out)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,199 @@
+import glob
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+from host import REPO_DIR, TOOLS_DIR
+import level_pool_sizes
+
+# A one-level tree, with what the tool reads from the rest of the repo. The area has:
+#  - a 2000x2000 square of terrain, 2 triangles in 4 cells each with EXTENDED_BOUNDS_MODE 1,
+#  - a box in every act and a special box right next to it, and another box far away in act 2,
+#    each 2 triangles with a child object,
+#  - a coin macro object.
+FILES = {
+    "include/config/config_world.h": "#define EXTENDED_BOUNDS_MODE 1\n",
+    "include/config/config_graphics.h": "#define GFX_POOL_SIZE {gfx}\n",
+    "src/game/object_list_processor.h": "#define OBJECT_POOL_CAPACITY 7\n",
+    "src/engine/surface_load.h": "#define DYNAMIC_SURFACE_POOL_SIZE 0x100\n",
+    "include/macro_presets.h": """\
+static struct MacroPreset MacroObjectPresets[] = {
+    {bhvYellowCoin, MODEL_YELLOW_COIN, 0}, // macro_yellow_coin
+};
+""",
+    "include/special_preset_names.h": """\
+enum SpecialPresets {
+    special_null_start,
+    special_box = 0x02,
+    special_end // not in special_presets.h
+};
+""",
+    "include/special_presets.h": """\
+static struct SpecialPreset SpecialObjectPresets[] = {
+    { 0x00, SPTYPE_YROT_NO_PARAMS, 0x00, MODEL_NONE, NULL },
+    { 0x02, SPTYPE_NO_YROT_OR_PARAMS, 0x00, MODEL_BOX, bhvBox },
+};
+""",
+    "data/behavior_data.c": """\
+const BehaviorScript bhvBox[] = {
+    BEGIN(OBJ_LIST_SURFACE),
+    LOAD_COLLISION_DATA(box_collision),
+    SET_FLOAT(oCollisionDistance, 500),
+    SPAWN_CHILD(/*Model*/ MODEL_NONE, /*Behavior*/ bhvBoxChild),
+    BEGIN_LOOP(),
+        CALL_NATIVE(load_object_collision_model),
+    END_LOOP(),
+};
+""",
+    "actors/box/collision.inc.c": """\
+const Collision box_collision[] = {
+    COL_INIT(),
+    COL_VERTEX_INIT(4),
+    COL_VERTEX(-100, 0, -100),
+    COL_VERTEX( 100, 0, -100),
+    COL_VERTEX( 100, 0,  100),
+    COL_VERTEX(-100, 0,  100),
+    COL_TRI_INIT(SURFACE_DEFAULT, 2),
+    COL_TRI(0, 1, 2),
+    COL_TRI(0, 2, 3),
+    COL_TRI_STOP(),
+    COL_END(),
+};
+""",
+    "actors/box/geo.inc.c": """\
+const GeoLayout box_geo[] = {
+    GEO_NODE_START(),
+    GEO_OPEN_NODE(),
+        GEO_DISPLAY_LIST(LAYER_OPAQUE, box_dl),
+    GEO_CLOSE_NODE(),
+    GEO_END(),
+};
+""",
+    "levels/scripts.c": """\
+const LevelScript script_func_global_1[] = {
+    LOAD_MODEL_FROM_DL(MODEL_YELLOW_COIN, coin_dl, LAYER_ALPHA),
+    RETURN(),
+};
+""",
+    "levels/test/script.c": """\
+const LevelScript level_test_entry[] = {
+    INIT_LEVEL(),
+    LOAD_MODEL_FROM_GEO(MODEL_BOX, box_geo),
+    JUMP_LINK(script_func_global_1),
+    AREA(/*index*/ 1, test_area_1_geo),
+        OBJECT(/*model*/ MODEL_BOX, /*pos*/ 3200, 0, 3000, /*angle*/ 0, 0, 0, /*bhvParam*/ 0, /*bhv*/ bhvBox),
+        OBJECT_WITH_ACTS(MODEL_BOX, -3000, 0, -3000, 0, 0, 0, 0, bhvBox, ACT_2),
+        TERRAIN(/*terrainData*/ test_area_1_collision),
+        MACRO_OBJECTS(/*objList*/ test_area_1_macro_objs),
+    END_AREA(),
+    EXIT(),
+};
+""",
+    "levels/test/areas/1/collision.inc.c": """\
+const Collision test_area_1_collision[] = {
+    COL_INIT(),
+    COL_VERTEX_INIT(4),
+    COL_VERTEX(-1000, 0, -1000),
+    COL_VERTEX( 1000, 0, -1000),
+    COL_VERTEX( 1000, 0,  1000),
+    COL_VERTEX(-1000, 0,  1000),
+    COL_TRI_INIT(SURFACE_DEFAULT, 2),
+    COL_TRI(0, 1, 2),
+    COL_TRI(0, 2, 3),
+    COL_TRI_STOP(),
+    COL_SPECIAL_INIT(1),
+    SPECIAL_OBJECT(/*preset*/ special_box, /*pos*/ 3000, 0, 3000),
+    COL_END(),
+};
+""",
+    "levels/test/areas/1/macro.inc.c": """\
+const MacroObject test_area_1_macro_objs[] = {
+    MACRO_OBJECT(/*preset*/ macro_yellow_coin, /*yaw*/ 0, /*pos*/ 0, 100, 200),
+    MACRO_OBJECT_END(),
+};
+""",
+    "levels/test/areas/1/geo.inc.c": """\
+const GeoLayout test_area_1_geo[] = {
+    GEO_NODE_START(),
+    GEO_OPEN_NODE(),
+        GEO_DISPLAY_LIST(LAYER_OPAQUE, test_dl_1),
+        GEO_DISPLAY_LIST(LAYER_ALPHA, NULL),
+        GEO_BRANCH(1, test_geo_shared),
+    GEO_CLOSE_NODE(),
+    GEO_END(),
+};
+
+const GeoLayout test_geo_shared[] = {
+    GEO_ANIMATED_PART(LAYER_OPAQUE, 0, 0, 0, test_dl_2),
+    GEO_RETURN(),
+};
+""",
+}
+
+
+class LevelPoolSizesTest(unittest.TestCase):
+    def run_tool(self, *args, gfx=100):
+        with tempfile.TemporaryDirectory() as tmp:
+            for path, contents in FILES.items():
+                os.makedirs(os.path.dirname(os.path.join(tmp, path)), exist_ok=True)
+                with open(os.path.join(tmp, path), "w") as f:
+                    f.write(contents.replace("{gfx}", str(gfx)))
+            header = os.path.join(tmp, "build", "pool_sizes.h")
+            result = subprocess.run([sys.executable, os.path.join(TOOLS_DIR, "level_pool_sizes.py"), "--root", tmp,
+                                     "--object-reserve", "0", "--gfx-base", "0", "--header", header] + list(args),
+                                    capture_output=True, text=True)
+            with open(header) as f:
+                return result, f.read()
+
+    def test_parse_calls(self):
+        self.assertEqual(level_pool_sizes.parse_calls("A(1, B(2, 3)),\n C(), D(x)"),
+                         [("A", ["1", "B(2, 3)"]), ("C", []), ("D", ["x"])])
+
+    def test_eval_int(self):
+        self.assertEqual(level_pool_sizes.eval_int("(u8) 0x10 | 1 << 2"), 0x14)
+        self.assertEqual(level_pool_sizes.eval_int("-300 / 7"), -43)
+        self.assertEqual(level_pool_sizes.eval_int("ACT_1 | ACT_3", {"ACT_1": 1, "ACT_3": 4}), 5)
+        with self.assertRaises(ValueError):
+            level_pool_sizes.eval_int("__import__('os')")
+
+    def test_area(self):
+        result, header = self.run_tool("--check")
+        rows = [line.split() for line in result.stdout.splitlines()]
+
+        # Objects: Mario, the two boxes and their children and the coin, plus the other box and
+        # its child in act 2. Dynamic surfaces: the two boxes next to each other, the one at
+        # x = 3200 in just 2 of the 4 cells. Gfx: a transform for each object, and 10 for each
+        # of the area's 2 display lists that aren't NULL and the box model's 1.
+        self.assertEqual(rows[1], ["test:1", "8!", "2", "8", "160", "4", "288!", "104!"])
+        self.assertEqual(rows[2:], [["limits:", "7", "objects,", "0x100", "dynamic", "surface", "bytes,", "100", "Gfx"]])
+        self.assertEqual(result.returncode, 1)
+
+        # With 25% headroom, rounded up
+        self.assertIn("#define OBJECT_POOL_CAPACITY 16\n", header)
+        self.assertIn("#define DYNAMIC_SURFACE_POOL_SIZE 0x400\n", header)
+        self.assertIn("#define GFX_POOL_SIZE 200\n", header)
+
+    def test_gfx_pool_size_is_never_lowered(self):
+        result, header = self.run_tool("--quiet", "--check", "--headroom", "0", gfx=1000)
+        self.assertEqual(result.stdout, "")
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("#define OBJECT_POOL_CAPACITY 8\n", header)
+        self.assertIn("#define GFX_POOL_SIZE 1000\n", header)
+
+    def test_repo_levels(self):
+        out = subprocess.run([sys.executable, os.path.join(TOOLS_DIR, "level_pool_sizes.py"), "--check"],
+                             check=True, capture_output=True, text=True).stdout
+        levels = {line.split(":")[0] for line in out.splitlines()[1:-1]}
+
+        # Every level has its areas found, and fits the current settings. The intro and file select
+        # scripts have no level_<name>_entry, so they're not sized.
+        self.assertEqual(levels, {os.path.basename(os.path.dirname(path))
+                                  for path in glob.glob(os.path.join(REPO_DIR, "levels", "*", "script.c"))}
+                         - {"intro", "menu"})
+        self.assertNotIn("!", out)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,44 @@
+import re
+import unittest
+
+from host import run_harness
+
+# DISABLE_ALL drops the profiler, whose timer reads are MIPS assembly.
+DEFINES = ["DISABLE_ALL"]
+
+
+def atan2s_max_error(output):
+    return float(re.search(r"atan2s max error ([0-9.]+)", output).group(1))
+
+
+def matrices(output):
+    return {line.split()[0]: [int(word, 16) for word in line.split()[1:]]
+            for line in output.splitlines() if line.startswith(("zxy ", "xyz "))}
+
+
+class MathKernelsTest(unittest.TestCase):
+    def test_atan2s_polynomial(self):
+        table = atan2s_max_error(run_harness("math_kernels", defines=DEFINES))
+        polynomial = atan2s_max_error(run_harness("math_kernels", defines=DEFINES + ["ATAN2S_POLYNOMIAL"]))
+
+        # The figures documented for ATAN2S_POLYNOMIAL in config_game.h
+        self.assertLessEqual(polynomial, 0.6)
+        self.assertLessEqual(table, 5.5)
+        self.assertGreater(table, polynomial)
+
+    def test_skip_zero_rotation(self):
+        full = matrices(run_harness("math_kernels", defines=DEFINES))
+        skipped = matrices(run_harness("math_kernels", defines=DEFINES + ["MTXF_SKIP_ZERO_ROTATION"]))
+
+        self.assertEqual(full.keys(), {"zxy", "xyz"})
+        self.assertEqual(full.keys(), skipped.keys())
+        for name in full:
+            for a, b in zip(full[name], skipped[name]):
+                # Only the sign of zeros may differ.
+                if a != b:
+                    self.assertEqual(a & 0x7FFFFFFF, 0, name)
+                    self.assertEqual(b & 0x7FFFFFFF, 0, name)
+
+
+if __name__ == "__main__":
+    unittest.main()
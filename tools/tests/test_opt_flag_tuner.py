@@ -0,0 +1,190 @@
+import json
+import os
+import stat
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+from host import TOOLS_DIR
+import opt_flag_tuner
+
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+
+SOURCES = ("src/a.c", "src/b.c")
+
+# The credits' CPU time with each file built with each set of flags, and the size of its code.
+# a.c is a lot faster with -O2, and -O3 only beats that by less than the tolerance. b.c is only
+# faster with -O2 by less than the tolerance, and just as fast but smaller with -Os.
+TIMES = {
+    "src/a.c": {"current": 1000, "-O2": 900, "-O3": 898, "-Os": 1000, "-fhang": 0},
+    "src/b.c": {"current": 1000, "-O2": 999, "-O3": 1200, "-Os": 1000, "-fhang": 0},
+}
+SIZES = {"current": 0x400, "-O2": 0x480, "-O3": 0x600, "-Os": 0x300, "-fhang": 0x400}
+
+CANDIDATES = """\
+# Like the Makefile's, with two that don't get as far as a report
+fast:   -O2
+o3:     -O3
+small:  -Os
+broken: -fbroken
+hang:   -fhang
+"""
+
+# Stands in for the Makefile: builds every file with the flags it would get, and a "ROM" that
+# tells the emulator which ones those were.
+FAKE_MAKE = """\
+import json, os, sys
+sys.path.insert(0, {tests_dir!r})
+from test_opt_flag_tuner import SHF_ALLOC, SHF_EXECINSTR, SIZES, SOURCES, make_elf
+
+with open("make.log", "a") as f:
+    f.write(" ".join(sys.argv[1:]) + "\\n")
+args = dict(arg.split("=", 1) for arg in sys.argv[1:] if "=" in arg)
+
+flags = {{}}
+with open(args["OPT_FLAGS_FILE"]) as f:
+    for line in f:
+        if ": OPT_FLAGS := " in line:
+            obj, value = line.strip().split(": OPT_FLAGS := ")
+            flags[obj[len("$(BUILD_DIR)/"):-len(".o")] + ".c"] = value
+if "OPT_TUNE_FILE" in args:
+    flags[args["OPT_TUNE_FILE"]] = args["OPT_TUNE_FLAGS"]
+if "-fbroken" in flags.values():
+    sys.exit("cc1: error: unrecognized command-line option '-fbroken'")
+
+for source in SOURCES:
+    obj = os.path.join("build", "us_n64", source[:-len(".c")] + ".o")
+    os.makedirs(os.path.dirname(obj), exist_ok=True)
+    with open(obj, "wb") as f:
+        size = SIZES[flags.get(source, "current")]
+        f.write(make_elf([(SHF_ALLOC | SHF_EXECINSTR, size), (SHF_ALLOC, 0x10)]))
+with open(os.path.join("build", "us_n64", "sm64.us.z64"), "w") as f:
+    json.dump(flags, f)
+"""
+
+# Stands in for the emulator running the credits benchmark.
+FAKE_EMULATOR = """\
+import json, sys
+sys.path.insert(0, {tests_dir!r})
+from test_opt_flag_tuner import SOURCES, TIMES
+
+with open(sys.argv[1]) as f:
+    flags = json.load(f)
+print("booting")
+if "-fhang" not in flags.values():
+    cpu = sum(TIMES[source][flags.get(source, "current")] for source in SOURCES)
+    print("[   1234] BENCHMARK frames=300 cpu=%d rsp=5000" % cpu)
+"""
+
+
+def make_elf(sections):
+    """A big endian ELF32 header and section headers, for (flags, size) sections."""
+    elf = bytearray(52)
+    elf[:6] = b"\x7fELF\x01\x02"
+    struct.pack_into(">I", elf, 0x20, len(elf))
+    struct.pack_into(">HH", elf, 0x2E, 40, len(sections))
+    for flags, size in sections:
+        header = bytearray(40)
+        struct.pack_into(">I", header, 0x08, flags)
+        struct.pack_into(">I", header, 0x14, size)
+        elf += header
+    return bytes(elf)
+
+
+class OptFlagTunerTest(unittest.TestCase):
+    def test_code_size(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "file.o")
+            with open(path, "wb") as f:
+                f.write(make_elf([(0, 0), (SHF_ALLOC | SHF_EXECINSTR, 0x40), (SHF_ALLOC, 0x10),
+                                  (SHF_ALLOC | SHF_EXECINSTR, 0x24)]))
+            self.assertEqual(opt_flag_tuner.code_size(path), 0x64)
+
+            with open(path, "wb") as f:
+                f.write(b"\x7fELF\x01\x01" + bytes(46))
+            with self.assertRaisesRegex(ValueError, "not a big endian ELF32"):
+                opt_flag_tuner.code_size(path)
+
+    def test_read_candidates(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "candidates.txt")
+            with open(path, "w") as f:
+                f.write(CANDIDATES)
+            self.assertEqual(opt_flag_tuner.read_candidates(path)[:2], [("fast", "-O2"), ("o3", "-O3")])
+
+            with open(path, "w") as f:
+                f.write("main $(GCC_MAIN_OPT_FLAGS)\n")
+            with self.assertRaisesRegex(ValueError, "expected 'name: flags'"):
+                opt_flag_tuner.read_candidates(path)
+
+    def test_tune(self):
+        tests_dir = os.path.dirname(os.path.abspath(__file__))
+        with tempfile.TemporaryDirectory() as tmp:
+            os.makedirs(os.path.join(tmp, "bin"))
+            os.makedirs(os.path.join(tmp, "src"))
+            make = os.path.join(tmp, "bin", "make")
+            with open(make, "w") as f:
+                f.write("#!%s\n" % sys.executable + FAKE_MAKE.format(tests_dir=tests_dir))
+            os.chmod(make, os.stat(make).st_mode | stat.S_IXUSR)
+            with open(os.path.join(tmp, "emulator.py"), "w") as f:
+                f.write(FAKE_EMULATOR.format(tests_dir=tests_dir))
+            with open(os.path.join(tmp, "candidates.txt"), "w") as f:
+                f.write(CANDIDATES)
+            for source in SOURCES:
+                open(os.path.join(tmp, source), "w").close()
+
+            env = dict(os.environ, PATH=os.path.join(tmp, "bin") + os.pathsep + os.environ["PATH"])
+            result = subprocess.run([sys.executable, os.path.join(TOOLS_DIR, "opt_flag_tuner.py"),
+                                     "--emulator", "%s emulator.py {rom}" % sys.executable, "--out", "opt_flags.mk",
+                                     "--candidates", "candidates.txt", "--results", "results.json",
+                                     "--make-args", "VERSION=jp", "-j", "2"] + list(SOURCES),
+                                    cwd=tmp, env=env, check=True, capture_output=True, text=True)
+
+            with open(os.path.join(tmp, "opt_flags.mk")) as f:
+                fragment = f.read()
+            with open(os.path.join(tmp, "results.json")) as f:
+                results = json.load(f)
+            with open(os.path.join(tmp, "make.log")) as f:
+                make_args = f.readline().split()
+            left = [path for path in ["opt_flag_tuner.mk", "src/a.o", "src/b.o"]
+                    if os.path.exists(os.path.join(tmp, "build", "us_n64", path))]
+
+        self.assertEqual(fragment, "\n".join([
+            "# Generated by tools/opt_flag_tuner.py, do not edit.",
+            "# Benchmark: credits, metric: cpu",
+            "",
+            "# fast",
+            "$(BUILD_DIR)/src/a.o: OPT_FLAGS := -O2",
+            "",
+            "# small",
+            "$(BUILD_DIR)/src/b.o: OPT_FLAGS := -Os",
+            "",
+        ]))
+
+        # b.c is measured with the flags picked for a.c.
+        self.assertEqual([(r["file"], r["candidate"], r["cpu"], r["code_size"]) for r in results], [
+            ("src/a.c", "current", 2000, 0x400),
+            ("src/a.c", "fast", 1900, 0x480),
+            ("src/a.c", "o3", 1898, 0x600),
+            ("src/a.c", "small", 2000, 0x300),
+            ("src/b.c", "current", 1900, 0x400),
+            ("src/b.c", "fast", 1899, 0x480),
+            ("src/b.c", "o3", 2100, 0x600),
+            ("src/b.c", "small", 1900, 0x300),
+        ])
+        self.assertEqual(results[0]["frames"], 300)
+        self.assertEqual(results[0]["flags"], None)
+        self.assertIn("  broken           build failed", result.stderr)
+        self.assertIn("  hang             no benchmark report", result.stderr)
+
+        self.assertEqual(make_args[:2], ["-j2", "VERSION=jp"])
+        self.assertIn("CREDITS_BENCHMARK=1", make_args)
+        self.assertIn("ISVPRINT=1", make_args)
+        self.assertEqual(left, [])
+
+
+if __name__ == "__main__":
+    unittest.main()
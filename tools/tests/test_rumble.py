@@ -0,0 +1,12 @@
+import unittest
+
+from host import run_harness
+
+
+class RumbleTest(unittest.TestCase):
+    def test_simulated_si(self):
+        run_harness("rumble_si")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,99 @@
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+from host import TOOLS_DIR
+import segment_relocs
+
+SEGMENT_BASE = 0x07000000
+
+
+def build_elf(data, relocs):
+    """
+    A big endian ELF32 holding a .data section at the start of segment 7 and a .rel.data with an
+    R_MIPS_32 relocation for each offset in relocs, like a segment linked with --emit-relocs.
+    """
+    shstrtab = b"\0.data\0.rel.data\0.shstrtab\0"
+    rel = b"".join(struct.pack(">II", SEGMENT_BASE + offset, segment_relocs.R_MIPS_32) for offset in relocs)
+
+    data_offset = 0x34
+    rel_offset = data_offset + len(data)
+    shstrtab_offset = rel_offset + len(rel)
+    shoff = shstrtab_offset + len(shstrtab)
+
+    header = b"\x7fELF\x01\x02\x01" + (b"\0" * 9)
+    header += struct.pack(">HHIIIIIHHHHHH", 1, 8, 1, 0, 0, shoff, 0, 0x34, 0, 0, 40, 4, 3)
+
+    def section(name, type, addr, offset, size, info, entsize):
+        return struct.pack(">IIIIIIIIII", name, type, 0, addr, offset, size, 0, info, 4, entsize)
+
+    sections = section(0, 0, 0, 0, 0, 0, 0)
+    sections += section(shstrtab.index(b".data"), 1, SEGMENT_BASE, data_offset, len(data), 0, 0)
+    sections += section(shstrtab.index(b".rel.data"), segment_relocs.SHT_REL, 0, rel_offset, len(rel), 1, 8)
+    sections += section(shstrtab.index(b".shstrtab"), 3, 0, shstrtab_offset, len(shstrtab), 0, 0)
+
+    return header + data + rel + shstrtab + sections
+
+
+def find_table(segment):
+    """
+    Reads the relocation table from the end of a loaded segment, as relocate_segment() does.
+    """
+    count, magic = struct.unpack_from(">II", segment, len(segment) - 8)
+    if magic != segment_relocs.SEGMENT_RELOCATION_MAGIC:
+        return None
+    return list(struct.unpack_from(">%dI" % count, segment, len(segment) - 8 - (4 * count)))
+
+
+class SegmentRelocsTest(unittest.TestCase):
+    def test_only_pointers_into_the_segment_are_kept(self):
+        data = struct.pack(">IIII", SEGMENT_BASE + 0x8, 0x08001000, SEGMENT_BASE + 0x4, 0)
+        elf = build_elf(data, [0x8, 0x4, 0x0])
+
+        # The pointer to segment 8 is left alone, and the table is sorted.
+        self.assertEqual(segment_relocs.find_relocations(elf), [0x0, 0x8])
+
+    def test_unaligned_relocation(self):
+        elf = build_elf(b"\0" * 8, [0x2])
+        with self.assertRaises(ValueError):
+            segment_relocs.find_relocations(elf)
+
+    def test_table_ends_on_rom_alignment(self):
+        for data_size in range(1, 40):
+            for offsets in ([], [0x0], [0x0, 0x4, 0x8]):
+                segment = (b"\xAA" * data_size) + segment_relocs.build_table(data_size, offsets)
+
+                self.assertEqual(len(segment) % 16, 0)
+                self.assertEqual((len(segment) - 8 - (4 * len(offsets))) % 4, 0)
+                self.assertEqual(find_table(segment), offsets)
+                # The data itself is untouched.
+                self.assertEqual(segment[:data_size], b"\xAA" * data_size)
+
+    def test_appends_to_extracted_segment(self):
+        data = struct.pack(">III", 0x12345678, SEGMENT_BASE + 0x8, 0xCAFEF00D)[:-1]
+        elf = build_elf(data + b"\0", [0x4])
+
+        with tempfile.TemporaryDirectory() as tmp:
+            elf_path = os.path.join(tmp, "segment.elf")
+            bin_path = os.path.join(tmp, "segment.bin")
+            with open(elf_path, "wb") as f:
+                f.write(elf)
+            with open(bin_path, "wb") as f:
+                f.write(data)
+
+            subprocess.run([sys.executable, os.path.join(TOOLS_DIR, "segment_relocs.py"), elf_path, bin_path],
+                           check=True)
+            with open(bin_path, "rb") as f:
+                segment = f.read()
+
+        # An uncompressed segment is loaded with the ROM's 16 byte padding after it.
+        self.assertEqual(len(segment) % 16, 0)
+        self.assertEqual(find_table(segment), [0x4])
+        self.assertEqual(segment[:len(data)], data)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,136 @@
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+from host import REPO_DIR, TOOLS_DIR
+import seq_compiler
+from seq_compiler import (
+    CompileError, SEQ_EVENT_CALL, SEQ_EVENT_DELAY, SEQ_EVENT_END, SEQ_EVENT_FALLBACK, SEQ_EVENT_LOOP,
+    SEQ_EVENT_LOOPEND, SEQ_EVENT_NOTE0, SEQ_EVENT_NOTE1, SEQ_EVENT_SET_VELOCITY,
+)
+
+
+def make_sequence(writeseq=True, dynamic=False):
+    """
+    A sequence with one channel and one layer, which calls a subroutine and loops over a note.
+    The channel's chan_writeseq patches the velocity of the subroutine's setvel, and with dynamic,
+    the channel also has a chan_dyncall.
+    """
+    seq = bytes([
+        0x90, 0x00, 0x06,                      # 0x00: seq_startchannel 0, 0x06
+        0xFD, 0x7F,                            # 0x03: seq_delay 0x7F
+        0xFF,                                  # 0x05: seq_end
+    ])
+    seq += bytes([0x90, 0x00, 0x10])           # 0x06: chan_setlayer 0, 0x10
+    if writeseq:
+        seq += bytes([0xC7, 0x00, 0x00, 0x24]) # 0x09: chan_writeseq 0, 0x24
+    else:
+        seq += bytes([0x00] * 4)               # 0x09: chan_testlayerfinished 0 (x4)
+    if dynamic:
+        seq += bytes([0xE4, 0x00])             # 0x0D: chan_dyncall, chan_testlayerfinished 0
+    else:
+        seq += bytes([0xFD, 0x10])             # 0x0D: chan_delay 0x10
+    seq += bytes([0xFF])                       # 0x0F: chan_end
+    seq += bytes([
+        0xC1, 0x60,                            # 0x10: layer_setvel 0x60
+        0xFC, 0x00, 0x20,                      # 0x12: layer_call 0x20
+        0xF8, 0x02,                            # 0x15: layer_loop 2
+        0x27, 0x81, 0x00, 0x50, 0x40,          # 0x17: layer_note0 39, 0x100, 0x50, 0x40
+        0xF7,                                  # 0x1C: layer_loopend
+        0xC0, 0x20,                            # 0x1D: layer_delay 0x20
+        0xFF,                                  # 0x1F: layer_end
+        0x67, 0x30, 0x50,                      # 0x20: layer_note1 39, 0x30, 0x50
+        0xC1, 0x40,                            # 0x23: layer_setvel 0x40
+        0xFF,                                  # 0x25: layer_end
+    ])
+    return seq
+
+
+# Events before the subroutine, as [op, arg0, arg1, arg2, value, offset]
+MAIN_EVENTS = [
+    [SEQ_EVENT_SET_VELOCITY, 0x60, 0, 0, 0, 0x10],
+    [SEQ_EVENT_CALL, 0, 0, 0, 7, 0x12],
+    [SEQ_EVENT_LOOP, 2, 0, 0, 0, 0x15],
+    [SEQ_EVENT_NOTE0, 39, 0x50, 0x40, 0x100, 0x17],
+    [SEQ_EVENT_LOOPEND, 0, 0, 0, 0, 0x1C],
+    [SEQ_EVENT_DELAY, 0, 0, 0, 0x20, 0x1D],
+    [SEQ_EVENT_END, 0, 0, 0, 0, 0x1F],
+    [SEQ_EVENT_NOTE1, 39, 0x50, 0, 0x30, 0x20],
+]
+
+
+class SeqCompilerTest(unittest.TestCase):
+    def test_events(self):
+        self.assertEqual(seq_compiler.compile_sequence(make_sequence(writeseq=False)), MAIN_EVENTS + [
+            [SEQ_EVENT_SET_VELOCITY, 0x40, 0, 0, 0, 0x23],
+            [SEQ_EVENT_END, 0, 0, 0, 0, 0x25],
+        ])
+
+    def test_written_command_falls_back(self):
+        # The patched command is left to the interpreter, along with everything after it.
+        self.assertEqual(seq_compiler.compile_sequence(make_sequence()), MAIN_EVENTS + [
+            [SEQ_EVENT_FALLBACK, 0, 0, 0, 0, 0x23],
+        ])
+
+    def test_dynamic_channel_code(self):
+        self.assertEqual(len(seq_compiler.compile_sequence(make_sequence(writeseq=False, dynamic=True))), 10)
+        with self.assertRaisesRegex(CompileError, "dynamic"):
+            seq_compiler.compile_sequence(make_sequence(dynamic=True))
+
+    def test_overlapping_commands(self):
+        seq = bytes([
+            0x90, 0x00, 0x04,                  # 0x00: seq_startchannel 0, 0x04
+            0xFF,                              # 0x03: seq_end
+            0x90, 0x00, 0x08,                  # 0x04: chan_setlayer 0, 0x08
+            0xFF,                              # 0x07: chan_end
+            0xC1, 0xFF,                        # 0x08: layer_setvel 0xFF
+            0xFB, 0x00, 0x09,                  # 0x0A: layer_jump 0x09, into the setvel
+        ])
+        with self.assertRaisesRegex(CompileError, "overlapping"):
+            seq_compiler.compile_sequence(seq)
+
+    def test_unknown_command(self):
+        with self.assertRaisesRegex(CompileError, "unknown seq command 0x10"):
+            seq_compiler.compile_sequence(bytes([0x10, 0xFF]))
+
+    def test_serialize_events(self):
+        events = seq_compiler.compile_sequence(make_sequence())
+        stream = seq_compiler.serialize_events(events, 0x30)
+
+        self.assertEqual(len(stream), 8 + (8 * len(events)) + 8)
+        self.assertEqual(stream[:8], b"SQEV" + struct.pack(">HH", len(events), 0))
+        self.assertEqual(stream[-8:], b"SQEV" + struct.pack(">I", 0x30))
+        for i, event in enumerate(events):
+            self.assertEqual(list(struct.unpack(">BBBBHH", stream[8 + (i * 8):16 + (i * 8)])), event)
+
+    def test_events_match_seqplayer(self):
+        with open(os.path.join(REPO_DIR, "src", "audio", "seqplayer.h")) as f:
+            enum = re.search(r"enum SeqEventOps \{(.*?)\};", f.read(), re.S).group(1)
+        names = re.findall(r"SEQ_EVENT_\w+", enum)
+
+        self.assertEqual(len(names), len(seq_compiler.EVENT_NAMES))
+        for i, name in enumerate(names):
+            self.assertEqual(getattr(seq_compiler, name), i, name)
+
+    def test_command_line(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            compiled = os.path.join(tmp, "compiled.m64")
+            broken = os.path.join(tmp, "broken.m64")
+            with open(compiled, "wb") as f:
+                f.write(make_sequence())
+            with open(broken, "wb") as f:
+                f.write(make_sequence(dynamic=True))
+            out = subprocess.run([sys.executable, os.path.join(TOOLS_DIR, "seq_compiler.py"), "--dump", compiled, broken],
+                                 check=True, capture_output=True, text=True).stdout
+
+        self.assertIn("compiled.m64: 38 bytes, 9 events (2 notes, 1 fallbacks), 88 stream bytes", out)
+        self.assertIn("    0017: note0               39  80  64   256", out)
+        self.assertIn("broken.m64: not compiled (chan_writeseq used together with dynamic channel code)", out)
+
+
+if __name__ == "__main__":
+    unittest.main()
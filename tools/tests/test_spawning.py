@@ -0,0 +1,12 @@
+import unittest
+
+from host import run_harness
+
+
+class DeferredSpawnTest(unittest.TestCase):
+    def test_counted_objects_spawn_with_the_area(self):
+        run_harness("deferred_spawns", defines=["TIME_SLICED_SPAWNING"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,13 @@
+import unittest
+
+from host import run_harness
+
+
+class UnisonNotesTest(unittest.TestCase):
+    def test_merged_notes_sound_like_their_own(self):
+        # DISABLE_ALL drops the audio profiler, whose timer reads are MIPS assembly.
+        run_harness("unison_notes", defines=["MERGE_UNISON_NOTES", "DISABLE_ALL"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,180 @@
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import png
+
+from host import TOOLS_DIR
+import texture_format_analyzer
+from texture_format_analyzer import Texture, expand5
+
+WHITE = (0xFF, 0xFF, 0xFF, 0xFF)
+BLACK = (0x00, 0x00, 0x00, 0xFF)
+CLEAR = (0x00, 0x00, 0x00, 0x00)
+
+# Every grey RGBA16 can hold, which only I8 has all of.
+GREYS = [(expand5(v), expand5(v), expand5(v), 0xFF) for v in range(32)]
+
+COLORS = [(0xFF, 0x00, 0x00, 0xFF), (0x00, 0xFF, 0x00, 0xFF), (0x00, 0x00, 0xFF, 0xFF), WHITE, CLEAR]
+
+
+def texels(size, colors):
+    """Diagonal stripes of the colors, or the colors themselves when there's one for each texel."""
+    if len(colors) == size * size:
+        return colors
+    return [colors[((i % size) + (i // size)) % len(colors)] for i in range(size * size)]
+
+
+def write_png(path, size, colors):
+    rows = [sum(texels(size, colors)[y * size:(y + 1) * size], ()) for y in range(size)]
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "wb") as f:
+        png.Writer(size, size, greyscale=False, alpha=True, bitdepth=8).write(f, rows)
+
+
+def choice(colors, threshold=0, allow_i=True, allow_ci=True):
+    texture = Texture("levels/test/texture.rgba16.png", 32, 32, texels(32, colors))
+    texture.choose_format(threshold, allow_i, allow_ci)
+    return texture.choice
+
+
+# A level with a texture for each way it can be loaded:
+#  - "checker" with gsDPLoadTextureBlock, and extracted from the base ROM,
+#  - "cutout" with its own texture image and render tile setup,
+#  - "shared" with a render tile that's set up elsewhere, like most vanilla level textures,
+#  - "palette" with gsDPLoadTextureBlock, but it only becomes cheaper as CI4.
+TEXTURES = {"checker": (32, [WHITE, BLACK]), "cutout": (16, [WHITE, CLEAR]), "shared": (16, [BLACK, WHITE]),
+            "palette": (16, COLORS)}
+
+TEXTURE_ARRAYS = "".join("""
+ALIGNED8 static const Texture test_%s[] = {
+#include "levels/test/%s.rgba16.inc.c"
+};
+""" % (name, name) for name in TEXTURES)
+
+MODEL = TEXTURE_ARRAYS + """
+static const Gfx test_dl_checker[] = {
+    gsDPLoadTextureBlock(test_checker, G_IM_FMT_RGBA, G_IM_SIZ_16b, 32, 32, 0, G_TX_WRAP | G_TX_NOMIRROR, G_TX_WRAP | G_TX_NOMIRROR, 5, 5, G_TX_NOLOD, G_TX_NOLOD),
+    gsDPLoadTextureBlock(test_palette, G_IM_FMT_RGBA, G_IM_SIZ_16b, 16, 16, 0, G_TX_WRAP | G_TX_NOMIRROR, G_TX_WRAP | G_TX_NOMIRROR, 4, 4, G_TX_NOLOD, G_TX_NOLOD),
+    gsSPEndDisplayList(),
+};
+
+static const Gfx test_dl_cutout[] = {
+    gsDPSetTextureImage(G_IM_FMT_RGBA, G_IM_SIZ_16b, 1, test_cutout),
+    gsDPSetTile(G_IM_FMT_RGBA, G_IM_SIZ_16b, 0, 0, G_TX_LOADTILE, 0, G_TX_WRAP | G_TX_NOMIRROR, G_TX_NOMASK, G_TX_NOLOD, G_TX_WRAP | G_TX_NOMIRROR, G_TX_NOMASK, G_TX_NOLOD),
+    gsDPLoadSync(),
+    gsDPLoadBlock(G_TX_LOADTILE, 0, 0, 16 * 16 - 1, CALC_DXT(16, G_IM_SIZ_16b_BYTES)),
+    gsDPPipeSync(),
+    gsDPSetTile(G_IM_FMT_RGBA, G_IM_SIZ_16b, 4, 0, G_TX_RENDERTILE, 0, G_TX_CLAMP, 4, G_TX_NOLOD, G_TX_MIRROR, 4, G_TX_NOLOD),
+    gsDPSetTileSize(0, 0, 0, (16 - 1) << G_TEXTURE_IMAGE_FRAC, (16 - 1) << G_TEXTURE_IMAGE_FRAC),
+    gsSPEndDisplayList(),
+};
+
+static const Gfx test_dl_shared[] = {
+    gsDPSetTextureImage(G_IM_FMT_RGBA, G_IM_SIZ_16b, 1, test_shared),
+    gsDPLoadSync(),
+    gsDPLoadBlock(G_TX_LOADTILE, 0, 0, 16 * 16 - 1, CALC_DXT(16, G_IM_SIZ_16b_BYTES)),
+    gsSPVertex(test_vertex, 4, 0),
+    gsSPEndDisplayList(),
+};
+"""
+
+
+class TextureFormatAnalyzerTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.model_path = os.path.join(self.tmp.name, "levels", "test", "model.inc.c")
+        for name, (size, colors) in TEXTURES.items():
+            write_png(self.texture_path(name, "rgba16"), size, colors)
+        with open(self.model_path, "w") as f:
+            f.write(MODEL)
+        with open(os.path.join(self.tmp.name, "assets.json"), "w") as f:
+            json.dump({"@sha1": "", "levels/test/checker.rgba16.png": [32, 32, 2048, {}]}, f)
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def texture_path(self, name, fmt):
+        return os.path.join(self.tmp.name, "levels", "test", "%s.%s.png" % (name, fmt))
+
+    def run_tool(self, *args):
+        return subprocess.run([sys.executable, os.path.join(TOOLS_DIR, "texture_format_analyzer.py"),
+                               "--root", self.tmp.name] + list(args), check=True, capture_output=True, text=True).stdout
+
+    def test_read_rgba16_texels(self):
+        path = os.path.join(self.tmp.name, "colors.png")
+        write_png(path, 2, [(100, 200, 50, 128), CLEAR])
+        # Rounded to 5 bits and expanded back, with any alpha opaque
+        self.assertEqual(texture_format_analyzer.read_rgba16_texels(path),
+                         (2, 2, [(99, 198, 49, 0xFF), CLEAR, CLEAR, (99, 198, 49, 0xFF)]))
+
+    def test_choose_format(self):
+        self.assertEqual(choice([WHITE, BLACK]), ("i4", 512, 0, 0))
+        self.assertEqual(choice([WHITE, BLACK], allow_i=False), ("ia4", 512, 0, 0))
+        self.assertEqual(choice([WHITE, CLEAR]), ("ia4", 512, 0, 0))
+        self.assertEqual(choice(GREYS), ("i8", 1024, 0, 0))
+        self.assertEqual(choice(GREYS, threshold=8), ("i4", 512, 0, 8))
+        self.assertEqual(choice(COLORS), ("ci4", 512, 10, 0))
+        self.assertIsNone(choice(COLORS, allow_ci=False))
+        # More colors than CI8 has
+        self.assertIsNone(choice([(expand5(i & 0x1F), expand5(i >> 5), 0, 0xFF) for i in range(32 * 32)]))
+
+    def test_report(self):
+        out = self.run_tool("--verbose").splitlines()
+        with open(self.model_path) as f:
+            self.assertEqual(f.read(), MODEL)
+
+        self.assertEqual(out[:4], [
+            "levels/test/checker.rgba16.png 32x32 -> i4 (error 0, 1536 bytes saved, 1 load sites): extracted from the base ROM",
+            "levels/test/cutout.rgba16.png 16x16 -> ia4 (error 0, 384 bytes saved, 1 load sites): can be rewritten",
+            "levels/test/palette.rgba16.png 16x16 -> ci4 (error 0, 374 bytes saved, 1 load sites): CI needs TLUT setup in the material",
+            "levels/test/shared.rgba16.png 16x16 -> i4 (error 0, 384 bytes saved, 1 load sites): "
+            "levels/test/model.inc.c: render tile is set up elsewhere",
+        ])
+        self.assertEqual(out[4:], [
+            "level                    textures  cheaper  rom saved tmem saved",
+            "test                            4        4       2678       2678",
+            "total                           4        4       2678       2678",
+        ])
+
+    def test_rewrite(self):
+        out = self.run_tool("--rewrite").splitlines()
+        with open(self.model_path) as f:
+            model = f.read()
+
+        self.assertEqual(out[-1].split()[-1], "1")
+        self.assertIn('#include "levels/test/cutout.ia4.inc.c"', model)
+        self.assertFalse(os.path.exists(self.texture_path("cutout", "rgba16")))
+
+        # Written as the intensity and alpha n64graphics reads back to the same texels
+        with open(self.texture_path("cutout", "ia4"), "rb") as f:
+            width, height, rows, _ = png.Reader(file=f).asDirect()
+            self.assertEqual((width, height), (16, 16))
+            self.assertEqual([list(row) for row in rows], [[0xFF, 0xFF, 0x00, 0x00] * 8 if y % 2 == 0 else
+                                                           [0x00, 0x00, 0xFF, 0xFF] * 8 for y in range(16)])
+
+        # Everything else is left as it was.
+        load_start = MODEL.index("    gsDPSetTextureImage(G_IM_FMT_RGBA, G_IM_SIZ_16b, 1, test_cutout)")
+        load_end = MODEL.index("    gsSPEndDisplayList(),", load_start)
+        self.assertEqual(model.replace("cutout.ia4", "cutout.rgba16"),
+                         MODEL[:load_start] + "    gsDPLoadTextureBlock_4b(test_cutout, G_IM_FMT_IA, 16, 16, 0, "
+                         "G_TX_MIRROR, G_TX_CLAMP, 4, 4, G_TX_NOLOD, G_TX_NOLOD),\n" + MODEL[load_end:])
+        for name in ("checker", "shared", "palette"):
+            self.assertTrue(os.path.exists(self.texture_path(name, "rgba16")), name)
+
+    def test_rewrite_extracted(self):
+        self.run_tool("--rewrite", "--include-extracted")
+        with open(self.model_path) as f:
+            model = f.read()
+
+        self.assertIn('#include "levels/test/checker.i4.inc.c"', model)
+        self.assertIn("    gsDPLoadTextureBlock_4b(test_checker, G_IM_FMT_I, 32, 32, 0, G_TX_WRAP | G_TX_NOMIRROR, "
+                      "G_TX_WRAP | G_TX_NOMIRROR, 5, 5, G_TX_NOLOD, G_TX_NOLOD),\n", model)
+        self.assertTrue(os.path.exists(self.texture_path("checker", "i4")))
+
+
+if __name__ == "__main__":
+    unittest.main()
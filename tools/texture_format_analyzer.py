@@ -0,0 +1,462 @@
+#!/usr/bin/env python3
+"""
+Finds RGBA16 textures that could use a cheaper format, reports what that would save per level, and can convert
+the ones it's able to.
+
+A texture's format comes from its file name (foo.rgba16.png), but many RGBA16 textures are greyscale, only use
+their one bit of alpha or have a handful of colors. For every *.rgba16.png under levels/, actors/ and textures/,
+this tool decodes the texels the way n64graphics and the RDP would, and picks the smallest format that
+reproduces them:
+  I4, I8       greyscale and fully opaque. I textures return their intensity as alpha too, so this assumes
+               the texture's alpha isn't used while it's opaque; pass --no-i if a material does.
+  IA4, IA8     greyscale with one bit alpha.
+  CI4, CI8     at most 16 or 256 distinct colors, plus a TLUT of that many RGBA16 entries. CI textures have
+               to fit in half of TMEM.
+By default only lossless choices are made. --threshold allows greyscale formats to be off by up to that much
+per channel (0-255), e.g. for textures that are greyscale apart from some noise, or that only need 3 or 4 bits.
+
+The report gives, per level, the texture data that would be saved in ROM (before compression), and the bytes
+fewer that are loaded into TMEM across the static load sites in the display lists (each site is counted once,
+however often it's drawn).
+
+--rewrite converts the textures whose every reference is a load it can redo: a gsDPLoadTextureBlock, or a
+gsDPSetTextureImage followed by the texture's own tile setup up to its gsDPSetTileSize, both of which are
+replaced with a gsDPLoadTextureBlock of the new format. The PNG is written under its new name and the
+#include of its data updated. Textures that share a render tile set up elsewhere, as most vanilla level
+textures do, are only reported. CI choices are also only reported, since they need TLUT setup in the
+material. Textures extracted from the base ROM (listed in assets.json) are skipped by --rewrite unless
+--include-extracted is given, as extracting assets again would bring the old files back.
+
+Usage:
+  texture_format_analyzer.py [--level bob] [--threshold 8] [--verbose]
+  texture_format_analyzer.py --rewrite [--level bob] [--include-extracted] [--no-i] [--no-ci]
+"""
+import argparse
+import json
+import os
+import re
+
+import png
+
+TEXTURE_DIRS = ("levels", "actors", "textures")
+SOURCE_DIRS = ("levels", "actors", "bin", "textures", "src", "data", "include")
+
+# TMEM is 4KB, and CI textures only get the lower half since their TLUT goes in the upper one.
+TMEM_SIZE = 4096
+
+# Candidate formats: name, G_IM_FMT, bits per texel.
+FORMATS = (
+    ("i4", "G_IM_FMT_I", 4),
+    ("ia4", "G_IM_FMT_IA", 4),
+    ("ci4", "G_IM_FMT_CI", 4),
+    ("i8", "G_IM_FMT_I", 8),
+    ("ia8", "G_IM_FMT_IA", 8),
+    ("ci8", "G_IM_FMT_CI", 8),
+)
+
+# Intensities each greyscale format can represent, as the RDP expands them to 8 bits.
+INTENSITY_LEVELS = {
+    "i4": [i * 0x11 for i in range(16)],
+    "i8": list(range(256)),
+    "ia4": [(i << 5) | (i << 2) | (i >> 1) for i in range(8)],
+    "ia8": [i * 0x11 for i in range(16)],
+}
+
+TEXTURE_ARRAY_RE = re.compile(r"\bTexture\s+(\w+)\s*\[[^\]]*\]\s*=\s*\{\s*((?:#include\s+\"[^\"]+\"\s*)+)\}")
+INCLUDE_RE = re.compile(r"#include\s+\"([^\"]+)\"")
+IDENT_RE = re.compile(r"\b[A-Za-z_]\w*\b")
+CMD_RE = re.compile(r"^(\s*)(\w+)\s*\((.*)\)\s*,?\s*(//.*)?$")
+
+GBI_CONSTANTS = {
+    "G_TX_RENDERTILE": 0,
+    "G_TX_LOADTILE": 7,
+    "G_TEXTURE_IMAGE_FRAC": 2,
+}
+
+# Commands allowed between a texture's gsDPSetTextureImage and its gsDPSetTileSize for the sequence to be
+# replaced with a gsDPLoadTextureBlock.
+TEXTURE_LOAD_COMMANDS = ("gsDPSetTile", "gsDPLoadSync", "gsDPLoadBlock", "gsDPTileSync", "gsDPPipeSync")
+
+
+def expand5(value):
+    return (value << 3) | (value >> 2)
+
+
+def read_rgba16_texels(path):
+    """The texture's size and texels, as the RDP sees them once n64graphics has converted it to RGBA16."""
+    texels = []
+    with open(path, "rb") as f:
+        width, height, rows, _ = png.Reader(file=f).asRGBA8()
+        for row in rows:
+            for x in range(width):
+                r, g, b, a = row[x * 4:x * 4 + 4]
+                # SCALE_8_5 in n64graphics
+                texels.append((expand5(((r + 4) * 0x1F) // 0xFF), expand5(((g + 4) * 0x1F) // 0xFF),
+                               expand5(((b + 4) * 0x1F) // 0xFF), 0xFF if a else 0))
+    return width, height, texels
+
+
+def is_intensity_only(fmt):
+    return fmt in ("i4", "i8")
+
+
+def nearest(levels, value):
+    return min(levels, key=lambda level: abs(level - value))
+
+
+def greyscale_error(fmt, colors):
+    """Largest channel error of representing colors in greyscale format fmt, and the intensity for each color."""
+    levels = INTENSITY_LEVELS[fmt]
+    error = 0
+    intensities = {}
+    for color in colors:
+        r, g, b, a = color
+        if is_intensity_only(fmt) and a != 0xFF:
+            return None, None
+        intensity = nearest(levels, (r + g + b + 1) // 3)
+        error = max(error, abs(r - intensity), abs(g - intensity), abs(b - intensity))
+        intensities[color] = intensity
+    return error, intensities
+
+
+class Texture:
+    def __init__(self, path, width, height, texels):
+        self.path = path
+        self.width = width
+        self.height = height
+        self.texels = texels
+        self.colors = set(texels)
+        self.arrays = []      # (source file, array name)
+        self.load_sites = 0
+        self.rewrites = []    # (source file, start, end, replacement) for every reference
+        self.blocker = None   # why the texture can't be rewritten
+        self.choice = None    # (fmt, texel bytes, tlut bytes, error)
+
+    @property
+    def group(self):
+        parts = self.path.split(os.sep)
+        if parts[0] == "levels":
+            return parts[1]
+        if parts[0] == "textures":
+            return os.path.join(parts[0], parts[1])
+        return parts[0]
+
+    def size(self, bits):
+        return (self.width * self.height * bits + 7) // 8
+
+    def choose_format(self, threshold, allow_i, allow_ci):
+        for fmt, _, bits in FORMATS:
+            texel_bytes = self.size(bits)
+            if fmt.startswith("ci"):
+                if not allow_ci:
+                    continue
+                if len(self.colors) > (1 << bits) or texel_bytes > TMEM_SIZE // 2:
+                    continue
+                candidate = (fmt, texel_bytes, len(self.colors) * 2, 0)
+            else:
+                if is_intensity_only(fmt) and not allow_i:
+                    continue
+                error, _ = greyscale_error(fmt, self.colors)
+                if error is None or error > threshold:
+                    continue
+                candidate = (fmt, texel_bytes, 0, error)
+            if candidate[1] + candidate[2] < self.size(16):
+                self.choice = candidate
+                return
+
+
+def split_args(text):
+    args = []
+    depth = 0
+    current = ""
+    for char in text:
+        if char == "," and depth == 0:
+            args.append(current.strip())
+            current = ""
+            continue
+        depth += (char == "(") - (char == ")")
+        current += char
+    args.append(current.strip())
+    return args
+
+
+def eval_gbi(expr):
+    """Evaluate a simple integer expression from a display list, or None."""
+    for name, value in GBI_CONSTANTS.items():
+        expr = re.sub(r"\b%s\b" % name, str(value), expr)
+    if not re.fullmatch(r"[\s\d()+\-*<>x]+", expr):
+        return None
+    try:
+        return int(eval(expr, {"__builtins__": {}}))
+    except (SyntaxError, TypeError, ValueError):
+        return None
+
+
+def load_texture_block(name, fmt, width, height, pal, tile_args):
+    """gsDPLoadTextureBlock for the texture in its new format. tile_args are cms, cmt, masks, maskt, shifts, shiftt."""
+    _, fmt_macro, bits = next(f for f in FORMATS if f[0] == fmt)
+    if bits == 4:
+        args = [name, fmt_macro, str(width), str(height), pal] + tile_args
+        return "gsDPLoadTextureBlock_4b(%s)," % ", ".join(args)
+    args = [name, fmt_macro, "G_IM_SIZ_8b", str(width), str(height), pal] + tile_args
+    return "gsDPLoadTextureBlock(%s)," % ", ".join(args)
+
+
+def line_spans(text, start):
+    """The lines of text from offset start on, as (line start, line end, line)."""
+    pos = start
+    while pos < len(text):
+        end = text.find("\n", pos)
+        if end < 0:
+            end = len(text)
+        yield pos, end, text[pos:end]
+        pos = end + 1
+
+
+class SourceIndex:
+    def __init__(self):
+        self.texts = {}
+        self.identifiers = {}
+        for top in SOURCE_DIRS:
+            for root, _, files in os.walk(top):
+                for name in files:
+                    if name.endswith((".c", ".h")):
+                        path = os.path.join(root, name)
+                        with open(path) as f:
+                            self.texts[path] = f.read()
+                        self.identifiers[path] = set(IDENT_RE.findall(self.texts[path]))
+
+    def files_using(self, name):
+        return [path for path, identifiers in self.identifiers.items() if name in identifiers]
+
+
+def find_texture_arrays(index, textures):
+    by_include = dict((os.path.splitext(path)[0] + ".inc.c", texture) for path, texture in textures.items())
+    for path, text in index.texts.items():
+        if ".rgba16.inc.c" not in text:
+            continue
+        for match in TEXTURE_ARRAY_RE.finditer(text):
+            includes = INCLUDE_RE.findall(match.group(2))
+            for include in includes:
+                texture = by_include.get(os.path.normpath(include))
+                if texture is None:
+                    continue
+                texture.arrays.append((path, match.group(1)))
+                if len(includes) > 1:
+                    texture.blocker = "shares the array %s with other data" % match.group(1)
+
+
+def find_references(index, texture):
+    """Count the texture's load sites and work out how to redo each of them, or why that isn't possible."""
+    for array_path, name in texture.arrays:
+        for path in index.files_using(name):
+            text = index.texts[path]
+            for match in re.finditer(r"\b%s\b" % name, text):
+                line_start = text.rfind("\n", 0, match.start()) + 1
+                line_end = text.find("\n", match.start())
+                line = text[line_start:line_end if line_end >= 0 else len(text)]
+                if re.search(r"\bTexture\s+%s\s*\[" % name, line):
+                    continue  # definition or declaration
+                cmd = CMD_RE.match(line)
+                if cmd is not None and cmd.group(2) in ("gsDPLoadTextureBlock", "gsDPSetTextureImage"):
+                    texture.load_sites += 1
+                    rewrite = (reference_load_block(texture, text, line_start, line, cmd) if cmd.group(2) == "gsDPLoadTextureBlock"
+                               else reference_texture_image(texture, text, line_start, cmd))
+                    if isinstance(rewrite, str):
+                        texture.blocker = texture.blocker or "%s: %s" % (path, rewrite)
+                    else:
+                        texture.rewrites.append((path,) + rewrite)
+                else:
+                    texture.blocker = texture.blocker or "%s: referenced outside of a texture load" % path
+
+
+def reference_load_block(texture, text, line_start, line, cmd):
+    args = split_args(cmd.group(3))
+    if len(args) != 12 or args[1:3] != ["G_IM_FMT_RGBA", "G_IM_SIZ_16b"]:
+        return "unexpected gsDPLoadTextureBlock arguments"
+    if eval_gbi(args[3]) != texture.width or eval_gbi(args[4]) != texture.height:
+        return "gsDPLoadTextureBlock size doesn't match the texture"
+    end = line_start + len(line)
+    return line_start, end, lambda fmt: cmd.group(1) + load_texture_block(args[0], fmt, texture.width, texture.height,
+                                                                             args[5], args[6:12])
+
+
+def reference_texture_image(texture, text, line_start, cmd):
+    args = split_args(cmd.group(3))
+    if args[0:2] != ["G_IM_FMT_RGBA", "G_IM_SIZ_16b"]:
+        return "unexpected gsDPSetTextureImage arguments"
+
+    render_tile = None
+    for start, end, line in line_spans(text, line_start):
+        if start == line_start:
+            continue
+        next_cmd = CMD_RE.match(line)
+        if next_cmd is None:
+            return "texture load isn't followed by its tile setup"
+        name, next_args = next_cmd.group(2), split_args(next_cmd.group(3))
+        if name == "gsDPSetTileSize":
+            if render_tile is None or eval_gbi(next_args[0]) != 0:
+                return "render tile is set up elsewhere"
+            size = [eval_gbi(arg) for arg in next_args[1:5]]
+            if size != [0, 0, (texture.width - 1) << 2, (texture.height - 1) << 2]:
+                return "tile size doesn't cover the texture"
+            tile_args = [render_tile[9], render_tile[6], render_tile[10], render_tile[7], render_tile[11], render_tile[8]]
+            return line_start, end, lambda fmt: cmd.group(1) + load_texture_block(args[3], fmt, texture.width,
+                                                                                    texture.height, render_tile[5],
+                                                                                    tile_args)
+        if name not in TEXTURE_LOAD_COMMANDS:
+            return "render tile is set up elsewhere"
+        if name == "gsDPSetTile" and eval_gbi(next_args[4]) == 0:
+            if eval_gbi(next_args[3]) != 0 or len(next_args) != 12:
+                return "texture isn't loaded at the start of TMEM"
+            render_tile = next_args
+    return "texture load isn't followed by its tile setup"
+
+
+def rewrite_texture(texture, fmt, edits, include_renames):
+    _, intensities = greyscale_error(fmt, texture.colors)
+    base = texture.path[:-len(".rgba16.png")]
+    new_path = "%s.%s.png" % (base, fmt)
+
+    # n64graphics reads greyscale textures from grey and alpha PNGs; the values written are exactly the
+    # intensities it maps to the chosen levels.
+    rows = []
+    for y in range(texture.height):
+        row = []
+        for color in texture.texels[y * texture.width:(y + 1) * texture.width]:
+            row += [intensities[color], color[3]]
+        rows.append(row)
+    with open(new_path, "wb") as f:
+        png.Writer(texture.width, texture.height, greyscale=True, alpha=True, bitdepth=8).write(f, rows)
+    os.remove(texture.path)
+
+    for array_path, _ in texture.arrays:
+        include_renames.append((array_path, base + ".rgba16.inc.c", "%s.%s.inc.c" % (base, fmt)))
+    for path, start, end, make in texture.rewrites:
+        edits.append((path, start, end, make(fmt)))
+
+
+def apply_edits(index, edits, include_renames):
+    """Write the changed sources. Edits are made from the end of each file so the earlier offsets stay valid."""
+    written = set()
+    for path, start, end, replacement in sorted(edits, key=lambda edit: (edit[0], edit[1]), reverse=True):
+        text = index.texts[path]
+        index.texts[path] = text[:start] + replacement + text[end:]
+        written.add(path)
+    for path, old_include, new_include in include_renames:
+        index.texts[path] = index.texts[path].replace('"%s"' % old_include, '"%s"' % new_include)
+        written.add(path)
+    for path in sorted(written):
+        with open(path, "w") as f:
+            f.write(index.texts[path])
+
+
+def extracted_assets():
+    try:
+        with open("assets.json") as f:
+            return set(path for path in json.load(f) if not path.startswith("@"))
+    except OSError:
+        return set()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Finds RGBA16 textures that could use a cheaper format.")
+    parser.add_argument("--root", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."),
+                        help="repository to work on (default: the one this tool is in)")
+    parser.add_argument("--level", help="only handle this level, or group like actors or textures/generic")
+    parser.add_argument("--threshold", type=int, default=0,
+                        help="largest per channel error (0-255) allowed for greyscale formats (default: 0)")
+    parser.add_argument("--no-i", action="store_true", help="don't use I4/I8, whose alpha is their intensity")
+    parser.add_argument("--no-ci", action="store_true", help="don't use CI4/CI8, e.g. to find what --rewrite can do")
+    parser.add_argument("--rewrite", action="store_true", help="convert the textures that can be and their loads")
+    parser.add_argument("--include-extracted", action="store_true",
+                        help="let --rewrite convert textures extracted from the base ROM")
+    parser.add_argument("--json", help="also write every texture's choice to this JSON file")
+    parser.add_argument("--verbose", action="store_true", help="list every texture that has a cheaper format")
+    args = parser.parse_args()
+
+    os.chdir(args.root)
+
+    textures = {}
+    for top in TEXTURE_DIRS:
+        for root, _, files in os.walk(top):
+            for name in sorted(files):
+                if not name.endswith(".rgba16.png"):
+                    continue
+                path = os.path.join(root, name)
+                texture = Texture(path, *read_rgba16_texels(path))
+                if args.level is None or texture.group == args.level:
+                    textures[path] = texture
+
+    index = SourceIndex()
+    find_texture_arrays(index, textures)
+    for texture in textures.values():
+        # Textures nothing includes aren't in the ROM.
+        if texture.arrays:
+            texture.choose_format(args.threshold, not args.no_i, not args.no_ci)
+        if texture.choice is not None:
+            find_references(index, texture)
+            if texture.load_sites == 0:
+                texture.blocker = texture.blocker or "no display list loads it"
+
+    extracted = extracted_assets()
+    edits = []
+    include_renames = []
+    groups = {}
+    for path in sorted(textures):
+        texture = textures[path]
+        group = groups.setdefault(texture.group, {"textures": 0, "cheaper": 0, "rom": 0, "tmem": 0, "rewritten": 0})
+        group["textures"] += 1
+        if texture.choice is None:
+            continue
+
+        fmt, texel_bytes, tlut_bytes, error = texture.choice
+        saved = texture.size(16) - texel_bytes - tlut_bytes
+        group["cheaper"] += 1
+        group["rom"] += saved
+        group["tmem"] += saved * texture.load_sites
+
+        status = texture.blocker
+        if status is None and fmt.startswith("ci"):
+            status = "CI needs TLUT setup in the material"
+        if status is None and path in extracted and not args.include_extracted:
+            status = "extracted from the base ROM"
+        if args.rewrite and status is None:
+            rewrite_texture(texture, fmt, edits, include_renames)
+            group["rewritten"] += 1
+            status = "rewritten"
+        if args.verbose:
+            print("%s %dx%d -> %s (error %d, %d bytes saved, %d load sites): %s"
+                  % (path, texture.width, texture.height, fmt, error, saved, texture.load_sites,
+                     status or "can be rewritten"))
+
+    apply_edits(index, edits, include_renames)
+
+    print("%-24s %8s %8s %10s %10s%s" % ("level", "textures", "cheaper", "rom saved", "tmem saved",
+                                          "  rewritten" if args.rewrite else ""))
+    totals = dict((key, 0) for key in ("textures", "cheaper", "rom", "tmem", "rewritten"))
+    for name in sorted(groups):
+        group = groups[name]
+        for key in totals:
+            totals[key] += group[key]
+        print("%-24s %8d %8d %10d %10d%s" % (name, group["textures"], group["cheaper"], group["rom"], group["tmem"],
+                                             "  %9d" % group["rewritten"] if args.rewrite else ""))
+    print("%-24s %8d %8d %10d %10d%s" % ("total", totals["textures"], totals["cheaper"], totals["rom"], totals["tmem"],
+                                         "  %9d" % totals["rewritten"] if args.rewrite else ""))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump([{
+                "path": texture.path,
+                "width": texture.width,
+                "height": texture.height,
+                "format": texture.choice[0],
+                "error": texture.choice[3],
+                "bytes_saved": texture.size(16) - texture.choice[1] - texture.choice[2],
+                "load_sites": texture.load_sites,
+                "blocker": texture.blocker,
+            } for texture in textures.values() if texture.choice is not None], f, indent=2)
+
+
+if __name__ == "__main__":
+    main()